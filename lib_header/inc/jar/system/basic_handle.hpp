@@ -121,10 +121,14 @@ protected:
   /// \param[in]      other       Other
   constexpr basic_handle& operator=(basic_handle&& other) noexcept
   {
-    if (this != other) {
+    if (this != &other) {
+      if (is_valid()) {
+        Resource::destroy(m_value);
+      }
       m_value = other.m_value;
       other.m_value = invalid_handle();
     }
+    return *this;
   }
 
   /// \brief Destructor
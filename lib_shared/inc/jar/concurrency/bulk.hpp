@@ -0,0 +1,343 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file bulk.hpp
+///
+
+#ifndef JAR_CONCURRENCY_BULK_HPP
+#define JAR_CONCURRENCY_BULK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <jar/concurrency/details/block_pool.hpp>
+#include <jar/concurrency/stop_token.hpp>
+#include <jar/concurrency/type_traits.hpp>
+
+namespace jar::concurrency {
+namespace details {
+
+/// \brief The split of a loop into runner tasks and chunks of iterations
+struct bulk_shape {
+  unsigned runners;
+  std::size_t chunk;
+};
+
+/// \brief Gets the worker count of a scheduler, the hardware concurrency if the scheduler does not tell
+template <typename Scheduler> unsigned concurrency_of(Scheduler const& scheduler) noexcept
+{
+  if constexpr (has_concurrency<Scheduler>::value) {
+    return std::max(1U, scheduler.concurrency());
+  } else {
+    return std::max(1U, std::thread::hardware_concurrency());
+  }
+}
+
+/// \brief Splits a loop of count iterations into at most one runner per worker and a few chunks per runner
+///
+/// The chunks are claimed dynamically, so the runners that finish early take over the chunks of the slow ones.
+inline bulk_shape make_bulk_shape(unsigned concurrency, std::size_t count) noexcept
+{
+  static constexpr std::size_t chunks_per_runner{4U};
+
+  auto const runners = static_cast<unsigned>(std::min<std::size_t>(concurrency, count));
+  auto const chunk_count = std::max<std::size_t>(1U, std::size_t{runners} * chunks_per_runner);
+  return bulk_shape{runners, std::max<std::size_t>(1U, (count + chunk_count - 1U) / chunk_count)};
+}
+
+/// \brief The block shared by the runners of a bulk operation
+///
+/// Allocated once per operation from the block pool. The runners claim chunks from a shared cursor and invoke the
+/// chunk invocable with [begin, end) and their slot, so the invocable can keep per-runner state. The first error, a
+/// cancellation or a stop request checked before every chunk stops the runners from claiming more chunks, the last
+/// one to arrive signals the receiver once and destroys the block.
+template <typename Receiver, typename Invocable> class bulk_block {
+  enum outcome : std::uint32_t { outcome_none, outcome_failed, outcome_canceled };
+
+public:
+  static bulk_block* create(Receiver&& receiver, Invocable&& invocable, std::size_t count, bulk_shape shape)
+  {
+    auto* block = state_pool<bulk_block>::allocate();
+    try {
+      return ::new (block) bulk_block{std::move(receiver), std::move(invocable), count, shape};
+    } catch (...) {
+      state_pool<bulk_block>::deallocate(block);
+      throw;
+    }
+  }
+
+  void run(unsigned slot) noexcept
+  {
+    while (outcome_none == m_outcome.load(std::memory_order_relaxed)) {
+      if (m_receiver.is_canceled()) {
+        static_cast<void>(settle(outcome_canceled));
+        break;
+      }
+
+      auto const begin = m_cursor.fetch_add(m_chunk, std::memory_order_relaxed);
+      if (begin >= m_count) {
+        break;
+      }
+
+      try {
+        std::invoke(m_invocable, begin, std::min(begin + m_chunk, m_count), slot);
+      } catch (...) {
+        fail(std::current_exception());
+      }
+    }
+  }
+
+  void fail(std::exception_ptr e) noexcept
+  {
+    if (settle(outcome_failed)) {
+      m_error = e;
+    }
+  }
+
+  void arrive() noexcept
+  {
+    if (1U != m_pending.fetch_sub(1U, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    switch (m_outcome.load(std::memory_order_relaxed)) {
+    case outcome_failed:
+      m_receiver.fail(m_error);
+      break;
+    case outcome_canceled:
+      m_receiver.cancel();
+      break;
+    default:
+      // Every runner was dropped by the scheduler if some chunks were never claimed.
+      if (m_cursor.load(std::memory_order_relaxed) < m_count) {
+        m_receiver.cancel();
+      } else {
+        try {
+          m_receiver.complete();
+        } catch (...) {
+          m_receiver.fail(std::current_exception());
+        }
+      }
+      break;
+    }
+
+    this->~bulk_block();
+    state_pool<bulk_block>::deallocate(this);
+  }
+
+private:
+  bulk_block(Receiver&& receiver, Invocable&& invocable, std::size_t count, bulk_shape shape)
+    : m_cursor{0U}
+    , m_count{count}
+    , m_chunk{shape.chunk}
+    , m_pending{shape.runners + 1U}
+    , m_outcome{outcome_none}
+    , m_error{}
+    , m_invocable{std::move(invocable)}
+    , m_receiver{std::move(receiver)}
+  {
+  }
+
+  bool settle(outcome value) noexcept
+  {
+    auto expected = outcome_none;
+    return m_outcome.compare_exchange_strong(expected, value, std::memory_order_acq_rel, std::memory_order_relaxed);
+  }
+
+  alignas(64) std::atomic<std::size_t> m_cursor;
+  alignas(64) std::size_t const m_count;
+  std::size_t const m_chunk;
+  std::atomic<std::uint32_t> m_pending;
+  std::atomic<outcome> m_outcome;
+  std::exception_ptr m_error;
+  Invocable m_invocable;
+  Receiver m_receiver;
+};
+
+/// \brief A runner task of a bulk operation, a runner dropped by the scheduler still arrives
+template <typename Block> class bulk_runner {
+public:
+  bulk_runner(Block* block, unsigned slot) noexcept
+    : m_block{block}
+    , m_slot{slot}
+  {
+  }
+
+  bulk_runner(bulk_runner const&) = delete;
+
+  bulk_runner(bulk_runner&& other) noexcept
+    : m_block{std::exchange(other.m_block, nullptr)}
+    , m_slot{other.m_slot}
+  {
+  }
+
+  bulk_runner& operator=(bulk_runner const&) = delete;
+  bulk_runner& operator=(bulk_runner&&) = delete;
+
+  ~bulk_runner()
+  {
+    if (nullptr != m_block) {
+      std::exchange(m_block, nullptr)->arrive();
+    }
+  }
+
+  void operator()() noexcept
+  {
+    m_block->run(m_slot);
+    std::exchange(m_block, nullptr)->arrive();
+  }
+
+private:
+  Block* m_block;
+  unsigned m_slot;
+};
+
+template <typename Receiver, typename Scheduler, typename Invocable> class bulk_state {
+  using block_type = bulk_block<Receiver, Invocable>;
+
+public:
+  bulk_state(Receiver&& receiver, Scheduler&& scheduler, Invocable&& invocable, std::size_t count, bulk_shape shape)
+    : m_receiver{std::move(receiver)}
+    , m_scheduler{std::move(scheduler)}
+    , m_invocable{std::move(invocable)}
+    , m_count{count}
+    , m_shape{shape}
+  {
+  }
+
+  void start()
+  {
+    if (m_receiver.is_canceled()) {
+      m_receiver.cancel();
+      return;
+    }
+
+    if (0U == m_count) {
+      try {
+        m_receiver.complete();
+      } catch (...) {
+        m_receiver.fail(std::current_exception());
+      }
+      return;
+    }
+
+    // The starter holds a reference of its own, so the block outlives a failure to schedule a runner.
+    auto* const block = block_type::create(std::move(m_receiver), std::move(m_invocable), m_count, m_shape);
+    for (unsigned slot = 0U; slot != m_shape.runners; ++slot) {
+      try {
+        m_scheduler.schedule(bulk_runner<block_type>{block, slot});
+      } catch (...) {
+        block->fail(std::current_exception());
+        for (++slot; slot != m_shape.runners; ++slot) {
+          block->arrive();
+        }
+        break;
+      }
+    }
+    block->arrive();
+  }
+
+private:
+  Receiver m_receiver;
+  Scheduler m_scheduler;
+  Invocable m_invocable;
+  std::size_t m_count;
+  bulk_shape m_shape;
+};
+
+template <typename Scheduler, typename Invocable> class bulk_sender {
+public:
+  using result_type = void;
+
+  bulk_sender(Scheduler&& scheduler, Invocable&& invocable, std::size_t count, bulk_shape shape) noexcept
+    : m_scheduler{std::move(scheduler)}
+    , m_invocable{std::move(invocable)}
+    , m_count{count}
+    , m_shape{shape}
+  {
+  }
+
+  template <typename Receiver> auto connect(Receiver&& receiver)
+  {
+    return bulk_state<Receiver, Scheduler, Invocable>{std::forward<Receiver>(receiver), std::move(m_scheduler),
+                                                      std::move(m_invocable), m_count, m_shape};
+  }
+
+private:
+  Scheduler m_scheduler;
+  Invocable m_invocable;
+  std::size_t m_count;
+  bulk_shape m_shape;
+};
+
+/// \brief Invokes an invocable of an index for every index of a chunk
+template <typename Invocable> class bulk_loop {
+public:
+  template <typename T>
+  explicit bulk_loop(T&& invocable)
+    : m_invocable{std::forward<T>(invocable)}
+  {
+  }
+
+  void operator()(std::size_t begin, std::size_t end, unsigned) const
+  {
+    for (auto index = begin; index != end; ++index) {
+      std::invoke(m_invocable, index);
+    }
+  }
+
+private:
+  Invocable m_invocable;
+};
+
+/// \brief Creates a bulk sender from an invocable of chunks, invoked as invocable(begin, end, slot)
+///
+/// Slots are in [0, shape.runners) and a slot is never used by two chunks at the same time.
+template <typename Scheduler, typename Invocable>
+auto bulk_chunks(Scheduler scheduler, std::size_t count, bulk_shape shape, Invocable&& invocable)
+{
+  static_assert(is_output_scheduler<Scheduler>::value, "scheduler must fulfill output Scheduler type requirements");
+  return bulk_sender<Scheduler, std::decay_t<Invocable>>{std::move(scheduler), std::forward<Invocable>(invocable),
+                                                         count, shape};
+}
+
+}  // namespace details
+
+/// \brief Creates a sender that invokes invocable(index) for every index in [0, count) on the scheduler
+///
+/// The iterations are split into chunks by the worker count of the scheduler, at most one runner task per worker
+/// claims chunks until the loop is done. The invocable is shared by the runners and invoked concurrently, so it is
+/// invoked through a const reference. The sender completes once, with the first error if an iteration throws.
+template <typename Scheduler, typename Invocable>
+auto bulk(Scheduler scheduler, std::size_t count, Invocable&& invocable)
+{
+  static_assert(std::is_invocable_v<std::decay_t<Invocable> const&, std::size_t>,
+                "Invocable must be invocable with an index");
+
+  auto const shape = details::make_bulk_shape(details::concurrency_of(scheduler), count);
+  return details::bulk_chunks(std::move(scheduler), count, shape,
+                              details::bulk_loop<std::decay_t<Invocable>>{std::forward<Invocable>(invocable)});
+}
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_BULK_HPP
@@ -0,0 +1,276 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file coroutine.hpp
+///
+
+#ifndef JAR_CONCURRENCY_COROUTINE_HPP
+#define JAR_CONCURRENCY_COROUTINE_HPP
+
+#if !defined(__cpp_impl_coroutine)
+#error "jar/concurrency/coroutine.hpp requires C++20 coroutines, configure with -Dcoroutines=ON"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <jar/concurrency/details/when_receiver.hpp>
+#include <jar/concurrency/future.hpp>
+#include <jar/concurrency/schedule.hpp>
+#include <jar/concurrency/stop_token.hpp>
+#include <jar/concurrency/type_traits.hpp>
+
+namespace jar::concurrency {
+
+/// \brief Thrown by co_await when the awaited sender or future was canceled
+class operation_canceled : public std::exception {
+public:
+  char const* what() const noexcept override { return "operation canceled"; }
+};
+
+namespace details {
+
+/// \brief A sender of this library, every sender declares the type of its result, awaitables such as task are excluded
+template <typename T>
+concept awaitable_sender = requires { typename std::remove_cvref_t<T>::result_type; } &&
+                           !requires(T&& t) { std::forward<T>(t).operator co_await(); };
+
+/// \brief A sender awaiter that is being started on the calling thread
+struct inline_start {
+  void const* awaiter;
+  bool is_completed;
+};
+
+inline thread_local inline_start* t_inline_start{nullptr};
+
+/// \brief Awaits a sender, the awaiting coroutine is resumed by the receiver on the thread that completes the sender
+///
+/// The operation state lives in the coroutine frame. A sender that completes inline, while it is being started, does
+/// not resume the coroutine recursively but lets it continue once the start returns, so a loop over inline senders
+/// does not grow the stack. The stop token of the awaiting promise, when it has one, is the stop token of the receiver.
+template <typename Sender> class sender_awaiter {
+  using value_type = typename Sender::result_type;
+
+  class receiver {
+  public:
+    explicit receiver(sender_awaiter* awaiter) noexcept
+      : m_awaiter{awaiter}
+    {
+    }
+
+    receiver(receiver const&) = delete;
+
+    receiver(receiver&& other) noexcept
+      : m_awaiter{std::exchange(other.m_awaiter, nullptr)}
+    {
+    }
+
+    receiver& operator=(receiver const&) = delete;
+    receiver& operator=(receiver&&) = delete;
+
+    ~receiver()
+    {
+      if (nullptr != m_awaiter) {
+        cancel();
+      }
+    }
+
+    template <typename... Values> void complete(Values&&... values)
+    {
+      m_awaiter->m_result.template emplace<s_value>(std::forward<Values>(values)...);
+      std::exchange(m_awaiter, nullptr)->signal();
+    }
+
+    void fail(std::exception_ptr e) noexcept
+    {
+      m_awaiter->m_result.template emplace<s_error>(e);
+      std::exchange(m_awaiter, nullptr)->signal();
+    }
+
+    void set_error(std::error_code error) noexcept
+    {
+      m_awaiter->m_result.template emplace<s_error_code>(error);
+      std::exchange(m_awaiter, nullptr)->signal();
+    }
+
+    void cancel() noexcept
+    {
+      m_awaiter->m_result.template emplace<s_canceled>();
+      std::exchange(m_awaiter, nullptr)->signal();
+    }
+
+    bool is_canceled() const noexcept { return nullptr == m_awaiter || m_awaiter->m_stop_token.stop_requested(); }
+
+    stop_token get_stop_token() const noexcept { return nullptr == m_awaiter ? stop_token{} : m_awaiter->m_stop_token; }
+
+  private:
+    sender_awaiter* m_awaiter;
+  };
+
+  using state_type = decltype(std::declval<Sender&>().connect(std::declval<receiver>()));
+
+  inline static constexpr std::size_t s_value{1U};
+  inline static constexpr std::size_t s_error{2U};
+  inline static constexpr std::size_t s_canceled{3U};
+  inline static constexpr std::size_t s_error_code{4U};
+
+public:
+  explicit sender_awaiter(Sender&& sender)
+    : m_sender{std::move(sender)}
+  {
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  template <typename Promise> bool await_suspend(std::coroutine_handle<Promise> handle)
+  {
+    m_handle = handle;
+    if constexpr (has_stop_token<Promise>::value) {
+      m_stop_token = handle.promise().get_stop_token();
+    }
+
+    m_state.emplace(m_sender.connect(receiver{this}));
+
+    // The coroutine may be resumed on another thread before start returns, only the locals are safe to touch.
+    inline_start current{this, false};
+    auto* const outer = std::exchange(t_inline_start, &current);
+    try {
+      m_state->start();
+    } catch (...) {
+      t_inline_start = outer;
+      throw;
+    }
+    t_inline_start = outer;
+    return !current.is_completed;
+  }
+
+  value_type await_resume()
+  {
+    switch (m_result.index()) {
+    case s_error:
+      std::rethrow_exception(std::get<s_error>(m_result));
+    case s_canceled:
+      throw operation_canceled{};
+    case s_error_code:
+      throw std::system_error{std::get<s_error_code>(m_result)};
+    default:
+      if constexpr (!std::is_void_v<value_type>) {
+        return std::move(std::get<s_value>(m_result));
+      }
+    }
+  }
+
+private:
+  void signal() noexcept
+  {
+    if (nullptr != t_inline_start && this == t_inline_start->awaiter) {
+      t_inline_start->is_completed = true;
+    } else {
+      m_handle.resume();
+    }
+  }
+
+  Sender m_sender;
+  std::optional<state_type> m_state{};
+  std::variant<std::monostate, non_void_t<value_type>, std::exception_ptr, std::monostate, std::error_code> m_result{};
+  std::coroutine_handle<> m_handle{};
+  stop_token m_stop_token{};
+};
+
+/// \brief Awaits a future, the awaiting coroutine is resumed on the thread that completes the promise
+///
+/// The awaiter is the continuation of the shared state itself, so awaiting does not allocate. A future that is already
+/// ready lets the coroutine continue without suspending.
+template <typename Value> class future_awaiter final : public continuation {
+public:
+  explicit future_awaiter(future<Value>&& future) noexcept
+    : m_future{std::move(future)}
+  {
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  bool await_suspend(std::coroutine_handle<> handle) noexcept
+  {
+    m_handle = handle;
+
+    inline_start current{this, false};
+    auto* const outer = std::exchange(t_inline_start, &current);
+    m_future.m_shared_state->attach(this);
+    t_inline_start = outer;
+    return !current.is_completed;
+  }
+
+  Value await_resume()
+  {
+    auto result = m_future.get();
+    if (result.is_canceled()) {
+      throw operation_canceled{};
+    }
+    if (result.has_error()) {
+      throw std::system_error{result.error()};
+    }
+    if constexpr (!std::is_void_v<Value>) {
+      return std::move(result.value());
+    }
+  }
+
+  void run() noexcept override
+  {
+    if (nullptr != t_inline_start && this == t_inline_start->awaiter) {
+      t_inline_start->is_completed = true;
+    } else {
+      m_handle.resume();
+    }
+  }
+
+private:
+  future<Value> m_future;
+  std::coroutine_handle<> m_handle{};
+};
+
+/// \brief Makes the senders of this library awaitable, co_await yields the value or throws the error
+///
+/// An error code is thrown as std::system_error.
+template <awaitable_sender Sender>
+  requires(!std::is_lvalue_reference_v<Sender>)
+auto operator co_await(Sender&& sender)
+{
+  return sender_awaiter<std::remove_cvref_t<Sender>>{std::move(sender)};
+}
+
+}  // namespace details
+
+/// \brief Makes a future awaitable, co_await consumes the future and yields the value or throws the error
+///
+/// \throw  operation_canceled if the future was canceled, std::system_error if it holds an error code
+template <typename Value> auto operator co_await(future<Value>&& future) noexcept
+{
+  return details::future_awaiter<Value>{std::move(future)};
+}
+
+/// \brief Creates a sender that resumes an awaiting coroutine on the scheduler, e.g. a worker of a thread_pool
+template <typename Scheduler> auto resume_on(Scheduler scheduler) noexcept
+{
+  return schedule(std::move(scheduler));
+}
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_COROUTINE_HPP
@@ -0,0 +1,147 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file block_pool.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_BLOCK_POOL_HPP
+#define JAR_CONCURRENCY_DETAILS_BLOCK_POOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/// \brief Enables the per-thread free lists of block_pool, address sanitized builds bypass them by default so that
+///        use-after-free of pooled objects is still detected
+#ifndef JAR_CONCURRENCY_BLOCK_POOL
+#if defined(__SANITIZE_ADDRESS__)
+#define JAR_CONCURRENCY_BLOCK_POOL 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define JAR_CONCURRENCY_BLOCK_POOL 0
+#endif
+#endif
+#endif
+
+#ifndef JAR_CONCURRENCY_BLOCK_POOL
+#define JAR_CONCURRENCY_BLOCK_POOL 1
+#endif
+
+namespace jar::concurrency::details {
+
+/// \brief Per-thread free lists of memory blocks of one size
+///
+/// A released block goes to the free list of the releasing thread, which is not necessarily the allocating thread.
+/// Blocks come from the global allocation functions, so any thread may free any block. The free lists are bounded
+/// and emptied when the thread exits. Blocks released later in the thread exit, e.g. by a thread_local destroyed after
+/// the free list, go straight back to the global allocator.
+///
+/// \tparam Size        Block size in bytes
+/// \tparam Alignment   Block alignment in bytes
+template <std::size_t Size, std::size_t Alignment> class block_pool {
+  static_assert(Size >= sizeof(void*), "block must be able to hold a free list link");
+
+  inline static constexpr bool s_is_over_aligned{Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__};
+  inline static constexpr std::size_t s_capacity{64U};
+
+  struct free_block {
+    free_block* next;
+  };
+
+  struct free_list {
+    free_list() noexcept = default;
+
+    free_list(free_list const&) = delete;
+    free_list(free_list&&) = delete;
+    free_list& operator=(free_list const&) = delete;
+    free_list& operator=(free_list&&) = delete;
+
+    ~free_list()
+    {
+      is_destroyed() = true;
+      while (nullptr != head) {
+        release(std::exchange(head, head->next));
+      }
+    }
+
+    free_block* head{nullptr};
+    std::size_t size{0U};
+  };
+
+public:
+  static void* allocate()
+  {
+    if constexpr (0 != JAR_CONCURRENCY_BLOCK_POOL) {
+      if (!is_destroyed()) {
+        auto& list = local();
+        if (nullptr != list.head) {
+          --list.size;
+          return std::exchange(list.head, list.head->next);
+        }
+      }
+    }
+
+    if constexpr (s_is_over_aligned) {
+      return ::operator new(Size, std::align_val_t{Alignment});
+    } else {
+      return ::operator new(Size);
+    }
+  }
+
+  static void deallocate(void* block) noexcept
+  {
+    if constexpr (0 != JAR_CONCURRENCY_BLOCK_POOL) {
+      if (!is_destroyed()) {
+        auto& list = local();
+        if (list.size != s_capacity) {
+          ++list.size;
+          list.head = ::new (block) free_block{list.head};
+          return;
+        }
+      }
+    }
+
+    release(block);
+  }
+
+private:
+  static free_list& local() noexcept
+  {
+    static thread_local free_list list;
+    return list;
+  }
+
+  /// \brief Tells whether the free list of this thread is gone, the flag is trivially destructible so it outlives it
+  static bool& is_destroyed() noexcept
+  {
+    static thread_local bool destroyed{false};
+    return destroyed;
+  }
+
+  static void release(void* block) noexcept
+  {
+    if constexpr (s_is_over_aligned) {
+      ::operator delete(block, std::align_val_t{Alignment});
+    } else {
+      ::operator delete(block);
+    }
+  }
+};
+
+/// \brief The block pool of a state type, sizes are rounded up so that similar states share a pool
+template <typename State> using state_pool = block_pool<(sizeof(State) + 15U) / 16U * 16U, alignof(State)>;
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_BLOCK_POOL_HPP
@@ -22,8 +22,10 @@
 #include <exception>
 #include <functional>
 #include <stdexcept>
+#include <system_error>
 #include <utility>
 
+#include <jar/concurrency/stop_token.hpp>
 #include <jar/concurrency/type_traits.hpp>
 
 namespace jar::concurrency::details {
@@ -33,11 +35,12 @@ class callback_receiver {
   enum class receiver_state { initial, completed, failed, canceled };
 
 public:
-  callback_receiver(CompleteHandler&& complete, ErrorHandler&& error, CancelHandler&& cancel)
+  callback_receiver(CompleteHandler&& complete, ErrorHandler&& error, CancelHandler&& cancel, stop_token token = {})
     : m_state{receiver_state::initial}
     , m_complete_handler{std::move(complete)}
     , m_error_handler{std::move(error)}
     , m_cancel_handler{std::move(cancel)}
+    , m_stop_token{std::move(token)}
   {
     static_assert(std::is_invocable_v<ErrorHandler, std::exception_ptr>,
                   "ErrorHandler must be noexcept and must accept std::exception_ptr as argument");
@@ -45,11 +48,12 @@ public:
                   "CancelHandler must be noexcept and must not expect any arguments");
   }
 
-  callback_receiver(callback_receiver&& other)
+  callback_receiver(callback_receiver&& other) noexcept(s_is_nothrow_movable)
     : m_state{other.m_state.load()}
     , m_complete_handler{std::move(other.m_complete_handler)}
     , m_error_handler{std::move(other.m_error_handler)}
     , m_cancel_handler{std::move(other.m_cancel_handler)}
+    , m_stop_token{std::move(other.m_stop_token)}
   {
   }
 
@@ -79,6 +83,19 @@ public:
     }
   }
 
+  /// \brief Fails with an error code, an error handler that does not accept std::error_code gets a system_error
+  void set_error(std::error_code error) noexcept
+  {
+    auto initial_state = receiver_state::initial;
+    if (m_state.compare_exchange_strong(initial_state, receiver_state::failed)) {
+      if constexpr (std::is_invocable_v<ErrorHandler, std::error_code>) {
+        std::invoke(std::move(m_error_handler), error);
+      } else {
+        std::invoke(std::move(m_error_handler), std::make_exception_ptr(std::system_error{error}));
+      }
+    }
+  }
+
   void cancel() noexcept
   {
     auto initial_state = receiver_state::initial;
@@ -87,13 +104,23 @@ public:
     }
   }
 
-  bool is_canceled() const noexcept { return receiver_state::failed != m_state.load(); }
+  bool is_canceled() const noexcept
+  {
+    return receiver_state::canceled == m_state.load() || m_stop_token.stop_requested();
+  }
+
+  stop_token get_stop_token() const noexcept { return m_stop_token; }
 
 private:
+  inline static constexpr bool s_is_nothrow_movable{std::is_nothrow_move_constructible_v<CompleteHandler>
+                                                    && std::is_nothrow_move_constructible_v<ErrorHandler>
+                                                    && std::is_nothrow_move_constructible_v<CancelHandler>};
+
   std::atomic<receiver_state> m_state;
   CompleteHandler m_complete_handler;
   ErrorHandler m_error_handler;
   CancelHandler m_cancel_handler;
+  stop_token m_stop_token;
 };
 
 template <typename CompleteHandler, typename ErrorHandler, typename CancelHandler,
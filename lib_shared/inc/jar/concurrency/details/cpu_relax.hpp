@@ -0,0 +1,35 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file cpu_relax.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_CPU_RELAX_HPP
+#define JAR_CONCURRENCY_DETAILS_CPU_RELAX_HPP
+
+namespace jar::concurrency::details {
+
+/// \brief Hints the processor that the calling thread is busy-waiting
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_CPU_RELAX_HPP
@@ -0,0 +1,62 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file error_channel.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_ERROR_CHANNEL_HPP
+#define JAR_CONCURRENCY_DETAILS_ERROR_CHANNEL_HPP
+
+#include <exception>
+#include <system_error>
+
+#include <jar/concurrency/type_traits.hpp>
+
+namespace jar::concurrency::details {
+
+/// \brief Signals an error code to the receiver, a receiver without the error code channel fails with system_error
+template <typename Receiver> void set_error(Receiver& receiver, std::error_code error) noexcept
+{
+  if constexpr (has_set_error<Receiver>::value) {
+    receiver.set_error(error);
+  } else {
+    receiver.fail(std::make_exception_ptr(std::system_error{error}));
+  }
+}
+
+/// \brief The first error of an operation with several children, either an exception or an error code
+class stored_error {
+public:
+  void store(std::exception_ptr e) noexcept { m_exception = e; }
+
+  void store(std::error_code error) noexcept { m_error = error; }
+
+  /// \brief Signals the stored error to the receiver through the channel it was stored from
+  template <typename Receiver> void deliver(Receiver& receiver) noexcept
+  {
+    if (m_exception) {
+      receiver.fail(m_exception);
+    } else {
+      set_error(receiver, m_error);
+    }
+  }
+
+private:
+  std::exception_ptr m_exception{};
+  std::error_code m_error{};
+};
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_ERROR_CHANNEL_HPP
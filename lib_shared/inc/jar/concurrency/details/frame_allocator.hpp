@@ -0,0 +1,81 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file frame_allocator.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_FRAME_ALLOCATOR_HPP
+#define JAR_CONCURRENCY_DETAILS_FRAME_ALLOCATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include <jar/concurrency/details/block_pool.hpp>
+
+namespace jar::concurrency::details {
+
+template <std::size_t Size> using frame_pool = block_pool<Size, alignof(std::max_align_t)>;
+
+/// \brief Gets the allocate functions of the size classes, the class N holds frames up to (N + 1) * Granularity bytes
+template <std::size_t Granularity, std::size_t... Classes>
+constexpr auto frame_allocate_table(std::index_sequence<Classes...>) noexcept
+{
+  return std::array<void* (*)(), sizeof...(Classes)>{&frame_pool<(Classes + 1U) * Granularity>::allocate...};
+}
+
+template <std::size_t Granularity, std::size_t... Classes>
+constexpr auto frame_deallocate_table(std::index_sequence<Classes...>) noexcept
+{
+  return std::array<void (*)(void*) noexcept, sizeof...(Classes)>{
+      &frame_pool<(Classes + 1U) * Granularity>::deallocate...};
+}
+
+/// \brief A recycling allocator of coroutine frames
+///
+/// Frames up to s_max_pooled bytes are rounded up to a multiple of s_granularity and allocated from the block pool of
+/// that size class, so a frame of a short-lived coroutine is usually reused by the next coroutine of a similar size.
+/// Larger frames come straight from the global allocation functions.
+class frame_allocator {
+  inline static constexpr std::size_t s_granularity{64U};
+  inline static constexpr std::size_t s_max_pooled{2048U};
+  inline static constexpr std::size_t s_class_count{s_max_pooled / s_granularity};
+
+  static constexpr std::size_t size_class(std::size_t size) noexcept { return (size - 1U) / s_granularity; }
+
+public:
+  static void* allocate(std::size_t size)
+  {
+    if (0U == size || size > s_max_pooled) {
+      return ::operator new(size);
+    }
+    static constexpr auto table{frame_allocate_table<s_granularity>(std::make_index_sequence<s_class_count>{})};
+    return table[size_class(size)]();
+  }
+
+  static void deallocate(void* frame, std::size_t size) noexcept
+  {
+    if (0U == size || size > s_max_pooled) {
+      ::operator delete(frame);
+      return;
+    }
+    static constexpr auto table{frame_deallocate_table<s_granularity>(std::make_index_sequence<s_class_count>{})};
+    table[size_class(size)](frame);
+  }
+};
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_FRAME_ALLOCATOR_HPP
@@ -0,0 +1,97 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file futex.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_FUTEX_HPP
+#define JAR_CONCURRENCY_DETAILS_FUTEX_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace jar::concurrency::details {
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) &&
+                  std::atomic<std::uint32_t>::is_always_lock_free,
+              "futex word must be a plain 32-bit integer");
+
+/// \brief Blocks the calling thread while the word holds the expected value
+///
+/// Off Linux a C++20 build blocks with std::atomic::wait, otherwise the wait degrades to yielding. May return
+/// spuriously, callers must re-check the word.
+inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept
+{
+#if defined(__linux__)
+  ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#elif defined(__cpp_lib_atomic_wait)
+  word.wait(expected, std::memory_order_relaxed);
+#else
+  if (word.load(std::memory_order_relaxed) == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+/// \brief Blocks the calling thread while the word holds the expected value, at most for the given timeout
+///
+/// May return spuriously or before the timeout, callers must re-check the word and the time.
+inline void futex_wait_for(std::atomic<std::uint32_t>& word, std::uint32_t expected,
+                           std::chrono::nanoseconds timeout) noexcept
+{
+#if defined(__linux__)
+  auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  ::timespec const relative{static_cast<::time_t>(seconds.count()), static_cast<long>((timeout - seconds).count())};
+  ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &relative, nullptr, 0);
+#else
+  static_cast<void>(timeout);
+  if (word.load(std::memory_order_relaxed) == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+/// \brief Wakes up to count threads blocked on the word
+inline void futex_wake(std::atomic<std::uint32_t>& word, int count = 1) noexcept
+{
+#if defined(__linux__)
+  ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#elif defined(__cpp_lib_atomic_wait)
+  if (1 == count) {
+    word.notify_one();
+  } else {
+    word.notify_all();
+  }
+#else
+  static_cast<void>(word);
+  static_cast<void>(count);
+#endif
+}
+
+/// \brief Wakes up all threads blocked on the word
+inline void futex_wake_all(std::atomic<std::uint32_t>& word) noexcept { futex_wake(word, INT_MAX); }
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_FUTEX_HPP
@@ -19,84 +19,136 @@
 #define JAR_CONCURRENCY_DETAILS_SENDER_ADAPTER_HPP
 
 #include <exception>
+#include <cstddef>
 #include <functional>
+#include <system_error>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
+#include "jar/concurrency/details/error_channel.hpp"
+#include "jar/concurrency/stop_token.hpp"
 #include "jar/concurrency/type_traits.hpp"
 
 namespace jar::concurrency::details {
 
-template <typename Receiver, typename Invocable> class receiver_adapter {
+/// \brief Runs a fused chain of invocables, each invocable is invoked with the result of the previous one
+///
+/// A chain of then() calls is a single receiver with a tuple of invocables instead of a receiver per stage, so the
+/// operation state of the whole chain is one flat object and the values are passed from stage to stage on the stack.
+/// Every stage is skipped and the next receiver canceled if stop was requested.
+template <typename Receiver, typename... Invocables> class receiver_adapter {
+  static_assert(0U < sizeof...(Invocables), "receiver_adapter requires an invocable");
+
 public:
-  receiver_adapter(Receiver&& receiver, Invocable&& invocable)
+  receiver_adapter(Receiver&& receiver, Invocables&&... invocables)
     : m_receiver{std::move(receiver)}
-    , m_invocable{std::move(invocable)}
+    , m_invocables{std::move(invocables)...}
   {
   }
 
-  template <typename... Values> void complete(Values&&... values)
+  receiver_adapter(Receiver&& receiver, std::tuple<Invocables...>&& invocables)
+    : m_receiver{std::move(receiver)}
+    , m_invocables{std::move(invocables)}
   {
-    static_assert(std::is_invocable_v<Invocable, Values...>, "Invocable must accept Values as arguments");
-
-    if constexpr (std::is_same_v<std::invoke_result_t<Invocable, Values...>, void>) {
-      std::invoke(std::move(m_invocable), std::forward<Values>(values)...);
-      m_receiver.complete();
-    } else {
-      m_receiver.complete(std::invoke(std::move(m_invocable), std::forward<Values>(values)...));
-    }
   }
 
+  /// \brief Invokes the invocables and completes the next receiver with the result, skipped if stop was requested
+  template <typename... Values> void complete(Values&&... values) { invoke<0U>(std::forward<Values>(values)...); }
+
   void fail(std::exception_ptr e) noexcept { m_receiver.fail(e); }
 
+  void set_error(std::error_code error) noexcept { details::set_error(m_receiver, error); }
+
   void cancel() noexcept { m_receiver.cancel(); }
 
   bool is_canceled() noexcept { return m_receiver.is_canceled(); }
 
+  stop_token get_stop_token() const noexcept { return details::get_stop_token(m_receiver); }
+
   template <typename T = Receiver, std::enable_if_t<has_future<T>::value, bool> = true> auto get_future()
   {
     return m_receiver.get_future();
   }
 
 private:
-  Receiver m_receiver;
-  Invocable m_invocable;
-};
-
-template <typename State> class composite_state {
-public:
-  composite_state(State&& state)
-    : m_state{std::move(state)}
+  template <std::size_t Index, typename... Values> void invoke(Values&&... values)
   {
+    if constexpr (Index == sizeof...(Invocables)) {
+      m_receiver.complete(std::forward<Values>(values)...);
+    } else {
+      using invocable_type = std::tuple_element_t<Index, std::tuple<Invocables...>>;
+      static_assert(std::is_invocable_v<invocable_type, Values...>, "Invocable must accept Values as arguments");
+
+      if (m_receiver.is_canceled()) {
+        m_receiver.cancel();
+        return;
+      }
+
+      auto&& invocable = std::get<Index>(m_invocables);
+      if constexpr (std::is_same_v<std::invoke_result_t<invocable_type, Values...>, void>) {
+        std::invoke(std::move(invocable), std::forward<Values>(values)...);
+        invoke<Index + 1U>();
+      } else {
+        invoke<Index + 1U>(std::invoke(std::move(invocable), std::forward<Values>(values)...));
+      }
+    }
   }
 
-  void start() { m_state.start(); }
-
-private:
-  State m_state;
+  Receiver m_receiver;
+  std::tuple<Invocables...> m_invocables;
 };
 
-template <typename Sender, typename Invocable> class sender_adapter {
-  using invocable_args_as_tuple = typename invocable<Invocable>::args_as_tuple;
+/// \brief A sender that runs a chain of invocables with the result of the sender
+///
+/// Applying then() to a sender_adapter appends the invocable to the chain instead of wrapping the adapter, so a chain
+/// of any depth connects to one receiver_adapter and starts as the operation state of the innermost sender. A chain
+/// that starts with schedule() is therefore scheduled as one task.
+template <typename Sender, typename... Invocables> class sender_adapter {
+  using last_invocable = std::tuple_element_t<sizeof...(Invocables) - 1U, std::tuple<Invocables...>>;
+  using invocable_args_as_tuple = typename invocable<last_invocable>::args_as_tuple;
+
+  template <typename, typename...> friend class sender_adapter;
 
 public:
-  using result_type = decltype(std::apply(std::declval<Invocable>(), std::declval<invocable_args_as_tuple>()));
+  using result_type = decltype(std::apply(std::declval<last_invocable>(), std::declval<invocable_args_as_tuple>()));
 
-  sender_adapter(Sender&& sender, Invocable&& invocable)
+  sender_adapter(Sender&& sender, Invocables&&... invocables)
     : m_sender{std::move(sender)}
-    , m_invocable{std::move(invocable)}
+    , m_invocables{std::move(invocables)...}
   {
   }
 
   template <typename Receiver> auto connect(Receiver&& receiver)
   {
-    return composite_state{
-        m_sender.connect(receiver_adapter{std::forward<Receiver>(receiver), std::move(m_invocable)})};
+    using adapter_type = receiver_adapter<std::decay_t<Receiver>, Invocables...>;
+    return m_sender.connect(adapter_type{std::forward<Receiver>(receiver), std::move(m_invocables)});
+  }
+
+  /// \brief Appends an invocable to the chain, the invocable is run with the result of the chain
+  template <typename Invocable> auto fuse(Invocable&& invocable) &&
+  {
+    return sender_adapter<Sender, Invocables..., std::decay_t<Invocable>>{
+        std::move(*this), std::forward<Invocable>(invocable), std::index_sequence_for<Invocables...>{}};
   }
 
 private:
+  template <typename Other, typename Invocable, std::size_t... Indices>
+  sender_adapter(Other&& other, Invocable&& invocable, std::index_sequence<Indices...>)
+    : m_sender{std::move(other.m_sender)}
+    , m_invocables{std::move(std::get<Indices>(other.m_invocables))..., std::forward<Invocable>(invocable)}
+  {
+  }
+
   Sender m_sender;
-  Invocable m_invocable;
+  std::tuple<Invocables...> m_invocables;
+};
+
+template <typename Sender> struct is_sender_adapter : std::false_type {
+};
+
+template <typename Sender, typename... Invocables>
+struct is_sender_adapter<sender_adapter<Sender, Invocables...>> : std::true_type {
 };
 
 }  // namespace jar::concurrency::details
@@ -19,46 +19,63 @@
 #define JAR_CONCURRENCY_DETAILS_VALUE_RECEIVER_HPP
 
 #include <exception>
-#include <memory>
+#include <system_error>
+#include <type_traits>
+#include <utility>
 
 #include <jar/concurrency/future.hpp>
+#include <jar/concurrency/stop_token.hpp>
 
 namespace jar::concurrency::details {
 
+/// \brief A receiver that completes a future
+///
+/// Copies of the receiver share the producer side of the shared state directly, the promise is broken when the last
+/// copy is destroyed without completing it. The receiver is canceled when the future is canceled or when stop is
+/// requested through its stop token.
 template <typename Value> class value_receiver {
 public:
   value_receiver()
-    : m_value{std::make_shared<promise<Value>>()}
+    : value_receiver{stop_token{}}
   {
   }
 
-  value_receiver(value_receiver const& other)
-    : m_value{other.m_value}
+  explicit value_receiver(stop_token token)
+    : m_state{state_ref<Value, true>::adopt(shared_state<Value>::create())}
+    , m_stop_token{std::move(token)}
   {
   }
 
+  value_receiver(value_receiver const& other) = default;
+  value_receiver(value_receiver&& other) noexcept = default;
+
   ~value_receiver() = default;
 
   template <typename V = Value, std::enable_if_t<!std::is_same_v<V, void>, bool> = true> void complete(V&& value)
   {
-    m_value->set_value(std::forward<V>(value));
+    m_state->set_value(future_result<Value>(std::forward<V>(value)));
   }
 
   template <typename V = Value, std::enable_if_t<std::is_same_v<V, void>, bool> = true> void complete()
   {
-    m_value->set_value();
+    m_state->set_value(future_result<Value>{});
   }
 
-  void fail(std::exception_ptr e) noexcept { m_value->set_exception(e); }
+  void fail(std::exception_ptr e) noexcept { m_state->set_exception(e); }
+
+  void set_error(std::error_code error) noexcept { m_state->set_error(error); }
+
+  void cancel() noexcept { m_state->cancel(); }
 
-  void cancel() noexcept { m_value->cancel(); }
+  bool is_canceled() const noexcept { return m_state->is_canceled() || m_stop_token.stop_requested(); }
 
-  bool is_canceled() const noexcept { return m_value->is_canceled(); }
+  stop_token get_stop_token() const noexcept { return m_stop_token; }
 
-  auto get_future() { return m_value->get_future(); }
+  auto get_future() { return future<Value>{m_state.get()}; }
 
 private:
-  std::shared_ptr<promise<Value>> m_value;
+  state_ref<Value, true> m_state;
+  stop_token m_stop_token;
 };
 
 }  // namespace jar::concurrency::details
@@ -0,0 +1,86 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file wait_helper.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_WAIT_HELPER_HPP
+#define JAR_CONCURRENCY_DETAILS_WAIT_HELPER_HPP
+
+#include <chrono>
+
+namespace jar::concurrency::details {
+
+/// \brief Lets a thread that blocks on a future run the scheduled tasks of the thread pool it belongs to
+///
+/// A worker of a thread pool installs a helper for the lifetime of the worker. A worker that waits on a sub-task would
+/// otherwise hold its thread while the sub-task may be queued behind it, with enough nesting every worker waits and the
+/// pool deadlocks.
+class wait_helper {
+public:
+  /// \brief Period after which a waiter that found no task looks for tasks again
+  inline static constexpr std::chrono::microseconds s_period{100};
+
+  /// \brief Gets the helper of the calling thread, null if the thread is not a thread pool worker
+  static wait_helper* current() noexcept;
+
+  /// \brief Runs one scheduled task, false if no task was found
+  virtual bool help() noexcept = 0;
+
+protected:
+  wait_helper() = default;
+  wait_helper(wait_helper const&) = default;
+  wait_helper(wait_helper&&) = default;
+  wait_helper& operator=(wait_helper const&) = default;
+  wait_helper& operator=(wait_helper&&) = default;
+  ~wait_helper() = default;
+
+  /// \brief Installs the helper of the calling thread, returns the previous helper
+  static wait_helper* install(wait_helper* helper) noexcept;
+};
+
+/// \brief A wait helper that runs the tasks of a scheduler that can be polled
+template <typename Scheduler> class scheduler_helper final : public wait_helper {
+public:
+  explicit scheduler_helper(Scheduler& scheduler) noexcept
+    : m_scheduler{scheduler}
+    , m_previous{install(this)}
+  {
+  }
+
+  scheduler_helper(scheduler_helper const&) = delete;
+  scheduler_helper(scheduler_helper&&) = delete;
+  scheduler_helper& operator=(scheduler_helper const&) = delete;
+  scheduler_helper& operator=(scheduler_helper&&) = delete;
+
+  ~scheduler_helper() { install(m_previous); }
+
+  bool help() noexcept override
+  {
+    auto task = m_scheduler.try_scheduled();
+    if (!task.has_value()) {
+      return false;
+    }
+    task.value()();
+    return true;
+  }
+
+private:
+  Scheduler& m_scheduler;
+  wait_helper* const m_previous;
+};
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_WAIT_HELPER_HPP
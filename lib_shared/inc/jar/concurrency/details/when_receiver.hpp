@@ -0,0 +1,131 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file when_receiver.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_WHEN_RECEIVER_HPP
+#define JAR_CONCURRENCY_DETAILS_WHEN_RECEIVER_HPP
+
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <jar/concurrency/stop_token.hpp>
+
+namespace jar::concurrency::details {
+
+/// \brief Maps void results to std::monostate, so that results can be stored in tuples and variants
+template <typename T> using non_void_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+/// \brief The stop source of the children of a combinator (when_all, when_any)
+///
+/// Stop is requested when the combinator is done before all of its children are, or when stop is requested for the
+/// receiver of the combinator. Children that do not poll is_canceled(), e.g. timers and socket operations, are
+/// canceled through their stop callbacks.
+class when_stop_source {
+  struct on_stop {
+    /// \brief Requests stop through a copy, the callbacks of the children may destroy the combinator
+    void operator()() const noexcept { stop_source{*source}.request_stop(); }
+
+    stop_source const* source;
+  };
+
+public:
+  explicit when_stop_source(stop_token const& parent)
+    : m_source{}
+    , m_on_stop{}
+  {
+    // A stop that has been requested already runs the callback right here.
+    if (parent.stop_possible()) {
+      m_on_stop.emplace(parent, on_stop{&m_source});
+    }
+  }
+
+  when_stop_source(when_stop_source const&) = delete;
+  when_stop_source(when_stop_source&&) = delete;
+  when_stop_source& operator=(when_stop_source const&) = delete;
+  when_stop_source& operator=(when_stop_source&&) = delete;
+
+  ~when_stop_source() = default;
+
+  stop_token get_token() const noexcept { return m_source.get_token(); }
+
+  void request_stop() noexcept { static_cast<void>(m_source.request_stop()); }
+
+private:
+  stop_source m_source;
+  std::optional<stop_callback<on_stop>> m_on_stop;
+};
+
+/// \brief The receiver of a child sender of a combinator (when_all, when_any)
+///
+/// Signals the block shared by the children exactly once. A receiver destroyed without a signal, e.g. by a sender that
+/// skips a canceled operation, counts as canceled.
+///
+/// \tparam Block   Shared block of the combinator
+/// \tparam Index   Index of the child sender
+template <typename Block, std::size_t Index> class when_receiver {
+public:
+  explicit when_receiver(Block* block) noexcept
+    : m_block{block}
+  {
+  }
+
+  when_receiver(when_receiver const&) = delete;
+
+  when_receiver(when_receiver&& other) noexcept
+    : m_block{std::exchange(other.m_block, nullptr)}
+  {
+  }
+
+  when_receiver& operator=(when_receiver const&) = delete;
+  when_receiver& operator=(when_receiver&&) = delete;
+
+  ~when_receiver()
+  {
+    if (nullptr != m_block) {
+      std::exchange(m_block, nullptr)->cancel();
+    }
+  }
+
+  /// \brief Completes the child, the receiver still holds the block if storing the values throws
+  template <typename... Values> void complete(Values&&... values)
+  {
+    m_block->template complete<Index>(std::forward<Values>(values)...);
+    m_block = nullptr;
+  }
+
+  void fail(std::exception_ptr e) noexcept { std::exchange(m_block, nullptr)->fail(e); }
+
+  void set_error(std::error_code error) noexcept { std::exchange(m_block, nullptr)->set_error(error); }
+
+  void cancel() noexcept { std::exchange(m_block, nullptr)->cancel(); }
+
+  bool is_canceled() const noexcept { return nullptr == m_block || m_block->is_canceled(); }
+
+  /// \brief Gets the stop token of the children, stop is requested once the outcome of the combinator is decided
+  stop_token get_stop_token() const noexcept { return nullptr == m_block ? stop_token{} : m_block->get_stop_token(); }
+
+private:
+  Block* m_block;
+};
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_WHEN_RECEIVER_HPP
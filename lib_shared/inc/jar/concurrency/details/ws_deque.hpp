@@ -0,0 +1,176 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file ws_deque.hpp
+///
+
+#ifndef JAR_CONCURRENCY_DETAILS_WS_DEQUE_HPP
+#define JAR_CONCURRENCY_DETAILS_WS_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace jar::concurrency::details {
+
+/// \brief A Chase-Lev work-stealing deque
+///
+/// The owner thread pushes and pops items at the bottom (LIFO), while any other thread may steal items from the top
+/// (FIFO). The ring buffer grows on demand; retired buffers are kept alive until the deque is destroyed, because a
+/// thief may still be reading from them. Sequentially consistent accesses are used instead of stand-alone fences, which
+/// keeps the deque analysable with ThreadSanitizer.
+///
+/// \tparam T   Item type, must be trivially copyable (e.g. a pointer)
+template <typename T> class ws_deque {
+  static_assert(std::is_trivially_copyable_v<T>, "ws_deque item type must be trivially copyable");
+
+  class ring {
+  public:
+    explicit ring(std::int64_t capacity)
+      : m_capacity{capacity}
+      , m_mask{capacity - 1}
+      , m_items{std::make_unique<std::atomic<T>[]>(static_cast<std::size_t>(capacity))}
+    {
+    }
+
+    std::int64_t capacity() const noexcept { return m_capacity; }
+
+    T get(std::int64_t index) const noexcept { return m_items[index & m_mask].load(std::memory_order_relaxed); }
+
+    void put(std::int64_t index, T item) noexcept { m_items[index & m_mask].store(item, std::memory_order_relaxed); }
+
+    std::unique_ptr<ring> grow(std::int64_t bottom, std::int64_t top) const
+    {
+      auto bigger = std::make_unique<ring>(m_capacity * 2);
+      for (auto index = top; index != bottom; ++index) {
+        bigger->put(index, get(index));
+      }
+      return bigger;
+    }
+
+  private:
+    std::int64_t const m_capacity;
+    std::int64_t const m_mask;
+    std::unique_ptr<std::atomic<T>[]> m_items;
+  };
+
+public:
+  /// \brief Constructor
+  ///
+  /// \param[in]  capacity    Initial capacity, rounded up to the next power of two
+  explicit ws_deque(std::size_t capacity = 256U)
+    : m_top{0}
+    , m_bottom{0}
+    , m_ring{nullptr}
+    , m_rings{}
+  {
+    std::int64_t size{1};
+    while (size < static_cast<std::int64_t>(capacity)) {
+      size *= 2;
+    }
+    m_rings.emplace_back(std::make_unique<ring>(size));
+    m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+  }
+
+  ws_deque(ws_deque const&) = delete;
+  ws_deque(ws_deque&&) = delete;
+  ws_deque& operator=(ws_deque const&) = delete;
+  ws_deque& operator=(ws_deque&&) = delete;
+
+  ~ws_deque() = default;
+
+  /// \brief Pushes an item to the bottom of the deque, only the owner may push
+  void push(T item)
+  {
+    auto const bottom = m_bottom.load(std::memory_order_relaxed);
+    auto const top = m_top.load(std::memory_order_acquire);
+    auto* buffer = m_ring.load(std::memory_order_relaxed);
+
+    if (bottom - top > buffer->capacity() - 1) {
+      m_rings.emplace_back(buffer->grow(bottom, top));
+      buffer = m_rings.back().get();
+      m_ring.store(buffer, std::memory_order_release);
+    }
+
+    buffer->put(bottom, item);
+    m_bottom.store(bottom + 1, std::memory_order_release);
+  }
+
+  /// \brief Pops the most recently pushed item, only the owner may pop
+  std::optional<T> pop() noexcept
+  {
+    auto const bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    auto* buffer = m_ring.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_seq_cst);
+    auto top = m_top.load(std::memory_order_seq_cst);
+
+    if (top > bottom) {
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+
+    std::optional<T> item{buffer->get(bottom)};
+    if (top == bottom) {
+      // Last item, race against the thieves.
+      if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item.reset();
+      }
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /// \brief Steals the least recently pushed item, any thread may steal
+  ///
+  /// Retries while the deque is not empty, so an empty result means that the deque was observed empty.
+  std::optional<T> steal() noexcept
+  {
+    auto top = m_top.load(std::memory_order_seq_cst);
+    auto bottom = m_bottom.load(std::memory_order_seq_cst);
+
+    while (top < bottom) {
+      auto const item = m_ring.load(std::memory_order_acquire)->get(top);
+      if (m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return item;
+      }
+      bottom = m_bottom.load(std::memory_order_seq_cst);
+    }
+    return std::nullopt;
+  }
+
+  /// \brief Gets an approximation of the item count
+  std::size_t size() const noexcept
+  {
+    auto const bottom = m_bottom.load(std::memory_order_relaxed);
+    auto const top = m_top.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<std::size_t>(bottom - top) : 0U;
+  }
+
+  /// \brief Checks whether the deque is (approximately) empty
+  bool empty() const noexcept { return 0U == size(); }
+
+private:
+  alignas(64) std::atomic<std::int64_t> m_top;
+  alignas(64) std::atomic<std::int64_t> m_bottom;
+  alignas(64) std::atomic<ring*> m_ring;
+  std::vector<std::unique_ptr<ring>> m_rings;
+};
+
+}  // namespace jar::concurrency::details
+
+#endif  // JAR_CONCURRENCY_DETAILS_WS_DEQUE_HPP
@@ -19,79 +19,258 @@
 #define JAR_CONCURRENCY_FUTURE_HPP
 
 #include <atomic>
-#include <condition_variable>
+#include <cstdint>
 #include <exception>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <stdexcept>
+#include <system_error>
 #include <type_traits>
 #include <utility>
 #include <variant>
 
+#include <jar/concurrency/details/block_pool.hpp>
+#include <jar/concurrency/details/futex.hpp>
+#include <jar/concurrency/details/wait_helper.hpp>
+
 namespace jar::concurrency {
 namespace details {
 
+/// \brief The result of a future: a value, an error code or a cancellation
+///
+/// An error code is the exception-free error channel, it is returned to the caller of get() instead of being thrown.
+/// Accessing the value of a result that holds an error code throws std::system_error.
 template <typename Value> class future_result {
 public:
   explicit future_result(Value&& value) noexcept(std::is_nothrow_move_constructible_v<Value>)
     : m_value{std::move(value)}
+    , m_error{}
   {
   }
 
   explicit future_result(Value const& value) noexcept(std::is_nothrow_copy_constructible_v<Value>)
     : m_value{value}
+    , m_error{}
   {
   }
 
   explicit future_result(std::nullopt_t opt) noexcept
     : m_value{opt}
+    , m_error{}
   {
   }
 
-  operator Value&() { return m_value.value(); }
-  operator const Value&() const { return m_value.value(); }
+  /// \brief Makes a result that holds an error code, which stays distinct from a std::error_code value
+  static future_result from_error(std::error_code error) noexcept { return future_result{error_tag{}, error}; }
+
+  operator Value&() { return value(); }
+  operator const Value&() const { return value(); }
   explicit operator bool() const noexcept { return m_value.has_value(); }
 
-  Value& value() { return m_value.value(); }
-  Value const& value() const { return m_value.value(); }
+  Value& value()
+  {
+    throw_on_error();
+    return m_value.value();
+  }
 
-  bool is_canceled() const noexcept { return !m_value.has_value(); }
+  Value const& value() const
+  {
+    throw_on_error();
+    return m_value.value();
+  }
+
+  bool is_canceled() const noexcept { return !m_value.has_value() && !m_error; }
+
+  bool has_error() const noexcept { return static_cast<bool>(m_error); }
+
+  std::error_code error() const noexcept { return m_error; }
 
 private:
+  struct error_tag {};
+
+  future_result(error_tag, std::error_code error) noexcept
+    : m_value{std::nullopt}
+    , m_error{error}
+  {
+  }
+
+  void throw_on_error() const
+  {
+    if (m_error) {
+      throw std::system_error{m_error};
+    }
+  }
+
   std::optional<Value> m_value;
+  std::error_code m_error;
 };
 
 template <> class future_result<void> {
 public:
   future_result() noexcept
     : m_is_canceled{false}
+    , m_error{}
   {
   }
 
   explicit future_result(std::nullopt_t) noexcept
     : m_is_canceled{true}
+    , m_error{}
   {
   }
 
-  explicit operator bool() const noexcept { return !is_canceled(); }
+  /// \brief Makes a result that holds an error code
+  static future_result from_error(std::error_code error) noexcept { return future_result{error_tag{}, error}; }
+
+  explicit operator bool() const noexcept { return !is_canceled() && !has_error(); }
   bool is_canceled() const noexcept { return m_is_canceled; }
+  bool has_error() const noexcept { return static_cast<bool>(m_error); }
+  std::error_code error() const noexcept { return m_error; }
 
 private:
+  struct error_tag {};
+
+  future_result(error_tag, std::error_code error) noexcept
+    : m_is_canceled{false}
+    , m_error{error}
+  {
+  }
+
   bool m_is_canceled;
+  std::error_code m_error;
+};
+
+/// \brief A continuation that runs once the shared state is ready
+class continuation {
+public:
+  /// \brief Runs the continuation and destroys it
+  virtual void run() noexcept = 0;
+
+protected:
+  continuation() noexcept = default;
+  ~continuation() = default;
+};
+
+/// \brief A continuation holding an invocable, allocated from the block pool of its type
+template <typename Invocable> class continuation_node final : public continuation {
+public:
+  static continuation* create(Invocable&& invocable)
+  {
+    auto* block = state_pool<continuation_node>::allocate();
+    try {
+      return ::new (block) continuation_node{std::move(invocable)};
+    } catch (...) {
+      state_pool<continuation_node>::deallocate(block);
+      throw;
+    }
+  }
+
+  void run() noexcept override
+  {
+    auto invocable = std::move(m_invocable);
+    this->~continuation_node();
+    state_pool<continuation_node>::deallocate(this);
+    std::invoke(invocable);
+  }
+
+private:
+  explicit continuation_node(Invocable&& invocable)
+    : m_invocable{std::move(invocable)}
+  {
+  }
+
+  ~continuation_node() = default;
+
+  Invocable m_invocable;
 };
 
+/// \brief The state shared by a promise and a future
+///
+/// The whole synchronization is a single 32-bit state word that waiters block on with a futex. A waiter sets the
+/// waiter bit before blocking, so completing the state wakes threads only when somebody actually waits. Completing
+/// with a value or an exception claims the state first and publishes it after the data is written, completing by
+/// cancelling or breaking the promise has no data and takes a single compare-and-swap.
+///
+/// The state is reference counted intrusively and allocated from a per-thread block pool, so a promise and future
+/// pair costs at most one allocation. Producer references (promises and value receivers) are counted in the upper half
+/// of the same counter word, the promise is broken when the last producer reference is released.
+///
+/// A continuation is stored before the continuation bit is set in the state word, the thread that completes the state
+/// sees the bit in the result of its completing read-modify-write and runs the continuation. If the state is already
+/// complete when the continuation is attached, it runs right away on the attaching thread.
 template <typename Value> class shared_state {
-  enum class state { init, value, error, canceled, broken };
+  enum state : std::uint32_t { state_init, state_claimed, state_value, state_error, state_canceled, state_broken };
+
+  inline static constexpr std::uint32_t s_state_mask{0x7U};
+  inline static constexpr std::uint32_t s_waiter_bit{0x8U};
+  inline static constexpr std::uint32_t s_continuation_bit{0x10U};
+
+  inline static constexpr std::uint64_t s_reference{0x1U};
+  inline static constexpr std::uint64_t s_producer{std::uint64_t{1U} << 32U};
 
 public:
+  /// \brief Creates a shared state holding one producer reference, which the caller adopts
+  static shared_state* create() { return ::new (state_pool<shared_state>::allocate()) shared_state{}; }
+
+  shared_state(shared_state const&) = delete;
+  shared_state(shared_state&&) = delete;
+  shared_state& operator=(shared_state const&) = delete;
+  shared_state& operator=(shared_state&&) = delete;
+
+  ~shared_state() = default;
+
+  void retain(bool is_producer) noexcept
+  {
+    m_counts.fetch_add(is_producer ? s_producer | s_reference : s_reference, std::memory_order_relaxed);
+  }
+
+  void release(bool is_producer) noexcept
+  {
+    auto decrement = s_reference;
+    if (is_producer) {
+      if (is_ready(m_state.load(std::memory_order_acquire))) {
+        decrement |= s_producer;
+      } else if (s_producer == (m_counts.fetch_sub(s_producer, std::memory_order_acq_rel) & ~(s_producer - 1U))) {
+        // Break the promise while this reference still keeps the state alive.
+        broken();
+      }
+    }
+
+    // Nobody can take a new reference through the last one, so releasing it needs no read-modify-write.
+    if (decrement == m_counts.load(std::memory_order_acquire) ||
+        decrement == m_counts.fetch_sub(decrement, std::memory_order_acq_rel)) {
+      this->~shared_state();
+      state_pool<shared_state>::deallocate(this);
+    }
+  }
+
+  /// \brief Blocks until the state is ready, a thread pool worker runs scheduled tasks of its pool meanwhile
+  ///
+  /// A worker that finds no task blocks for the helping period at a time, so the tasks scheduled later, e.g. by a
+  /// timer, are picked up too.
   void wait() const
   {
-    if (!is_ready()) {
-      std::unique_lock<std::mutex> lock{m_mutex};
-      if (!is_ready()) {
-        m_condition.wait(lock, [this] {
-          return is_ready();
-        });
+    auto* const helper = wait_helper::current();
+    auto current = m_state.load(std::memory_order_acquire);
+    while (!is_ready(current)) {
+      if (nullptr != helper && helper->help()) {
+        current = m_state.load(std::memory_order_acquire);
+        continue;
       }
+
+      if (0U == (current & s_waiter_bit)) {
+        if (!m_state.compare_exchange_weak(current, current | s_waiter_bit, std::memory_order_acquire)) {
+          continue;
+        }
+        current |= s_waiter_bit;
+      }
+      if (nullptr == helper) {
+        futex_wait(m_state, current);
+      } else {
+        futex_wait_for(m_state, current, wait_helper::s_period);
+      }
+      current = m_state.load(std::memory_order_acquire);
     }
   }
 
@@ -99,79 +278,214 @@ public:
   {
     wait();
 
-    switch (m_state.load(std::memory_order_relaxed)) {
-    case state::canceled:
-      [[fallthrough]];
-    case state::value:
+    switch (m_state.load(std::memory_order_acquire) & s_state_mask) {
+    case state_value:
       return std::move(std::get<future_result<Value>>(m_data));
-    case state::error:
+    case state_error:
       std::rethrow_exception(std::get<std::exception_ptr>(m_data));
-    case state::broken:
+    case state_canceled:
+      return future_result<Value>(std::nullopt);
+    case state_broken:
       throw std::domain_error{"broken promise"};
     default:
       throw std::domain_error{"shared state broken"};
     }
   }
 
-  void set_value(future_result<Value>&& value)
+  void set_value(future_result<Value>&& result)
   {
-    auto initial_state = state::init;
-    if (m_state.compare_exchange_strong(initial_state, state::value)) {
-      m_data = std::move(value);
-      m_condition.notify_one();
+    if (claim()) {
+      m_data = std::move(result);
+      publish(state_value);
     }
   }
 
   void set_exception(std::exception_ptr e)
   {
-    auto initial_state = state::init;
-    if (m_state.compare_exchange_strong(initial_state, state::error)) {
+    if (claim()) {
       m_data = e;
-      m_condition.notify_one();
+      publish(state_error);
     }
   }
 
-  void cancel()
+  /// \brief Completes the state with an error code, which get() returns instead of throwing
+  void set_error(std::error_code error) noexcept
   {
-    auto initial_state = state::init;
-    if (m_state.compare_exchange_strong(initial_state, state::canceled)) {
-      m_data = future_result<Value>(std::nullopt);
-      m_condition.notify_one();
+    if (claim()) {
+      m_data.template emplace<future_result<Value>>(future_result<Value>::from_error(error));
+      publish(state_value);
     }
   }
 
-  void broken()
+  void cancel() noexcept { complete(state_canceled); }
+
+  /// \brief Attaches the continuation, a state takes at most one continuation
+  void attach(continuation* next) noexcept
   {
-    auto initial_state = state::init;
-    if (m_state.compare_exchange_strong(initial_state, state::broken)) {
-      m_condition.notify_one();
+    m_continuation = next;
+    auto current = m_state.load(std::memory_order_relaxed);
+    while (!is_ready(current)) {
+      if (m_state.compare_exchange_weak(current, current | s_continuation_bit, std::memory_order_release,
+                                        std::memory_order_acquire)) {
+        return;
+      }
     }
+
+    m_continuation = nullptr;
+    next->run();
   }
 
-  bool is_canceled() const noexcept { return state::canceled == m_state.load(std::memory_order_relaxed); }
+  void broken() noexcept { complete(state_broken); }
+
+  bool is_canceled() const noexcept
+  {
+    return state_canceled == (m_state.load(std::memory_order_relaxed) & s_state_mask);
+  }
 
 private:
-  bool is_ready() const noexcept { return state::init != m_state.load(std::memory_order_relaxed); }
+  shared_state() noexcept
+    : m_data{}
+    , m_state{state_init}
+    , m_counts{s_producer | s_reference}
+    , m_continuation{nullptr}
+  {
+  }
+
+  static bool is_ready(std::uint32_t current) noexcept { return (current & s_state_mask) > state_claimed; }
+
+  /// \brief Moves the state from init to claimed, keeping the waiter bit
+  bool claim() noexcept
+  {
+    auto current = m_state.load(std::memory_order_relaxed);
+    while (state_init == (current & s_state_mask)) {
+      if (m_state.compare_exchange_weak(current, current | state_claimed, std::memory_order_acquire)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void publish(state final_state) noexcept { completed(m_state.exchange(final_state, std::memory_order_acq_rel)); }
+
+  /// \brief Moves the state from init straight to a final state that carries no data
+  void complete(state final_state) noexcept
+  {
+    auto current = m_state.load(std::memory_order_relaxed);
+    while (state_init == (current & s_state_mask)) {
+      if (m_state.compare_exchange_weak(current, final_state, std::memory_order_acq_rel)) {
+        completed(current);
+        return;
+      }
+    }
+  }
 
-  mutable std::mutex m_mutex;
-  mutable std::condition_variable m_condition;
+  /// \brief Wakes the waiters and runs the continuation, given the state word before completion
+  ///
+  /// The continuation runs last, because it may release the reference that keeps the state alive.
+  void completed(std::uint32_t previous) noexcept
+  {
+    if (0U != (previous & s_waiter_bit)) {
+      futex_wake_all(m_state);
+    }
+    if (0U != (previous & s_continuation_bit)) {
+      std::exchange(m_continuation, nullptr)->run();
+    }
+  }
 
   std::variant<std::monostate, std::exception_ptr, future_result<Value>> m_data;
-  std::atomic<state> m_state;
+  mutable std::atomic<std::uint32_t> m_state;
+  std::atomic<std::uint64_t> m_counts;
+  continuation* m_continuation;
+};
+
+/// \brief An intrusive reference to a shared state
+///
+/// \tparam Value       Value type of the shared state
+/// \tparam IsProducer  Whether the reference is held by a producer (a promise or a value receiver)
+template <typename Value, bool IsProducer> class state_ref {
+public:
+  state_ref() noexcept
+    : m_state{nullptr}
+  {
+  }
+
+  explicit state_ref(shared_state<Value>* state) noexcept
+    : m_state{state}
+  {
+    if (nullptr != m_state) {
+      m_state->retain(IsProducer);
+    }
+  }
+
+  state_ref(state_ref const& other) noexcept
+    : state_ref{other.m_state}
+  {
+  }
+
+  /// \brief Makes a reference that adopts the reference created with the shared state
+  static state_ref adopt(shared_state<Value>* state) noexcept
+  {
+    state_ref adopted;
+    adopted.m_state = state;
+    return adopted;
+  }
+
+  state_ref(state_ref&& other) noexcept
+    : m_state{std::exchange(other.m_state, nullptr)}
+  {
+  }
+
+  state_ref& operator=(state_ref const& other) noexcept
+  {
+    if (this != &other) {
+      *this = state_ref{other};
+    }
+    return *this;
+  }
+
+  state_ref& operator=(state_ref&& other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      m_state = std::exchange(other.m_state, nullptr);
+    }
+    return *this;
+  }
+
+  ~state_ref() { reset(); }
+
+  shared_state<Value>* get() const noexcept { return m_state; }
+
+  shared_state<Value>* operator->() const noexcept { return m_state; }
+
+  void reset() noexcept
+  {
+    if (nullptr != m_state) {
+      std::exchange(m_state, nullptr)->release(IsProducer);
+    }
+  }
+
+private:
+  shared_state<Value>* m_state;
 };
 
+template <typename Value> class value_receiver;
+
+template <typename Value, typename Invocable> class then_task;
+
+template <typename Value> class future_awaiter;
+
 }  // namespace details
 
 template <typename Value> class promise;
 
 template <typename Value> class future {
   friend class promise<Value>;
+  friend class details::value_receiver<Value>;
+  friend class details::future_awaiter<Value>;
 
 public:
-  future() noexcept
-    : m_shared_state{nullptr}
-  {
-  }
+  future() noexcept = default;
 
   future(future const&) = delete;
   future(future&&) noexcept = default;
@@ -182,25 +496,63 @@ public:
 
   auto get() { return m_shared_state->get(); }
 
-  bool is_valid() const noexcept { return nullptr != m_shared_state; }
+  bool is_valid() const noexcept { return nullptr != m_shared_state.get(); }
 
   void wait() const { return m_shared_state->wait(); }
 
   void cancel() { m_shared_state->cancel(); }
 
+  /// \brief Attaches an invocable that is called with the value once the future is ready, consumes the future
+  ///
+  /// The invocable runs on the thread that completes the promise, or right away if the future is already ready. An
+  /// exception, an error code, a cancellation or a broken promise skips the invocable and is passed on to the returned
+  /// future.
+  template <typename Invocable> auto then(Invocable&& invocable)
+  {
+    using task_type = details::then_task<Value, std::decay_t<Invocable>>;
+
+    promise<typename task_type::result_type> next;
+    auto result = next.get_future();
+    auto* state = m_shared_state.get();
+    state->attach(details::continuation_node<task_type>::create(
+        task_type{std::move(m_shared_state), std::move(next), std::forward<Invocable>(invocable)}));
+    return result;
+  }
+
+  /// \brief Attaches an invocable that is scheduled with the scheduler once the future is ready, consumes the future
+  template <typename Scheduler, typename Invocable> auto then(Scheduler scheduler, Invocable&& invocable)
+  {
+    using task_type = details::then_task<Value, std::decay_t<Invocable>>;
+
+    promise<typename task_type::result_type> next;
+    auto result = next.get_future();
+    auto* state = m_shared_state.get();
+    auto schedule = [scheduler = std::move(scheduler),
+                     task = task_type{std::move(m_shared_state), std::move(next), std::forward<Invocable>(invocable)}]()
+        mutable {
+          // A task that could not be scheduled is destroyed, which breaks the returned future.
+          try {
+            scheduler.schedule(std::move(task));
+          } catch (...) {
+          }
+        };
+    state->attach(details::continuation_node<decltype(schedule)>::create(std::move(schedule)));
+    return result;
+  }
+
 private:
-  explicit future(std::shared_ptr<details::shared_state<Value>> state)
-    : m_shared_state(std::move(state))
+  explicit future(details::shared_state<Value>* state) noexcept
+    : m_shared_state{state}
   {
   }
 
-  std::shared_ptr<details::shared_state<Value>> m_shared_state;
+  details::state_ref<Value, false> m_shared_state;
 };
 
 template <typename Value> class promise {
 public:
   promise()
-    : m_shared_state{std::make_shared<details::shared_state<Value>>()}
+    : m_shared_state{details::state_ref<Value, true>::adopt(details::shared_state<Value>::create())}
   {
   }
 
@@ -209,14 +561,10 @@ public:
   promise& operator=(promise const&) = delete;
   promise& operator=(promise&&) noexcept = default;
 
-  ~promise()
-  {
-    if (nullptr != m_shared_state) {
-      m_shared_state->broken();
-    }
-  }
+  /// \brief Destructor, breaks the promise unless a value receiver still shares the state
+  ~promise() = default;
 
-  auto get_future() { return future<Value>{m_shared_state}; }
+  auto get_future() { return future<Value>{m_shared_state.get()}; }
 
   template <typename V = Value, std::enable_if_t<!std::is_same_v<V, void>, bool> = true> void set_value(V&& value)
   {
@@ -230,14 +578,80 @@ public:
 
   void set_exception(std::exception_ptr e) { m_shared_state->set_exception(e); }
 
+  /// \brief Completes the future with an error code, get() returns it in the result instead of throwing
+  void set_error(std::error_code error) noexcept { m_shared_state->set_error(error); }
+
   bool is_canceled() const noexcept { return m_shared_state->is_canceled(); }
 
   void cancel() { m_shared_state->cancel(); }
 
 private:
-  std::shared_ptr<details::shared_state<Value>> m_shared_state;
+  details::state_ref<Value, true> m_shared_state;
 };
 
+namespace details {
+
+/// \brief Result type of a future continuation
+template <typename Value, typename Invocable> struct continuation_result {
+  using type = std::invoke_result_t<Invocable, Value&&>;
+};
+
+template <typename Invocable> struct continuation_result<void, Invocable> {
+  using type = std::invoke_result_t<Invocable>;
+};
+
+/// \brief The task of a future continuation, invokes the invocable with the value and completes the next promise
+template <typename Value, typename Invocable> class then_task {
+public:
+  using result_type = typename continuation_result<Value, Invocable>::type;
+
+  template <typename I>
+  then_task(state_ref<Value, false>&& state, promise<result_type>&& next, I&& invocable)
+    : m_state{std::move(state)}
+    , m_next{std::move(next)}
+    , m_invocable{std::forward<I>(invocable)}
+  {
+  }
+
+  void operator()() noexcept
+  {
+    if (!m_next.is_canceled()) {
+      try {
+        auto result = m_state->get();
+        if (result.is_canceled()) {
+          m_next.cancel();
+        } else if (result.has_error()) {
+          m_next.set_error(result.error());
+        } else if constexpr (std::is_void_v<Value>) {
+          fulfil();
+        } else {
+          fulfil(std::move(result.value()));
+        }
+      } catch (...) {
+        m_next.set_exception(std::current_exception());
+      }
+    }
+    m_state.reset();
+  }
+
+private:
+  template <typename... Args> void fulfil(Args&&... args)
+  {
+    if constexpr (std::is_void_v<result_type>) {
+      std::invoke(std::move(m_invocable), std::forward<Args>(args)...);
+      m_next.set_value();
+    } else {
+      m_next.set_value(std::invoke(std::move(m_invocable), std::forward<Args>(args)...));
+    }
+  }
+
+  state_ref<Value, false> m_state;
+  promise<result_type> m_next;
+  Invocable m_invocable;
+};
+
+}  // namespace details
+
 }  // namespace jar::concurrency
 
 #endif  // JAR_CONCURRENCY_FUTURE_HPP
@@ -0,0 +1,170 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file idle_workers.hpp
+///
+
+#ifndef JAR_CONCURRENCY_IDLE_WORKERS_HPP
+#define JAR_CONCURRENCY_IDLE_WORKERS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <jar/concurrency/details/cpu_relax.hpp>
+
+namespace jar::concurrency {
+
+/// \brief What an idle worker does while its scheduler has no tasks
+enum class idle_policy {
+  block,           ///< The worker blocks in the scheduler
+  spin_then_park   ///< The worker spins, then yields, and finally parks on its own event
+};
+
+/// \brief Idle strategy of the thread pool workers
+struct idle_strategy {
+  idle_policy policy{idle_policy::block};
+  unsigned spin_count{1024U};  ///< Polls with a pause instruction in between
+  unsigned yield_count{16U};   ///< Polls with a yield in between, after the spinning
+};
+
+/// \brief Idle workers of a scheduler
+///
+/// An idle worker first polls its scheduler in a spin loop, then in a yield loop and finally parks on a per-worker
+/// futex. A notification is absorbed by a spinning worker when there is one, only otherwise a parked worker is woken
+/// up, so a busy pool does not pay for system calls on every scheduled task.
+class idle_workers {
+public:
+  /// \brief Constructor
+  ///
+  /// \param[in]  strategy        Spin and yield counts
+  /// \param[in]  worker_count    Worker count
+  ///
+  /// \throw  std::invalid_argument if the worker count is zero
+  idle_workers(idle_strategy const& strategy, unsigned worker_count);
+
+  idle_workers(idle_workers const&) = delete;
+  idle_workers(idle_workers&&) = delete;
+  idle_workers& operator=(idle_workers const&) = delete;
+  idle_workers& operator=(idle_workers&&) = delete;
+
+  ~idle_workers() = default;
+
+  /// \brief Idles the worker until the poll returns a task, the workers are stopped or the worker has been parked for
+  /// the timeout
+  ///
+  /// \param[in]  worker  Worker index, less than the worker count
+  /// \param[in]  poll    Non-blocking poll that returns an optional task
+  /// \param[in]  timeout Longest time to stay parked, by default no limit
+  ///
+  /// \return The polled task, empty if the workers were stopped or the timeout expired
+  template <typename Poll>
+  auto wait(unsigned worker, Poll&& poll, std::chrono::nanoseconds timeout = s_no_timeout) -> decltype(poll())
+  {
+    for (;;) {
+      m_spinning.fetch_add(1U, std::memory_order_seq_cst);
+      for (unsigned n = 0U; n != m_spin_count + m_yield_count && !is_stopped(); ++n) {
+        auto task = poll();
+        if (task.has_value()) {
+          m_spinning.fetch_sub(1U, std::memory_order_seq_cst);
+          return task;
+        }
+        if (n < m_spin_count) {
+          details::cpu_relax();
+        } else {
+          std::this_thread::yield();
+        }
+      }
+
+      // The worker is registered as parked before it stops spinning and polls once more, so a notifier either sees it
+      // spinning and the last poll finds the task, or sees it parked and wakes it up.
+      prepare_park(worker);
+      if (is_stopped()) {
+        cancel_park(worker);
+        return std::nullopt;
+      }
+      auto task = poll();
+      if (task.has_value()) {
+        cancel_park(worker);
+        return task;
+      }
+      // A timed out worker that a notifier picked at the same time has been woken up instead.
+      if (!park(worker, timeout) && withdraw(worker)) {
+        return std::nullopt;
+      }
+      if (is_stopped()) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  /// \brief Notifies that count tasks were scheduled
+  ///
+  /// Spinning workers take the tasks first, a parked worker is woken up only for the tasks they cannot cover.
+  void notify(std::size_t count = 1U) noexcept;
+
+  /// \brief Stops the workers, parked workers are woken up and every wait returns
+  void stop() noexcept;
+
+  /// \brief Checks whether the workers are stopped
+  bool is_stopped() const noexcept { return m_is_stopped.load(std::memory_order_acquire); }
+
+  /// \brief Gets the number of spinning workers
+  unsigned spinning() const noexcept { return m_spinning.load(std::memory_order_relaxed); }
+
+  /// \brief Gets the number of parked workers
+  unsigned parked() const noexcept { return m_parked_count.load(std::memory_order_relaxed); }
+
+  /// \brief No park timeout
+  inline static constexpr std::chrono::nanoseconds s_no_timeout{std::chrono::nanoseconds::max()};
+
+private:
+  struct alignas(64) event {
+    std::atomic<std::uint32_t> state{0U};
+  };
+
+  inline static constexpr std::uint32_t s_unset{0U};
+  inline static constexpr std::uint32_t s_set{1U};
+
+  void prepare_park(unsigned worker) noexcept;
+
+  void cancel_park(unsigned worker) noexcept;
+
+  /// \brief Removes the worker from the parked workers, false if a notifier already removed it
+  bool withdraw(unsigned worker) noexcept;
+
+  /// \brief Parks the worker until it is woken up, false if the timeout expired first
+  bool park(unsigned worker, std::chrono::nanoseconds timeout) noexcept;
+
+  void unpark(unsigned worker) noexcept;
+
+  unsigned const m_spin_count;
+  unsigned const m_yield_count;
+  std::unique_ptr<event[]> m_events;
+  alignas(64) std::atomic_uint m_spinning;
+  alignas(64) std::atomic_uint m_parked_count;
+  std::atomic_bool m_is_stopped;
+  std::mutex m_mutex;
+  std::vector<unsigned> m_parked;
+};
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_IDLE_WORKERS_HPP
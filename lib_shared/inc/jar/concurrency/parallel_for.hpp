@@ -0,0 +1,103 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file parallel_for.hpp
+///
+
+#ifndef JAR_CONCURRENCY_PARALLEL_FOR_HPP
+#define JAR_CONCURRENCY_PARALLEL_FOR_HPP
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <jar/concurrency/bulk.hpp>
+#include <jar/concurrency/wait.hpp>
+
+namespace jar::concurrency {
+namespace details {
+
+template <typename Future> void wait_loop(Future&& future)
+{
+  if (future.get().is_canceled()) {
+    throw std::domain_error{"parallel loop canceled"};
+  }
+}
+
+}  // namespace details
+
+/// \brief Invokes invocable(index) for every index in [0, count) on the scheduler and waits for the loop to finish
+///
+/// The calling thread blocks until the loop is done, a thread_pool worker runs the scheduled tasks meanwhile, so loops
+/// may be nested.
+///
+/// \throw  The first exception thrown by the invocable, std::domain_error if the scheduler dropped the loop
+template <typename Scheduler, typename Invocable>
+void parallel_for(Scheduler scheduler, std::size_t count, Invocable&& invocable)
+{
+  details::wait_loop(wait(bulk(std::move(scheduler), count, std::forward<Invocable>(invocable))));
+}
+
+/// \brief Reduces transform(index) of every index in [0, count) on the scheduler and waits for the result
+///
+/// Every runner reduces its chunks into a partial accumulator of its own, the accumulators are on separate cache lines
+/// and are reduced into init on the calling thread. Like std::transform_reduce, the reduction must be associative and
+/// commutative. Like parallel_for, may be called from a thread_pool worker.
+///
+/// \throw  The first exception thrown by transform or reduce, std::domain_error if the scheduler dropped the loop
+template <typename Scheduler, typename T, typename Reduce, typename Transform>
+T parallel_transform_reduce(Scheduler scheduler, std::size_t count, T init, Reduce reduce, Transform transform)
+{
+  static_assert(std::is_convertible_v<std::invoke_result_t<Transform const&, std::size_t>, T>,
+                "Transform must return a value convertible to T");
+
+  struct alignas(64) partial {
+    std::optional<T> value;
+  };
+
+  auto const shape = details::make_bulk_shape(details::concurrency_of(scheduler), count);
+  std::vector<partial> partials(shape.runners);
+
+  details::wait_loop(wait(details::bulk_chunks(
+      std::move(scheduler), count, shape,
+      [&partials, &reduce, &transform](std::size_t begin, std::size_t end, unsigned slot) {
+        // The chunk is reduced in a local accumulator, the shared cache line is written once per chunk.
+        T value = std::invoke(transform, begin);
+        for (auto index = begin + 1U; index != end; ++index) {
+          value = std::invoke(reduce, std::move(value), std::invoke(transform, index));
+        }
+
+        auto& accumulator = partials[slot].value;
+        if (accumulator.has_value()) {
+          accumulator = std::invoke(reduce, std::move(*accumulator), std::move(value));
+        } else {
+          accumulator.emplace(std::move(value));
+        }
+      })));
+
+  for (auto& accumulator : partials) {
+    if (accumulator.value.has_value()) {
+      init = std::invoke(reduce, std::move(init), std::move(*accumulator.value));
+    }
+  }
+  return init;
+}
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_PARALLEL_FOR_HPP
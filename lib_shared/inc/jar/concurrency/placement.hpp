@@ -0,0 +1,106 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file placement.hpp
+///
+
+#ifndef JAR_CONCURRENCY_PLACEMENT_HPP
+#define JAR_CONCURRENCY_PLACEMENT_HPP
+
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jar::concurrency {
+
+/// \brief Worker thread placement policy
+enum class placement_policy {
+  none,     ///< Workers are not pinned, the operating system places them
+  compact,  ///< Every worker is pinned to one core, cores are filled one NUMA node after another
+  scatter,  ///< Every worker is pinned to one core, consecutive workers go to different NUMA nodes
+  numa      ///< Workers are bound to the cores of a NUMA node and every node gets its own scheduler partition
+};
+
+/// \brief A NUMA node and its cores
+struct numa_node {
+  unsigned id;
+  std::vector<unsigned> cpus;
+};
+
+/// \brief NUMA nodes of the system
+using cpu_topology = std::vector<numa_node>;
+
+/// \brief Parses a Linux cpu list, e.g. "0-3,8,10-11"
+///
+/// \throw  std::invalid_argument if the list is malformed
+std::vector<unsigned> parse_cpu_list(std::string const& list);
+
+/// \brief Reads the NUMA nodes from a sysfs node directory
+///
+/// \param[in]  root    Directory that contains the nodeN/cpulist files
+///
+/// \return NUMA nodes sorted by id, empty if the directory does not exist
+cpu_topology read_cpu_topology(std::string const& root = "/sys/devices/system/node");
+
+/// \brief Gets the cores the calling process is allowed to run on
+std::vector<unsigned> allowed_cpus();
+
+/// \brief Gets the NUMA nodes of the system restricted to the allowed cores
+///
+/// Falls back to a single node with all allowed cores when the system does not expose NUMA information.
+cpu_topology system_topology();
+
+/// \brief Plans the cores of every worker
+///
+/// \param[in]  topology        NUMA nodes
+/// \param[in]  policy          Placement policy
+/// \param[in]  worker_count    Worker count
+///
+/// \return Cores per worker, a worker with no cores is not pinned
+std::vector<std::vector<unsigned>> plan_placement(cpu_topology const& topology, placement_policy policy,
+                                                  unsigned worker_count);
+
+/// \brief Gets the index of the NUMA node the calling thread currently runs on
+std::optional<std::size_t> current_node(cpu_topology const& topology) noexcept;
+
+/// \brief Sets the cores a thread may run on, does nothing if cpus is empty
+///
+/// \throw  std::system_error if the affinity cannot be set
+void set_affinity(std::thread& thread, std::vector<unsigned> const& cpus);
+
+/// \brief Restricts the calling thread to a set of cores for the lifetime of the object
+///
+/// Memory that is first touched in the scope is allocated from the NUMA node of those cores.
+class scoped_affinity {
+public:
+  /// \brief Constructor, does nothing if cpus is empty
+  ///
+  /// \throw  std::system_error if the affinity cannot be set
+  explicit scoped_affinity(std::vector<unsigned> const& cpus);
+
+  scoped_affinity(scoped_affinity const&) = delete;
+  scoped_affinity(scoped_affinity&&) = delete;
+  scoped_affinity& operator=(scoped_affinity const&) = delete;
+  scoped_affinity& operator=(scoped_affinity&&) = delete;
+
+  ~scoped_affinity();
+
+private:
+  std::vector<unsigned> m_previous;
+};
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_PLACEMENT_HPP
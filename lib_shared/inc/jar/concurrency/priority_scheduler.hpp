@@ -0,0 +1,199 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file priority_scheduler.hpp
+///
+
+#ifndef JAR_CONCURRENCY_PRIORITY_SCHEDULER_HPP
+#define JAR_CONCURRENCY_PRIORITY_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <jar/concurrency/unique_task.hpp>
+
+namespace jar::concurrency {
+
+/// \brief A scheduler with prioritised task lanes
+///
+/// Lane 0 has the highest priority. With the strict policy a worker always takes the task from the highest priority
+/// lane that is not empty, unless the oldest task of a lower priority lane has waited longer than the starvation limit.
+/// With the weighted policy the lanes are served by smooth weighted round-robin, so every lane gets a share of the
+/// workers that is proportional to its weight.
+class priority_scheduler {
+  class adapter {
+  public:
+    adapter(priority_scheduler* const schd, unsigned priority)
+      : m_scheduler{schd}
+      , m_priority{priority}
+    {
+    }
+
+    template <typename Invocable, typename... Args> void schedule(Invocable&& invocable, Args&&... args)
+    {
+      static_assert(std::is_invocable_v<Invocable, Args...>, "Invocable type must be invocable with args");
+      if constexpr (0U == sizeof...(Args)) {
+        m_scheduler->schedule(std::forward<Invocable>(invocable), m_priority);
+      } else {
+        // Arguments are decay-copied into the task, like std::thread and std::async do.
+        m_scheduler->schedule(
+            [invocable = std::forward<Invocable>(invocable),
+             args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+              std::apply(
+                  [&invocable](auto&... args) {
+                    std::invoke(std::move(invocable), std::move(args)...);
+                  },
+                  args);
+            },
+            m_priority);
+      }
+    }
+
+    template <typename ForwardIt> void schedule_bulk(ForwardIt first, ForwardIt last)
+    {
+      m_scheduler->schedule_bulk(first, last, m_priority);
+    }
+
+    template <typename Range> void schedule_bulk(Range&& range)
+    {
+      m_scheduler->schedule_bulk(std::begin(range), std::end(range), m_priority);
+    }
+
+  private:
+    priority_scheduler* const m_scheduler;
+    unsigned const m_priority;
+  };
+
+public:
+  using task_type = unique_task;
+  using clock = std::chrono::steady_clock;
+
+  /// \brief Lane selection policy
+  enum class policy { strict, weighted };
+
+  /// \brief Constructs a scheduler with strict priority lanes
+  ///
+  /// \param[in]  worker_count        Worker count, must not be zero
+  /// \param[in]  lane_count          Lane count, must not be zero
+  /// \param[in]  starvation_limit    How long a task may wait before it is served regardless of its priority
+  ///
+  /// \throw  std::invalid_argument if worker_count or lane_count is zero
+  explicit priority_scheduler(unsigned worker_count, unsigned lane_count = 2U,
+                              std::chrono::microseconds starvation_limit = std::chrono::milliseconds{10});
+
+  /// \brief Constructs a scheduler with weighted priority lanes, one lane per weight
+  ///
+  /// \param[in]  worker_count        Worker count, must not be zero
+  /// \param[in]  weights             Lane weights, there must be at least one lane and no weight can be zero
+  ///
+  /// \throw  std::invalid_argument if worker_count, the lane count or any weight is zero
+  priority_scheduler(unsigned worker_count, std::vector<unsigned> weights);
+
+  priority_scheduler(priority_scheduler const&) = delete;
+  priority_scheduler(priority_scheduler&&) = delete;
+  priority_scheduler& operator=(priority_scheduler const&) = delete;
+  priority_scheduler& operator=(priority_scheduler&&) = delete;
+
+  ~priority_scheduler() = default;
+
+  std::optional<task_type> scheduled();
+
+  /// \brief Schedules a task on the lowest priority lane
+  void schedule(task_type&& task);
+
+  /// \brief Schedules a task on the given lane
+  ///
+  /// \throw  std::invalid_argument if there is no lane for the priority
+  void schedule(task_type&& task, unsigned priority);
+
+  /// \brief Schedules the tasks of [first, last) on the given lane under a single lock, the tasks are moved from
+  ///
+  /// \throw  std::invalid_argument if there is no lane for the priority
+  template <typename ForwardIt> void schedule_bulk(ForwardIt first, ForwardIt last, unsigned priority)
+  {
+    auto& lane = lane_at(priority);
+    auto const now = clock::now();
+
+    std::size_t count{0U}, waiters{0U};
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      for (; first != last; ++first, ++count) {
+        lane.tasks.emplace_back(entry{task_type{std::move(*first)}, now});
+      }
+      waiters = m_waiters;
+    }
+    notify(count, waiters);
+  }
+
+  void clear() noexcept;
+
+  /// \brief Gets an adapter that schedules on the given lane, by default on the lowest priority lane
+  ///
+  /// \throw  std::invalid_argument if there is no lane for the priority
+  adapter get_adapter(unsigned priority) { return adapter{this, lane_index(priority)}; }
+
+  adapter get_adapter() noexcept { return adapter{this, lowest_priority()}; }
+
+  /// \brief Gets the number of lanes
+  unsigned lane_count() const noexcept { return static_cast<unsigned>(m_lanes.size()); }
+
+  /// \brief Gets the priority of the lowest priority lane
+  unsigned lowest_priority() const noexcept { return lane_count() - 1U; }
+
+private:
+  struct entry {
+    task_type task;
+    clock::time_point enqueued;
+  };
+
+  struct lane {
+    std::deque<entry> tasks{};
+    std::int64_t weight{1};
+    std::int64_t current{0};
+  };
+
+  unsigned lane_index(unsigned priority) const;
+
+  lane& lane_at(unsigned priority) { return m_lanes[lane_index(priority)]; }
+
+  std::optional<task_type> pop_locked();
+
+  std::optional<std::size_t> select_strict(clock::time_point now) noexcept;
+
+  std::optional<std::size_t> select_weighted() noexcept;
+
+  void notify(std::size_t count, std::size_t waiters) noexcept;
+
+  policy const m_policy;
+  clock::duration const m_starvation_limit;
+  std::vector<lane> m_lanes;
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::size_t m_waiters;
+  bool m_is_cancelled;
+};
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_PRIORITY_SCHEDULER_HPP
@@ -19,6 +19,7 @@
 #define JAR_CONCURRENCY_QUEUE_HPP
 
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
 #include <mutex>
 #include <optional>
@@ -27,8 +28,11 @@ namespace jar::concurrency {
 
 template <typename T, typename Container = std::deque<T>> class queue {
 public:
+  using value_type = T;
+
   queue()
     : m_is_cancelled{false}
+    , m_waiters{0U}
     , m_container{}
   {
   }
@@ -37,9 +41,11 @@ public:
   {
     std::unique_lock<std::mutex> lock{m_mutex};
     if (m_container.empty() || !m_is_cancelled) {
+      ++m_waiters;
       m_condition.wait(lock, [this]() {
         return !m_container.empty() || m_is_cancelled;
       });
+      --m_waiters;
     }
 
     if (m_is_cancelled) {
@@ -52,7 +58,18 @@ public:
   std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>)
   {
     std::unique_lock<std::mutex> lock{m_mutex, std::try_to_lock};
-    if (m_container.empty() || !lock) {
+    if (!lock || m_container.empty()) {
+      return std::nullopt;
+    }
+
+    return pop_front();
+  }
+
+  /// \brief Pops an item without waiting for one, unlike try_pop waits for the lock so an empty result means empty
+  std::optional<T> poll() noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_container.empty()) {
       return std::nullopt;
     }
 
@@ -68,19 +85,50 @@ public:
     m_condition.notify_one();
   }
 
-  bool try_push(T item) noexcept(std::is_nothrow_move_constructible_v<T>)
+  /// \brief Pushes the items of [first, last) under a single lock, the items are moved from
+  ///
+  /// Wakes up at most as many waiting consumers as there were items pushed.
+  template <typename InputIt> void push_bulk(InputIt first, InputIt last)
+  {
+    std::size_t count{0U}, waiters{0U};
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      for (; first != last; ++first, ++count) {
+        m_container.emplace_back(std::move(*first));
+      }
+      waiters = m_waiters;
+    }
+
+    if (count >= waiters) {
+      m_condition.notify_all();
+    } else {
+      for (std::size_t n = 0U; n != count; ++n) {
+        m_condition.notify_one();
+      }
+    }
+  }
+
+  /// \brief Pushes the item if the queue is not locked, the item is moved from only when it was pushed
+  template <typename U> bool try_push(U&& item) noexcept(std::is_nothrow_constructible_v<T, U&&>)
   {
     {
       std::unique_lock<std::mutex> lock{m_mutex, std::try_to_lock};
       if (!lock) {
         return false;
       }
-      m_container.emplace_back(std::move(item));
+      m_container.emplace_back(std::forward<U>(item));
     }
     m_condition.notify_one();
     return true;
   }
 
+  /// \brief Gets the item count
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_container.size();
+  }
+
   void clear() noexcept
   {
     {
@@ -100,8 +148,9 @@ private:
   }
 
   bool m_is_cancelled;
+  std::size_t m_waiters;
   Container m_container;
-  std::mutex m_mutex;
+  mutable std::mutex m_mutex;
   std::condition_variable m_condition;
 };
 
@@ -0,0 +1,307 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file ring_queue.hpp
+///
+
+#ifndef JAR_CONCURRENCY_RING_QUEUE_HPP
+#define JAR_CONCURRENCY_RING_QUEUE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#include <jar/concurrency/details/cpu_relax.hpp>
+
+namespace jar::concurrency {
+
+/// \brief A bounded lock-free multi-producer multi-consumer queue
+///
+/// Items are stored in a fixed ring of cache-line sized cells, each cell carries a sequence number that tells whether
+/// the cell is ready to be written or read (D. Vyukov's bounded MPMC queue). The non-blocking operations never take a
+/// lock. Blocking operations spin for a while and only then park the thread on a condition variable, so the mutex is
+/// touched only when a thread actually sleeps or must be woken up.
+///
+/// \tparam T           Item type
+/// \tparam Capacity    Number of cells, must be a power of two
+template <typename T, std::size_t Capacity = 1024U> class ring_queue {
+  static_assert(Capacity >= 2U && (Capacity & (Capacity - 1U)) == 0U, "ring_queue capacity must be a power of two");
+  // An item is constructed into a cell only after the cell has been claimed, a throw there would never publish the cell
+  // and every consumer that reaches it would spin forever.
+  static_assert(std::is_nothrow_move_constructible_v<T>, "ring_queue item type must be nothrow move constructible");
+
+public:
+  using value_type = T;
+
+  ring_queue()
+    : m_enqueue_position{0U}
+    , m_dequeue_position{0U}
+    , m_cells{}
+    , m_is_cancelled{false}
+    , m_pop_waiters{0U}
+    , m_push_waiters{0U}
+  {
+    for (std::size_t n = 0U; n != Capacity; ++n) {
+      m_cells[n].sequence.store(n, std::memory_order_relaxed);
+    }
+  }
+
+  ring_queue(ring_queue const&) = delete;
+  ring_queue(ring_queue&&) = delete;
+  ring_queue& operator=(ring_queue const&) = delete;
+  ring_queue& operator=(ring_queue&&) = delete;
+
+  ~ring_queue()
+  {
+    while (dequeue().has_value()) {
+    }
+  }
+
+  std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    for (unsigned n = 0U; n != s_spin_limit; ++n) {
+      if (m_is_cancelled.load(std::memory_order_acquire)) {
+        return std::nullopt;
+      }
+      auto item = dequeue();
+      if (item.has_value()) {
+        notify(m_push_waiters, m_push_condition);
+        return item;
+      }
+      details::cpu_relax();
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_pop_waiters.fetch_add(1U, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!m_is_cancelled.load(std::memory_order_acquire)) {
+      auto item = dequeue();
+      if (item.has_value()) {
+        m_pop_waiters.fetch_sub(1U, std::memory_order_relaxed);
+        lock.unlock();
+        notify(m_push_waiters, m_push_condition);
+        return item;
+      }
+      m_pop_condition.wait(lock);
+    }
+    m_pop_waiters.fetch_sub(1U, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    auto item = dequeue();
+    if (item.has_value()) {
+      notify(m_push_waiters, m_push_condition);
+    }
+    return item;
+  }
+
+  /// \brief Pops an item without waiting for one, the same as try_pop because the queue does not lock
+  std::optional<T> poll() noexcept(std::is_nothrow_move_constructible_v<T>) { return try_pop(); }
+
+  void push(T item) noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    for (unsigned n = 0U; n != s_spin_limit; ++n) {
+      if (enqueue(std::move(item))) {
+        notify(m_pop_waiters, m_pop_condition);
+        return;
+      }
+      details::cpu_relax();
+    }
+
+    bool has_pushed{false};
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_push_waiters.fetch_add(1U, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!m_is_cancelled.load(std::memory_order_acquire)) {
+        has_pushed = enqueue(std::move(item));
+        if (has_pushed) {
+          break;
+        }
+        m_push_condition.wait(lock);
+      }
+      m_push_waiters.fetch_sub(1U, std::memory_order_relaxed);
+    }
+
+    if (has_pushed) {
+      notify(m_pop_waiters, m_pop_condition);
+    }
+  }
+
+  /// \brief Pushes the items of [first, last), the items are moved from
+  ///
+  /// Waiting consumers are notified once for the whole batch, and at most as many of them are woken up as there were
+  /// items pushed. Blocks like push() while the queue is full. Items are converted to T like in try_push().
+  template <typename InputIt> void push_bulk(InputIt first, InputIt last)
+  {
+    std::size_t count{0U};
+    for (; first != last; ++first) {
+      // Binds an iterator that yields items by value to a named temporary, so that a passed through item outlives the
+      // push.
+      auto&& element = *first;
+      auto&& item = to_item(std::move(element));
+      if (enqueue(std::forward<decltype(item)>(item))) {
+        ++count;
+      } else {
+        notify(m_pop_waiters, m_pop_condition, count);
+        count = 0U;
+        push(std::forward<decltype(item)>(item));
+      }
+    }
+    notify(m_pop_waiters, m_pop_condition, count);
+  }
+
+  /// \brief Pushes the item if the queue is not full, the item is moved from only when it was pushed
+  ///
+  /// An item that converts to T with a throwing constructor (e.g. a copy) is converted before a cell is claimed, so a
+  /// throw leaves the queue untouched. The converted item is discarded if the queue is full.
+  template <typename U> bool try_push(U&& item) noexcept(std::is_nothrow_constructible_v<T, U&&>)
+  {
+    if (!enqueue(to_item(std::forward<U>(item)))) {
+      return false;
+    }
+    notify(m_pop_waiters, m_pop_condition);
+    return true;
+  }
+
+  /// \brief Gets an approximation of the item count, items that are being pushed or popped may or may not be counted
+  std::size_t size() const noexcept
+  {
+    auto const popped = m_dequeue_position.load(std::memory_order_relaxed);
+    auto const pushed = m_enqueue_position.load(std::memory_order_relaxed);
+    return pushed > popped ? std::min(pushed - popped, Capacity) : 0U;
+  }
+
+  void clear() noexcept
+  {
+    m_is_cancelled.store(true, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+    }
+    m_pop_condition.notify_all();
+    m_push_condition.notify_all();
+
+    while (dequeue().has_value()) {
+    }
+  }
+
+private:
+  inline static constexpr std::size_t s_mask{Capacity - 1U};
+  inline static constexpr unsigned s_spin_limit{128U};
+  inline static constexpr std::size_t s_cache_line{64U};
+
+  struct alignas(s_cache_line) cell {
+    std::atomic_size_t sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  /// \brief Passes through an item that constructs T without throwing, converts any other item to T right away
+  template <typename U> static decltype(auto) to_item(U&& item)
+  {
+    if constexpr (std::is_nothrow_constructible_v<T, U&&>) {
+      return std::forward<U>(item);
+    } else {
+      return T(std::forward<U>(item));
+    }
+  }
+
+  /// \brief Constructs the item into the queue, the item is left untouched if the queue is full
+  template <typename U> bool enqueue(U&& item) noexcept
+  {
+    static_assert(std::is_nothrow_constructible_v<T, U&&>, "item must be nothrow constructible into a claimed cell");
+    auto position = m_enqueue_position.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = m_cells[position & s_mask];
+      auto const sequence = cell.sequence.load(std::memory_order_acquire);
+      auto const difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+      if (0 == difference) {
+        if (m_enqueue_position.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed)) {
+          ::new (static_cast<void*>(cell.storage)) T(std::forward<U>(item));
+          cell.sequence.store(position + 1U, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = m_enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::optional<T> dequeue() noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    auto position = m_dequeue_position.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = m_cells[position & s_mask];
+      auto const sequence = cell.sequence.load(std::memory_order_acquire);
+      auto const difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1U);
+      if (0 == difference) {
+        if (m_dequeue_position.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed)) {
+          auto* stored = std::launder(reinterpret_cast<T*>(cell.storage));
+          std::optional<T> item{std::move(*stored)};
+          stored->~T();
+          cell.sequence.store(position + Capacity, std::memory_order_release);
+          return item;
+        }
+      } else if (difference < 0) {
+        return std::nullopt;
+      } else {
+        position = m_dequeue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// \brief Wakes up to count waiters, the waiter count is an atomic so that the fast path does not take the mutex
+  void notify(std::atomic_uint& waiters, std::condition_variable& condition, std::size_t count = 1U) noexcept
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto const waiting = waiters.load(std::memory_order_relaxed);
+    if (0U != waiting && 0U != count) {
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+      }
+      if (count >= waiting) {
+        condition.notify_all();
+      } else {
+        for (std::size_t n = 0U; n != count; ++n) {
+          condition.notify_one();
+        }
+      }
+    }
+  }
+
+  alignas(s_cache_line) std::atomic_size_t m_enqueue_position;
+  alignas(s_cache_line) std::atomic_size_t m_dequeue_position;
+  alignas(s_cache_line) std::array<cell, Capacity> m_cells;
+
+  alignas(s_cache_line) std::atomic_bool m_is_cancelled;
+  std::atomic_uint m_pop_waiters;
+  std::atomic_uint m_push_waiters;
+  std::mutex m_mutex;
+  std::condition_variable m_pop_condition;
+  std::condition_variable m_push_condition;
+};
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_RING_QUEUE_HPP
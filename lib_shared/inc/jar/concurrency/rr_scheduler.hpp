@@ -18,20 +18,33 @@
 #ifndef JAR_CONCURRENCY_RR_SCHEDULER_HPP
 #define JAR_CONCURRENCY_RR_SCHEDULER_HPP
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <iterator>
 #include <optional>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include <jar/concurrency/idle_workers.hpp>
 #include <jar/concurrency/queue.hpp>
+#include <jar/concurrency/ring_queue.hpp>
+#include <jar/concurrency/stats.hpp>
+#include <jar/concurrency/unique_task.hpp>
 
 namespace jar::concurrency {
 
-class rr_scheduler {
+/// \brief A round-robin scheduler over a set of task queues
+///
+/// \tparam Queue   Task queue type, e.g. the mutex based queue or the lock-free ring_queue
+/// \tparam Stats   Statistics policy, no_stats compiles every statistics hook to nothing
+template <typename Queue, typename Stats = no_stats> class basic_rr_scheduler {
   class adapter {
   public:
-    explicit adapter(rr_scheduler* const schd)
+    explicit adapter(basic_rr_scheduler* const schd)
       : m_scheduler{schd}
     {
     }
@@ -39,41 +52,190 @@ class rr_scheduler {
     template <typename Invocable, typename... Args> void schedule(Invocable&& invocable, Args&&... args)
     {
       static_assert(std::is_invocable_v<Invocable, Args...>, "Invocable type must be invocable with args");
-      m_scheduler->schedule(
-          [invocable = std::forward<Invocable>(invocable), args = std::forward_as_tuple(std::forward<Args>(args)...)]() mutable {
-            return std::apply(
-                [&invocable](auto&&... args) {
-                  std::invoke(std::move(invocable), std::forward<Args>(args)...);
-                },
-                std::move(args));
-          });
+      // The invocable is instrumented before it is type erased, so the statistics do not add an allocation.
+      if constexpr (0U == sizeof...(Args)) {
+        m_scheduler->push(m_scheduler->m_stats.instrument(std::forward<Invocable>(invocable)));
+      } else {
+        // Arguments are decay-copied into the task, like std::thread and std::async do.
+        m_scheduler->push(m_scheduler->m_stats.instrument([invocable = std::forward<Invocable>(invocable),
+                               args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+          std::apply(
+              [&invocable](auto&... args) {
+                std::invoke(std::move(invocable), std::move(args)...);
+              },
+              args);
+        }));
+      }
+    }
+
+    template <typename ForwardIt> void schedule_bulk(ForwardIt first, ForwardIt last)
+    {
+      m_scheduler->schedule_bulk(first, last);
     }
 
+    template <typename Range> void schedule_bulk(Range&& range) { m_scheduler->schedule_bulk(range); }
+
+    unsigned concurrency() const noexcept { return m_scheduler->concurrency(); }
+
   private:
-    rr_scheduler* const m_scheduler;
+    basic_rr_scheduler* const m_scheduler;
   };
 
 public:
-  using task_type = std::function<void(void)>;
+  using task_type = typename Queue::value_type;
 
-  explicit rr_scheduler(unsigned queue_count);
+  explicit basic_rr_scheduler(unsigned queue_count);
 
   std::optional<task_type> scheduled();
 
-  void schedule(task_type&& task);
+  /// \brief Gets a scheduled task without blocking, empty if every queue was observed empty
+  std::optional<task_type> try_scheduled();
+
+  /// \brief Schedules a task, with statistics the task is instrumented after it has been type erased
+  void schedule(task_type&& task) { push(m_stats.instrument(std::move(task))); }
+
+  /// \brief Schedules the tasks of [first, last), the tasks are moved from
+  ///
+  /// The batch is split into contiguous chunks, one per queue, and every chunk is pushed with a single queue operation,
+  /// so the push index is advanced once and each queue wakes up at most as many workers as it received tasks.
+  template <typename ForwardIt> void schedule_bulk(ForwardIt first, ForwardIt last)
+  {
+    auto const count = static_cast<std::size_t>(std::distance(first, last));
+    if (0U == count) {
+      return;
+    }
+
+    if constexpr (!std::is_same_v<Stats, no_stats>) {
+      m_stats.on_schedule(false, count);
+    }
+
+    auto const chunk_count = std::min(count, m_task_queue.size());
+    auto const index = m_push_index.fetch_add(static_cast<unsigned>(chunk_count), std::memory_order_relaxed);
+    for (std::size_t n = 0U; n != chunk_count; ++n) {
+      auto const chunk_size = count / chunk_count + (n < count % chunk_count ? 1U : 0U);
+      auto const chunk_last = std::next(first, static_cast<std::ptrdiff_t>(chunk_size));
+      auto& chunk_queue = m_task_queue[(index + n) % m_task_queue.size()];
+      if constexpr (std::is_same_v<Stats, no_stats>) {
+        chunk_queue.push_bulk(first, chunk_last);
+      } else {
+        chunk_queue.push_bulk(instrumenting_iterator<ForwardIt>{first, &m_stats},
+                              instrumenting_iterator<ForwardIt>{chunk_last, &m_stats});
+      }
+      first = chunk_last;
+    }
+
+    notify_idle(count);
+  }
+
+  template <typename Range> void schedule_bulk(Range&& range) { schedule_bulk(std::begin(range), std::end(range)); }
+
+  /// \brief Gets an approximation of the scheduled task count
+  std::size_t size() const;
+
+  /// \brief Gets the number of queues, one per worker
+  unsigned concurrency() const noexcept { return static_cast<unsigned>(m_task_queue.size()); }
 
   void clear() noexcept;
 
+  /// \brief Makes the calling thread pop first from the queue at the index, a worker that reuses the slot of a retired
+  /// worker takes over its queue and its statistics
+  void attach(unsigned index) noexcept;
+
+  /// \brief Sets the idle workers that are notified of scheduled tasks, must be set before any task is scheduled
+  void set_idle_workers(idle_workers* workers) noexcept { m_idle_workers = workers; }
+
   auto get_adapter() noexcept { return adapter{this}; }
 
+  /// \brief Takes a snapshot of the runtime statistics, available only with a collecting statistics policy
+  template <typename S = Stats, typename = std::enable_if_t<!std::is_same_v<S, no_stats>>> stats_snapshot stats() const
+  {
+    auto snapshot = m_stats.snapshot();
+    snapshot.queue_depths.reserve(m_task_queue.size());
+    for (auto const& queue : m_task_queue) {
+      snapshot.queue_depths.push_back(queue.size());
+    }
+    return snapshot;
+  }
+
 private:
-  using task_queue = std::vector<queue<task_type>>;
+  using task_queue = std::vector<Queue>;
+
+  /// \brief An input iterator that yields the instrumented task of each element as it is pushed, the element is moved
+  /// from only when it is read
+  template <typename ForwardIt> class instrumenting_iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = task_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = task_type;
+
+    instrumenting_iterator(ForwardIt it, Stats* stats)
+      : m_it{it}
+      , m_stats{stats}
+    {
+    }
+
+    task_type operator*() const { return task_type{m_stats->instrument(std::move(*m_it))}; }
+
+    instrumenting_iterator& operator++()
+    {
+      ++m_it;
+      return *this;
+    }
+
+    bool operator==(instrumenting_iterator const& other) const { return m_it == other.m_it; }
+
+    bool operator!=(instrumenting_iterator const& other) const { return m_it != other.m_it; }
+
+  private:
+    ForwardIt m_it;
+    Stats* m_stats;
+  };
+
+  void push(task_type&& task);
 
+  unsigned thread_index() noexcept;
+
+  void notify_idle(std::size_t count = 1U) noexcept
+  {
+    if (nullptr != m_idle_workers) {
+      m_idle_workers->notify(count);
+    }
+  }
+
+  std::uint64_t const m_id;
   task_queue m_task_queue;
   std::atomic_uint m_push_index;
   std::atomic_uint m_pop_index;
+  idle_workers* m_idle_workers;
+  Stats m_stats;
 };
 
+/// \brief Type alias for the round-robin scheduler over mutex based queues
+using rr_scheduler = basic_rr_scheduler<queue<unique_task>>;
+
+/// \brief Type alias for the round-robin scheduler over lock-free ring queues
+using rr_ring_scheduler = basic_rr_scheduler<ring_queue<unique_task>>;
+
+/// \brief Type alias for the round-robin scheduler over mutex based queues that collects runtime statistics
+using rr_stats_scheduler = basic_rr_scheduler<queue<unique_task>, scheduler_stats>;
+
+/// \brief Type alias for the round-robin scheduler over lock-free ring queues that collects runtime statistics
+using rr_ring_stats_scheduler = basic_rr_scheduler<ring_queue<unique_task>, scheduler_stats>;
+
+/// \brief Explicit instantiation declaration for the round-robin scheduler over mutex based queues
+extern template class basic_rr_scheduler<queue<unique_task>>;
+
+/// \brief Explicit instantiation declaration for the round-robin scheduler over lock-free ring queues
+extern template class basic_rr_scheduler<ring_queue<unique_task>>;
+
+/// \brief Explicit instantiation declaration for the statistics collecting scheduler over mutex based queues
+extern template class basic_rr_scheduler<queue<unique_task>, scheduler_stats>;
+
+/// \brief Explicit instantiation declaration for the statistics collecting scheduler over lock-free ring queues
+extern template class basic_rr_scheduler<ring_queue<unique_task>, scheduler_stats>;
+
 }  // namespace jar::concurrency
 
 #endif  // JAR_CONCURRENCY_RR_SCHEDULER_HPP
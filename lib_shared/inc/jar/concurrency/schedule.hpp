@@ -38,15 +38,24 @@ public:
   {
   }
 
+  /// \brief Schedules the receiver, work that is canceled before it is scheduled or run is skipped and canceled
   void start()
   {
+    if (m_receiver.is_canceled()) {
+      m_receiver.cancel();
+      return;
+    }
+
     m_scheduler.schedule([state = std::move(*this)]() mutable {
-      if (!state.m_receiver.is_canceled()) {
-        try {
-          state.m_receiver.complete();
-        } catch (...) {
-          state.m_receiver.fail(std::current_exception());
-        }
+      if (state.m_receiver.is_canceled()) {
+        state.m_receiver.cancel();
+        return;
+      }
+
+      try {
+        state.m_receiver.complete();
+      } catch (...) {
+        state.m_receiver.fail(std::current_exception());
       }
     });
   }
@@ -58,6 +67,8 @@ private:
 
 template <typename Scheduler> class schedule_sender {
 public:
+  using result_type = void;
+
   explicit schedule_sender(Scheduler&& scheduler) noexcept
     : m_scheduler{std::move(scheduler)}
   {
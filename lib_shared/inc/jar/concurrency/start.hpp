@@ -18,18 +18,25 @@
 #ifndef JAR_CONCURRENCY_START_HPP
 #define JAR_CONCURRENCY_START_HPP
 
+#include <utility>
+
 #include <jar/concurrency/details/value_receiver.hpp>
+#include <jar/concurrency/stop_token.hpp>
 
 namespace jar::concurrency {
 
-template <typename Sender> void start(Sender&& sender)
+/// \brief Starts the sender and forgets its result, a stop request through the token cancels the work that has not
+///        run yet
+template <typename Sender> void start(Sender&& sender, stop_token token)
 {
   using value_type = typename Sender::result_type;
 
-  auto state = sender.connect(details::value_receiver<value_type>{});
+  auto state = sender.connect(details::value_receiver<value_type>{std::move(token)});
   state.start();
 }
 
+template <typename Sender> void start(Sender&& sender) { start(std::forward<Sender>(sender), stop_token{}); }
+
 }  // namespace jar::concurrency
 
 #endif  // JAR_CONCURRENCY_START_HPP
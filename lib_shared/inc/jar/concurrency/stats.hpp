@@ -0,0 +1,166 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file stats.hpp
+///
+
+#ifndef JAR_CONCURRENCY_STATS_HPP
+#define JAR_CONCURRENCY_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace jar::concurrency {
+
+/// \brief A latency histogram with power of two buckets
+///
+/// Bucket n counts the durations of [2^n, 2^(n+1)) nanoseconds, the first bucket also counts zero durations and the
+/// last bucket everything longer. Recording is a single relaxed increment.
+class latency_histogram {
+public:
+  inline static constexpr std::size_t s_bucket_count{40U};
+
+  using buckets_type = std::array<std::uint64_t, s_bucket_count>;
+
+  void record(std::chrono::nanoseconds duration) noexcept;
+
+  buckets_type snapshot() const noexcept;
+
+private:
+  std::array<std::atomic_uint64_t, s_bucket_count> m_buckets{};
+};
+
+/// \brief A point in time copy of a latency histogram
+struct latency_snapshot {
+  latency_histogram::buckets_type buckets{};
+
+  /// \brief Gets the number of recorded durations
+  std::uint64_t count() const noexcept;
+
+  /// \brief Gets the upper bound of the bucket the given fraction (e.g. 0.99) of the durations falls in
+  std::chrono::nanoseconds percentile(double fraction) const noexcept;
+
+  latency_snapshot& operator+=(latency_snapshot const& other) noexcept;
+};
+
+/// \brief A point in time copy of the counters of a worker
+struct worker_snapshot {
+  std::uint64_t scheduled{0U};       ///< Tasks scheduled
+  std::uint64_t push_fallbacks{0U};  ///< Tasks pushed with a blocking push after every try_push failed
+  std::uint64_t local_pops{0U};      ///< Tasks taken from the worker's own queue
+  std::uint64_t foreign_pops{0U};    ///< Tasks taken from the queue of another worker
+  latency_snapshot queue_wait;       ///< Time from scheduling a task to starting it
+  latency_snapshot run_time;         ///< Time from starting a task to finishing it
+
+  worker_snapshot& operator+=(worker_snapshot const& other) noexcept;
+};
+
+/// \brief A point in time copy of the statistics of a scheduler
+///
+/// Counters are read one by one while the scheduler runs, so a snapshot is not an atomic cut of all counters.
+struct stats_snapshot {
+  std::vector<worker_snapshot> workers;    ///< Counters of the worker threads, indexed by the worker
+  worker_snapshot external;                ///< Counters of the threads that are not workers
+  std::vector<std::size_t> queue_depths;  ///< Approximate task count of every queue
+
+  /// \brief Sums the counters of all threads
+  worker_snapshot total() const noexcept;
+};
+
+/// \brief Statistics policy that collects nothing, every hook compiles to nothing
+struct no_stats {
+  explicit constexpr no_stats(unsigned /*worker_count*/) noexcept {}
+
+  void attach(unsigned /*worker*/) noexcept {}
+
+  void on_schedule(bool /*is_fallback*/, std::size_t /*count*/ = 1U) noexcept {}
+
+  void on_pop(bool /*is_foreign*/) noexcept {}
+
+  template <typename Invocable> Invocable&& instrument(Invocable&& invocable) noexcept
+  {
+    return std::forward<Invocable>(invocable);
+  }
+};
+
+/// \brief Statistics policy that collects per worker counters and latency histograms
+///
+/// Every worker has its own cache line isolated slot, so counting does not contend between workers. Threads that are
+/// not workers (e.g. producers) share a small set of striped slots. Tasks are instrumented when they are scheduled, the
+/// instrumented task records its queue wait and run time when it is run.
+class scheduler_stats {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit scheduler_stats(unsigned worker_count);
+
+  scheduler_stats(scheduler_stats const&) = delete;
+  scheduler_stats(scheduler_stats&&) = delete;
+  scheduler_stats& operator=(scheduler_stats const&) = delete;
+  scheduler_stats& operator=(scheduler_stats&&) = delete;
+
+  ~scheduler_stats() = default;
+
+  /// \brief Attaches the calling thread to a worker slot, the counters of the thread go to the slot from now on
+  void attach(unsigned worker) noexcept;
+
+  void on_schedule(bool is_fallback, std::size_t count = 1U) noexcept;
+
+  void on_pop(bool is_foreign) noexcept;
+
+  void on_run(clock::duration queue_wait, clock::duration run_time) noexcept;
+
+  /// \brief Wraps an invocable into one that records its queue wait and run time
+  template <typename Invocable> auto instrument(Invocable&& invocable)
+  {
+    return [invocable = std::forward<Invocable>(invocable), stats = this, scheduled = clock::now()]() mutable {
+      auto const started = clock::now();
+      std::invoke(invocable);
+      stats->on_run(started - scheduled, clock::now() - started);
+    };
+  }
+
+  stats_snapshot snapshot() const;
+
+private:
+  struct alignas(64) slot {
+    std::atomic_uint64_t scheduled{0U};
+    std::atomic_uint64_t push_fallbacks{0U};
+    std::atomic_uint64_t local_pops{0U};
+    std::atomic_uint64_t foreign_pops{0U};
+    latency_histogram queue_wait;
+    latency_histogram run_time;
+
+    worker_snapshot snapshot() const noexcept;
+  };
+
+  inline static constexpr unsigned s_stripe_count{8U};
+
+  slot& local() noexcept;
+
+  std::uint64_t const m_id;
+  unsigned const m_worker_count;
+  std::unique_ptr<slot[]> m_slots;
+};
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_STATS_HPP
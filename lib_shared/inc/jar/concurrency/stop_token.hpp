@@ -0,0 +1,241 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file stop_token.hpp
+///
+
+#ifndef JAR_CONCURRENCY_STOP_TOKEN_HPP
+#define JAR_CONCURRENCY_STOP_TOKEN_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <jar/concurrency/type_traits.hpp>
+
+namespace jar::concurrency {
+namespace details {
+
+/// \brief A callback registered to a stop state
+class stop_callback_base {
+public:
+  virtual void execute() noexcept = 0;
+
+protected:
+  stop_callback_base() noexcept = default;
+  ~stop_callback_base() = default;
+
+private:
+  friend class stop_state;
+
+  stop_callback_base* m_next{nullptr};
+  stop_callback_base* m_previous{nullptr};
+  bool m_is_registered{false};
+  std::atomic_bool m_is_executed{false};
+};
+
+/// \brief The shared state of a stop source and its tokens
+///
+/// Reference counted intrusively and allocated from the block pool. Checking for a stop request is a single atomic
+/// load, the mutex is taken only to register and deregister callbacks and to request stop.
+class stop_state {
+public:
+  static stop_state* create();
+
+  stop_state(stop_state const&) = delete;
+  stop_state(stop_state&&) = delete;
+  stop_state& operator=(stop_state const&) = delete;
+  stop_state& operator=(stop_state&&) = delete;
+
+  void retain() noexcept { m_references.fetch_add(1U, std::memory_order_relaxed); }
+
+  void release() noexcept;
+
+  bool stop_requested() const noexcept { return m_is_requested.load(std::memory_order_acquire); }
+
+  /// \brief Requests stop and runs the registered callbacks on the calling thread, false if stop was already requested
+  bool request_stop() noexcept;
+
+  /// \brief Registers a callback, false if stop was already requested and the callback was not registered
+  bool add(stop_callback_base* callback);
+
+  /// \brief Deregisters a callback, waits for the callback to finish if another thread is running it
+  void remove(stop_callback_base* callback) noexcept;
+
+private:
+  stop_state() noexcept;
+  ~stop_state() = default;
+
+  std::atomic<std::uint32_t> m_references;
+  std::atomic_bool m_is_requested;
+  std::mutex m_mutex;
+  stop_callback_base* m_callbacks;
+  stop_callback_base* m_running;
+  std::thread::id m_requester;
+};
+
+}  // namespace details
+
+/// \brief A token for checking whether stop has been requested, tokens are cheap to copy
+///
+/// A default constructed token has no stop source and stop can never be requested.
+class stop_token {
+public:
+  stop_token() noexcept
+    : m_state{nullptr}
+  {
+  }
+
+  stop_token(stop_token const& other) noexcept
+    : m_state{other.m_state}
+  {
+    if (nullptr != m_state) {
+      m_state->retain();
+    }
+  }
+
+  stop_token(stop_token&& other) noexcept
+    : m_state{std::exchange(other.m_state, nullptr)}
+  {
+  }
+
+  stop_token& operator=(stop_token other) noexcept
+  {
+    std::swap(m_state, other.m_state);
+    return *this;
+  }
+
+  ~stop_token()
+  {
+    if (nullptr != m_state) {
+      m_state->release();
+    }
+  }
+
+  bool stop_requested() const noexcept { return nullptr != m_state && m_state->stop_requested(); }
+
+  bool stop_possible() const noexcept { return nullptr != m_state; }
+
+private:
+  friend class stop_source;
+  template <typename> friend class stop_callback;
+
+  explicit stop_token(details::stop_state* state) noexcept
+    : m_state{state}
+  {
+    m_state->retain();
+  }
+
+  details::stop_state* m_state;
+};
+
+/// \brief The owner side of a stop state, requests stop for every token obtained from it
+///
+/// Copies share the stop state.
+class stop_source {
+public:
+  stop_source()
+    : m_state{details::stop_state::create()}
+  {
+  }
+
+  stop_source(stop_source const& other) noexcept
+    : m_state{other.m_state}
+  {
+    m_state->retain();
+  }
+
+  stop_source(stop_source&&) = delete;
+
+  stop_source& operator=(stop_source const&) = delete;
+  stop_source& operator=(stop_source&&) = delete;
+
+  ~stop_source() { m_state->release(); }
+
+  stop_token get_token() const noexcept { return stop_token{m_state}; }
+
+  /// \brief Requests stop, the callbacks are run on the calling thread by the first request only
+  bool request_stop() noexcept { return m_state->request_stop(); }
+
+  bool stop_requested() const noexcept { return m_state->stop_requested(); }
+
+private:
+  details::stop_state* const m_state;
+};
+
+/// \brief Runs a callback when stop is requested, or right away if it has been requested already
+///
+/// The destructor deregisters the callback and waits for it to finish if stop is being requested on another thread,
+/// so the callback may safely refer to objects that outlive the stop_callback.
+template <typename Callback> class stop_callback final : private details::stop_callback_base {
+public:
+  template <typename C>
+  stop_callback(stop_token const& token, C&& callback)
+    : m_callback{std::forward<C>(callback)}
+    , m_state{token.m_state}
+  {
+    static_assert(std::is_nothrow_invocable_v<Callback>, "stop callback must be noexcept invocable");
+
+    if (nullptr != m_state) {
+      if (m_state->add(this)) {
+        m_state->retain();
+      } else {
+        m_state = nullptr;
+        std::invoke(m_callback);
+      }
+    }
+  }
+
+  stop_callback(stop_callback const&) = delete;
+  stop_callback(stop_callback&&) = delete;
+  stop_callback& operator=(stop_callback const&) = delete;
+  stop_callback& operator=(stop_callback&&) = delete;
+
+  ~stop_callback()
+  {
+    if (nullptr != m_state) {
+      m_state->remove(this);
+      m_state->release();
+    }
+  }
+
+private:
+  void execute() noexcept override { std::invoke(m_callback); }
+
+  Callback m_callback;
+  details::stop_state* m_state;
+};
+
+template <typename Callback> stop_callback(stop_token const&, Callback) -> stop_callback<Callback>;
+
+namespace details {
+
+/// \brief Gets the stop token of a receiver, a token without a stop source if the receiver has none
+template <typename Receiver> stop_token get_stop_token(Receiver const& receiver) noexcept
+{
+  if constexpr (has_stop_token<Receiver>::value) {
+    return receiver.get_stop_token();
+  } else {
+    return stop_token{};
+  }
+}
+
+}  // namespace details
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_STOP_TOKEN_HPP
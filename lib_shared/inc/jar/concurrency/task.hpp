@@ -0,0 +1,295 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file task.hpp
+///
+
+#ifndef JAR_CONCURRENCY_TASK_HPP
+#define JAR_CONCURRENCY_TASK_HPP
+
+#if !defined(__cpp_impl_coroutine)
+#error "jar/concurrency/task.hpp requires C++20 coroutines, configure with -Dcoroutines=ON"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <jar/concurrency/coroutine.hpp>
+#include <jar/concurrency/details/frame_allocator.hpp>
+#include <jar/concurrency/details/when_receiver.hpp>
+#include <jar/concurrency/stop_token.hpp>
+#include <jar/concurrency/type_traits.hpp>
+
+namespace jar::concurrency {
+
+template <typename Value = void> class task;
+
+namespace details {
+
+/// \brief Common part of the task promises, the frames are allocated from the recycling frame allocator
+template <typename Value> class task_promise_base {
+  class final_awaiter {
+  public:
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+      auto const continuation = handle.promise().m_continuation;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+public:
+  static void* operator new(std::size_t size) { return frame_allocator::allocate(size); }
+
+  static void operator delete(void* frame, std::size_t size) noexcept { frame_allocator::deallocate(frame, size); }
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+
+  final_awaiter final_suspend() const noexcept { return {}; }
+
+  void unhandled_exception() noexcept { m_result.template emplace<s_error>(std::current_exception()); }
+
+  stop_token get_stop_token() const noexcept { return m_stop_token; }
+
+  void set_stop_token(stop_token token) noexcept { m_stop_token = std::move(token); }
+
+  void set_continuation(std::coroutine_handle<> continuation) noexcept { m_continuation = continuation; }
+
+  Value result()
+  {
+    if (s_error == m_result.index()) {
+      std::rethrow_exception(std::get<s_error>(m_result));
+    }
+    if constexpr (!std::is_void_v<Value>) {
+      return std::move(std::get<s_value>(m_result));
+    }
+  }
+
+protected:
+  inline static constexpr std::size_t s_value{1U};
+  inline static constexpr std::size_t s_error{2U};
+
+  std::variant<std::monostate, non_void_t<Value>, std::exception_ptr> m_result{};
+
+private:
+  std::coroutine_handle<> m_continuation{};
+  stop_token m_stop_token{};
+};
+
+template <typename Value> class task_promise : public task_promise_base<Value> {
+public:
+  task<Value> get_return_object() noexcept;
+
+  template <typename V> void return_value(V&& value)
+  {
+    this->m_result.template emplace<task_promise_base<Value>::s_value>(std::forward<V>(value));
+  }
+};
+
+template <> class task_promise<void> : public task_promise_base<void> {
+public:
+  task<void> get_return_object() noexcept;
+
+  void return_void() noexcept { m_result.template emplace<s_value>(); }
+};
+
+/// \brief A coroutine that is started by a sender state and destroys itself when it completes
+class detached_task {
+public:
+  class promise_type {
+  public:
+    static void* operator new(std::size_t size) { return frame_allocator::allocate(size); }
+
+    static void operator delete(void* frame, std::size_t size) noexcept { frame_allocator::deallocate(frame, size); }
+
+    detached_task get_return_object() const noexcept { return {}; }
+
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+
+    std::suspend_never final_suspend() const noexcept { return {}; }
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+template <typename Value, typename Receiver> detached_task run_task(task<Value> work, Receiver receiver)
+{
+  std::exception_ptr error{};
+  try {
+    if constexpr (std::is_void_v<Value>) {
+      co_await std::move(work);
+      receiver.complete();
+    } else {
+      receiver.complete(co_await std::move(work));
+    }
+    co_return;
+  } catch (operation_canceled const&) {
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  if (error) {
+    receiver.fail(error);
+  } else {
+    receiver.cancel();
+  }
+}
+
+template <typename Receiver, typename Value> class task_state {
+public:
+  task_state(task<Value>&& task, Receiver&& receiver)
+    : m_task{std::move(task)}
+    , m_receiver{std::move(receiver)}
+  {
+  }
+
+  void start()
+  {
+    if (m_receiver.is_canceled()) {
+      m_receiver.cancel();
+      return;
+    }
+
+    m_task.set_stop_token(get_stop_token(m_receiver));
+    run_task(std::move(m_task), std::move(m_receiver));
+  }
+
+private:
+  task<Value> m_task;
+  Receiver m_receiver;
+};
+
+}  // namespace details
+
+/// \brief A lazily started coroutine that produces a value
+///
+/// A task does not run until it is awaited, or started as a sender. The awaiting coroutine is resumed through symmetric
+/// transfer when the task completes, so chains of tasks do not grow the stack, and the stop token of the awaiting
+/// coroutine is passed on to the task. The frames are recycled by a per-thread pool, so a short-lived task does not
+/// reach the global allocator once the pool has warmed up. A task runs on the thread that resumes it, to continue on a
+/// thread_pool worker await resume_on(pool.get_scheduler()).
+///
+/// \tparam Value   Type of the value, may be void
+template <typename Value> class task {
+  using handle_type = std::coroutine_handle<details::task_promise<Value>>;
+
+  class awaiter {
+  public:
+    explicit awaiter(handle_type handle) noexcept
+      : m_handle{handle}
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept
+    {
+      if constexpr (has_stop_token<Promise>::value) {
+        m_handle.promise().set_stop_token(awaiting.promise().get_stop_token());
+      }
+      m_handle.promise().set_continuation(awaiting);
+      return m_handle;
+    }
+
+    Value await_resume() { return m_handle.promise().result(); }
+
+  private:
+    handle_type m_handle;
+  };
+
+  template <typename, typename> friend class details::task_state;
+  friend class details::task_promise<Value>;
+
+public:
+  using promise_type = details::task_promise<Value>;
+  using result_type = Value;
+
+  task(task const&) = delete;
+
+  task(task&& other) noexcept
+    : m_handle{std::exchange(other.m_handle, nullptr)}
+  {
+  }
+
+  task& operator=(task const&) = delete;
+
+  task& operator=(task&& other) noexcept
+  {
+    if (this != &other) {
+      destroy();
+      m_handle = std::exchange(other.m_handle, nullptr);
+    }
+    return *this;
+  }
+
+  ~task() { destroy(); }
+
+  /// \brief Starts the task and suspends the awaiting coroutine until the task completes
+  awaiter operator co_await() && noexcept { return awaiter{m_handle}; }
+
+  /// \brief Connects the task as a sender, the task starts on the thread that starts the state
+  template <typename Receiver> auto connect(Receiver&& receiver) &&
+  {
+    return details::task_state<std::decay_t<Receiver>, Value>{std::move(*this), std::forward<Receiver>(receiver)};
+  }
+
+  template <typename Receiver> auto connect(Receiver&& receiver) &
+  {
+    return std::move(*this).connect(std::forward<Receiver>(receiver));
+  }
+
+private:
+  explicit task(handle_type handle) noexcept
+    : m_handle{handle}
+  {
+  }
+
+  void set_stop_token(stop_token token) noexcept { m_handle.promise().set_stop_token(std::move(token)); }
+
+  void destroy() noexcept
+  {
+    if (m_handle) {
+      m_handle.destroy();
+    }
+  }
+
+  handle_type m_handle;
+};
+
+namespace details {
+
+template <typename Value> task<Value> task_promise<Value>::get_return_object() noexcept
+{
+  return task<Value>{std::coroutine_handle<task_promise<Value>>::from_promise(*this)};
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept
+{
+  return task<void>{std::coroutine_handle<task_promise<void>>::from_promise(*this)};
+}
+
+}  // namespace details
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_TASK_HPP
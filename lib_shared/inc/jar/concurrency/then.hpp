@@ -18,13 +18,26 @@
 #ifndef JAR_CONCURRENCY_THEN_HPP
 #define JAR_CONCURRENCY_THEN_HPP
 
+#include <type_traits>
+#include <utility>
+
 #include <jar/concurrency/details/sender_adapter.hpp>
 
 namespace jar::concurrency {
 
+/// \brief Creates a sender that invokes the invocable with the result of the sender
+///
+/// Chained then() calls are fused into a single sender, see details::sender_adapter.
 template <typename Sender, typename Invocable> auto then(Sender&& sender, Invocable&& invocable)
 {
-  return details::sender_adapter{std::forward<Sender>(sender), std::forward<Invocable>(invocable)};
+  if constexpr (details::is_sender_adapter<std::decay_t<Sender>>::value) {
+    return std::decay_t<Sender>{std::forward<Sender>(sender)}.fuse(std::forward<Invocable>(invocable));
+  } else {
+    using sender_type = std::decay_t<Sender>;
+    using invocable_type = std::decay_t<Invocable>;
+    return details::sender_adapter<sender_type, invocable_type>{sender_type{std::forward<Sender>(sender)},
+                                                                invocable_type{std::forward<Invocable>(invocable)}};
+  }
 }
 
 }  // namespace jar::concurrency
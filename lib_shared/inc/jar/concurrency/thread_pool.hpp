@@ -19,28 +19,130 @@
 #define JAR_CONCURRENCY_THREAD_POOL_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
 #include <thread>
+#include <utility>
 #include <vector>
 
+#include <jar/concurrency/details/wait_helper.hpp>
+#include <jar/concurrency/idle_workers.hpp>
+#include <jar/concurrency/placement.hpp>
 #include <jar/concurrency/type_traits.hpp>
 
 namespace jar::concurrency {
 
+/// \brief Elastic thread pool options, the pool is elastic when the maximum thread count is not zero
+///
+/// A supervisor thread checks the scheduler every queue age period and adds a worker when scheduled tasks have not
+/// been picked up during the period or when the queues are deeper than the queue depth per worker. A worker that has
+/// been parked for the keep-alive period retires, unless the pool is at its minimum thread count.
+struct elastic_options {
+  unsigned min_threads{1U};
+  unsigned max_threads{0U};
+  std::chrono::milliseconds queue_age{10};
+  std::size_t queue_depth{64U};
+  std::chrono::milliseconds keep_alive{10000};
+};
+
+/// \brief Thread pool options
+struct thread_pool_options {
+  unsigned thread_count{std::thread::hardware_concurrency()};  ///< Thread count, the initial count of an elastic pool
+  placement_policy placement{placement_policy::none};
+  idle_strategy idle{};  ///< Used only with schedulers that can be polled, others always block
+  elastic_options elastic{};
+};
+
 template <typename Scheduler> class thread_pool {
 public:
-  explicit thread_pool(unsigned thread_count = std::thread::hardware_concurrency())
-    : m_thread_count{std::max(1U, thread_count)}
+  /// \brief Constructor, the scheduler is constructed from the thread count and the extra scheduler arguments
+  template <typename... SchedulerArgs>
+  explicit thread_pool(unsigned thread_count = std::thread::hardware_concurrency(), SchedulerArgs&&... args)
+    : thread_pool{thread_pool_options{thread_count, placement_policy::none, idle_strategy{}, elastic_options{}},
+                  std::forward<SchedulerArgs>(args)...}
+  {
+  }
+
+  /// \brief Constructor with worker placement
+  ///
+  /// With the numa placement every NUMA node gets its own scheduler partition. The partition is constructed while the
+  /// calling thread is bound to the node, so that the memory of its queues is allocated from the node.
+  ///
+  /// With the spin-then-park idle strategy every partition gets its idle workers, the workers poll the scheduler
+  /// and park on their own event instead of blocking in the scheduler. An elastic pool always polls, its scheduler
+  /// is constructed for the maximum thread count.
+  ///
+  /// \throw  std::invalid_argument if the pool is elastic and the scheduler cannot be polled, the minimum thread count
+  ///         is greater than the maximum or the placement is numa
+  template <typename... SchedulerArgs>
+  explicit thread_pool(thread_pool_options const& options, SchedulerArgs&&... args)
+    : m_thread_count{0U != options.elastic.max_threads ? options.elastic.max_threads
+                                                        : std::max(1U, options.thread_count)}
+    , m_topology{placement_policy::none == options.placement ? cpu_topology{} : system_topology()}
+    , m_placement{plan_placement(m_topology, options.placement, m_thread_count)}
     , m_threads{m_thread_count}
-    , m_scheduler{m_thread_count}
+    , m_partitions{}
+    , m_idle{}
+    , m_elastic{options.elastic}
+    , m_workers{}
+    , m_live{0U}
+    , m_supervisor{}
+    , m_is_stopping{false}
   {
     static_assert(is_input_scheduler<Scheduler>::value, "scheduler must fulfill input Scheduler type requirements");
 
+    if (is_elastic()) {
+      if (!is_elastic_scheduler<Scheduler>::value) {
+        throw std::invalid_argument{"elastic thread pool requires a scheduler that can be polled and sized"};
+      }
+      if (m_elastic.min_threads > m_elastic.max_threads || placement_policy::numa == options.placement) {
+        throw std::invalid_argument{"invalid elastic thread pool options"};
+      }
+    }
+
+    auto const partition_count =
+        placement_policy::numa == options.placement ? std::min<std::size_t>(m_topology.size(), m_thread_count) : 1U;
+
+    for (std::size_t partition = 0U; partition != partition_count; ++partition) {
+      auto const worker_count =
+          static_cast<unsigned>((m_thread_count - partition + partition_count - 1U) / partition_count);
+      scoped_affinity affinity{partition_count > 1U ? m_topology[partition].cpus : std::vector<unsigned>{}};
+      if (1U == partition_count) {
+        m_partitions.emplace_back(std::make_unique<Scheduler>(worker_count, std::forward<SchedulerArgs>(args)...));
+      } else {
+        m_partitions.emplace_back(std::make_unique<Scheduler>(worker_count, args...));
+      }
+
+      if constexpr (is_idle_scheduler<Scheduler>::value) {
+        if (idle_policy::spin_then_park == options.idle.policy || is_elastic()) {
+          m_idle.emplace_back(std::make_unique<idle_workers>(options.idle, worker_count));
+          m_partitions.back()->set_idle_workers(m_idle.back().get());
+        }
+      }
+    }
+
     try {
-      for (auto& thread : m_threads) {
-        thread = std::thread{[this]() {
-          run();
+      if constexpr (is_elastic_scheduler<Scheduler>::value) {
+        if (is_elastic()) {
+          start_elastic(std::clamp(options.thread_count, m_elastic.min_threads, m_elastic.max_threads));
+          return;
+        }
+      }
+
+      for (std::size_t worker = 0U; worker != m_threads.size(); ++worker) {
+        auto const partition = worker % partition_count;
+        m_threads[worker] = std::thread{[this, partition, index = static_cast<unsigned>(worker / partition_count)]() {
+          run(*m_partitions[partition], m_idle.empty() ? nullptr : m_idle[partition].get(), index);
         }};
+        set_affinity(m_threads[worker], m_placement[worker]);
+        m_live.fetch_add(1U, std::memory_order_relaxed);
       }
     } catch (...) {
       join();
@@ -55,33 +157,223 @@ public:
 
   ~thread_pool() { join(); }
 
-  auto get_scheduler()
+  /// \brief Gets the scheduler adapter, the arguments are passed to the adapter getter (e.g. a task priority)
+  ///
+  /// With NUMA partitions the adapter schedules to the partition of the node the calling thread runs on.
+  template <typename... Args> auto get_scheduler(Args&&... args)
+  {
+    return get_scheduler_for(local_partition(), std::forward<Args>(args)...);
+  }
+
+  /// \brief Gets the scheduler adapter of a partition
+  template <typename... Args> auto get_scheduler_for(std::size_t partition, Args&&... args)
   {
+    auto& scheduler = *m_partitions.at(partition);
     if constexpr (has_scheduler_adapter<Scheduler>::value) {
-      return m_scheduler.get_adapter();
+      return scheduler.get_adapter(std::forward<Args>(args)...);
     } else {
-      return m_scheduler;
+      static_assert(0U == sizeof...(Args), "scheduler without an adapter does not accept arguments");
+      return scheduler;
     }
   }
 
+  /// \brief Takes a snapshot of the scheduler statistics of a partition, available when the scheduler collects them
+  template <typename S = Scheduler>
+  auto stats(std::size_t partition = 0U) const -> decltype(std::declval<S const&>().stats())
+  {
+    return m_partitions.at(partition)->stats();
+  }
+
+  /// \brief Gets the number of scheduler partitions
+  std::size_t partition_count() const noexcept { return m_partitions.size(); }
+
+  /// \brief Gets the number of running worker threads, changes over time in an elastic pool
+  unsigned thread_count() const noexcept { return m_live.load(std::memory_order_relaxed); }
+
 private:
-  void run() noexcept
+  /// \brief Per worker state of an elastic pool
+  struct alignas(64) worker_state {
+    std::atomic_bool is_running{false};
+    std::atomic_uint64_t started{0U};
+  };
+
+  bool is_elastic() const noexcept { return 0U != m_elastic.max_threads; }
+
+  void run(Scheduler& scheduler, idle_workers* idle, unsigned index) noexcept
+  {
+    // The worker takes the scheduler slot of its pool slot, a respawned worker reuses the slot of the retired one.
+    if constexpr (has_worker_attach<Scheduler>::value) {
+      scheduler.attach(index);
+    }
+
+    if constexpr (is_idle_scheduler<Scheduler>::value) {
+      // A worker that waits on a future runs the tasks of its partition meanwhile, see details::wait_helper.
+      details::scheduler_helper<Scheduler> helper{scheduler};
+      if (nullptr != idle) {
+        poll(scheduler, *idle, index);
+      } else {
+        run_blocking(scheduler);
+      }
+    } else {
+      run_blocking(scheduler);
+    }
+  }
+
+  /// \brief Runs the tasks of the scheduler, blocking in the scheduler while there are none
+  void run_blocking(Scheduler& scheduler) noexcept
   {
     using task_type = typename Scheduler::task_type;
 
-    std::optional<task_type> task;
-    do {
-      task = m_scheduler.scheduled();
+    // The task is destroyed right after it has run, its captures must not live until the next task is scheduled.
+    for (;;) {
+      std::optional<task_type> task{scheduler.scheduled()};
+      if (!task.has_value()) {
+        break;
+      }
+      task.value()();
+    }
+  }
+
+  /// \brief Runs the tasks of a scheduler that can be polled, an elastic worker retires after the keep-alive period
+  void poll(Scheduler& scheduler, idle_workers& idle, unsigned index) noexcept
+  {
+    auto const keep_alive = is_elastic() ? m_elastic.keep_alive : idle_workers::s_no_timeout;
+
+    while (!idle.is_stopped()) {
+      auto task = scheduler.try_scheduled();
+      if (!task.has_value()) {
+        task = idle.wait(
+            index,
+            [&scheduler]() {
+              return scheduler.try_scheduled();
+            },
+            keep_alive);
+      }
 
       if (task.has_value()) {
+        if (is_elastic()) {
+          m_workers[index].started.fetch_add(1U, std::memory_order_relaxed);
+        }
         task.value()();
+      } else if (is_elastic() && !idle.is_stopped() && retire()) {
+        break;
+      }
+    }
+
+    if (is_elastic()) {
+      m_workers[index].is_running.store(false, std::memory_order_release);
+    }
+  }
+
+  void start_elastic(unsigned thread_count)
+  {
+    m_workers = std::make_unique<worker_state[]>(m_thread_count);
+    for (unsigned worker = 0U; worker != thread_count; ++worker) {
+      spawn(worker);
+    }
+    m_supervisor = std::thread{[this]() {
+      supervise();
+    }};
+  }
+
+  /// \brief Starts a worker in a free slot, a retired worker of the slot is joined first
+  void spawn(std::size_t worker)
+  {
+    if (m_threads[worker].joinable()) {
+      m_threads[worker].join();
+    }
+
+    m_workers[worker].is_running.store(true, std::memory_order_relaxed);
+    m_live.fetch_add(1U, std::memory_order_relaxed);
+    try {
+      m_threads[worker] = std::thread{[this, index = static_cast<unsigned>(worker)]() {
+        run(*m_partitions.front(), m_idle.front().get(), index);
+      }};
+    } catch (...) {
+      m_live.fetch_sub(1U, std::memory_order_relaxed);
+      m_workers[worker].is_running.store(false, std::memory_order_relaxed);
+      throw;
+    }
+    set_affinity(m_threads[worker], m_placement[worker]);
+  }
+
+  /// \brief Retires the calling worker unless the pool is at its minimum thread count
+  bool retire() noexcept
+  {
+    auto live = m_live.load(std::memory_order_relaxed);
+    while (live > m_elastic.min_threads) {
+      if (m_live.compare_exchange_weak(live, live - 1U, std::memory_order_relaxed)) {
+        return true;
       }
-    } while (task.has_value());
+    }
+    return false;
+  }
+
+  /// \brief Adds a worker when the scheduled tasks are stalled or the queues are too deep
+  void supervise() noexcept
+  {
+    auto& scheduler = *m_partitions.front();
+    auto last_started = started();
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (!m_condition.wait_for(lock, m_elastic.queue_age, [this]() {
+      return m_is_stopping;
+    })) {
+      auto const now_started = started();
+      auto const queued = scheduler.size();
+      auto const live = m_live.load(std::memory_order_relaxed);
+
+      auto const is_stalled = 0U != queued && now_started == last_started;
+      auto const is_deep = queued > m_elastic.queue_depth * std::max(1U, live);
+      last_started = now_started;
+
+      if ((is_stalled || is_deep) && live < m_thread_count) {
+        grow();
+      }
+    }
+  }
+
+  void grow() noexcept
+  {
+    for (std::size_t worker = 0U; worker != m_threads.size(); ++worker) {
+      if (!m_workers[worker].is_running.load(std::memory_order_acquire)) {
+        try {
+          spawn(worker);
+        } catch (...) {
+          // The pool keeps running with the workers it has, the next period tries again.
+        }
+        return;
+      }
+    }
+  }
+
+  std::uint64_t started() const noexcept
+  {
+    std::uint64_t count{0U};
+    for (unsigned worker = 0U; worker != m_thread_count; ++worker) {
+      count += m_workers[worker].started.load(std::memory_order_relaxed);
+    }
+    return count;
   }
 
   void join() noexcept
   {
-    m_scheduler.clear();
+    if (m_supervisor.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_is_stopping = true;
+      }
+      m_condition.notify_all();
+      m_supervisor.join();
+    }
+
+    for (auto& partition : m_partitions) {
+      partition->clear();
+    }
+
+    for (auto& idle : m_idle) {
+      idle->stop();
+    }
 
     for (auto& thread : m_threads) {
       if (thread.joinable()) {
@@ -90,9 +382,28 @@ private:
     }
   }
 
+  std::size_t local_partition() const noexcept
+  {
+    if (1U == m_partitions.size()) {
+      return 0U;
+    }
+    return std::min(current_node(m_topology).value_or(0U), m_partitions.size() - 1U);
+  }
+
   unsigned const m_thread_count;
+  cpu_topology const m_topology;
+  std::vector<std::vector<unsigned>> const m_placement;
   std::vector<std::thread> m_threads;
-  Scheduler m_scheduler;
+  std::vector<std::unique_ptr<Scheduler>> m_partitions;
+  std::vector<std::unique_ptr<idle_workers>> m_idle;
+
+  elastic_options const m_elastic;
+  std::unique_ptr<worker_state[]> m_workers;
+  std::atomic_uint m_live;
+  std::thread m_supervisor;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_is_stopping;
 };
 
 }  // namespace jar::concurrency
@@ -0,0 +1,409 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file timer.hpp
+///
+
+#ifndef JAR_CONCURRENCY_TIMER_HPP
+#define JAR_CONCURRENCY_TIMER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <jar/concurrency/details/block_pool.hpp>
+#include <jar/concurrency/stop_token.hpp>
+#include <jar/concurrency/type_traits.hpp>
+#include <jar/concurrency/unique_task.hpp>
+
+namespace jar::concurrency {
+
+/// \brief A timer service backed by a hierarchical timing wheel
+///
+/// The wheel has six levels of 64 slots, a timer is placed on the level where its expiry tick first differs from the
+/// current tick and is cascaded down level by level as the time advances. Every level keeps a bitmap of its occupied
+/// slots, so the timer thread sleeps until the next occupied slot instead of waking up on every tick. Scheduling and
+/// cancelling a timer are constant time operations.
+///
+/// The timer tasks are run by the timer thread and must not block or throw, heavier work should be handed over to a
+/// scheduler, e.g. with the schedule_at() and schedule_after() senders.
+class timer {
+public:
+  using clock = std::chrono::steady_clock;
+  using task_type = unique_task;
+
+  /// \brief Handle to a scheduled timer
+  struct handle {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+  /// \brief Constructor, starts the timer thread
+  ///
+  /// \param[in]  resolution  Tick length, timers expire at the first tick at or after their deadline
+  ///
+  /// \throw  std::invalid_argument if the resolution is not positive
+  explicit timer(clock::duration resolution = std::chrono::milliseconds{1});
+
+  timer(timer const&) = delete;
+  timer(timer&&) = delete;
+  timer& operator=(timer const&) = delete;
+  timer& operator=(timer&&) = delete;
+
+  /// \brief Destructor, stops the timer thread, pending timers are dropped
+  ~timer();
+
+  /// \brief Schedules a task to run at the deadline
+  handle schedule_at(clock::time_point deadline, task_type&& task);
+
+  /// \brief Schedules a task to run after the delay
+  handle schedule_after(clock::duration delay, task_type&& task);
+
+  /// \brief Schedules a task to run every period, the first run is one period from now
+  ///
+  /// Deadlines are advanced by the period from the previous deadline, so the runs do not drift.
+  ///
+  /// \throw  std::invalid_argument if the period is shorter than the resolution
+  handle schedule_every(clock::duration period, task_type&& task);
+
+  /// \brief Cancels a timer
+  ///
+  /// \return True if the timer was pending or periodic, false if it already ran or was cancelled
+  bool cancel(handle timer_handle) noexcept;
+
+  /// \brief Gets the number of pending timers
+  std::size_t size() const;
+
+private:
+  inline static constexpr unsigned s_level_bits{6U};
+  inline static constexpr std::size_t s_slot_count{std::size_t{1U} << s_level_bits};
+  inline static constexpr std::size_t s_level_count{6U};
+  inline static constexpr std::uint64_t s_max_ticks{(std::uint64_t{1U} << (s_level_bits * s_level_count)) - 1U};
+  inline static constexpr std::uint32_t s_nil{~std::uint32_t{0U}};
+
+  enum class node_state : std::uint8_t { free, pending, running, cancelled };
+
+  struct node {
+    task_type task;
+    std::uint64_t tick{0U};
+    std::uint64_t period{0U};
+    std::uint32_t prev{s_nil};
+    std::uint32_t next{s_nil};
+    std::uint32_t generation{0U};
+    std::uint8_t level{0U};
+    std::uint8_t slot{0U};
+    node_state state{node_state::free};
+  };
+
+  struct level {
+    std::uint64_t occupied{0U};
+    std::array<std::uint32_t, s_slot_count> heads{};
+  };
+
+  struct expiration {
+    std::size_t level;
+    std::size_t slot;
+    std::uint64_t tick;
+  };
+
+  void run() noexcept;
+
+  handle add(std::uint64_t tick, std::uint64_t period, task_type&& task);
+
+  std::uint32_t allocate();
+
+  void release(std::uint32_t index) noexcept;
+
+  void link(std::uint32_t index) noexcept;
+
+  void unlink(std::uint32_t index) noexcept;
+
+  std::optional<expiration> next_expiration() const noexcept;
+
+  void expire(std::uint64_t tick, std::vector<std::uint32_t>& expired);
+
+  std::uint64_t tick_of(clock::time_point time_point) const noexcept;
+
+  clock::time_point time_of(std::uint64_t tick) const noexcept;
+
+  clock::duration const m_resolution;
+  clock::time_point const m_start;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::vector<node> m_nodes;
+  std::vector<std::uint32_t> m_free;
+  std::array<level, s_level_count> m_levels;
+  std::uint64_t m_current;
+  std::uint64_t m_wakeup;
+  std::size_t m_size;
+  bool m_is_stopping;
+  std::thread m_thread;
+};
+
+namespace details {
+
+/// \brief Completes a receiver on the scheduler, unless it has been canceled meanwhile
+template <typename Receiver, typename Scheduler> void complete_on(Scheduler& scheduler, Receiver&& receiver)
+{
+  scheduler.schedule([receiver = std::move(receiver)]() mutable {
+    if (receiver.is_canceled()) {
+      receiver.cancel();
+      return;
+    }
+
+    try {
+      receiver.complete();
+    } catch (...) {
+      receiver.fail(std::current_exception());
+    }
+  });
+}
+
+/// \brief The block shared by an armed timer and the stop callback of its receiver
+///
+/// Allocated from the block pool when the receiver can be stopped. The deadline and a stop request race to claim the
+/// receiver: the deadline hops to the scheduler, a stop request cancels the timer and the receiver right away instead
+/// of holding them until the deadline. The countdown keeps the block alive for the arming thread, the timer task and
+/// the claim; the stop callback is deregistered when the block is destroyed.
+template <typename Receiver, typename Scheduler> class timer_block {
+  struct on_stop {
+    void operator()() const noexcept { block->stop(); }
+
+    timer_block* block;
+  };
+
+  /// \brief The reference of the timer task, arrives when the task is destroyed, whether it ran or not
+  class task_reference {
+  public:
+    explicit task_reference(timer_block* block) noexcept
+      : m_block{block}
+    {
+    }
+
+    task_reference(task_reference const&) = delete;
+    task_reference(task_reference&& other) noexcept
+      : m_block{std::exchange(other.m_block, nullptr)}
+    {
+    }
+
+    task_reference& operator=(task_reference const&) = delete;
+    task_reference& operator=(task_reference&&) = delete;
+
+    ~task_reference()
+    {
+      if (nullptr != m_block) {
+        m_block->drop();
+      }
+    }
+
+    timer_block* operator->() const noexcept { return m_block; }
+
+  private:
+    timer_block* m_block;
+  };
+
+public:
+  static timer_block* create(Receiver&& receiver, Scheduler&& scheduler, timer& timer_service)
+  {
+    auto* block = state_pool<timer_block>::allocate();
+    try {
+      return ::new (block) timer_block{std::move(receiver), std::move(scheduler), timer_service};
+    } catch (...) {
+      state_pool<timer_block>::deallocate(block);
+      throw;
+    }
+  }
+
+  /// \brief Schedules the timer and registers the stop callback, consumes the reference of the arming thread
+  void arm(timer::clock::time_point deadline)
+  {
+    // The token is taken first, the receiver is moved out by the timer thread once the timer expires.
+    auto const token = get_stop_token(m_receiver);
+    try {
+      m_handle = m_timer->schedule_at(deadline, [reference = task_reference{this}]() mutable {
+        reference->expire();
+      });
+    } catch (...) {
+      arrive();
+      throw;
+    }
+
+    // A stop that has been requested already runs the callback right here.
+    m_on_stop.emplace(token, on_stop{this});
+    arrive();
+  }
+
+private:
+  timer_block(Receiver&& receiver, Scheduler&& scheduler, timer& timer_service)
+    : m_pending{3U}
+    , m_is_claimed{false}
+    , m_receiver{std::move(receiver)}
+    , m_scheduler{std::move(scheduler)}
+    , m_timer{&timer_service}
+    , m_handle{}
+    , m_on_stop{}
+  {
+  }
+
+  bool claim() noexcept { return !m_is_claimed.exchange(true, std::memory_order_acq_rel); }
+
+  /// \brief Runs on the timer thread at the deadline
+  void expire()
+  {
+    if (claim()) {
+      if (m_receiver.is_canceled()) {
+        m_receiver.cancel();
+      } else {
+        complete_on(m_scheduler, std::move(m_receiver));
+      }
+      arrive();
+    }
+  }
+
+  /// \brief Runs on the thread that requests stop
+  void stop() noexcept
+  {
+    if (claim()) {
+      m_receiver.cancel();
+      static_cast<void>(m_timer->cancel(m_handle));
+      arrive();
+    }
+  }
+
+  /// \brief Runs when the timer task is destroyed, a task that never ran leaves the receiver to the block destructor
+  void drop() noexcept
+  {
+    if (claim()) {
+      arrive();
+    }
+    arrive();
+  }
+
+  void arrive() noexcept
+  {
+    if (1U != m_pending.fetch_sub(1U, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    this->~timer_block();
+    state_pool<timer_block>::deallocate(this);
+  }
+
+  std::atomic<std::uint32_t> m_pending;
+  std::atomic_bool m_is_claimed;
+  Receiver m_receiver;
+  Scheduler m_scheduler;
+  timer* const m_timer;
+  timer::handle m_handle;
+  std::optional<stop_callback<on_stop>> m_on_stop;
+};
+
+template <typename Receiver, typename Scheduler> class timer_state {
+public:
+  timer_state(Receiver&& receiver, Scheduler&& scheduler, timer& timer_service, timer::clock::time_point deadline)
+    : m_receiver{std::move(receiver)}
+    , m_scheduler{std::move(scheduler)}
+    , m_timer{&timer_service}
+    , m_deadline{deadline}
+  {
+  }
+
+  /// \brief Arms the timer, work that is canceled before the deadline does not hop to the scheduler
+  ///
+  /// A receiver that can be stopped gets a stop callback, which cancels the timer and the receiver as soon as stop is
+  /// requested.
+  void start()
+  {
+    if (m_receiver.is_canceled()) {
+      m_receiver.cancel();
+      return;
+    }
+
+    if (get_stop_token(m_receiver).stop_possible()) {
+      timer_block<Receiver, Scheduler>::create(std::move(m_receiver), std::move(m_scheduler), *m_timer)
+          ->arm(m_deadline);
+      return;
+    }
+
+    auto* const timer_service = m_timer;
+    auto const deadline = m_deadline;
+    timer_service->schedule_at(deadline, [state = std::move(*this)]() mutable {
+      if (state.m_receiver.is_canceled()) {
+        state.m_receiver.cancel();
+        return;
+      }
+
+      complete_on(state.m_scheduler, std::move(state.m_receiver));
+    });
+  }
+
+private:
+  Receiver m_receiver;
+  Scheduler m_scheduler;
+  timer* m_timer;
+  timer::clock::time_point m_deadline;
+};
+
+template <typename Scheduler> class timer_sender {
+public:
+  using result_type = void;
+
+  timer_sender(Scheduler&& scheduler, timer& timer_service, timer::clock::time_point deadline) noexcept
+    : m_scheduler{std::move(scheduler)}
+    , m_timer{&timer_service}
+    , m_deadline{deadline}
+  {
+  }
+
+  template <typename Receiver> auto connect(Receiver&& receiver)
+  {
+    return timer_state<Receiver, Scheduler>{std::forward<Receiver>(receiver), std::move(m_scheduler), *m_timer,
+                                            m_deadline};
+  }
+
+private:
+  Scheduler m_scheduler;
+  timer* m_timer;
+  timer::clock::time_point m_deadline;
+};
+
+}  // namespace details
+
+/// \brief Gets a sender that completes on the scheduler at the deadline
+template <typename Scheduler>
+auto schedule_at(timer& timer_service, Scheduler scheduler, timer::clock::time_point deadline) noexcept
+{
+  static_assert(is_output_scheduler<Scheduler>::value, "scheduler must fulfill output Scheduler type requirements");
+  return details::timer_sender<Scheduler>{std::move(scheduler), timer_service, deadline};
+}
+
+/// \brief Gets a sender that completes on the scheduler after the delay
+template <typename Scheduler>
+auto schedule_after(timer& timer_service, Scheduler scheduler, timer::clock::duration delay) noexcept
+{
+  return schedule_at(timer_service, std::move(scheduler), timer::clock::now() + delay);
+}
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_TIMER_HPP
@@ -19,6 +19,7 @@
 #define JAR_CONCURRENCY_SCHEDULER_TYPE_TRAITS_HPP
 
 #include <functional>
+#include <system_error>
 #include <tuple>
 #include <type_traits>
 
@@ -88,6 +89,57 @@ struct has_scheduler_adapter<Scheduler, std::void_t<decltype(std::declval<Schedu
   : std::true_type {
 };
 
+class idle_workers;
+
+template <typename Scheduler, typename = void> struct is_idle_scheduler : std::false_type {
+};
+
+template <typename Scheduler>
+struct is_idle_scheduler<
+    Scheduler, std::void_t<decltype(std::declval<Scheduler>().try_scheduled()),
+                           decltype(std::declval<Scheduler>().set_idle_workers(std::declval<idle_workers*>()))>>
+  : std::true_type {
+};
+
+template <typename Scheduler, typename = void> struct is_elastic_scheduler : std::false_type {
+};
+
+template <typename Scheduler>
+struct is_elastic_scheduler<Scheduler, std::void_t<decltype(std::declval<Scheduler const>().size())>>
+  : is_idle_scheduler<Scheduler> {
+};
+
+template <typename Scheduler, typename = void> struct has_worker_attach : std::false_type {
+};
+
+template <typename Scheduler>
+struct has_worker_attach<Scheduler, std::void_t<decltype(std::declval<Scheduler&>().attach(0U))>> : std::true_type {
+};
+
+template <typename Scheduler, typename = void> struct has_concurrency : std::false_type {
+};
+
+template <typename Scheduler>
+struct has_concurrency<Scheduler, std::void_t<decltype(std::declval<Scheduler const>().concurrency())>>
+  : std::true_type {
+};
+
+template <typename Receiver, typename = void> struct has_stop_token : std::false_type {
+};
+
+template <typename Receiver>
+struct has_stop_token<Receiver, std::void_t<decltype(std::declval<Receiver const>().get_stop_token())>>
+  : std::true_type {
+};
+
+template <typename Receiver, typename = void> struct has_set_error : std::false_type {
+};
+
+template <typename Receiver>
+struct has_set_error<Receiver, std::void_t<decltype(std::declval<Receiver&>().set_error(std::error_code{}))>>
+  : std::true_type {
+};
+
 template <typename T, typename = void> struct has_future : std::false_type {
 };
 
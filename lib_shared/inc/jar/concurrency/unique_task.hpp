@@ -0,0 +1,162 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file unique_task.hpp
+///
+
+#ifndef JAR_CONCURRENCY_UNIQUE_TASK_HPP
+#define JAR_CONCURRENCY_UNIQUE_TASK_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace jar::concurrency {
+
+/// \brief A move-only task with an inline small buffer
+///
+/// Works like std::function<void(void)>, but does not require the callable to be copyable and stores callables that fit
+/// into the buffer in place, so scheduling a small closure does not allocate. Larger callables, and callables that may
+/// throw when moved, are stored on the heap.
+///
+/// \tparam BufferSize  Size of the inline buffer in bytes
+template <std::size_t BufferSize = 64U> class basic_unique_task {
+  static_assert(BufferSize >= sizeof(void*), "BufferSize must be able to hold a pointer");
+
+  struct operations {
+    void (*invoke)(void* storage);
+    void (*move)(void* from, void* to) noexcept;
+    void (*destroy)(void* storage) noexcept;
+  };
+
+  template <typename F> struct inline_model {
+    static F* get(void* storage) noexcept { return std::launder(static_cast<F*>(storage)); }
+
+    static void invoke(void* storage) { std::invoke(*get(storage)); }
+
+    static void move(void* from, void* to) noexcept
+    {
+      ::new (to) F(std::move(*get(from)));
+      get(from)->~F();
+    }
+
+    static void destroy(void* storage) noexcept { get(storage)->~F(); }
+
+    inline static constexpr operations s_operations{&invoke, &move, &destroy};
+  };
+
+  template <typename F> struct heap_model {
+    static F*& get(void* storage) noexcept { return *std::launder(static_cast<F**>(storage)); }
+
+    static void invoke(void* storage) { std::invoke(*get(storage)); }
+
+    static void move(void* from, void* to) noexcept { ::new (to) F*(get(from)); }
+
+    static void destroy(void* storage) noexcept { delete get(storage); }
+
+    inline static constexpr operations s_operations{&invoke, &move, &destroy};
+  };
+
+public:
+  /// \brief Tells whether a callable of type F is stored in the inline buffer
+  template <typename F>
+  inline static constexpr bool is_inline = sizeof(F) <= BufferSize && alignof(std::max_align_t) % alignof(F) == 0U
+                                           && std::is_nothrow_move_constructible_v<F>;
+
+  basic_unique_task() noexcept
+    : m_operations{nullptr}
+  {
+  }
+
+  basic_unique_task(std::nullptr_t) noexcept
+    : m_operations{nullptr}
+  {
+  }
+
+  template <typename F, typename Callable = std::decay_t<F>,
+            std::enable_if_t<!std::is_same_v<Callable, basic_unique_task> && std::is_invocable_v<Callable&>, bool>
+            = true>
+  basic_unique_task(F&& callable)
+    : m_operations{nullptr}
+  {
+    if constexpr (is_inline<Callable>) {
+      ::new (static_cast<void*>(m_storage)) Callable(std::forward<F>(callable));
+      m_operations = &inline_model<Callable>::s_operations;
+    } else {
+      ::new (static_cast<void*>(m_storage)) Callable*(new Callable(std::forward<F>(callable)));
+      m_operations = &heap_model<Callable>::s_operations;
+    }
+  }
+
+  basic_unique_task(basic_unique_task&& other) noexcept
+    : m_operations{other.m_operations}
+  {
+    if (nullptr != m_operations) {
+      m_operations->move(other.m_storage, m_storage);
+      other.m_operations = nullptr;
+    }
+  }
+
+  basic_unique_task& operator=(basic_unique_task&& other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      if (nullptr != other.m_operations) {
+        other.m_operations->move(other.m_storage, m_storage);
+        m_operations = other.m_operations;
+        other.m_operations = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  basic_unique_task(basic_unique_task const&) = delete;
+  basic_unique_task& operator=(basic_unique_task const&) = delete;
+
+  ~basic_unique_task() { reset(); }
+
+  /// \brief Invokes the stored callable
+  ///
+  /// \throw  std::bad_function_call if the task is empty
+  void operator()()
+  {
+    if (nullptr == m_operations) {
+      throw std::bad_function_call{};
+    }
+    m_operations->invoke(m_storage);
+  }
+
+  explicit operator bool() const noexcept { return nullptr != m_operations; }
+
+private:
+  void reset() noexcept
+  {
+    if (nullptr != m_operations) {
+      m_operations->destroy(m_storage);
+      m_operations = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char m_storage[BufferSize];
+  operations const* m_operations;
+};
+
+/// \brief Type alias for the task type used by the schedulers
+using unique_task = basic_unique_task<>;
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_UNIQUE_TASK_HPP
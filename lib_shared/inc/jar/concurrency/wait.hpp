@@ -21,14 +21,17 @@
 #include <utility>
 
 #include <jar/concurrency/details/value_receiver.hpp>
+#include <jar/concurrency/stop_token.hpp>
 
 namespace jar::concurrency {
 
-template <typename Sender> auto wait(Sender&& sender)
+/// \brief Starts the sender and gets a future of its result, a stop request through the token cancels the work that
+///        has not run yet
+template <typename Sender> auto wait(Sender&& sender, stop_token token)
 {
   using value_type = typename Sender::result_type;
 
-  details::value_receiver<value_type> receiver;
+  details::value_receiver<value_type> receiver{std::move(token)};
   auto future = receiver.get_future();
 
   auto state = sender.connect(std::move(receiver));
@@ -37,6 +40,8 @@ template <typename Sender> auto wait(Sender&& sender)
   return future;
 }
 
+template <typename Sender> auto wait(Sender&& sender) { return wait(std::forward<Sender>(sender), stop_token{}); }
+
 }  // namespace jar::concurrency
 
 #endif  // JAR_CONCURRENCY_WAIT_HPP
@@ -0,0 +1,217 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file when_all.hpp
+///
+
+#ifndef JAR_CONCURRENCY_WHEN_ALL_HPP
+#define JAR_CONCURRENCY_WHEN_ALL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <system_error>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <jar/concurrency/details/block_pool.hpp>
+#include <jar/concurrency/details/error_channel.hpp>
+#include <jar/concurrency/details/when_receiver.hpp>
+#include <jar/concurrency/stop_token.hpp>
+
+namespace jar::concurrency {
+namespace details {
+
+/// \brief The block shared by the children of when_all
+///
+/// Allocated once per operation from the block pool. Every child arrives exactly once by decrementing a single atomic
+/// countdown, the last one to arrive signals the receiver and destroys the block. The first child that fails or is
+/// canceled decides the outcome and requests stop for the other children.
+template <typename Receiver, typename... Results> class when_all_block {
+  enum outcome : std::uint32_t { outcome_none, outcome_failed, outcome_canceled };
+
+public:
+  using result_type = std::tuple<non_void_t<Results>...>;
+
+  static when_all_block* create(Receiver&& receiver)
+  {
+    auto* block = state_pool<when_all_block>::allocate();
+    try {
+      return ::new (block) when_all_block{std::move(receiver)};
+    } catch (...) {
+      state_pool<when_all_block>::deallocate(block);
+      throw;
+    }
+  }
+
+  template <std::size_t Index, typename... Values> void complete(Values&&... values)
+  {
+    std::get<Index>(m_results).emplace(std::forward<Values>(values)...);
+    arrive();
+  }
+
+  void fail(std::exception_ptr e) noexcept { fail_with(e); }
+
+  void set_error(std::error_code error) noexcept { fail_with(error); }
+
+  void cancel() noexcept
+  {
+    if (settle(outcome_canceled)) {
+      m_stop.request_stop();
+    }
+    arrive();
+  }
+
+  bool is_canceled() noexcept
+  {
+    return outcome_none != m_outcome.load(std::memory_order_acquire) || m_receiver.is_canceled();
+  }
+
+  stop_token get_stop_token() const noexcept { return m_stop.get_token(); }
+
+private:
+  explicit when_all_block(Receiver&& receiver)
+    : m_pending{sizeof...(Results)}
+    , m_outcome{outcome_none}
+    , m_error{}
+    , m_results{}
+    , m_receiver{std::move(receiver)}
+    , m_stop{details::get_stop_token(m_receiver)}
+  {
+  }
+
+  template <typename Error> void fail_with(Error error) noexcept
+  {
+    if (settle(outcome_failed)) {
+      m_error.store(error);
+      // The deciding child has not arrived yet, so the block outlives the stop callbacks of the others.
+      m_stop.request_stop();
+    }
+    arrive();
+  }
+
+  bool settle(outcome value) noexcept
+  {
+    auto expected = outcome_none;
+    return m_outcome.compare_exchange_strong(expected, value, std::memory_order_acq_rel, std::memory_order_relaxed);
+  }
+
+  void arrive() noexcept
+  {
+    // The countdown publishes the results and the error of every child to the last one to arrive.
+    if (1U != m_pending.fetch_sub(1U, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    switch (m_outcome.load(std::memory_order_relaxed)) {
+    case outcome_failed:
+      m_error.deliver(m_receiver);
+      break;
+    case outcome_canceled:
+      m_receiver.cancel();
+      break;
+    default:
+      try {
+        std::apply(
+            [this](auto&... results) {
+              m_receiver.complete(result_type{std::move(*results)...});
+            },
+            m_results);
+      } catch (...) {
+        m_receiver.fail(std::current_exception());
+      }
+      break;
+    }
+
+    this->~when_all_block();
+    state_pool<when_all_block>::deallocate(this);
+  }
+
+  std::atomic<std::uint32_t> m_pending;
+  std::atomic<outcome> m_outcome;
+  stored_error m_error;
+  std::tuple<std::optional<non_void_t<Results>>...> m_results;
+  Receiver m_receiver;
+  when_stop_source m_stop;
+};
+
+template <typename Receiver, typename... Senders> class when_all_state {
+  using block_type = when_all_block<Receiver, typename Senders::result_type...>;
+
+public:
+  when_all_state(Receiver&& receiver, std::tuple<Senders...>&& senders)
+    : m_receiver{std::move(receiver)}
+    , m_senders{std::move(senders)}
+  {
+  }
+
+  /// \brief Connects and starts the children, the block may be gone as soon as the last child is started
+  void start() { start(block_type::create(std::move(m_receiver)), std::index_sequence_for<Senders...>{}); }
+
+private:
+  template <std::size_t... Indices> void start(block_type* block, std::index_sequence<Indices...>)
+  {
+    // Every receiver exists before the first child is connected, so a throwing connect cancels the children that
+    // were not started instead of leaving the countdown hanging.
+    std::tuple<when_receiver<block_type, Indices>...> receivers{when_receiver<block_type, Indices>{block}...};
+    std::tuple states{std::get<Indices>(m_senders).connect(std::move(std::get<Indices>(receivers)))...};
+    std::apply(
+        [](auto&... states) {
+          (states.start(), ...);
+        },
+        states);
+  }
+
+  Receiver m_receiver;
+  std::tuple<Senders...> m_senders;
+};
+
+template <typename... Senders> class when_all_sender {
+public:
+  using result_type = std::tuple<non_void_t<typename Senders::result_type>...>;
+
+  explicit when_all_sender(std::tuple<Senders...>&& senders)
+    : m_senders{std::move(senders)}
+  {
+  }
+
+  template <typename Receiver> auto connect(Receiver&& receiver)
+  {
+    return when_all_state<Receiver, Senders...>{std::forward<Receiver>(receiver), std::move(m_senders)};
+  }
+
+private:
+  std::tuple<Senders...> m_senders;
+};
+
+}  // namespace details
+
+/// \brief Creates a sender that completes with the results of all senders once every one of them has completed
+///
+/// The result is a tuple with one element per sender, void results are represented by std::monostate. The first
+/// sender to fail or to be canceled decides the outcome, stop is requested for the senders that have not completed yet.
+template <typename... Senders> auto when_all(Senders&&... senders)
+{
+  static_assert(0U != sizeof...(Senders), "when_all requires at least one sender");
+  return details::when_all_sender<std::decay_t<Senders>...>{
+      std::tuple<std::decay_t<Senders>...>{std::forward<Senders>(senders)...}};
+}
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_WHEN_ALL_HPP
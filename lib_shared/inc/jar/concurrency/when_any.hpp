@@ -0,0 +1,206 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file when_any.hpp
+///
+
+#ifndef JAR_CONCURRENCY_WHEN_ANY_HPP
+#define JAR_CONCURRENCY_WHEN_ANY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <system_error>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <jar/concurrency/details/block_pool.hpp>
+#include <jar/concurrency/details/error_channel.hpp>
+#include <jar/concurrency/details/when_receiver.hpp>
+#include <jar/concurrency/stop_token.hpp>
+
+namespace jar::concurrency {
+namespace details {
+
+/// \brief The result of when_any, the common result of the senders or a variant indexed by the sender
+template <typename First, typename... Rest> struct when_any_result {
+  using type = std::conditional_t<(std::is_same_v<First, Rest> && ...), First,
+                                  std::variant<non_void_t<First>, non_void_t<Rest>...>>;
+};
+
+template <typename... Results> using when_any_result_t = typename when_any_result<Results...>::type;
+
+/// \brief The block shared by the children of when_any
+///
+/// Allocated once per operation from the block pool. The first child to complete with a value requests stop for the
+/// other children and signals the receiver right away. The single atomic countdown only keeps the block
+/// alive until every child has arrived; if no child completed, the last one to arrive fails the receiver with the
+/// first error or cancels it.
+template <typename Receiver, typename... Results> class when_any_block {
+public:
+  using result_type = when_any_result_t<Results...>;
+
+  static when_any_block* create(Receiver&& receiver)
+  {
+    auto* block = state_pool<when_any_block>::allocate();
+    try {
+      return ::new (block) when_any_block{std::move(receiver)};
+    } catch (...) {
+      state_pool<when_any_block>::deallocate(block);
+      throw;
+    }
+  }
+
+  template <std::size_t Index, typename... Values> void complete(Values&&... values)
+  {
+    if (!m_is_done.exchange(true, std::memory_order_acq_rel)) {
+      // This child arrives only after the request, so the block outlives the stop callbacks of the others.
+      m_stop.request_stop();
+      try {
+        if constexpr (std::is_same_v<result_type, std::tuple_element_t<Index, std::tuple<Results...>>>) {
+          m_receiver.complete(std::forward<Values>(values)...);
+        } else {
+          m_receiver.complete(result_type{std::in_place_index<Index>, std::forward<Values>(values)...});
+        }
+      } catch (...) {
+        m_receiver.fail(std::current_exception());
+      }
+    }
+    arrive();
+  }
+
+  void fail(std::exception_ptr e) noexcept { fail_with(e); }
+
+  void set_error(std::error_code error) noexcept { fail_with(error); }
+
+  void cancel() noexcept { arrive(); }
+
+  bool is_canceled() noexcept { return m_is_done.load(std::memory_order_acquire) || m_receiver.is_canceled(); }
+
+  stop_token get_stop_token() const noexcept { return m_stop.get_token(); }
+
+private:
+  explicit when_any_block(Receiver&& receiver)
+    : m_pending{sizeof...(Results)}
+    , m_is_done{false}
+    , m_has_error{false}
+    , m_error{}
+    , m_receiver{std::move(receiver)}
+    , m_stop{details::get_stop_token(m_receiver)}
+  {
+  }
+
+  template <typename Error> void fail_with(Error error) noexcept
+  {
+    if (!m_has_error.exchange(true, std::memory_order_relaxed)) {
+      m_error.store(error);
+    }
+    arrive();
+  }
+
+  void arrive() noexcept
+  {
+    if (1U != m_pending.fetch_sub(1U, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    if (!m_is_done.load(std::memory_order_relaxed)) {
+      if (m_has_error.load(std::memory_order_relaxed)) {
+        m_error.deliver(m_receiver);
+      } else {
+        m_receiver.cancel();
+      }
+    }
+
+    this->~when_any_block();
+    state_pool<when_any_block>::deallocate(this);
+  }
+
+  std::atomic<std::uint32_t> m_pending;
+  std::atomic_bool m_is_done;
+  std::atomic_bool m_has_error;
+  stored_error m_error;
+  Receiver m_receiver;
+  when_stop_source m_stop;
+};
+
+template <typename Receiver, typename... Senders> class when_any_state {
+  using block_type = when_any_block<Receiver, typename Senders::result_type...>;
+
+public:
+  when_any_state(Receiver&& receiver, std::tuple<Senders...>&& senders)
+    : m_receiver{std::move(receiver)}
+    , m_senders{std::move(senders)}
+  {
+  }
+
+  /// \brief Connects and starts the children, the block may be gone as soon as the last child is started
+  void start() { start(block_type::create(std::move(m_receiver)), std::index_sequence_for<Senders...>{}); }
+
+private:
+  template <std::size_t... Indices> void start(block_type* block, std::index_sequence<Indices...>)
+  {
+    std::tuple<when_receiver<block_type, Indices>...> receivers{when_receiver<block_type, Indices>{block}...};
+    std::tuple states{std::get<Indices>(m_senders).connect(std::move(std::get<Indices>(receivers)))...};
+    std::apply(
+        [](auto&... states) {
+          (states.start(), ...);
+        },
+        states);
+  }
+
+  Receiver m_receiver;
+  std::tuple<Senders...> m_senders;
+};
+
+template <typename... Senders> class when_any_sender {
+public:
+  using result_type = when_any_result_t<typename Senders::result_type...>;
+
+  explicit when_any_sender(std::tuple<Senders...>&& senders)
+    : m_senders{std::move(senders)}
+  {
+  }
+
+  template <typename Receiver> auto connect(Receiver&& receiver)
+  {
+    return when_any_state<Receiver, Senders...>{std::forward<Receiver>(receiver), std::move(m_senders)};
+  }
+
+private:
+  std::tuple<Senders...> m_senders;
+};
+
+}  // namespace details
+
+/// \brief Creates a sender that completes with the result of the first sender to complete
+///
+/// The result is the common result of the senders, or a variant indexed by the sender if the results differ (void
+/// results are represented by std::monostate). Stop is requested for the other senders once a result is delivered,
+/// senders that already started running and do not observe stop still run to completion. The operation fails with the
+/// first error only if no sender completed, and is canceled if every sender was canceled.
+template <typename... Senders> auto when_any(Senders&&... senders)
+{
+  static_assert(0U != sizeof...(Senders), "when_any requires at least one sender");
+  return details::when_any_sender<std::decay_t<Senders>...>{
+      std::tuple<std::decay_t<Senders>...>{std::forward<Senders>(senders)...}};
+}
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_WHEN_ANY_HPP
@@ -0,0 +1,141 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file ws_scheduler.hpp
+///
+
+#ifndef JAR_CONCURRENCY_WS_SCHEDULER_HPP
+#define JAR_CONCURRENCY_WS_SCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <jar/concurrency/details/ws_deque.hpp>
+#include <jar/concurrency/idle_workers.hpp>
+#include <jar/concurrency/unique_task.hpp>
+
+namespace jar::concurrency {
+
+/// \brief A work-stealing scheduler
+///
+/// Every worker owns a Chase-Lev deque. Tasks scheduled from a worker thread are pushed to the worker's own deque and
+/// popped in LIFO order, idle workers steal the oldest tasks from the other workers in FIFO order. Tasks scheduled from
+/// any other thread go through a shared injection queue.
+class ws_scheduler {
+  class adapter {
+  public:
+    explicit adapter(ws_scheduler* const schd)
+      : m_scheduler{schd}
+    {
+    }
+
+    template <typename Invocable, typename... Args> void schedule(Invocable&& invocable, Args&&... args)
+    {
+      static_assert(std::is_invocable_v<Invocable, Args...>, "Invocable type must be invocable with args");
+      if constexpr (0U == sizeof...(Args)) {
+        m_scheduler->schedule(std::forward<Invocable>(invocable));
+      } else {
+        // Arguments are decay-copied into the task, like std::thread and std::async do.
+        m_scheduler->schedule([invocable = std::forward<Invocable>(invocable),
+                               args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+          std::apply(
+              [&invocable](auto&... args) {
+                std::invoke(std::move(invocable), std::move(args)...);
+              },
+              args);
+        });
+      }
+    }
+
+    unsigned concurrency() const noexcept { return m_scheduler->concurrency(); }
+
+  private:
+    ws_scheduler* const m_scheduler;
+  };
+
+public:
+  using task_type = unique_task;
+
+  explicit ws_scheduler(unsigned worker_count);
+
+  ws_scheduler(ws_scheduler const&) = delete;
+  ws_scheduler(ws_scheduler&&) = delete;
+  ws_scheduler& operator=(ws_scheduler const&) = delete;
+  ws_scheduler& operator=(ws_scheduler&&) = delete;
+
+  ~ws_scheduler();
+
+  std::optional<task_type> scheduled();
+
+  /// \brief Gets a scheduled task without blocking, empty if no task was found
+  std::optional<task_type> try_scheduled();
+
+  void schedule(task_type&& task);
+
+  /// \brief Gets an approximation of the scheduled task count
+  std::size_t size() const noexcept;
+
+  /// \brief Gets the number of deques, one per worker
+  unsigned concurrency() const noexcept { return static_cast<unsigned>(m_deques.size()); }
+
+  void clear() noexcept;
+
+  /// \brief Makes the calling thread the owner of the deque at the index, a worker that reuses the slot of a retired
+  /// worker takes over its deque
+  void attach(unsigned index) noexcept;
+
+  /// \brief Sets the idle workers that are notified of scheduled tasks, must be set before any task is scheduled
+  void set_idle_workers(idle_workers* workers) noexcept { m_idle_workers = workers; }
+
+  auto get_adapter() noexcept { return adapter{this}; }
+
+private:
+  using task_deque = details::ws_deque<task_type*>;
+
+  inline static constexpr unsigned s_no_worker{~0U};
+
+  unsigned worker_index() noexcept;
+
+  std::optional<task_type> find_task(unsigned index);
+
+  std::optional<task_type> pop_injected();
+
+  void notify() noexcept;
+
+  std::uint64_t const m_id;
+  std::vector<task_deque> m_deques;
+  std::atomic_uint m_worker_index;
+
+  std::mutex m_injection_mutex;
+  std::deque<task_type> m_injection;
+  std::atomic_size_t m_injection_size;
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::atomic_uint64_t m_epoch;
+  std::atomic_uint m_sleepers;
+  std::atomic_bool m_is_cancelled;
+  idle_workers* m_idle_workers;
+};
+
+}  // namespace jar::concurrency
+
+#endif  // JAR_CONCURRENCY_WS_SCHEDULER_HPP
@@ -0,0 +1,135 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file idle_workers.cpp
+///
+#include "jar/concurrency/idle_workers.hpp"
+
+#include <algorithm>
+
+#include <jar/concurrency/details/futex.hpp>
+#include <jar/core/contract.hpp>
+
+namespace jar::concurrency {
+
+idle_workers::idle_workers(idle_strategy const& strategy, unsigned worker_count)
+  : m_spin_count{strategy.spin_count}
+  , m_yield_count{strategy.yield_count}
+  , m_events{}
+  , m_spinning{0U}
+  , m_parked_count{0U}
+  , m_is_stopped{false}
+  , m_parked{}
+{
+  contract::not_zero(worker_count, "worker_count cannot be zero");
+  m_events = std::make_unique<event[]>(worker_count);
+  m_parked.reserve(worker_count);
+}
+
+void idle_workers::notify(std::size_t count) noexcept
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (0U == m_parked_count.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  auto const spinning = m_spinning.load(std::memory_order_relaxed);
+  if (spinning >= count) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  for (auto n = count - spinning; 0U != n && !m_parked.empty(); --n) {
+    unpark(m_parked.back());
+    m_parked.pop_back();
+  }
+  m_parked_count.store(static_cast<unsigned>(m_parked.size()), std::memory_order_relaxed);
+}
+
+void idle_workers::stop() noexcept
+{
+  m_is_stopped.store(true, std::memory_order_seq_cst);
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  for (auto const worker : m_parked) {
+    unpark(worker);
+  }
+  m_parked.clear();
+  m_parked_count.store(0U, std::memory_order_relaxed);
+}
+
+void idle_workers::prepare_park(unsigned worker) noexcept
+{
+  m_events[worker].state.store(s_unset, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_parked.push_back(worker);
+    m_parked_count.store(static_cast<unsigned>(m_parked.size()), std::memory_order_relaxed);
+  }
+  m_spinning.fetch_sub(1U, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void idle_workers::cancel_park(unsigned worker) noexcept
+{
+  // A notifier already picked this worker for a task, hand the wake-up over to another worker.
+  if (!withdraw(worker) && !is_stopped()) {
+    notify();
+  }
+}
+
+bool idle_workers::withdraw(unsigned worker) noexcept
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  auto const found = std::find(m_parked.begin(), m_parked.end(), worker);
+  if (found == m_parked.end()) {
+    return false;
+  }
+
+  m_parked.erase(found);
+  m_parked_count.store(static_cast<unsigned>(m_parked.size()), std::memory_order_relaxed);
+  return true;
+}
+
+bool idle_workers::park(unsigned worker, std::chrono::nanoseconds timeout) noexcept
+{
+  using clock = std::chrono::steady_clock;
+
+  auto& state = m_events[worker].state;
+  if (s_no_timeout == timeout) {
+    while (s_unset == state.load(std::memory_order_acquire)) {
+      details::futex_wait(state, s_unset);
+    }
+    return true;
+  }
+
+  auto const deadline = clock::now() + timeout;
+  while (s_unset == state.load(std::memory_order_acquire)) {
+    auto const now = clock::now();
+    if (now >= deadline) {
+      return false;
+    }
+    details::futex_wait_for(state, s_unset, deadline - now);
+  }
+  return true;
+}
+
+void idle_workers::unpark(unsigned worker) noexcept
+{
+  auto& state = m_events[worker].state;
+  state.store(s_set, std::memory_order_release);
+  details::futex_wake(state);
+}
+
+}  // namespace jar::concurrency
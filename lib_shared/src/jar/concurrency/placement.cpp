@@ -0,0 +1,269 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file placement.cpp
+///
+#include "jar/concurrency/placement.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <jar/core/contract.hpp>
+
+namespace jar::concurrency {
+namespace {
+
+#if defined(__linux__)
+std::vector<unsigned> to_cpus(cpu_set_t const& set)
+{
+  std::vector<unsigned> cpus;
+  for (unsigned cpu = 0U; cpu != CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+cpu_set_t to_cpu_set(std::vector<unsigned> const& cpus) noexcept
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto const cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return set;
+}
+
+void set_affinity(pthread_t thread, std::vector<unsigned> const& cpus)
+{
+  auto const set = to_cpu_set(cpus);
+  auto const result = ::pthread_setaffinity_np(thread, sizeof(set), &set);
+  if (0 != result) {
+    throw std::system_error{result, std::system_category()};
+  }
+}
+#endif
+
+}  // namespace
+
+std::vector<unsigned> parse_cpu_list(std::string const& list)
+{
+  auto const is_space = [](char c) { return 0 != std::isspace(static_cast<unsigned char>(c)); };
+
+  std::vector<unsigned> cpus;
+  std::istringstream stream{list};
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), is_space), range.end());
+    if (range.empty()) {
+      continue;
+    }
+
+    auto const dash = range.find('-');
+    try {
+      auto const first = static_cast<unsigned>(std::stoul(range.substr(0U, dash)));
+      auto const last =
+          (std::string::npos == dash) ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1U)));
+      contract::not_greater(first, last, "cpu range must be ascending");
+      for (auto cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (std::logic_error const&) {
+      throw std::invalid_argument{"malformed cpu list"};
+    }
+  }
+  return cpus;
+}
+
+cpu_topology read_cpu_topology(std::string const& root)
+{
+  namespace fs = std::filesystem;
+  auto const is_digit = [](char c) { return 0 != std::isdigit(static_cast<unsigned char>(c)); };
+
+  cpu_topology topology;
+  std::error_code error;
+  for (auto const& entry : fs::directory_iterator{root, error}) {
+    auto const name = entry.path().filename().string();
+    if (name.size() <= 4U || 0 != name.compare(0U, 4U, "node") ||
+        !std::all_of(name.begin() + 4, name.end(), is_digit)) {
+      continue;
+    }
+
+    std::ifstream file{entry.path() / "cpulist"};
+    std::string list;
+    if (file && std::getline(file, list)) {
+      topology.push_back(numa_node{static_cast<unsigned>(std::stoul(name.substr(4U))), parse_cpu_list(list)});
+    }
+  }
+
+  std::sort(topology.begin(), topology.end(), [](auto const& lhs, auto const& rhs) {
+    return lhs.id < rhs.id;
+  });
+  return topology;
+}
+
+std::vector<unsigned> allowed_cpus()
+{
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (0 == ::sched_getaffinity(0, sizeof(set), &set)) {
+    return to_cpus(set);
+  }
+#endif
+
+  std::vector<unsigned> cpus(std::max(1U, std::thread::hardware_concurrency()));
+  for (unsigned cpu = 0U; cpu != cpus.size(); ++cpu) {
+    cpus[cpu] = cpu;
+  }
+  return cpus;
+}
+
+cpu_topology system_topology()
+{
+  auto const allowed = allowed_cpus();
+
+  cpu_topology topology;
+  for (auto& node : read_cpu_topology()) {
+    auto const is_not_allowed = [&allowed](unsigned cpu) {
+      return !std::binary_search(allowed.begin(), allowed.end(), cpu);
+    };
+    node.cpus.erase(std::remove_if(node.cpus.begin(), node.cpus.end(), is_not_allowed), node.cpus.end());
+    if (!node.cpus.empty()) {
+      topology.push_back(std::move(node));
+    }
+  }
+
+  if (topology.empty()) {
+    topology.push_back(numa_node{0U, allowed});
+  }
+  return topology;
+}
+
+std::vector<std::vector<unsigned>> plan_placement(cpu_topology const& topology, placement_policy policy,
+                                                  unsigned worker_count)
+{
+  std::vector<std::vector<unsigned>> placement(worker_count);
+  if (placement_policy::none == policy || topology.empty()) {
+    return placement;
+  }
+
+  if (placement_policy::numa == policy) {
+    for (unsigned worker = 0U; worker != worker_count; ++worker) {
+      placement[worker] = topology[worker % topology.size()].cpus;
+    }
+    return placement;
+  }
+
+  // Order the cores either node after node (compact) or one core of each node in turn (scatter).
+  std::vector<unsigned> order;
+  if (placement_policy::compact == policy) {
+    for (auto const& node : topology) {
+      order.insert(order.end(), node.cpus.begin(), node.cpus.end());
+    }
+  } else {
+    std::size_t widest{0U};
+    for (auto const& node : topology) {
+      widest = std::max(widest, node.cpus.size());
+    }
+    for (std::size_t index = 0U; index != widest; ++index) {
+      for (auto const& node : topology) {
+        if (index < node.cpus.size()) {
+          order.push_back(node.cpus[index]);
+        }
+      }
+    }
+  }
+
+  if (!order.empty()) {
+    for (unsigned worker = 0U; worker != worker_count; ++worker) {
+      placement[worker] = {order[worker % order.size()]};
+    }
+  }
+  return placement;
+}
+
+std::optional<std::size_t> current_node(cpu_topology const& topology) noexcept
+{
+#if defined(__linux__)
+  auto const cpu = ::sched_getcpu();
+  if (cpu >= 0) {
+    for (std::size_t index = 0U; index != topology.size(); ++index) {
+      auto const& cpus = topology[index].cpus;
+      if (std::find(cpus.begin(), cpus.end(), static_cast<unsigned>(cpu)) != cpus.end()) {
+        return index;
+      }
+    }
+  }
+#else
+  static_cast<void>(topology);
+#endif
+  return std::nullopt;
+}
+
+void set_affinity(std::thread& thread, std::vector<unsigned> const& cpus)
+{
+#if defined(__linux__)
+  if (!cpus.empty()) {
+    set_affinity(thread.native_handle(), cpus);
+  }
+#else
+  static_cast<void>(thread);
+  static_cast<void>(cpus);
+#endif
+}
+
+scoped_affinity::scoped_affinity(std::vector<unsigned> const& cpus)
+  : m_previous{}
+{
+#if defined(__linux__)
+  if (!cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    auto const result = ::pthread_getaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (0 != result) {
+      throw std::system_error{result, std::system_category()};
+    }
+    set_affinity(::pthread_self(), cpus);
+    m_previous = to_cpus(set);
+  }
+#else
+  static_cast<void>(cpus);
+#endif
+}
+
+scoped_affinity::~scoped_affinity()
+{
+#if defined(__linux__)
+  if (!m_previous.empty()) {
+    auto const set = to_cpu_set(m_previous);
+    static_cast<void>(::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set));
+  }
+#endif
+}
+
+}  // namespace jar::concurrency
@@ -0,0 +1,177 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file priority_scheduler.cpp
+///
+#include "jar/concurrency/priority_scheduler.hpp"
+
+#include <jar/core/contract.hpp>
+
+namespace jar::concurrency {
+
+priority_scheduler::priority_scheduler(unsigned worker_count, unsigned lane_count,
+                                       std::chrono::microseconds starvation_limit)
+  : m_policy{policy::strict}
+  , m_starvation_limit{starvation_limit}
+  , m_lanes(lane_count)
+  , m_waiters{0U}
+  , m_is_cancelled{false}
+{
+  contract::not_zero(worker_count, "worker_count cannot be zero");
+  contract::not_zero(lane_count, "lane_count cannot be zero");
+}
+
+priority_scheduler::priority_scheduler(unsigned worker_count, std::vector<unsigned> weights)
+  : m_policy{policy::weighted}
+  , m_starvation_limit{clock::duration::max()}
+  , m_lanes(weights.size())
+  , m_waiters{0U}
+  , m_is_cancelled{false}
+{
+  contract::not_zero(worker_count, "worker_count cannot be zero");
+  contract::not_zero(weights.size(), "there must be at least one lane");
+
+  for (std::size_t index = 0U; index != weights.size(); ++index) {
+    contract::not_zero(weights[index], "lane weight cannot be zero");
+    m_lanes[index].weight = weights[index];
+  }
+}
+
+std::optional<priority_scheduler::task_type> priority_scheduler::scheduled()
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  while (!m_is_cancelled) {
+    auto task = pop_locked();
+    if (task.has_value()) {
+      return task;
+    }
+
+    ++m_waiters;
+    m_condition.wait(lock);
+    --m_waiters;
+  }
+
+  return std::nullopt;
+}
+
+void priority_scheduler::schedule(task_type&& task) { schedule(std::move(task), lowest_priority()); }
+
+void priority_scheduler::schedule(task_type&& task, unsigned priority)
+{
+  auto& lane = lane_at(priority);
+  auto const now = clock::now();
+
+  std::size_t waiters{0U};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    lane.tasks.emplace_back(entry{std::move(task), now});
+    waiters = m_waiters;
+  }
+  notify(1U, waiters);
+}
+
+void priority_scheduler::clear() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_is_cancelled = true;
+    for (auto& lane : m_lanes) {
+      lane.tasks.clear();
+    }
+  }
+  m_condition.notify_all();
+}
+
+unsigned priority_scheduler::lane_index(unsigned priority) const
+{
+  contract::not_greater(priority, lowest_priority(), "there is no lane for the priority");
+  return priority;
+}
+
+std::optional<priority_scheduler::task_type> priority_scheduler::pop_locked()
+{
+  auto const index = (policy::strict == m_policy) ? select_strict(clock::now()) : select_weighted();
+  if (!index.has_value()) {
+    return std::nullopt;
+  }
+
+  auto& tasks = m_lanes[index.value()].tasks;
+  std::optional<task_type> task{std::move(tasks.front().task)};
+  tasks.pop_front();
+  return task;
+}
+
+std::optional<std::size_t> priority_scheduler::select_strict(clock::time_point now) noexcept
+{
+  std::optional<std::size_t> highest, starving;
+  for (std::size_t index = 0U; index != m_lanes.size(); ++index) {
+    auto const& tasks = m_lanes[index].tasks;
+    if (tasks.empty()) {
+      continue;
+    }
+
+    if (!highest.has_value()) {
+      highest = index;
+    }
+
+    // The oldest starving task is served first, regardless of its priority.
+    auto const enqueued = tasks.front().enqueued;
+    if (now - enqueued > m_starvation_limit &&
+        (!starving.has_value() || enqueued < m_lanes[starving.value()].tasks.front().enqueued)) {
+      starving = index;
+    }
+  }
+
+  return starving.has_value() ? starving : highest;
+}
+
+std::optional<std::size_t> priority_scheduler::select_weighted() noexcept
+{
+  std::int64_t total{0};
+  std::optional<std::size_t> selected;
+  for (std::size_t index = 0U; index != m_lanes.size(); ++index) {
+    auto& lane = m_lanes[index];
+    if (lane.tasks.empty()) {
+      continue;
+    }
+
+    lane.current += lane.weight;
+    total += lane.weight;
+    if (!selected.has_value() || lane.current > m_lanes[selected.value()].current) {
+      selected = index;
+    }
+  }
+
+  if (selected.has_value()) {
+    m_lanes[selected.value()].current -= total;
+  }
+  return selected;
+}
+
+void priority_scheduler::notify(std::size_t count, std::size_t waiters) noexcept
+{
+  if (0U == waiters || 0U == count) {
+    return;
+  }
+
+  if (count >= waiters) {
+    m_condition.notify_all();
+  } else {
+    for (std::size_t n = 0U; n != count; ++n) {
+      m_condition.notify_one();
+    }
+  }
+}
+
+}  // namespace jar::concurrency
@@ -19,49 +19,119 @@
 #include <jar/core/contract.hpp>
 
 namespace jar::concurrency {
+namespace {
 
-rr_scheduler::rr_scheduler(unsigned queue_count)
-  : m_task_queue{queue_count}
+std::atomic_uint64_t g_scheduler_id{0U};
+
+/// \brief Identity of the scheduler the calling thread pops from, schedulers are told apart by id instead of address
+thread_local std::uint64_t t_owner_id{~std::uint64_t{0U}};
+thread_local unsigned t_owner_index{0U};
+
+}  // namespace
+
+template <typename Queue, typename Stats>
+basic_rr_scheduler<Queue, Stats>::basic_rr_scheduler(unsigned queue_count)
+  : m_id{g_scheduler_id.fetch_add(1U, std::memory_order_relaxed)}
+  , m_task_queue{queue_count}
   , m_push_index{0U}
   , m_pop_index{0U}
+  , m_idle_workers{nullptr}
+  , m_stats{queue_count}
 {
   contract::not_zero(queue_count, "queue_count cannot be zero");
 }
 
-std::optional<rr_scheduler::task_type> rr_scheduler::scheduled()
+template <typename Queue, typename Stats>
+std::optional<typename basic_rr_scheduler<Queue, Stats>::task_type> basic_rr_scheduler<Queue, Stats>::scheduled()
 {
-  static thread_local unsigned const thread_index{m_pop_index.fetch_add(1U, std::memory_order_relaxed)};
+  auto const index = thread_index();
+  m_stats.attach(index);
 
   std::optional<task_type> task;
   for (unsigned n = 0U; n != m_task_queue.size(); ++n) {
-    task = m_task_queue[(thread_index + n) % m_task_queue.size()].try_pop();
+    task = m_task_queue[(index + n) % m_task_queue.size()].try_pop();
     if (task.has_value()) {
+      m_stats.on_pop(0U != n);
       return task;
     }
   }
 
-  return m_task_queue[thread_index % m_task_queue.size()].pop();
+  task = m_task_queue[index % m_task_queue.size()].pop();
+  if (task.has_value()) {
+    m_stats.on_pop(false);
+  }
+  return task;
+}
+
+template <typename Queue, typename Stats>
+std::optional<typename basic_rr_scheduler<Queue, Stats>::task_type> basic_rr_scheduler<Queue, Stats>::try_scheduled()
+{
+  auto const index = thread_index();
+  m_stats.attach(index);
+
+  for (unsigned n = 0U; n != m_task_queue.size(); ++n) {
+    auto task = m_task_queue[(index + n) % m_task_queue.size()].poll();
+    if (task.has_value()) {
+      m_stats.on_pop(0U != n);
+      return task;
+    }
+  }
+  return std::nullopt;
 }
 
-void rr_scheduler::clear() noexcept
+template <typename Queue, typename Stats> std::size_t basic_rr_scheduler<Queue, Stats>::size() const
+{
+  std::size_t count{0U};
+  for (auto const& queue : m_task_queue) {
+    count += queue.size();
+  }
+  return count;
+}
+
+template <typename Queue, typename Stats> void basic_rr_scheduler<Queue, Stats>::clear() noexcept
 {
   for (auto& queue : m_task_queue) {
     queue.clear();
   }
 }
 
-void rr_scheduler::schedule(task_type&& task)
+template <typename Queue, typename Stats> void basic_rr_scheduler<Queue, Stats>::push(task_type&& task)
 {
   const std::size_t try_n_times{m_task_queue.size() * 4U};
 
+  // The task is moved from only by the try_push that succeeds, so retrying does not copy it.
   auto index = m_push_index.fetch_add(1U, std::memory_order_relaxed);
   for (unsigned n = 0U; n != try_n_times; ++n) {
-    if (m_task_queue[(index + n) % m_task_queue.size()].try_push(task)) {
+    if (m_task_queue[(index + n) % m_task_queue.size()].try_push(std::move(task))) {
+      m_stats.on_schedule(false);
+      notify_idle();
       return;
     }
   }
 
-  m_task_queue[index % m_task_queue.size()].push(std::forward<task_type>(task));
+  m_task_queue[index % m_task_queue.size()].push(std::move(task));
+  m_stats.on_schedule(true);
+  notify_idle();
+}
+
+template <typename Queue, typename Stats> void basic_rr_scheduler<Queue, Stats>::attach(unsigned index) noexcept
+{
+  t_owner_id = m_id;
+  t_owner_index = index;
+}
+
+template <typename Queue, typename Stats> unsigned basic_rr_scheduler<Queue, Stats>::thread_index() noexcept
+{
+  if (t_owner_id != m_id) {
+    t_owner_id = m_id;
+    t_owner_index = m_pop_index.fetch_add(1U, std::memory_order_relaxed);
+  }
+  return t_owner_index;
 }
 
+template class basic_rr_scheduler<queue<unique_task>>;
+template class basic_rr_scheduler<ring_queue<unique_task>>;
+template class basic_rr_scheduler<queue<unique_task>, scheduler_stats>;
+template class basic_rr_scheduler<ring_queue<unique_task>, scheduler_stats>;
+
 }  // namespace jar::concurrency
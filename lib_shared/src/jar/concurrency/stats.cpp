@@ -0,0 +1,199 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file stats.cpp
+///
+#include "jar/concurrency/stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <jar/core/contract.hpp>
+
+namespace jar::concurrency {
+namespace {
+
+std::atomic_uint64_t g_stats_id{0U};
+
+/// \brief Identity of the statistics the calling thread is attached to, told apart by id instead of address
+thread_local std::uint64_t t_stats_id{~std::uint64_t{0U}};
+thread_local unsigned t_stats_slot{0U};
+
+/// \brief Gets the index of the highest set bit, value must not be zero
+unsigned highest_bit(std::uint64_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return 63U - static_cast<unsigned>(__builtin_clzll(value));
+#else
+  unsigned bit{0U};
+  while (0U != (value >>= 1U)) {
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+void add(latency_histogram& histogram, scheduler_stats::clock::duration duration) noexcept
+{
+  histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+}
+
+}  // namespace
+
+void latency_histogram::record(std::chrono::nanoseconds duration) noexcept
+{
+  auto const nanoseconds = duration.count();
+  auto const bucket = nanoseconds > 0 ? highest_bit(static_cast<std::uint64_t>(nanoseconds)) : 0U;
+  m_buckets[std::min<std::size_t>(bucket, s_bucket_count - 1U)].fetch_add(1U, std::memory_order_relaxed);
+}
+
+latency_histogram::buckets_type latency_histogram::snapshot() const noexcept
+{
+  buckets_type buckets{};
+  for (std::size_t n = 0U; n != s_bucket_count; ++n) {
+    buckets[n] = m_buckets[n].load(std::memory_order_relaxed);
+  }
+  return buckets;
+}
+
+std::uint64_t latency_snapshot::count() const noexcept
+{
+  std::uint64_t count{0U};
+  for (auto const bucket : buckets) {
+    count += bucket;
+  }
+  return count;
+}
+
+std::chrono::nanoseconds latency_snapshot::percentile(double fraction) const noexcept
+{
+  auto const total = count();
+  if (0U == total) {
+    return std::chrono::nanoseconds::zero();
+  }
+
+  auto const rank = std::max<std::uint64_t>(1U, static_cast<std::uint64_t>(std::ceil(fraction * total)));
+  std::uint64_t seen{0U};
+  std::size_t bucket{0U};
+  for (; bucket != buckets.size() - 1U; ++bucket) {
+    seen += buckets[bucket];
+    if (seen >= rank) {
+      break;
+    }
+  }
+  return std::chrono::nanoseconds{std::int64_t{1} << (bucket + 1U)};
+}
+
+latency_snapshot& latency_snapshot::operator+=(latency_snapshot const& other) noexcept
+{
+  for (std::size_t n = 0U; n != buckets.size(); ++n) {
+    buckets[n] += other.buckets[n];
+  }
+  return *this;
+}
+
+worker_snapshot& worker_snapshot::operator+=(worker_snapshot const& other) noexcept
+{
+  scheduled += other.scheduled;
+  push_fallbacks += other.push_fallbacks;
+  local_pops += other.local_pops;
+  foreign_pops += other.foreign_pops;
+  queue_wait += other.queue_wait;
+  run_time += other.run_time;
+  return *this;
+}
+
+worker_snapshot stats_snapshot::total() const noexcept
+{
+  auto sum = external;
+  for (auto const& worker : workers) {
+    sum += worker;
+  }
+  return sum;
+}
+
+scheduler_stats::scheduler_stats(unsigned worker_count)
+  : m_id{g_stats_id.fetch_add(1U, std::memory_order_relaxed)}
+  , m_worker_count{worker_count}
+  , m_slots{}
+{
+  contract::not_zero(worker_count, "worker_count cannot be zero");
+  m_slots = std::make_unique<slot[]>(worker_count + s_stripe_count);
+}
+
+void scheduler_stats::attach(unsigned worker) noexcept
+{
+  t_stats_id = m_id;
+  t_stats_slot = worker % m_worker_count;
+}
+
+void scheduler_stats::on_schedule(bool is_fallback, std::size_t count) noexcept
+{
+  auto& counters = local();
+  counters.scheduled.fetch_add(count, std::memory_order_relaxed);
+  if (is_fallback) {
+    counters.push_fallbacks.fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+void scheduler_stats::on_pop(bool is_foreign) noexcept
+{
+  auto& counters = local();
+  (is_foreign ? counters.foreign_pops : counters.local_pops).fetch_add(1U, std::memory_order_relaxed);
+}
+
+void scheduler_stats::on_run(clock::duration queue_wait, clock::duration run_time) noexcept
+{
+  auto& counters = local();
+  add(counters.queue_wait, queue_wait);
+  add(counters.run_time, run_time);
+}
+
+stats_snapshot scheduler_stats::snapshot() const
+{
+  stats_snapshot snapshot;
+  snapshot.workers.reserve(m_worker_count);
+  for (unsigned n = 0U; n != m_worker_count; ++n) {
+    snapshot.workers.push_back(m_slots[n].snapshot());
+  }
+  for (unsigned n = 0U; n != s_stripe_count; ++n) {
+    snapshot.external += m_slots[m_worker_count + n].snapshot();
+  }
+  return snapshot;
+}
+
+worker_snapshot scheduler_stats::slot::snapshot() const noexcept
+{
+  worker_snapshot snapshot;
+  snapshot.scheduled = scheduled.load(std::memory_order_relaxed);
+  snapshot.push_fallbacks = push_fallbacks.load(std::memory_order_relaxed);
+  snapshot.local_pops = local_pops.load(std::memory_order_relaxed);
+  snapshot.foreign_pops = foreign_pops.load(std::memory_order_relaxed);
+  snapshot.queue_wait.buckets = queue_wait.snapshot();
+  snapshot.run_time.buckets = run_time.snapshot();
+  return snapshot;
+}
+
+scheduler_stats::slot& scheduler_stats::local() noexcept
+{
+  if (t_stats_id == m_id) {
+    return m_slots[t_stats_slot];
+  }
+
+  static thread_local std::size_t const stripe{std::hash<std::thread::id>{}(std::this_thread::get_id())};
+  return m_slots[m_worker_count + stripe % s_stripe_count];
+}
+
+}  // namespace jar::concurrency
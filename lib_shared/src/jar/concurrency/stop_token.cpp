@@ -0,0 +1,124 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file stop_token.cpp
+///
+#include "jar/concurrency/stop_token.hpp"
+
+#include <new>
+
+#include <jar/concurrency/details/block_pool.hpp>
+
+namespace jar::concurrency::details {
+
+stop_state::stop_state() noexcept
+  : m_references{1U}
+  , m_is_requested{false}
+  , m_mutex{}
+  , m_callbacks{nullptr}
+  , m_running{nullptr}
+  , m_requester{}
+{
+}
+
+stop_state* stop_state::create() { return ::new (state_pool<stop_state>::allocate()) stop_state{}; }
+
+void stop_state::release() noexcept
+{
+  if (1U == m_references.fetch_sub(1U, std::memory_order_acq_rel)) {
+    this->~stop_state();
+    state_pool<stop_state>::deallocate(this);
+  }
+}
+
+bool stop_state::request_stop() noexcept
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  if (m_is_requested.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  m_is_requested.store(true, std::memory_order_release);
+  m_requester = std::this_thread::get_id();
+
+  while (nullptr != m_callbacks) {
+    auto* const callback = m_callbacks;
+    m_callbacks = callback->m_next;
+    if (nullptr != m_callbacks) {
+      m_callbacks->m_previous = nullptr;
+    }
+    callback->m_is_registered = false;
+    m_running = callback;
+
+    // The callback may deregister other callbacks, or itself, so it runs without the lock.
+    lock.unlock();
+    callback->execute();
+    lock.lock();
+
+    if (m_running == callback) {
+      callback->m_is_executed.store(true, std::memory_order_release);
+    }
+    m_running = nullptr;
+  }
+  return true;
+}
+
+bool stop_state::add(stop_callback_base* callback)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (m_is_requested.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
+  callback->m_next = m_callbacks;
+  callback->m_previous = nullptr;
+  if (nullptr != m_callbacks) {
+    m_callbacks->m_previous = callback;
+  }
+  m_callbacks = callback;
+  callback->m_is_registered = true;
+  return true;
+}
+
+void stop_state::remove(stop_callback_base* callback) noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (callback->m_is_registered) {
+      if (nullptr != callback->m_previous) {
+        callback->m_previous->m_next = callback->m_next;
+      } else {
+        m_callbacks = callback->m_next;
+      }
+      if (nullptr != callback->m_next) {
+        callback->m_next->m_previous = callback->m_previous;
+      }
+      callback->m_is_registered = false;
+      return;
+    }
+
+    if (m_running != callback || m_requester == std::this_thread::get_id()) {
+      // Already executed, or deregistered from within its own execution.
+      if (m_running == callback) {
+        m_running = nullptr;
+      }
+      return;
+    }
+  }
+
+  while (!callback->m_is_executed.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace jar::concurrency::details
@@ -0,0 +1,369 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file timer.cpp
+///
+#include "jar/concurrency/timer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <jar/core/contract.hpp>
+
+namespace jar::concurrency {
+namespace {
+
+/// \brief Gets the index of the highest set bit, value must not be zero
+unsigned highest_bit(std::uint64_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return 63U - static_cast<unsigned>(__builtin_clzll(value));
+#else
+  unsigned bit{0U};
+  while (0U != (value >>= 1U)) {
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+/// \brief Gets the index of the lowest set bit, value must not be zero
+unsigned lowest_bit(std::uint64_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+  unsigned bit{0U};
+  while (0U == (value & 1U)) {
+    value >>= 1U;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+std::uint64_t rotate_right(std::uint64_t value, unsigned shift) noexcept
+{
+  return (value >> shift) | (value << ((64U - shift) & 63U));
+}
+
+}  // namespace
+
+timer::timer(clock::duration resolution)
+  : m_resolution{resolution}
+  , m_start{clock::now()}
+  , m_nodes{}
+  , m_free{}
+  , m_levels{}
+  , m_current{0U}
+  , m_wakeup{0U}
+  , m_size{0U}
+  , m_is_stopping{false}
+  , m_thread{}
+{
+  contract::not_less(resolution.count(), clock::rep{1}, "resolution must be positive");
+  for (auto& level : m_levels) {
+    level.heads.fill(s_nil);
+  }
+  m_thread = std::thread{[this]() {
+    run();
+  }};
+}
+
+timer::~timer()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_is_stopping = true;
+  }
+  m_condition.notify_one();
+  m_thread.join();
+}
+
+timer::handle timer::schedule_at(clock::time_point deadline, task_type&& task)
+{
+  return add(tick_of(deadline), 0U, std::move(task));
+}
+
+timer::handle timer::schedule_after(clock::duration delay, task_type&& task)
+{
+  return schedule_at(clock::now() + delay, std::move(task));
+}
+
+timer::handle timer::schedule_every(clock::duration period, task_type&& task)
+{
+  auto const ticks = period / m_resolution;
+  contract::not_less(ticks, decltype(ticks){1}, "period must not be shorter than the resolution");
+  return add(tick_of(clock::now() + period), static_cast<std::uint64_t>(ticks), std::move(task));
+}
+
+bool timer::cancel(handle timer_handle) noexcept
+{
+  // Declared before the lock so that the cancelled task is destroyed only after the lock has been released.
+  task_type cancelled_task;
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (timer_handle.index >= m_nodes.size() || m_nodes[timer_handle.index].generation != timer_handle.generation) {
+    return false;
+  }
+
+  auto& cancelled = m_nodes[timer_handle.index];
+  switch (cancelled.state) {
+  case node_state::pending:
+    cancelled_task = std::move(cancelled.task);
+    unlink(timer_handle.index);
+    release(timer_handle.index);
+    --m_size;
+    return true;
+  case node_state::running:
+    // The task is running right now, only the following runs of a periodic timer can be cancelled.
+    if (0U != cancelled.period) {
+      cancelled.state = node_state::cancelled;
+      return true;
+    }
+    return false;
+  default:
+    return false;
+  }
+}
+
+std::size_t timer::size() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_size;
+}
+
+void timer::run() noexcept
+{
+  std::vector<std::uint32_t> expired;
+  std::vector<std::uint64_t> periods;
+  std::vector<task_type> tasks;
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+  while (!m_is_stopping) {
+    expire(clock::now() < m_start ? 0U : static_cast<std::uint64_t>((clock::now() - m_start) / m_resolution), expired);
+
+    if (!expired.empty()) {
+      for (auto const index : expired) {
+        periods.push_back(m_nodes[index].period);
+        tasks.emplace_back(std::move(m_nodes[index].task));
+      }
+
+      // Captures are destroyed without the lock held, their destructors may schedule or cancel timers.
+      lock.unlock();
+      for (std::size_t n = 0U; n != tasks.size(); ++n) {
+        tasks[n]();
+        if (0U == periods[n]) {
+          tasks[n] = task_type{};
+        }
+      }
+      lock.lock();
+
+      bool has_cancelled{false};
+      for (std::size_t n = 0U; n != expired.size(); ++n) {
+        auto& expired_node = m_nodes[expired[n]];
+        if (node_state::running == expired_node.state && 0U != expired_node.period) {
+          expired_node.task = std::move(tasks[n]);
+          expired_node.tick = std::max(expired_node.tick + expired_node.period, m_current);
+          expired_node.state = node_state::pending;
+          link(expired[n]);
+          ++m_size;
+        } else {
+          has_cancelled = has_cancelled || 0U != periods[n];
+          release(expired[n]);
+        }
+      }
+      expired.clear();
+      periods.clear();
+      if (has_cancelled) {
+        lock.unlock();
+        tasks.clear();
+        lock.lock();
+      } else {
+        tasks.clear();
+      }
+      continue;
+    }
+
+    // Timers scheduled while the thread sleeps wake it up only if they expire before the planned wake-up.
+    auto const next = next_expiration();
+    if (next.has_value()) {
+      m_wakeup = next->tick;
+      m_condition.wait_until(lock, time_of(next->tick));
+    } else {
+      m_wakeup = std::numeric_limits<std::uint64_t>::max();
+      m_condition.wait(lock);
+    }
+    m_wakeup = 0U;
+  }
+}
+
+timer::handle timer::add(std::uint64_t tick, std::uint64_t period, task_type&& task)
+{
+  bool is_earlier{false};
+  handle added{};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    added.index = allocate();
+
+    auto& added_node = m_nodes[added.index];
+    added_node.task = std::move(task);
+    added_node.tick = std::max(tick, m_current);
+    added_node.period = period;
+    added_node.state = node_state::pending;
+    added.generation = added_node.generation;
+
+    link(added.index);
+    ++m_size;
+    is_earlier = added_node.tick < m_wakeup;
+  }
+
+  if (is_earlier) {
+    m_condition.notify_one();
+  }
+  return added;
+}
+
+std::uint32_t timer::allocate()
+{
+  if (!m_free.empty()) {
+    auto const index = m_free.back();
+    m_free.pop_back();
+    return index;
+  }
+
+  contract::not_greater(m_nodes.size(), std::size_t{s_nil - 1U}, "too many timers");
+  m_nodes.emplace_back();
+  return static_cast<std::uint32_t>(m_nodes.size() - 1U);
+}
+
+void timer::release(std::uint32_t index) noexcept
+{
+  auto& released = m_nodes[index];
+  released.task = task_type{};
+  released.state = node_state::free;
+  ++released.generation;
+  m_free.push_back(index);
+}
+
+void timer::link(std::uint32_t index) noexcept
+{
+  auto& linked = m_nodes[index];
+
+  // The top level wraps around, every slot but the current one stands for a future range. Timers beyond the last of
+  // them are parked there and cascaded again when it is reached.
+  auto const top_slot_range = std::uint64_t{1U} << (s_level_bits * (s_level_count - 1U));
+  auto const placed = std::min(linked.tick, (m_current & ~(top_slot_range - 1U)) + s_max_ticks);
+  auto const level_index =
+      std::min<std::size_t>(highest_bit((placed ^ m_current) | (s_slot_count - 1U)) / s_level_bits, s_level_count - 1U);
+  auto const slot = (placed >> (level_index * s_level_bits)) & (s_slot_count - 1U);
+
+  auto& placed_level = m_levels[level_index];
+  linked.level = static_cast<std::uint8_t>(level_index);
+  linked.slot = static_cast<std::uint8_t>(slot);
+  linked.prev = s_nil;
+  linked.next = placed_level.heads[slot];
+  if (s_nil != linked.next) {
+    m_nodes[linked.next].prev = index;
+  }
+  placed_level.heads[slot] = index;
+  placed_level.occupied |= std::uint64_t{1U} << slot;
+}
+
+void timer::unlink(std::uint32_t index) noexcept
+{
+  auto& unlinked = m_nodes[index];
+  auto& placed_level = m_levels[unlinked.level];
+
+  if (s_nil != unlinked.next) {
+    m_nodes[unlinked.next].prev = unlinked.prev;
+  }
+  if (s_nil != unlinked.prev) {
+    m_nodes[unlinked.prev].next = unlinked.next;
+  } else {
+    placed_level.heads[unlinked.slot] = unlinked.next;
+    if (s_nil == unlinked.next) {
+      placed_level.occupied &= ~(std::uint64_t{1U} << unlinked.slot);
+    }
+  }
+  unlinked.prev = s_nil;
+  unlinked.next = s_nil;
+}
+
+std::optional<timer::expiration> timer::next_expiration() const noexcept
+{
+  // Every timer on a level expires before the timers on the levels above it, so the lowest occupied level wins.
+  for (std::size_t level_index = 0U; level_index != s_level_count; ++level_index) {
+    auto const occupied = m_levels[level_index].occupied;
+    if (0U == occupied) {
+      continue;
+    }
+
+    auto const shift = static_cast<unsigned>(level_index * s_level_bits);
+    auto const current_slot = static_cast<unsigned>((m_current >> shift) & (s_slot_count - 1U));
+    auto const slot = (current_slot + lowest_bit(rotate_right(occupied, current_slot))) & (s_slot_count - 1U);
+
+    auto const slot_range = std::uint64_t{1U} << shift;
+    auto const level_range = slot_range << s_level_bits;
+    auto tick = (m_current & ~(level_range - 1U)) + slot * slot_range;
+    if (slot < current_slot) {
+      tick += level_range;
+    }
+    return expiration{level_index, slot, std::max(tick, m_current)};
+  }
+  return std::nullopt;
+}
+
+void timer::expire(std::uint64_t tick, std::vector<std::uint32_t>& expired)
+{
+  for (auto next = next_expiration(); next.has_value() && next->tick <= tick; next = next_expiration()) {
+    m_current = next->tick;
+
+    auto& expired_level = m_levels[next->level];
+    auto index = expired_level.heads[next->slot];
+    expired_level.heads[next->slot] = s_nil;
+    expired_level.occupied &= ~(std::uint64_t{1U} << next->slot);
+
+    while (s_nil != index) {
+      auto& expired_node = m_nodes[index];
+      auto const following = expired_node.next;
+      expired_node.prev = s_nil;
+      expired_node.next = s_nil;
+
+      if (expired_node.tick <= m_current) {
+        expired_node.state = node_state::running;
+        expired.push_back(index);
+        --m_size;
+      } else {
+        link(index);
+      }
+      index = following;
+    }
+  }
+  m_current = std::max(m_current, tick);
+}
+
+std::uint64_t timer::tick_of(clock::time_point time_point) const noexcept
+{
+  if (time_point <= m_start) {
+    return 0U;
+  }
+  return static_cast<std::uint64_t>((time_point - m_start + m_resolution - clock::duration{1}) / m_resolution);
+}
+
+timer::clock::time_point timer::time_of(std::uint64_t tick) const noexcept
+{
+  return m_start + static_cast<clock::rep>(tick) * m_resolution;
+}
+
+}  // namespace jar::concurrency
@@ -0,0 +1,32 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file wait_helper.cpp
+///
+#include "jar/concurrency/details/wait_helper.hpp"
+
+#include <utility>
+
+namespace jar::concurrency::details {
+namespace {
+
+thread_local wait_helper* t_wait_helper{nullptr};
+
+}  // namespace
+
+wait_helper* wait_helper::current() noexcept { return t_wait_helper; }
+
+wait_helper* wait_helper::install(wait_helper* helper) noexcept { return std::exchange(t_wait_helper, helper); }
+
+}  // namespace jar::concurrency::details
@@ -0,0 +1,221 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file ws_scheduler.cpp
+///
+#include "jar/concurrency/ws_scheduler.hpp"
+
+#include <memory>
+
+#include <jar/concurrency/details/block_pool.hpp>
+#include <jar/core/contract.hpp>
+
+namespace jar::concurrency {
+namespace {
+
+std::atomic_uint64_t g_scheduler_id{0U};
+
+/// \brief Identity of the scheduler that owns the calling thread, schedulers are told apart by id instead of address
+thread_local std::uint64_t t_owner_id{~std::uint64_t{0U}};
+thread_local unsigned t_owner_index{~0U};
+
+using task_type = ws_scheduler::task_type;
+
+/// \brief Destroys a deque task and returns its block to the free list of the calling thread
+struct pooled_task_delete {
+  void operator()(task_type* task) const noexcept
+  {
+    std::destroy_at(task);
+    details::state_pool<task_type>::deallocate(task);
+  }
+};
+
+/// \brief A task on a deque, allocated from the block pool so that a worker that pops its own tasks does not go
+/// through the global allocator
+using pooled_task = std::unique_ptr<task_type, pooled_task_delete>;
+
+pooled_task make_pooled_task(task_type&& task)
+{
+  return pooled_task{::new (details::state_pool<task_type>::allocate()) task_type{std::move(task)}};
+}
+
+}  // namespace
+
+ws_scheduler::ws_scheduler(unsigned worker_count)
+  : m_id{g_scheduler_id.fetch_add(1U, std::memory_order_relaxed)}
+  , m_deques{worker_count}
+  , m_worker_index{0U}
+  , m_injection{}
+  , m_injection_size{0U}
+  , m_epoch{0U}
+  , m_sleepers{0U}
+  , m_is_cancelled{false}
+  , m_idle_workers{nullptr}
+{
+  contract::not_zero(worker_count, "worker_count cannot be zero");
+}
+
+ws_scheduler::~ws_scheduler()
+{
+  for (auto& deque : m_deques) {
+    for (auto task = deque.steal(); task.has_value(); task = deque.steal()) {
+      pooled_task{task.value()};
+    }
+  }
+}
+
+std::optional<ws_scheduler::task_type> ws_scheduler::scheduled()
+{
+  auto const index = worker_index();
+
+  while (!m_is_cancelled.load(std::memory_order_acquire)) {
+    auto const epoch = m_epoch.load(std::memory_order_seq_cst);
+
+    auto task = find_task(index);
+    if (task.has_value()) {
+      return task;
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_sleepers.fetch_add(1U, std::memory_order_seq_cst);
+    m_condition.wait(lock, [this, epoch]() {
+      return epoch != m_epoch.load(std::memory_order_seq_cst) || m_is_cancelled.load(std::memory_order_relaxed);
+    });
+    m_sleepers.fetch_sub(1U, std::memory_order_relaxed);
+  }
+
+  return std::nullopt;
+}
+
+std::optional<ws_scheduler::task_type> ws_scheduler::try_scheduled()
+{
+  if (m_is_cancelled.load(std::memory_order_acquire)) {
+    return std::nullopt;
+  }
+  return find_task(worker_index());
+}
+
+void ws_scheduler::schedule(task_type&& task)
+{
+  if (t_owner_id == m_id && t_owner_index != s_no_worker) {
+    auto local = make_pooled_task(std::move(task));
+    m_deques[t_owner_index].push(local.get());
+    static_cast<void>(local.release());
+  } else {
+    std::lock_guard<std::mutex> lock{m_injection_mutex};
+    m_injection.emplace_back(std::move(task));
+    m_injection_size.fetch_add(1U, std::memory_order_release);
+  }
+
+  notify();
+}
+
+std::size_t ws_scheduler::size() const noexcept
+{
+  auto count = m_injection_size.load(std::memory_order_relaxed);
+  for (auto const& deque : m_deques) {
+    count += deque.size();
+  }
+  return count;
+}
+
+void ws_scheduler::clear() noexcept
+{
+  m_is_cancelled.store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+  }
+  m_condition.notify_all();
+
+  std::lock_guard<std::mutex> lock{m_injection_mutex};
+  m_injection.clear();
+  m_injection_size.store(0U, std::memory_order_relaxed);
+}
+
+void ws_scheduler::attach(unsigned index) noexcept
+{
+  t_owner_id = m_id;
+  t_owner_index = index < m_deques.size() ? index : s_no_worker;
+}
+
+unsigned ws_scheduler::worker_index() noexcept
+{
+  if (t_owner_id != m_id) {
+    auto const index = m_worker_index.fetch_add(1U, std::memory_order_relaxed);
+    t_owner_id = m_id;
+    t_owner_index = index < m_deques.size() ? index : s_no_worker;
+  }
+  return t_owner_index;
+}
+
+std::optional<ws_scheduler::task_type> ws_scheduler::find_task(unsigned index)
+{
+  std::optional<task_type*> task;
+  if (index != s_no_worker) {
+    task = m_deques[index].pop();
+  }
+
+  if (!task.has_value()) {
+    auto injected = pop_injected();
+    if (injected.has_value()) {
+      return injected;
+    }
+
+    auto const start = (index == s_no_worker) ? 0U : index + 1U;
+    for (std::size_t n = 0U; n != m_deques.size() && !task.has_value(); ++n) {
+      task = m_deques[(start + n) % m_deques.size()].steal();
+    }
+  }
+
+  if (!task.has_value()) {
+    return std::nullopt;
+  }
+
+  pooled_task owned{task.value()};
+  return std::optional<task_type>{std::move(*owned)};
+}
+
+std::optional<ws_scheduler::task_type> ws_scheduler::pop_injected()
+{
+  if (0U == m_injection_size.load(std::memory_order_acquire)) {
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lock{m_injection_mutex};
+  if (m_injection.empty()) {
+    return std::nullopt;
+  }
+
+  std::optional<task_type> task{std::move(m_injection.front())};
+  m_injection.pop_front();
+  m_injection_size.fetch_sub(1U, std::memory_order_relaxed);
+  return task;
+}
+
+void ws_scheduler::notify() noexcept
+{
+  m_epoch.fetch_add(1U, std::memory_order_seq_cst);
+  if (0U != m_sleepers.load(std::memory_order_seq_cst)) {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+    }
+    m_condition.notify_one();
+  }
+
+  if (nullptr != m_idle_workers) {
+    m_idle_workers->notify();
+  }
+}
+
+}  // namespace jar::concurrency
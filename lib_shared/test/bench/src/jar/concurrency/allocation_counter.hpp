@@ -0,0 +1,43 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file allocation_counter.hpp
+///
+#ifndef JAR_CONCURRENCY_ALLOCATION_COUNTER_HPP
+#define JAR_CONCURRENCY_ALLOCATION_COUNTER_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+namespace jar::concurrency::bench {
+
+/// \brief Gets the number of global operator new calls made by the process so far
+///
+/// The benchmark executable replaces the global allocation functions to count the calls.
+std::size_t allocation_count() noexcept;
+
+/// \brief Adds the average number of allocations per iteration as "Allocations" counter
+///
+/// \param[in|out]  state       Benchmark state
+/// \param[in]      since       Allocation count at the start of the benchmark
+inline void report_allocations(::benchmark::State& state, std::size_t since)
+{
+  auto const allocations = static_cast<double>(allocation_count() - since);
+  state.counters["Allocations"] = ::benchmark::Counter(allocations, ::benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace jar::concurrency::bench
+
+#endif  // JAR_CONCURRENCY_ALLOCATION_COUNTER_HPP
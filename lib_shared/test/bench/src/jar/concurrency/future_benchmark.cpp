@@ -0,0 +1,217 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file future_benchmark.cpp
+///
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <jar/concurrency/future.hpp>
+#include <jar/concurrency/schedule.hpp>
+#include <jar/concurrency/then.hpp>
+#include <jar/concurrency/wait.hpp>
+#include <jar/concurrency/when_all.hpp>
+
+#include "allocation_counter.hpp"
+#include "latency.hpp"
+
+namespace jar::concurrency::bench {
+
+using clock = std::chrono::steady_clock;
+
+/// \brief A scheduler that runs the tasks right away on the calling thread
+struct inline_scheduler {
+  template <typename Invocable> void schedule(Invocable&& invocable)
+  {
+    std::invoke(std::forward<Invocable>(invocable));
+  }
+};
+
+/// \brief A benchmark case for setting and getting a value without a waiting thread
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per promise
+///   - size of the shared state in bytes
+void future_ready_get(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    promise<int> promise;
+    auto future = promise.get_future();
+    promise.set_value(1);
+    ::benchmark::DoNotOptimize(future.get());
+  }
+
+  report_allocations(state, allocations);
+  state.counters["state_bytes"] = static_cast<double>(sizeof(details::shared_state<int>));
+}
+
+/// \brief A benchmark case for a continuation attached before the promise is fulfilled
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per continuation
+void future_then(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    promise<int> promise;
+    auto next = promise.get_future().then([](int value) {
+      return value + 1;
+    });
+    promise.set_value(1);
+    ::benchmark::DoNotOptimize(next.get());
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for waiting on a sender that completes right away
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per wait
+void future_wait_sender(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    auto future = wait(then(schedule(inline_scheduler{}), []() {
+      return 1;
+    }));
+    ::benchmark::DoNotOptimize(future.get());
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for joining four senders that complete right away
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per join
+void future_when_all(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    auto sender = [](int value) {
+      return then(schedule(inline_scheduler{}), [value]() {
+        return value;
+      });
+    };
+    auto future = wait(when_all(sender(1), sender(2), sender(3), sender(4)));
+    ::benchmark::DoNotOptimize(future.get());
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for an error reported as an exception, which get() rethrows
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per error
+void future_error_exception(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+  auto const error = std::make_error_code(std::errc::connection_reset);
+
+  for (auto _ : state) {
+    promise<int> promise;
+    auto future = promise.get_future();
+    promise.set_exception(std::make_exception_ptr(std::system_error{error}));
+    try {
+      ::benchmark::DoNotOptimize(future.get());
+    } catch (std::system_error const& e) {
+      ::benchmark::DoNotOptimize(e.code());
+    }
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for an error reported as an error code, which get() returns in the result
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per error
+void future_error_code(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+  auto const error = std::make_error_code(std::errc::connection_reset);
+
+  for (auto _ : state) {
+    promise<int> promise;
+    auto future = promise.get_future();
+    promise.set_error(error);
+    ::benchmark::DoNotOptimize(future.get().error());
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for handing a value from a promise to a thread blocked on the future
+///
+/// A responder thread sets the value as soon as it receives the promise, the latency is measured from setting the
+/// value to the return of get.
+///
+/// This benchmark provides the following counters:
+///   - median and 99th percentile of the handoff latency
+void future_handoff(::benchmark::State& state)
+{
+  std::atomic<promise<clock::rep>*> pending{nullptr};
+  std::atomic_bool is_done{false};
+  std::thread responder{[&pending, &is_done]() {
+    while (!is_done.load(std::memory_order_acquire)) {
+      auto* request = pending.exchange(nullptr, std::memory_order_acq_rel);
+      if (nullptr == request) {
+        std::this_thread::yield();
+        continue;
+      }
+      // Give the requester time to block on the future.
+      std::this_thread::sleep_for(std::chrono::microseconds{20});
+      request->set_value(clock::now().time_since_epoch().count());
+    }
+  }};
+
+  std::vector<double> samples;
+  samples.reserve(static_cast<std::size_t>(state.max_iterations));
+
+  for (auto _ : state) {
+    promise<clock::rep> request;
+    auto future = request.get_future();
+    pending.store(&request, std::memory_order_release);
+    auto const set = clock::time_point{clock::duration{future.get().value()}};
+    samples.push_back(std::chrono::duration<double, std::micro>{clock::now() - set}.count());
+  }
+
+  is_done.store(true, std::memory_order_release);
+  responder.join();
+  report_latency(state, samples);
+}
+
+BENCHMARK(future_ready_get);
+BENCHMARK(future_then);
+BENCHMARK(future_wait_sender);
+BENCHMARK(future_when_all);
+BENCHMARK(future_error_exception);
+BENCHMARK(future_error_code);
+BENCHMARK(future_handoff)->Iterations(5000)->UseRealTime();
+
+}  // namespace jar::concurrency::bench
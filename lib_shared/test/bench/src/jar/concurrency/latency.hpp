@@ -0,0 +1,51 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file latency.hpp
+///
+#ifndef JAR_CONCURRENCY_LATENCY_HPP
+#define JAR_CONCURRENCY_LATENCY_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace jar::concurrency::bench {
+
+/// \brief Gets the percentile of the samples, the samples are sorted in place
+inline double percentile(std::vector<double>& samples, double fraction)
+{
+  std::sort(samples.begin(), samples.end());
+  auto const index = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1U));
+  return samples[index];
+}
+
+/// \brief Adds the median and the 99th percentile of the latency samples as "p50_us" and "p99_us" counters
+///
+/// \param[in|out]  state       Benchmark state
+/// \param[in]      samples     Latency samples in microseconds
+inline void report_latency(::benchmark::State& state, std::vector<double>& samples)
+{
+  if (samples.empty()) {
+    return;
+  }
+  state.counters["p50_us"] = percentile(samples, 0.50);
+  state.counters["p99_us"] = percentile(samples, 0.99);
+}
+
+}  // namespace jar::concurrency::bench
+
+#endif  // JAR_CONCURRENCY_LATENCY_HPP
@@ -0,0 +1,163 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file parallel_for_benchmark.cpp
+///
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <jar/concurrency/parallel_for.hpp>
+#include <jar/concurrency/rr_scheduler.hpp>
+#include <jar/concurrency/thread_pool.hpp>
+
+namespace jar::concurrency::bench {
+namespace {
+
+constexpr std::size_t element_count{1'000'000U};
+
+/// \brief The per-element work of the loops, cheap enough that the loop overhead shows
+double transform(double value) noexcept { return std::sqrt(value) * 0.5 + 1.0; }
+
+std::vector<double> make_input()
+{
+  std::vector<double> input(element_count);
+  for (std::size_t index = 0U; index != input.size(); ++index) {
+    input[index] = static_cast<double>(index);
+  }
+  return input;
+}
+
+void report_elements(::benchmark::State& state)
+{
+  state.counters["Elements"] = ::benchmark::Counter(static_cast<double>(state.iterations() * element_count),
+                                                    ::benchmark::Counter::kIsRate);
+}
+
+}  // namespace
+
+/// \brief A benchmark case for a serial transform and reduce of 1M elements, the baseline of the parallel cases
+///
+/// This benchmark provides the following counters:
+///   - elements per second
+void loop_serial(::benchmark::State& state)
+{
+  auto const input = make_input();
+  std::vector<double> output(input.size());
+
+  for (auto _ : state) {
+    double sum{0.0};
+    for (std::size_t index = 0U; index != input.size(); ++index) {
+      output[index] = transform(input[index]);
+      sum += output[index];
+    }
+    ::benchmark::DoNotOptimize(sum);
+  }
+
+  report_elements(state);
+}
+
+/// \brief A benchmark case for a transform and reduce of 1M elements fanned out with std::async, one task per core
+///
+/// This benchmark provides the following counters:
+///   - elements per second
+void loop_async(::benchmark::State& state)
+{
+  auto const input = make_input();
+  std::vector<double> output(input.size());
+  auto const task_count = std::max(1U, std::thread::hardware_concurrency());
+  auto const chunk = (input.size() + task_count - 1U) / task_count;
+
+  std::vector<std::future<double>> futures;
+  futures.reserve(task_count);
+
+  for (auto _ : state) {
+    futures.clear();
+    for (std::size_t begin = 0U; begin < input.size(); begin += chunk) {
+      auto const end = std::min(begin + chunk, input.size());
+      futures.emplace_back(std::async(std::launch::async, [&input, &output, begin, end]() {
+        double sum{0.0};
+        for (auto index = begin; index != end; ++index) {
+          output[index] = transform(input[index]);
+          sum += output[index];
+        }
+        return sum;
+      }));
+    }
+
+    double sum{0.0};
+    for (auto& future : futures) {
+      sum += future.get();
+    }
+    ::benchmark::DoNotOptimize(sum);
+  }
+
+  report_elements(state);
+}
+
+/// \brief A benchmark case for a transform of 1M elements with parallel_for on a thread pool
+///
+/// This benchmark provides the following counters:
+///   - elements per second
+void loop_parallel_for(::benchmark::State& state)
+{
+  auto const input = make_input();
+  std::vector<double> output(input.size());
+  thread_pool<rr_scheduler> pool;
+
+  for (auto _ : state) {
+    parallel_for(pool.get_scheduler(), input.size(), [&input, &output](std::size_t index) {
+      output[index] = transform(input[index]);
+    });
+    ::benchmark::DoNotOptimize(output.data());
+  }
+
+  report_elements(state);
+}
+
+/// \brief A benchmark case for a transform and reduce of 1M elements with parallel_transform_reduce on a thread pool
+///
+/// This benchmark provides the following counters:
+///   - elements per second
+void loop_parallel_transform_reduce(::benchmark::State& state)
+{
+  auto const input = make_input();
+  thread_pool<rr_scheduler> pool;
+
+  for (auto _ : state) {
+    auto const sum = parallel_transform_reduce(
+        pool.get_scheduler(), input.size(), 0.0,
+        [](double lhs, double rhs) {
+          return lhs + rhs;
+        },
+        [&input](std::size_t index) {
+          return transform(input[index]);
+        });
+    ::benchmark::DoNotOptimize(sum);
+  }
+
+  report_elements(state);
+}
+
+BENCHMARK(loop_serial)->Unit(::benchmark::kMicrosecond);
+BENCHMARK(loop_async)->Unit(::benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(loop_parallel_for)->Unit(::benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(loop_parallel_transform_reduce)->Unit(::benchmark::kMicrosecond)->UseRealTime();
+
+}  // namespace jar::concurrency::bench
@@ -0,0 +1,101 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file priority_scheduler_benchmark.cpp
+///
+#include "latency.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <jar/concurrency/priority_scheduler.hpp>
+#include <jar/concurrency/rr_scheduler.hpp>
+#include <jar/concurrency/thread_pool.hpp>
+
+namespace jar::concurrency::bench {
+
+using clock = std::chrono::steady_clock;
+
+/// \brief Busy-waits for the given duration, stands for a small bulk task
+void spin_for(clock::duration duration) noexcept
+{
+  auto const until = clock::now() + duration;
+  while (clock::now() < until) {
+  }
+}
+
+/// \brief A benchmark case for the queueing delay of a latency-critical task under bulk load
+///
+/// Every iteration floods the pool with bulk tasks and then schedules a probe task, the time from scheduling the
+/// probe until it starts to run is the queueing delay. With priority_scheduler the probe goes to the highest priority
+/// lane, with rr_scheduler it queues behind the bulk tasks.
+///
+/// This benchmark provides the following counters:
+///   - median queueing delay in microseconds
+///   - 99th percentile queueing delay in microseconds
+template <typename Scheduler> void queueing_delay(::benchmark::State& state)
+{
+  static constexpr unsigned worker_count{2U};
+  static constexpr auto bulk_duration = std::chrono::microseconds{1};
+
+  auto const bulk_count = static_cast<unsigned>(state.range(0));
+  thread_pool<Scheduler> pool{worker_count};
+  auto bulk = pool.get_scheduler();
+  auto probe = [&pool]() {
+    if constexpr (std::is_same_v<Scheduler, priority_scheduler>) {
+      return pool.get_scheduler(0U);
+    } else {
+      return pool.get_scheduler();
+    }
+  }();
+
+  std::atomic_uint outstanding{0U};
+  std::vector<double> delays;
+  delays.reserve(static_cast<std::size_t>(state.max_iterations));
+
+  for (auto _ : state) {
+    outstanding.store(bulk_count);
+    for (unsigned n = 0U; n != bulk_count; ++n) {
+      bulk.schedule([&outstanding]() {
+        spin_for(bulk_duration);
+        outstanding.fetch_sub(1U);
+      });
+    }
+
+    std::promise<clock::duration> started;
+    auto delay = started.get_future();
+    auto const scheduled = clock::now();
+    probe.schedule([&started, scheduled]() {
+      started.set_value(clock::now() - scheduled);
+    });
+    delays.push_back(std::chrono::duration<double, std::micro>{delay.get()}.count());
+
+    state.PauseTiming();
+    while (0U != outstanding.load()) {
+      std::this_thread::yield();
+    }
+    state.ResumeTiming();
+  }
+
+  report_latency(state, delays);
+}
+
+BENCHMARK_TEMPLATE(queueing_delay, rr_scheduler)->Arg(64)->Arg(256)->Iterations(500)->UseRealTime();
+BENCHMARK_TEMPLATE(queueing_delay, priority_scheduler)->Arg(64)->Arg(256)->Iterations(500)->UseRealTime();
+
+}  // namespace jar::concurrency::bench
@@ -0,0 +1,109 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file rr_scheduler_benchmark.cpp
+///
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <jar/concurrency/rr_scheduler.hpp>
+
+namespace jar::concurrency::bench {
+
+/// \brief Queue count used by the submission benchmarks, stands for the worker count of a pool
+static constexpr unsigned g_queue_count{4U};
+
+/// \brief Makes a batch of small tasks
+std::vector<unique_task> make_tasks(std::size_t count)
+{
+  std::vector<unique_task> tasks;
+  tasks.reserve(count);
+  for (std::size_t n = 0U; n != count; ++n) {
+    tasks.emplace_back([n]() {
+      ::benchmark::DoNotOptimize(n);
+    });
+  }
+  return tasks;
+}
+
+/// \brief Runs all tasks left in the scheduler
+template <typename Scheduler> void drain(Scheduler& scheduler, std::size_t count)
+{
+  for (std::size_t n = 0U; n != count; ++n) {
+    scheduler.scheduled().value()();
+  }
+}
+
+/// \brief A benchmark case for submitting a batch of tasks one by one
+///
+/// This benchmark provides the following counters:
+///   - tasks per second
+template <typename Scheduler> void schedule_one_by_one(::benchmark::State& state)
+{
+  auto const count = static_cast<std::size_t>(state.range(0));
+  Scheduler scheduler{g_queue_count};
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto tasks = make_tasks(count);
+    state.ResumeTiming();
+
+    for (auto& task : tasks) {
+      scheduler.schedule(std::move(task));
+    }
+
+    state.PauseTiming();
+    drain(scheduler, count);
+    state.ResumeTiming();
+  }
+
+  state.counters["Tasks"] =
+      ::benchmark::Counter(static_cast<double>(state.iterations() * state.range(0)), ::benchmark::Counter::kIsRate);
+}
+
+/// \brief A benchmark case for submitting a batch of tasks with schedule_bulk
+///
+/// This benchmark provides the following counters:
+///   - tasks per second
+template <typename Scheduler> void schedule_bulk(::benchmark::State& state)
+{
+  auto const count = static_cast<std::size_t>(state.range(0));
+  Scheduler scheduler{g_queue_count};
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto tasks = make_tasks(count);
+    state.ResumeTiming();
+
+    scheduler.schedule_bulk(tasks);
+
+    state.PauseTiming();
+    drain(scheduler, count);
+    state.ResumeTiming();
+  }
+
+  state.counters["Tasks"] =
+      ::benchmark::Counter(static_cast<double>(state.iterations() * state.range(0)), ::benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_TEMPLATE(schedule_one_by_one, rr_scheduler)->RangeMultiplier(10)->Range(10, 10'000);
+BENCHMARK_TEMPLATE(schedule_bulk, rr_scheduler)->RangeMultiplier(10)->Range(10, 10'000);
+BENCHMARK_TEMPLATE(schedule_one_by_one, rr_ring_scheduler)->RangeMultiplier(10)->Range(10, 512);
+BENCHMARK_TEMPLATE(schedule_bulk, rr_ring_scheduler)->RangeMultiplier(10)->Range(10, 512);
+BENCHMARK_TEMPLATE(schedule_one_by_one, rr_stats_scheduler)->RangeMultiplier(10)->Range(10, 10'000);
+BENCHMARK_TEMPLATE(schedule_bulk, rr_stats_scheduler)->RangeMultiplier(10)->Range(10, 10'000);
+
+}  // namespace jar::concurrency::bench
@@ -0,0 +1,138 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file then_benchmark.cpp
+///
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <utility>
+
+#include <jar/concurrency/schedule.hpp>
+#include <jar/concurrency/then.hpp>
+#include <jar/concurrency/unique_task.hpp>
+#include <jar/concurrency/wait.hpp>
+
+#include "allocation_counter.hpp"
+
+namespace jar::concurrency::bench {
+
+/// \brief A scheduler that type-erases the task like the thread pool schedulers do and runs it on the calling thread
+struct erasing_scheduler {
+  template <typename Invocable> void schedule(Invocable&& invocable)
+  {
+    unique_task task{std::forward<Invocable>(invocable)};
+    task();
+  }
+};
+
+/// \brief Appends the stages with then(), which fuses them into the first sender_adapter
+template <std::size_t Depth, typename Sender> auto make_fused_chain(Sender&& sender)
+{
+  if constexpr (0U == Depth) {
+    return std::forward<Sender>(sender);
+  } else {
+    return make_fused_chain<Depth - 1U>(then(std::forward<Sender>(sender), [](int value) {
+      return value + 1;
+    }));
+  }
+}
+
+/// \brief Wraps every stage into a sender_adapter of its own, as then() did before the chains were fused
+template <std::size_t Depth, typename Sender> auto make_nested_chain(Sender&& sender)
+{
+  if constexpr (0U == Depth) {
+    return std::forward<Sender>(sender);
+  } else {
+    return make_nested_chain<Depth - 1U>(details::sender_adapter{std::forward<Sender>(sender), [](int value) {
+                                                                   return value + 1;
+                                                                 }});
+  }
+}
+
+/// \brief A benchmark case for a chain of then() stages, the first stage produces the value
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per chain
+template <std::size_t Depth> void then_fused_chain(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    auto future = wait(make_fused_chain<Depth - 1U>(then(schedule(erasing_scheduler{}), []() {
+      return 0;
+    })));
+    ::benchmark::DoNotOptimize(future.get());
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for the same chain without fusion, every stage adds a receiver and a state
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per chain
+template <std::size_t Depth> void then_nested_chain(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    auto future = wait(make_nested_chain<Depth - 1U>(then(schedule(erasing_scheduler{}), []() {
+      return 0;
+    })));
+    ::benchmark::DoNotOptimize(future.get());
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for a single stage that does the work of the whole chain, the baseline for the chains
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per chain
+template <std::size_t Depth> void then_hand_written(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    auto future = wait(then(schedule(erasing_scheduler{}), []() {
+      int value{0};
+      for (std::size_t stage = 1U; stage != Depth; ++stage) {
+        value = value + 1;
+      }
+      return value;
+    }));
+    ::benchmark::DoNotOptimize(future.get());
+  }
+
+  report_allocations(state, allocations);
+}
+
+BENCHMARK_TEMPLATE(then_fused_chain, 1U);
+BENCHMARK_TEMPLATE(then_fused_chain, 2U);
+BENCHMARK_TEMPLATE(then_fused_chain, 4U);
+BENCHMARK_TEMPLATE(then_fused_chain, 8U);
+BENCHMARK_TEMPLATE(then_fused_chain, 16U);
+BENCHMARK_TEMPLATE(then_nested_chain, 1U);
+BENCHMARK_TEMPLATE(then_nested_chain, 2U);
+BENCHMARK_TEMPLATE(then_nested_chain, 4U);
+BENCHMARK_TEMPLATE(then_nested_chain, 8U);
+BENCHMARK_TEMPLATE(then_nested_chain, 16U);
+BENCHMARK_TEMPLATE(then_hand_written, 1U);
+BENCHMARK_TEMPLATE(then_hand_written, 2U);
+BENCHMARK_TEMPLATE(then_hand_written, 4U);
+BENCHMARK_TEMPLATE(then_hand_written, 8U);
+BENCHMARK_TEMPLATE(then_hand_written, 16U);
+
+}  // namespace jar::concurrency::bench
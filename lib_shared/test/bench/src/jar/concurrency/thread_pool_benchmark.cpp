@@ -0,0 +1,131 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file thread_pool_benchmark.cpp
+///
+#include "latency.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <jar/concurrency/idle_workers.hpp>
+#include <jar/concurrency/rr_scheduler.hpp>
+#include <jar/concurrency/thread_pool.hpp>
+
+namespace jar::concurrency::bench {
+
+/// \brief A benchmark case for task throughput of a pool with the given worker placement
+///
+/// Every iteration schedules a batch of small tasks from the benchmark thread and waits until the pool has run them.
+///
+/// This benchmark provides the following counters:
+///   - tasks per second
+void placement_throughput(::benchmark::State& state)
+{
+  static constexpr unsigned task_count{10'000U};
+
+  thread_pool_options const options{std::thread::hardware_concurrency(), static_cast<placement_policy>(state.range(0))};
+  thread_pool<rr_scheduler> pool{options};
+  auto scheduler = pool.get_scheduler();
+
+  std::atomic_uint done{0U};
+  std::vector<unique_task> tasks;
+  tasks.reserve(task_count);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    done.store(0U);
+    tasks.clear();
+    for (unsigned n = 0U; n != task_count; ++n) {
+      tasks.emplace_back([&done]() {
+        done.fetch_add(1U, std::memory_order_relaxed);
+      });
+    }
+    state.ResumeTiming();
+
+    scheduler.schedule_bulk(tasks);
+    while (task_count != done.load(std::memory_order_relaxed)) {
+      std::this_thread::yield();
+    }
+  }
+
+  state.counters["Tasks"] = ::benchmark::Counter(static_cast<double>(state.iterations() * task_count),
+                                                 ::benchmark::Counter::kIsRate);
+}
+
+/// \brief A benchmark configuration comparing unpinned, compact and scatter placement
+BENCHMARK(placement_throughput)
+    ->ArgName("placement")
+    ->Arg(static_cast<int>(placement_policy::none))
+    ->Arg(static_cast<int>(placement_policy::compact))
+    ->Arg(static_cast<int>(placement_policy::scatter))
+    ->UseRealTime();
+
+/// \brief A benchmark case for the wake-to-run time of an idle worker with the given idle strategy
+///
+/// Every iteration leaves the pool idle for a while, so that the workers spin, yield or park depending on the strategy,
+/// and then schedules a task that measures the time from scheduling until it starts to run.
+///
+/// This benchmark provides the following counters:
+///   - median wake-to-run time in microseconds
+///   - 99th percentile wake-to-run time in microseconds
+void wake_latency(::benchmark::State& state)
+{
+  using clock = std::chrono::steady_clock;
+  static constexpr unsigned worker_count{2U};
+
+  idle_strategy const strategy{static_cast<idle_policy>(state.range(0)), static_cast<unsigned>(state.range(1)), 16U};
+  auto const idle_time = std::chrono::microseconds{state.range(2)};
+  thread_pool<rr_ring_scheduler> pool{thread_pool_options{worker_count, placement_policy::none, strategy}};
+  auto scheduler = pool.get_scheduler();
+
+  std::atomic<clock::rep> latency{0};
+  std::vector<double> samples;
+  samples.reserve(static_cast<std::size_t>(state.max_iterations));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    latency.store(0);
+    std::this_thread::sleep_for(idle_time);
+    state.ResumeTiming();
+
+    auto const scheduled = clock::now();
+    scheduler.schedule([&latency, scheduled]() {
+      latency.store(std::max<clock::rep>(1, (clock::now() - scheduled).count()), std::memory_order_release);
+    });
+    while (0 == latency.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    samples.push_back(std::chrono::duration<double, std::micro>{clock::duration{latency.load()}}.count());
+  }
+
+  report_latency(state, samples);
+}
+
+/// \brief A benchmark configuration comparing blocking, parking right away and spinning before parking
+BENCHMARK(wake_latency)
+    ->ArgNames({"policy", "spin", "idle_us"})
+    ->Args({static_cast<int>(idle_policy::block), 0, 50})
+    ->Args({static_cast<int>(idle_policy::spin_then_park), 0, 50})
+    ->Args({static_cast<int>(idle_policy::spin_then_park), 1024, 50})
+    ->Args({static_cast<int>(idle_policy::block), 0, 1000})
+    ->Args({static_cast<int>(idle_policy::spin_then_park), 0, 1000})
+    ->Args({static_cast<int>(idle_policy::spin_then_park), 1024, 1000})
+    ->Iterations(2000)
+    ->UseRealTime();
+
+}  // namespace jar::concurrency::bench
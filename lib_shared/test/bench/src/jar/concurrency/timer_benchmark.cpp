@@ -0,0 +1,120 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file timer_benchmark.cpp
+///
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <jar/concurrency/timer.hpp>
+
+namespace jar::concurrency::bench {
+
+/// \brief A benchmark case for scheduling and cancelling a batch of timers
+///
+/// Every iteration schedules the given number of timers with deadlines spread from one second to one day, so they
+/// land on every level of the wheel, and cancels them all.
+///
+/// This benchmark provides the following counters:
+///   - timers scheduled and cancelled per second
+void timer_schedule_cancel(::benchmark::State& state)
+{
+  auto const timer_count = static_cast<std::size_t>(state.range(0));
+
+  timer timer_service;
+  std::mt19937_64 generator{42U};
+  std::uniform_int_distribution<std::int64_t> delay{1, 86400};
+  std::vector<timer::handle> handles;
+  handles.reserve(timer_count);
+
+  for (auto _ : state) {
+    for (std::size_t n = 0U; n != timer_count; ++n) {
+      handles.push_back(timer_service.schedule_after(std::chrono::seconds{delay(generator)}, []() {}));
+    }
+    for (auto const handle : handles) {
+      ::benchmark::DoNotOptimize(timer_service.cancel(handle));
+    }
+    handles.clear();
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(timer_count));
+}
+
+/// \brief A benchmark case for one schedule and cancel while a large number of timers is pending
+///
+/// The cost must not depend on the number of pending timers.
+///
+/// This benchmark provides the following counters:
+///   - timers scheduled and cancelled per second
+void timer_pending(::benchmark::State& state)
+{
+  auto const pending_count = static_cast<std::size_t>(state.range(0));
+
+  timer timer_service;
+  std::mt19937_64 generator{42U};
+  std::uniform_int_distribution<std::int64_t> delay{1, 86400};
+  for (std::size_t n = 0U; n != pending_count; ++n) {
+    timer_service.schedule_after(std::chrono::seconds{delay(generator)}, []() {});
+  }
+
+  for (auto _ : state) {
+    auto const handle = timer_service.schedule_after(std::chrono::seconds{delay(generator)}, []() {});
+    ::benchmark::DoNotOptimize(timer_service.cancel(handle));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// \brief A benchmark case for expiring a batch of timers
+///
+/// Every iteration schedules the given number of timers within the next ten milliseconds and waits until all of them
+/// have run on the timer thread.
+///
+/// This benchmark provides the following counters:
+///   - timers expired per second
+void timer_expire(::benchmark::State& state)
+{
+  auto const timer_count = static_cast<unsigned>(state.range(0));
+
+  timer timer_service;
+  std::mt19937_64 generator{42U};
+  std::uniform_int_distribution<std::int64_t> delay{0, 10'000};
+  std::atomic_uint count{0U};
+
+  for (auto _ : state) {
+    count.store(0U);
+    for (unsigned n = 0U; n != timer_count; ++n) {
+      timer_service.schedule_after(std::chrono::microseconds{delay(generator)}, [&count]() {
+        count.fetch_add(1U, std::memory_order_relaxed);
+      });
+    }
+    while (timer_count != count.load(std::memory_order_relaxed)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * timer_count);
+}
+
+BENCHMARK(timer_schedule_cancel)->Arg(1 << 10)->Arg(1 << 20)->Unit(::benchmark::kMillisecond);
+BENCHMARK(timer_pending)->Arg(0)->Arg(1 << 20);
+BENCHMARK(timer_expire)->Arg(1 << 16)->Unit(::benchmark::kMillisecond)->UseRealTime();
+
+}  // namespace jar::concurrency::bench
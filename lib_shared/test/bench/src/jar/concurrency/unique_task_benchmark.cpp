@@ -0,0 +1,88 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file unique_task_benchmark.cpp
+///
+#include "allocation_counter.hpp"
+
+#include <array>
+#include <functional>
+
+#include <jar/concurrency/rr_scheduler.hpp>
+#include <jar/concurrency/unique_task.hpp>
+
+namespace jar::concurrency::bench {
+
+/// \brief A callable with a given size, stands for a closure with captured state
+template <std::size_t Size> struct payload {
+  void operator()() { ::benchmark::DoNotOptimize(m_bytes.data()); }
+
+  std::array<char, Size> m_bytes{};
+};
+
+/// \brief A benchmark case for constructing and invoking a task from a closure
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per task
+template <typename Task, std::size_t Size> void task_construction(::benchmark::State& state)
+{
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    Task task{payload<Size>{}};
+    task();
+    ::benchmark::DoNotOptimize(task);
+  }
+
+  report_allocations(state, allocations);
+}
+
+/// \brief A benchmark case for scheduling a closure and running it from the scheduler
+///
+/// This benchmark provides the following counters:
+///   - heap allocations per task
+template <typename Scheduler, std::size_t Size> void scheduler_round_trip(::benchmark::State& state)
+{
+  Scheduler scheduler{1U};
+  auto adapter = scheduler.get_adapter();
+
+  // Warm up the queue so that the mutex based queue has allocated its first block.
+  adapter.schedule(payload<Size>{});
+  scheduler.scheduled().value()();
+
+  auto const allocations = allocation_count();
+
+  for (auto _ : state) {
+    adapter.schedule(payload<Size>{});
+    scheduler.scheduled().value()();
+  }
+
+  report_allocations(state, allocations);
+}
+
+BENCHMARK_TEMPLATE(task_construction, std::function<void(void)>, 8);
+BENCHMARK_TEMPLATE(task_construction, std::function<void(void)>, 48);
+BENCHMARK_TEMPLATE(task_construction, std::function<void(void)>, 128);
+BENCHMARK_TEMPLATE(task_construction, unique_task, 8);
+BENCHMARK_TEMPLATE(task_construction, unique_task, 48);
+BENCHMARK_TEMPLATE(task_construction, unique_task, 128);
+
+BENCHMARK_TEMPLATE(scheduler_round_trip, rr_scheduler, 8);
+BENCHMARK_TEMPLATE(scheduler_round_trip, rr_scheduler, 48);
+BENCHMARK_TEMPLATE(scheduler_round_trip, rr_scheduler, 128);
+BENCHMARK_TEMPLATE(scheduler_round_trip, rr_ring_scheduler, 8);
+BENCHMARK_TEMPLATE(scheduler_round_trip, rr_ring_scheduler, 48);
+BENCHMARK_TEMPLATE(scheduler_round_trip, rr_ring_scheduler, 128);
+
+}  // namespace jar::concurrency::bench
@@ -43,6 +43,7 @@ public:
     void complete(Value value) { m_instance->complete(std::move(value)); }
     void fail(std::exception_ptr e) { m_instance->fail(e); }
     void cancel() { m_instance->cancel(); }
+    bool is_canceled() const noexcept { return false; }
 
   private:
     mock_receiver* m_instance;
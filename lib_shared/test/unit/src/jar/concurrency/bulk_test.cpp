@@ -0,0 +1,117 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file bulk_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "jar/concurrency/details/value_receiver.hpp"
+
+#include "jar/concurrency/bulk.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/then.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/wait.hpp"
+
+namespace jar::concurrency::test {
+
+class bulk_test : public ::testing::Test {
+public:
+  thread_pool<rr_scheduler>& executor() { return m_executor; }
+
+private:
+  thread_pool<rr_scheduler> m_executor{4U};
+};
+
+TEST(bulk_shape_test, test_shape)
+{
+  auto shape = details::make_bulk_shape(4U, 1000U);
+  EXPECT_EQ(4U, shape.runners);
+  EXPECT_EQ(63U, shape.chunk);
+
+  shape = details::make_bulk_shape(8U, 3U);
+  EXPECT_EQ(3U, shape.runners);
+  EXPECT_EQ(1U, shape.chunk);
+
+  EXPECT_EQ(0U, details::make_bulk_shape(8U, 0U).runners);
+}
+
+TEST_F(bulk_test, test_complete)
+{
+  static constexpr std::size_t count{100000U};
+
+  auto visits = std::make_unique<std::atomic_uint[]>(count);
+  auto future = wait(bulk(executor().get_scheduler(), count, [&visits](std::size_t index) {
+    visits[index].fetch_add(1U, std::memory_order_relaxed);
+  }));
+
+  EXPECT_FALSE(future.get().is_canceled());
+  for (std::size_t index = 0U; index != count; ++index) {
+    ASSERT_EQ(1U, visits[index].load()) << "index " << index;
+  }
+}
+
+TEST_F(bulk_test, test_empty)
+{
+  auto future = wait(then(bulk(executor().get_scheduler(), 0U,
+                               [](std::size_t) {
+                                 ADD_FAILURE() << "Empty 'bulk' executed!";
+                               }),
+                          []() {
+                            return true;
+                          }));
+
+  EXPECT_TRUE(future.get().value());
+}
+
+TEST_F(bulk_test, test_fail)
+{
+  static constexpr std::size_t count{100000U};
+
+  std::atomic_size_t executed{0U};
+  auto future = wait(bulk(executor().get_scheduler(), count, [&executed](std::size_t index) {
+    executed.fetch_add(1U, std::memory_order_relaxed);
+    if (index == 10U) {
+      throw std::runtime_error{"expected test error"};
+    }
+  }));
+
+  EXPECT_THROW(future.get(), std::runtime_error);
+  // The runners stop claiming chunks after the error.
+  EXPECT_GT(count, executed.load());
+}
+
+TEST_F(bulk_test, test_cancel)
+{
+  auto sender = bulk(executor().get_scheduler(), 1000U, [](std::size_t) {
+    ADD_FAILURE() << "Canceled 'bulk' executed!";
+  });
+
+  details::value_receiver<void> receiver{};
+  auto future = receiver.get_future();
+
+  auto state = sender.connect(std::move(receiver));
+  future.cancel();
+  state.start();
+
+  EXPECT_TRUE(future.get().is_canceled());
+}
+
+}  // namespace jar::concurrency::test
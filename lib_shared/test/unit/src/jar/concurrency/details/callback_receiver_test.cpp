@@ -18,6 +18,7 @@
 
 #include <exception>
 #include <functional>
+#include <system_error>
 #include <utility>
 
 #include "jar/concurrency/mock_sender.hpp"
@@ -103,6 +104,39 @@ TEST(callback_receiver_test, test_fail)
   EXPECT_TRUE(is_failed);
 }
 
+TEST(callback_receiver_test, test_set_error)
+{
+  auto const expected = std::make_error_code(std::errc::resource_unavailable_try_again);
+
+  // An error handler with an overload for error codes gets the error code as is.
+  struct error_handler {
+    void operator()(std::exception_ptr) const noexcept { ADD_FAILURE() << "Error code delivered as an exception!"; }
+    void operator()(std::error_code code) const noexcept { *error = code; }
+
+    std::error_code* error;
+  };
+
+  std::error_code error;
+  auto receiver = make_callback_receiver(empty_value_handler, error_handler{&error}, empty_cancel_handler);
+  receiver.set_error(expected);
+  EXPECT_EQ(expected, error);
+
+  // An error handler without the error code channel gets the error code as a system_error.
+  bool is_failed{false};
+  auto fallback = make_callback_receiver(
+      empty_value_handler,
+      [&is_failed, &expected](std::exception_ptr e) noexcept {
+        try {
+          std::rethrow_exception(e);
+        } catch (std::system_error const& error) {
+          is_failed = expected == error.code();
+        }
+      },
+      empty_cancel_handler);
+  fallback.set_error(expected);
+  EXPECT_TRUE(is_failed);
+}
+
 TEST(callback_receiver_test, test_cancel)
 {
   bool is_canceled{false};
@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "jar/concurrency/details/sender_adapter.hpp"
+#include "jar/concurrency/then.hpp"
 
 #include "jar/concurrency/mock_sender.hpp"
 
@@ -78,6 +79,30 @@ TEST(sender_adapter_test, test_fail)
   state.start();
 }
 
+TEST(sender_adapter_test, test_fuse)
+{
+  auto first = []() {
+    return 1;
+  };
+  auto next = [](int arg) {
+    return arg + 1;
+  };
+  auto last = [](int arg) {
+    return std::to_string(arg);
+  };
+
+  auto chain = then(then(then(mock_sender{}, first), next), last);
+  static_assert(std::is_same_v<sender_adapter<mock_sender, decltype(first), decltype(next), decltype(last)>,
+                               decltype(chain)>,
+                "then() chain was not fused");
+  static_assert(std::is_same_v<std::string, decltype(chain)::result_type>, "sender_adapter::result_type mismatch");
+
+  mock_receiver<std::string> receiver;
+  EXPECT_CALL(receiver, complete(std::string{"2"})).Times(1U);
+  auto state = chain.connect(receiver.make_delegate());
+  state.start();
+}
+
 TEST(sender_adapter_test, test_cancel)
 {
   mock_receiver<int> receiver;
@@ -16,6 +16,8 @@
 ///
 #include <gtest/gtest.h>
 
+#include <optional>
+#include <stdexcept>
 #include <utility>
 
 #include "jar/concurrency/details/value_receiver.hpp"
@@ -90,4 +92,24 @@ TEST(value_receiver_test, test_fail)
   EXPECT_THROW(future.get(), std::runtime_error);
 }
 
+TEST(value_receiver_test, test_broken)
+{
+  std::optional<value_receiver<int>> receiver{std::in_place};
+  auto future = receiver->get_future();
+
+  // The promise is broken only when the last copy of the receiver is gone.
+  std::optional<value_receiver<int>> copy{*receiver};
+  receiver.reset();
+  copy->complete(1);
+  copy.reset();
+  EXPECT_EQ(1, future.get());
+
+  receiver.emplace();
+  future = receiver->get_future();
+  copy.emplace(*receiver);
+  receiver.reset();
+  copy.reset();
+  EXPECT_THROW(future.get(), std::domain_error);
+}
+
 }  // namespace jar::concurrency::details::test
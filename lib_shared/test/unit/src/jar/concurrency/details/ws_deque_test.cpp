@@ -0,0 +1,114 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file ws_deque_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "jar/concurrency/details/ws_deque.hpp"
+
+namespace jar::concurrency::details::test {
+
+TEST(ws_deque_test, test_pop_is_lifo)
+{
+  ws_deque<int> deque;
+  deque.push(1);
+  deque.push(2);
+  deque.push(3);
+
+  EXPECT_EQ(3U, deque.size());
+  EXPECT_EQ(3, deque.pop());
+  EXPECT_EQ(2, deque.pop());
+  EXPECT_EQ(1, deque.pop());
+  EXPECT_EQ(std::nullopt, deque.pop());
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(ws_deque_test, test_steal_is_fifo)
+{
+  ws_deque<int> deque;
+  deque.push(1);
+  deque.push(2);
+  deque.push(3);
+
+  EXPECT_EQ(1, deque.steal());
+  EXPECT_EQ(2, deque.steal());
+  EXPECT_EQ(3, deque.pop());
+  EXPECT_EQ(std::nullopt, deque.steal());
+}
+
+TEST(ws_deque_test, test_grow)
+{
+  static constexpr int item_count{1000};
+
+  ws_deque<int> deque{2U};
+  for (int i = 0; i < item_count; ++i) {
+    deque.push(i);
+  }
+
+  EXPECT_EQ(0, deque.steal());
+  for (int i = item_count - 1; i > 0; --i) {
+    EXPECT_EQ(i, deque.pop());
+  }
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(ws_deque_test, test_concurrent_steal)
+{
+  static constexpr int item_count{100'000};
+  static constexpr int thief_count{3};
+
+  ws_deque<int> deque{16U};
+  std::atomic_bool is_done{false};
+  std::vector<std::atomic_int> seen(item_count);
+
+  auto thief = [&deque, &is_done, &seen]() {
+    while (!is_done.load() || !deque.empty()) {
+      auto item = deque.steal();
+      if (item.has_value()) {
+        seen[item.value()].fetch_add(1);
+      }
+    }
+  };
+
+  std::vector<std::future<void>> thieves;
+  for (int n = 0; n < thief_count; ++n) {
+    thieves.emplace_back(std::async(std::launch::async, thief));
+  }
+
+  for (int i = 0; i < item_count; ++i) {
+    deque.push(i);
+    if (i % 3 == 0) {
+      auto item = deque.pop();
+      if (item.has_value()) {
+        seen[item.value()].fetch_add(1);
+      }
+    }
+  }
+  is_done.store(true);
+
+  for (auto& future : thieves) {
+    future.get();
+  }
+
+  for (int i = 0; i < item_count; ++i) {
+    EXPECT_EQ(1, seen[i].load()) << "item " << i;
+  }
+}
+
+}  // namespace jar::concurrency::details::test
@@ -17,9 +17,17 @@
 #include <gtest/gtest.h>
 
 #include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
 #include <thread>
+#include <vector>
 
 #include "jar/concurrency/future.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/unique_task.hpp"
 
 namespace jar::concurrency::test {
 
@@ -63,6 +71,31 @@ TEST(future_test, test_wait_value)
   EXPECT_NO_THROW(trigger.get());
 }
 
+TEST(future_test, test_many_waiters)
+{
+  static constexpr unsigned waiter_count{4U};
+  static constexpr unsigned handoff_count{1000U};
+
+  // Every round hands a value to several blocked waiters, a lost wake-up would hang the test.
+  for (unsigned n = 0U; n != handoff_count; ++n) {
+    promise<unsigned> promise;
+    auto future = promise.get_future();
+
+    std::vector<std::future<void>> waiters;
+    for (unsigned waiter = 0U; waiter != waiter_count; ++waiter) {
+      waiters.emplace_back(std::async(std::launch::async, [&future]() {
+        future.wait();
+      }));
+    }
+
+    promise.set_value(n);
+    for (auto& waiter : waiters) {
+      waiter.get();
+    }
+    EXPECT_EQ(n, future.get().value());
+  }
+}
+
 TEST(future_test, test_cancel)
 {
   auto canceled_future_maker = [](auto canceler) {
@@ -104,6 +137,55 @@ TEST(future_test, test_exception)
   EXPECT_THROW(future.get(), std::runtime_error);
 }
 
+TEST(future_test, test_error_code)
+{
+  auto const expected = std::make_error_code(std::errc::connection_reset);
+
+  promise<int> promise;
+  auto future = promise.get_future();
+  promise.set_error(expected);
+
+  auto result = future.get();
+  EXPECT_TRUE(result.has_error());
+  EXPECT_FALSE(result.is_canceled());
+  EXPECT_EQ(expected, result.error());
+  EXPECT_THROW(result.value(), std::system_error);
+
+  // The error code skips the continuation and is passed on without an exception.
+  ::jar::concurrency::promise<void> other;
+  auto next = other.get_future().then([]() {
+    ADD_FAILURE() << "Continuation of an error code executed!";
+  });
+  other.set_error(expected);
+  auto const next_result = next.get();
+  EXPECT_TRUE(next_result.has_error());
+  EXPECT_EQ(expected, next_result.error());
+}
+
+TEST(future_test, test_error_code_value)
+{
+  auto const expected = std::make_error_code(std::errc::connection_reset);
+
+  // An error code as the value is not mistaken for the error channel.
+  promise<std::error_code> promise;
+  auto future = promise.get_future();
+  promise.set_value(expected);
+
+  auto result = future.get();
+  EXPECT_FALSE(result.has_error());
+  EXPECT_FALSE(result.is_canceled());
+  EXPECT_EQ(expected, result.value());
+
+  ::jar::concurrency::promise<std::error_code> other;
+  auto error = other.get_future();
+  other.set_error(expected);
+
+  auto const error_result = error.get();
+  EXPECT_TRUE(error_result.has_error());
+  EXPECT_EQ(expected, error_result.error());
+  EXPECT_THROW(error_result.value(), std::system_error);
+}
+
 TEST(future_test, test_broken)
 {
   auto broken_future_maker = []() {
@@ -115,4 +197,129 @@ TEST(future_test, test_broken)
   EXPECT_THROW(future.get(), std::domain_error);
 }
 
+TEST(future_test, test_release_at_thread_exit)
+{
+  // The thread_local is constructed before the free list of the state pool, so it is destroyed after it.
+  std::thread thread{[]() {
+    thread_local std::optional<promise<int>> kept;
+    kept.emplace();
+    promise<int>{}.get_future();
+  }};
+  thread.join();
+}
+
+/// \brief A scheduler that keeps the scheduled tasks until they are run by the test
+struct manual_scheduler {
+  template <typename Invocable> void schedule(Invocable&& invocable)
+  {
+    tasks->emplace_back(std::forward<Invocable>(invocable));
+  }
+
+  std::vector<unique_task>* tasks;
+};
+
+TEST(future_test, test_then_ready)
+{
+  promise<int> promise;
+  auto future = promise.get_future();
+  promise.set_value(1);
+
+  auto next = future.then([](int value) {
+    return value + 1;
+  });
+  EXPECT_FALSE(future.is_valid());
+  EXPECT_EQ(2, next.get().value());
+}
+
+TEST(future_test, test_then_pending)
+{
+  promise<std::unique_ptr<int>> promise;
+  std::thread::id continued;
+
+  auto next = promise.get_future()
+                  .then([&continued](std::unique_ptr<int> value) {
+                    continued = std::this_thread::get_id();
+                    return *value;
+                  })
+                  .then([](int value) {
+                    EXPECT_EQ(42, value);
+                  });
+
+  std::thread producer{[&promise]() {
+    promise.set_value(std::make_unique<int>(42));
+  }};
+  auto const producer_id = producer.get_id();
+  producer.join();
+
+  EXPECT_TRUE(next.get());
+  EXPECT_EQ(producer_id, continued);
+}
+
+TEST(future_test, test_then_failure)
+{
+  auto never_called = [](int) -> int {
+    ADD_FAILURE() << "continuation called";
+    return 0;
+  };
+
+  promise<int> failed;
+  auto after_failure = failed.get_future().then(never_called);
+  failed.set_exception(std::make_exception_ptr(std::runtime_error{"test exception"}));
+  EXPECT_THROW(after_failure.get(), std::runtime_error);
+
+  promise<int> canceled;
+  auto after_cancel = canceled.get_future().then(never_called);
+  canceled.cancel();
+  EXPECT_TRUE(after_cancel.get().is_canceled());
+
+  std::optional<promise<int>> broken{std::in_place};
+  auto after_broken = broken->get_future().then(never_called);
+  broken.reset();
+  EXPECT_THROW(after_broken.get(), std::domain_error);
+
+  promise<void> throwing;
+  auto after_throw = throwing.get_future().then([]() {
+    throw std::runtime_error{"test exception"};
+  });
+  throwing.set_value();
+  EXPECT_THROW(after_throw.get(), std::runtime_error);
+}
+
+TEST(future_test, test_then_scheduler)
+{
+  std::vector<unique_task> tasks;
+  promise<int> promise;
+
+  auto next = promise.get_future().then(manual_scheduler{&tasks}, [](int value) {
+    return value * 2;
+  });
+  EXPECT_TRUE(tasks.empty());
+
+  promise.set_value(21);
+  ASSERT_EQ(1U, tasks.size());
+  tasks.front()();
+  EXPECT_EQ(42, next.get().value());
+}
+
+TEST(future_test, test_then_in_flight)
+{
+  static constexpr int operation_count{1000};
+
+  thread_pool<rr_scheduler> pool{2U};
+  std::vector<promise<int>> promises(operation_count);
+  std::vector<future<int>> results;
+  for (auto& promise : promises) {
+    results.emplace_back(promise.get_future().then(pool.get_scheduler(), [](int value) {
+      return value + 1;
+    }));
+  }
+
+  for (int n = 0; n != operation_count; ++n) {
+    promises[static_cast<std::size_t>(n)].set_value(n);
+  }
+  for (int n = 0; n != operation_count; ++n) {
+    EXPECT_EQ(n + 1, results[static_cast<std::size_t>(n)].get().value());
+  }
+}
+
 }  // namespace jar::concurrency::test
@@ -0,0 +1,153 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file idle_workers_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#include "jar/concurrency/idle_workers.hpp"
+#include "jar/concurrency/latch.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/ws_scheduler.hpp"
+
+namespace jar::concurrency::test {
+namespace {
+
+/// \brief Parks the workers right away
+constexpr idle_strategy park_only{idle_policy::spin_then_park, 0U, 0U};
+
+/// \brief Polls a value once, the value is consumed by the poll
+std::optional<int> take(std::atomic_int& value)
+{
+  auto const taken = value.exchange(0);
+  return 0 == taken ? std::nullopt : std::optional<int>{taken};
+}
+
+void wait_until_parked(idle_workers const& idle, unsigned count)
+{
+  while (idle.parked() != count) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+}
+
+template <typename Scheduler> void run_in_thread_pool(idle_strategy const& strategy)
+{
+  static constexpr unsigned task_count{10000U};
+
+  latch done{task_count};
+  thread_pool<Scheduler> pool{thread_pool_options{4U, placement_policy::none, strategy}};
+
+  auto scheduler = pool.get_scheduler();
+  for (unsigned n = 0U; n != task_count; ++n) {
+    scheduler.schedule([&done]() {
+      done.count_down();
+    });
+  }
+
+  EXPECT_NO_THROW(done.wait());
+}
+
+}  // namespace
+
+TEST(idle_workers_test, test_precondition)
+{
+  EXPECT_THROW({ idle_workers(idle_strategy{}, 0U); }, std::invalid_argument);
+}
+
+TEST(idle_workers_test, test_polled_task)
+{
+  idle_workers idle{idle_strategy{}, 1U};
+  std::atomic_int value{42};
+
+  auto const task = idle.wait(0U, [&value]() {
+    return take(value);
+  });
+  EXPECT_EQ(42, task);
+  EXPECT_EQ(0U, idle.spinning());
+  EXPECT_EQ(0U, idle.parked());
+}
+
+TEST(idle_workers_test, test_notify_parked)
+{
+  idle_workers idle{park_only, 1U};
+  std::atomic_int value{0};
+
+  auto worker = std::async(std::launch::async, [&idle, &value]() {
+    return idle.wait(0U, [&value]() {
+      return take(value);
+    });
+  });
+
+  wait_until_parked(idle, 1U);
+  value.store(42);
+  idle.notify();
+
+  EXPECT_EQ(42, worker.get());
+  EXPECT_EQ(0U, idle.parked());
+}
+
+TEST(idle_workers_test, test_notify_without_idle_workers)
+{
+  idle_workers idle{park_only, 2U};
+
+  EXPECT_NO_THROW(idle.notify(2U));
+  EXPECT_EQ(0U, idle.parked());
+}
+
+TEST(idle_workers_test, test_stop)
+{
+  idle_workers idle{park_only, 2U};
+  std::atomic_int value{0};
+
+  auto poll = [&value]() {
+    return take(value);
+  };
+  auto worker1 = std::async(std::launch::async, [&idle, &poll]() {
+    return idle.wait(0U, poll);
+  });
+  auto worker2 = std::async(std::launch::async, [&idle, &poll]() {
+    return idle.wait(1U, poll);
+  });
+
+  wait_until_parked(idle, 2U);
+  idle.stop();
+
+  EXPECT_EQ(std::nullopt, worker1.get());
+  EXPECT_EQ(std::nullopt, worker2.get());
+  EXPECT_TRUE(idle.is_stopped());
+  EXPECT_EQ(std::nullopt, idle.wait(0U, poll));
+}
+
+TEST(idle_workers_test, test_thread_pool)
+{
+  idle_strategy const spinning{idle_policy::spin_then_park, 64U, 4U};
+
+  run_in_thread_pool<rr_scheduler>(spinning);
+  run_in_thread_pool<rr_ring_scheduler>(spinning);
+  run_in_thread_pool<ws_scheduler>(spinning);
+
+  run_in_thread_pool<rr_scheduler>(park_only);
+  run_in_thread_pool<rr_ring_scheduler>(park_only);
+  run_in_thread_pool<ws_scheduler>(park_only);
+}
+
+}  // namespace jar::concurrency::test
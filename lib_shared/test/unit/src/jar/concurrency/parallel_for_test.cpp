@@ -0,0 +1,94 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file parallel_for_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "jar/concurrency/parallel_for.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/ws_scheduler.hpp"
+
+namespace jar::concurrency::test {
+
+TEST(parallel_for_test, test_parallel_for)
+{
+  static constexpr std::size_t count{100000U};
+
+  thread_pool<rr_scheduler> executor{4U};
+  std::vector<std::size_t> values(count, 0U);
+
+  parallel_for(executor.get_scheduler(), count, [&values](std::size_t index) {
+    values[index] = index * 2U;
+  });
+
+  for (std::size_t index = 0U; index != count; ++index) {
+    ASSERT_EQ(index * 2U, values[index]);
+  }
+}
+
+TEST(parallel_for_test, test_parallel_for_fail)
+{
+  thread_pool<rr_scheduler> executor{4U};
+
+  EXPECT_THROW(parallel_for(executor.get_scheduler(), 1000U,
+                            [](std::size_t index) {
+                              if (index == 500U) {
+                                throw std::runtime_error{"expected test error"};
+                              }
+                            }),
+               std::runtime_error);
+}
+
+TEST(parallel_for_test, test_transform_reduce)
+{
+  static constexpr std::size_t count{1000000U};
+
+  thread_pool<ws_scheduler> executor{4U};
+  auto const sum = parallel_transform_reduce(
+      executor.get_scheduler(), count, std::uint64_t{7U},
+      [](std::uint64_t lhs, std::uint64_t rhs) {
+        return lhs + rhs;
+      },
+      [](std::size_t index) {
+        return std::uint64_t{index};
+      });
+
+  EXPECT_EQ(std::uint64_t{7U} + std::uint64_t{count} * (count - 1U) / 2U, sum);
+}
+
+TEST(parallel_for_test, test_transform_reduce_empty)
+{
+  thread_pool<rr_scheduler> executor{2U};
+  auto const result = parallel_transform_reduce(
+      executor.get_scheduler(), 0U, std::string{"init"},
+      [](std::string lhs, std::string const& rhs) {
+        return lhs + rhs;
+      },
+      [](std::size_t) {
+        ADD_FAILURE() << "Empty 'parallel_transform_reduce' executed!";
+        return std::string{};
+      });
+
+  EXPECT_EQ("init", result);
+}
+
+}  // namespace jar::concurrency::test
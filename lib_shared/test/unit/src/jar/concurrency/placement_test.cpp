@@ -0,0 +1,112 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file placement_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "jar/concurrency/placement.hpp"
+
+namespace jar::concurrency::test {
+
+using cpus = std::vector<unsigned>;
+
+/// \brief A two node topology with four cores per node
+static cpu_topology const g_topology{numa_node{0U, {0U, 1U, 2U, 3U}}, numa_node{1U, {4U, 5U, 6U, 7U}}};
+
+TEST(placement_test, test_parse_cpu_list)
+{
+  EXPECT_EQ((cpus{0U}), parse_cpu_list("0"));
+  EXPECT_EQ((cpus{0U, 1U, 2U, 3U, 8U, 10U, 11U}), parse_cpu_list("0-3,8,10-11\n"));
+  EXPECT_EQ(cpus{}, parse_cpu_list(""));
+
+  EXPECT_THROW(parse_cpu_list("a-b"), std::invalid_argument);
+  EXPECT_THROW(parse_cpu_list("3-1"), std::invalid_argument);
+}
+
+TEST(placement_test, test_read_cpu_topology)
+{
+  namespace fs = std::filesystem;
+
+  auto const root = fs::temp_directory_path() / "jar_placement_test";
+  fs::remove_all(root);
+  fs::create_directories(root / "node1");
+  fs::create_directories(root / "node0");
+  fs::create_directories(root / "power");
+  std::ofstream{root / "node0" / "cpulist"} << "0-1\n";
+  std::ofstream{root / "node1" / "cpulist"} << "2,3\n";
+
+  auto const topology = read_cpu_topology(root.string());
+  ASSERT_EQ(2U, topology.size());
+  EXPECT_EQ(0U, topology[0].id);
+  EXPECT_EQ((cpus{0U, 1U}), topology[0].cpus);
+  EXPECT_EQ(1U, topology[1].id);
+  EXPECT_EQ((cpus{2U, 3U}), topology[1].cpus);
+
+  fs::remove_all(root);
+  EXPECT_TRUE(read_cpu_topology(root.string()).empty());
+}
+
+TEST(placement_test, test_system_topology)
+{
+  auto const topology = system_topology();
+  ASSERT_FALSE(topology.empty());
+  for (auto const& node : topology) {
+    EXPECT_FALSE(node.cpus.empty());
+  }
+}
+
+TEST(placement_test, test_plan_placement)
+{
+  auto const none = plan_placement(g_topology, placement_policy::none, 3U);
+  EXPECT_EQ((std::vector<cpus>{{}, {}, {}}), none);
+
+  auto const compact = plan_placement(g_topology, placement_policy::compact, 3U);
+  EXPECT_EQ((std::vector<cpus>{{0U}, {1U}, {2U}}), compact);
+
+  auto const scatter = plan_placement(g_topology, placement_policy::scatter, 3U);
+  EXPECT_EQ((std::vector<cpus>{{0U}, {4U}, {1U}}), scatter);
+
+  auto const numa = plan_placement(g_topology, placement_policy::numa, 3U);
+  EXPECT_EQ((std::vector<cpus>{g_topology[0].cpus, g_topology[1].cpus, g_topology[0].cpus}), numa);
+
+  auto const wrapped = plan_placement(g_topology, placement_policy::compact, 9U);
+  EXPECT_EQ(cpus{0U}, wrapped.back());
+}
+
+TEST(placement_test, test_affinity)
+{
+  auto const allowed = allowed_cpus();
+  ASSERT_FALSE(allowed.empty());
+
+  {
+    scoped_affinity affinity{{allowed.front()}};
+    EXPECT_EQ(cpus{allowed.front()}, allowed_cpus());
+  }
+  EXPECT_EQ(allowed, allowed_cpus());
+
+  std::thread thread{[]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }};
+  EXPECT_NO_THROW(set_affinity(thread, {allowed.back()}));
+  thread.join();
+}
+
+}  // namespace jar::concurrency::test
@@ -0,0 +1,159 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file priority_scheduler_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "jar/concurrency/priority_scheduler.hpp"
+#include "jar/concurrency/schedule.hpp"
+#include "jar/concurrency/then.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/type_traits.hpp"
+#include "jar/concurrency/wait.hpp"
+
+namespace jar::concurrency::test {
+
+/// \brief Runs count tasks from the scheduler on the calling thread
+void run(priority_scheduler& sched, unsigned count)
+{
+  for (unsigned n = 0U; n < count; ++n) {
+    sched.scheduled().value()();
+  }
+}
+
+/// \brief Makes a task that appends the value to the order
+unique_task record(std::vector<int>& order, int value)
+{
+  return [&order, value]() {
+    order.push_back(value);
+  };
+}
+
+TEST(priority_scheduler_test, test_precondition)
+{
+  EXPECT_THROW({ priority_scheduler(0U); }, std::invalid_argument);
+  EXPECT_THROW({ priority_scheduler(1U, 0U); }, std::invalid_argument);
+  EXPECT_THROW({ priority_scheduler(1U, std::vector<unsigned>{}); }, std::invalid_argument);
+  EXPECT_THROW({ priority_scheduler(1U, std::vector<unsigned>{1U, 0U}); }, std::invalid_argument);
+
+  priority_scheduler sched{1U, 2U};
+  EXPECT_THROW(sched.get_adapter(2U), std::invalid_argument);
+  EXPECT_THROW(sched.schedule(unique_task{}, 2U), std::invalid_argument);
+}
+
+TEST(priority_scheduler_test, test_traits)
+{
+  EXPECT_TRUE(is_input_scheduler<priority_scheduler>::value);
+  EXPECT_TRUE(is_output_scheduler<priority_scheduler>::value);
+  EXPECT_TRUE(has_scheduler_adapter<priority_scheduler>::value);
+}
+
+TEST(priority_scheduler_test, test_strict_priority)
+{
+  priority_scheduler sched{1U, 3U, std::chrono::hours{1}};
+  std::vector<int> order;
+
+  sched.schedule(record(order, 2));
+  sched.schedule(record(order, 1), 1U);
+  sched.get_adapter(0U).schedule(record(order, 0));
+  sched.get_adapter(2U).schedule(
+      [&order](int value) {
+        order.push_back(value);
+      },
+      3);
+
+  run(sched, 4U);
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3}), order);
+}
+
+TEST(priority_scheduler_test, test_starvation_guard)
+{
+  priority_scheduler sched{1U, 2U, std::chrono::milliseconds{1}};
+  std::vector<int> order;
+
+  sched.schedule(record(order, 1), 1U);
+  std::this_thread::sleep_for(std::chrono::milliseconds{5});
+  sched.schedule(record(order, 0), 0U);
+
+  run(sched, 2U);
+  EXPECT_EQ((std::vector<int>{1, 0}), order);
+}
+
+TEST(priority_scheduler_test, test_weighted_share)
+{
+  static constexpr unsigned tasks_per_lane{8U};
+
+  priority_scheduler sched{1U, std::vector<unsigned>{3U, 1U}};
+  std::vector<int> lanes;
+
+  for (unsigned n = 0U; n < tasks_per_lane; ++n) {
+    sched.schedule(record(lanes, 0), 0U);
+    sched.schedule(record(lanes, 1), 1U);
+  }
+
+  run(sched, 8U);
+  EXPECT_EQ(6, std::count(lanes.begin(), lanes.end(), 0));
+  EXPECT_EQ(2, std::count(lanes.begin(), lanes.end(), 1));
+}
+
+TEST(priority_scheduler_test, test_bulk_scheduling)
+{
+  priority_scheduler sched{1U, 2U};
+  std::vector<int> order;
+
+  std::vector<unique_task> tasks;
+  tasks.emplace_back(record(order, 1));
+  tasks.emplace_back(record(order, 2));
+  sched.get_adapter(1U).schedule_bulk(tasks);
+  sched.get_adapter(0U).schedule(record(order, 0));
+
+  run(sched, 3U);
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), order);
+}
+
+TEST(priority_scheduler_test, test_clear)
+{
+  priority_scheduler sched{1U};
+
+  auto worker = std::async(std::launch::async, [&sched]() {
+    EXPECT_EQ(std::nullopt, sched.scheduled());
+  });
+
+  sched.clear();
+  EXPECT_NO_THROW(worker.get());
+}
+
+TEST(priority_scheduler_test, test_sender_in_thread_pool)
+{
+  static constexpr int expected{42};
+
+  thread_pool<priority_scheduler> pool{2U, 4U, std::chrono::milliseconds{5}};
+
+  auto sender = then(schedule(pool.get_scheduler(0U)), []() {
+    return expected;
+  });
+  auto future = wait(std::move(sender));
+
+  EXPECT_EQ(expected, future.get().value());
+}
+
+}  // namespace jar::concurrency::test
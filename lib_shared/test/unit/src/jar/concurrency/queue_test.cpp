@@ -18,6 +18,7 @@
 
 #include <future>
 #include <memory>
+#include <vector>
 
 #include "jar/concurrency/queue.hpp"
 
@@ -70,6 +71,26 @@ TEST(queue_test, test_try_throughput)
   consumer(int_queue);
 }
 
+TEST(queue_test, test_push_bulk)
+{
+  queue<std::unique_ptr<int>> ptr_queue;
+
+  std::vector<std::unique_ptr<int>> items;
+  for (int i = 0; i < g_item_count; ++i) {
+    items.emplace_back(std::make_unique<int>(i));
+  }
+
+  auto consumer = std::async(std::launch::async, [&ptr_queue]() {
+    for (int i = 0; i < g_item_count; ++i) {
+      EXPECT_EQ(i, *ptr_queue.pop().value());
+    }
+  });
+
+  ptr_queue.push_bulk(items.begin(), items.end());
+  EXPECT_NO_THROW(consumer.get());
+  EXPECT_EQ(nullptr, items.front());
+}
+
 TEST(queue_test, test_try_pop_empty)
 {
   queue<int> queue;
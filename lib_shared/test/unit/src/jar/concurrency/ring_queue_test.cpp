@@ -0,0 +1,177 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file ring_queue_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "jar/concurrency/ring_queue.hpp"
+
+namespace jar::concurrency::test {
+
+static constexpr int g_item_count = 100;
+
+TEST(ring_queue_test, test_throughput)
+{
+  ring_queue<std::unique_ptr<int>, 8U> ptr_queue;
+
+  auto producer = std::async(std::launch::async, [&ptr_queue]() {
+    for (int i = 0; i < g_item_count; ++i) {
+      ptr_queue.push(std::make_unique<int>(i));
+    }
+  });
+
+  for (int i = 0; i < g_item_count; ++i) {
+    EXPECT_EQ(i, *ptr_queue.pop().value());
+  }
+}
+
+TEST(ring_queue_test, test_try_push_full)
+{
+  ring_queue<int, 4U> int_queue;
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(int_queue.try_push(i));
+  }
+  EXPECT_FALSE(int_queue.try_push(4));
+
+  EXPECT_EQ(0, int_queue.try_pop());
+  EXPECT_TRUE(int_queue.try_push(4));
+  for (int i = 1; i < 5; ++i) {
+    EXPECT_EQ(i, int_queue.try_pop());
+  }
+  EXPECT_EQ(std::nullopt, int_queue.try_pop());
+}
+
+TEST(ring_queue_test, test_try_push_throwing_copy)
+{
+  // An item whose copy throws, moves do not.
+  struct throwing_copy {
+    explicit throwing_copy(int v) noexcept
+      : value{v}
+    {
+    }
+    throwing_copy(throwing_copy const&) { throw std::runtime_error{"copy"}; }
+    throwing_copy(throwing_copy&&) noexcept = default;
+    throwing_copy& operator=(throwing_copy const&) = delete;
+    throwing_copy& operator=(throwing_copy&&) noexcept = default;
+    ~throwing_copy() = default;
+
+    int value;
+  };
+
+  ring_queue<throwing_copy, 4U> queue;
+  throwing_copy const item{1};
+
+  // The copy throws before a cell is claimed, the queue is left untouched.
+  EXPECT_THROW(queue.try_push(item), std::runtime_error);
+  EXPECT_EQ(0U, queue.size());
+
+  EXPECT_TRUE(queue.try_push(throwing_copy{2}));
+  EXPECT_EQ(2, queue.try_pop().value().value);
+  EXPECT_FALSE(queue.try_pop().has_value());
+}
+
+TEST(ring_queue_test, test_push_bulk_larger_than_capacity)
+{
+  ring_queue<std::unique_ptr<int>, 8U> ptr_queue;
+
+  std::vector<std::unique_ptr<int>> items;
+  for (int i = 0; i < g_item_count; ++i) {
+    items.emplace_back(std::make_unique<int>(i));
+  }
+
+  auto consumer = std::async(std::launch::async, [&ptr_queue]() {
+    for (int i = 0; i < g_item_count; ++i) {
+      EXPECT_EQ(i, *ptr_queue.pop().value());
+    }
+  });
+
+  ptr_queue.push_bulk(items.begin(), items.end());
+  EXPECT_NO_THROW(consumer.get());
+}
+
+TEST(ring_queue_test, test_try_pop_empty)
+{
+  ring_queue<int> queue;
+  EXPECT_EQ(std::nullopt, queue.try_pop());
+}
+
+TEST(ring_queue_test, test_multiple_producers_and_consumers)
+{
+  static constexpr int producer_count{4};
+  static constexpr int items_per_producer{10000};
+
+  ring_queue<int, 64U> int_queue;
+
+  std::vector<std::future<void>> producers;
+  for (int p = 0; p < producer_count; ++p) {
+    producers.emplace_back(std::async(std::launch::async, [&int_queue, p]() {
+      for (int i = 0; i < items_per_producer; ++i) {
+        int_queue.push(p * items_per_producer + i);
+      }
+    }));
+  }
+
+  std::vector<std::future<long>> consumers;
+  for (int c = 0; c < producer_count; ++c) {
+    consumers.emplace_back(std::async(std::launch::async, [&int_queue]() {
+      long sum{0};
+      for (int i = 0; i < items_per_producer; ++i) {
+        sum += int_queue.pop().value();
+      }
+      return sum;
+    }));
+  }
+
+  long sum{0};
+  for (auto& consumer : consumers) {
+    sum += consumer.get();
+  }
+
+  static constexpr long total{producer_count * items_per_producer};
+  EXPECT_EQ(total * (total - 1) / 2, sum);
+}
+
+TEST(ring_queue_test, test_clear)
+{
+  ring_queue<int> queue;
+
+  auto consumer = std::async(std::launch::async, [&queue]() {
+    EXPECT_EQ(std::nullopt, queue.pop());
+  });
+
+  queue.clear();
+}
+
+TEST(ring_queue_test, test_clear_releases_blocked_producer)
+{
+  ring_queue<int, 2U> queue;
+  EXPECT_TRUE(queue.try_push(0));
+  EXPECT_TRUE(queue.try_push(1));
+
+  auto producer = std::async(std::launch::async, [&queue]() {
+    queue.push(2);
+  });
+
+  queue.clear();
+  EXPECT_NO_THROW(producer.get());
+}
+
+}  // namespace jar::concurrency::test
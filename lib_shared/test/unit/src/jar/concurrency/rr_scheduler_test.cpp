@@ -20,8 +20,11 @@
 #include <future>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 
+#include "jar/concurrency/latch.hpp"
 #include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/thread_pool.hpp"
 
 namespace jar::concurrency::test {
 
@@ -79,6 +82,65 @@ TEST(scheduler_test, test_clear)
   EXPECT_NO_THROW(worker.get());
 }
 
+TEST(scheduler_test, test_try_scheduled)
+{
+  rr_ring_scheduler sched{2U};
+  mock_task task;
+  EXPECT_CALL(task, op()).Times(2U);
+
+  EXPECT_EQ(std::nullopt, sched.try_scheduled());
+  sched.schedule(std::ref(task));
+  sched.schedule(std::ref(task));
+
+  for (unsigned n = 0U; n != 2U; ++n) {
+    auto scheduled = sched.try_scheduled();
+    ASSERT_TRUE(scheduled.has_value());
+    scheduled.value()();
+  }
+  EXPECT_EQ(std::nullopt, sched.try_scheduled());
+}
+
+TEST(scheduler_test, test_bulk_scheduling)
+{
+  static constexpr unsigned task_count{10U};
+
+  rr_scheduler sched{3U};
+  mock_task task;
+  EXPECT_CALL(task, op()).Times(task_count);
+
+  std::vector<rr_scheduler::task_type> tasks;
+  for (unsigned n = 0U; n < task_count; ++n) {
+    tasks.emplace_back(std::ref(task));
+  }
+  sched.schedule_bulk(tasks);
+
+  auto worker = std::async(std::launch::async, [&sched]() {
+    for (unsigned n = 0U; n < task_count; ++n) {
+      auto task = sched.scheduled();
+      task.value()();
+    }
+  });
+
+  EXPECT_NO_THROW(worker.get());
+}
+
+TEST(scheduler_test, test_bulk_scheduling_in_thread_pool)
+{
+  static constexpr unsigned task_count{10000U};
+
+  latch done{task_count};
+  thread_pool<rr_ring_scheduler> pool{4U};
+
+  std::vector<std::function<void(void)>> tasks{task_count, [&done]() {
+                                                  done.count_down();
+                                                }};
+
+  auto scheduler = pool.get_scheduler();
+  scheduler.schedule_bulk(tasks.begin(), tasks.end());
+
+  EXPECT_NO_THROW(done.wait());
+}
+
 TEST(thread_pool_test, test_scheduling_with_adapter)
 {
   static constexpr unsigned task_count{3U};
@@ -106,4 +168,41 @@ TEST(thread_pool_test, test_scheduling_with_adapter)
   EXPECT_NO_THROW(worker.get());
 }
 
+TEST(scheduler_test, test_ring_queue_scheduling)
+{
+  static constexpr unsigned task_count{3U};
+
+  rr_ring_scheduler sched{2U};
+  mock_task task1, task2, task3;
+
+  EXPECT_CALL(task1, op).Times(1U);
+  EXPECT_CALL(task2, op()).Times(1U);
+  EXPECT_CALL(task3, op()).Times(1U);
+
+  sched.schedule(std::ref(task1));
+  sched.schedule(std::ref(task2));
+  sched.schedule(std::ref(task3));
+
+  auto worker = std::async(std::launch::async, [&sched]() {
+    for (unsigned n = 0U; n < task_count; ++n) {
+      auto task = sched.scheduled();
+      task.value()();
+    }
+  });
+
+  EXPECT_NO_THROW(worker.get());
+}
+
+TEST(scheduler_test, test_ring_queue_clear)
+{
+  rr_ring_scheduler sched{1U};
+
+  auto worker = std::async(std::launch::async, [&sched]() {
+    EXPECT_EQ(std::nullopt, sched.scheduled());
+  });
+
+  sched.clear();
+  EXPECT_NO_THROW(worker.get());
+}
+
 }  // namespace jar::concurrency::test
@@ -0,0 +1,158 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file stats_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "jar/concurrency/latch.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/stats.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+
+namespace jar::concurrency::test {
+
+TEST(stats_test, test_precondition)
+{
+  EXPECT_THROW({ scheduler_stats{0U}; }, std::invalid_argument);
+}
+
+TEST(stats_test, test_histogram)
+{
+  using namespace std::chrono_literals;
+
+  latency_histogram histogram;
+  histogram.record(0ns);
+  histogram.record(1ns);
+  histogram.record(1000ns);
+  histogram.record(24h);
+
+  latency_snapshot snapshot{histogram.snapshot()};
+  EXPECT_EQ(2U, snapshot.buckets[0U]);
+  EXPECT_EQ(1U, snapshot.buckets[9U]);
+  EXPECT_EQ(1U, snapshot.buckets[latency_histogram::s_bucket_count - 1U]);
+  EXPECT_EQ(4U, snapshot.count());
+
+  EXPECT_EQ(2ns, snapshot.percentile(0.5));
+  EXPECT_EQ(1024ns, snapshot.percentile(0.75));
+  EXPECT_EQ(0ns, latency_snapshot{}.percentile(0.5));
+}
+
+TEST(stats_test, test_scheduler_counters)
+{
+  static constexpr unsigned task_count{8U};
+
+  rr_stats_scheduler scheduler{2U};
+  for (unsigned n = 0U; n != task_count; ++n) {
+    scheduler.schedule([]() {});
+  }
+
+  auto snapshot = scheduler.stats();
+  EXPECT_EQ(task_count, snapshot.external.scheduled);
+  EXPECT_EQ((std::vector<std::size_t>{task_count / 2U, task_count / 2U}), snapshot.queue_depths);
+
+  // One worker drains both queues, so half of the tasks come from the queue of the other worker.
+  std::async(std::launch::async, [&scheduler]() {
+    for (unsigned n = 0U; n != task_count; ++n) {
+      scheduler.scheduled().value()();
+    }
+  }).get();
+
+  snapshot = scheduler.stats();
+  auto const total = snapshot.total();
+  EXPECT_EQ(task_count, total.local_pops + total.foreign_pops);
+  EXPECT_EQ(task_count / 2U, total.foreign_pops);
+  EXPECT_EQ(task_count, total.queue_wait.count());
+  EXPECT_EQ(task_count, total.run_time.count());
+  EXPECT_EQ(0U, snapshot.external.run_time.count());
+  EXPECT_EQ((std::vector<std::size_t>{0U, 0U}), snapshot.queue_depths);
+}
+
+TEST(stats_test, test_bulk_counters)
+{
+  rr_ring_stats_scheduler scheduler{2U};
+  std::vector<unique_task> tasks(4U);
+  for (auto& task : tasks) {
+    task = []() {};
+  }
+  scheduler.schedule_bulk(tasks);
+
+  EXPECT_EQ(tasks.size(), scheduler.stats().external.scheduled);
+  EXPECT_EQ(0U, scheduler.stats().external.push_fallbacks);
+
+  for (std::size_t n = 0U; n != tasks.size(); ++n) {
+    scheduler.try_scheduled().value()();
+  }
+  EXPECT_EQ(tasks.size(), scheduler.stats().total().run_time.count());
+}
+
+TEST(stats_test, test_bulk_lambdas)
+{
+  unsigned run_count{0U};
+  auto counter = [&run_count]() {
+    ++run_count;
+  };
+  std::vector<decltype(counter)> tasks(3U, counter);
+
+  rr_stats_scheduler scheduler{2U};
+  scheduler.schedule_bulk(tasks);
+  rr_ring_stats_scheduler ring_scheduler{2U};
+  ring_scheduler.schedule_bulk(tasks.begin(), tasks.end());
+
+  for (std::size_t n = 0U; n != tasks.size(); ++n) {
+    scheduler.try_scheduled().value()();
+    ring_scheduler.try_scheduled().value()();
+  }
+  EXPECT_EQ(2U * tasks.size(), run_count);
+  EXPECT_EQ(tasks.size(), scheduler.stats().total().run_time.count());
+  EXPECT_EQ(tasks.size(), ring_scheduler.stats().total().run_time.count());
+}
+
+TEST(stats_test, test_thread_pool)
+{
+  using namespace std::chrono_literals;
+  static constexpr unsigned task_count{16U};
+
+  thread_pool<rr_stats_scheduler> pool{2U};
+  latch done{task_count};
+  auto scheduler = pool.get_scheduler();
+  for (unsigned n = 0U; n != task_count; ++n) {
+    scheduler.schedule([&done]() {
+      std::this_thread::sleep_for(1ms);
+      done.count_down();
+    });
+  }
+  done.wait();
+
+  // The last task counts down before its run time is recorded.
+  auto snapshot = pool.stats();
+  for (auto const deadline = std::chrono::steady_clock::now() + 5s;
+       snapshot.total().run_time.count() != task_count && std::chrono::steady_clock::now() < deadline;
+       snapshot = pool.stats()) {
+    std::this_thread::yield();
+  }
+
+  ASSERT_EQ(2U, snapshot.workers.size());
+  EXPECT_EQ(task_count, snapshot.total().run_time.count());
+  EXPECT_EQ(0U, snapshot.external.run_time.count());
+  EXPECT_LE(1ms, snapshot.total().run_time.percentile(0.5));
+}
+
+}  // namespace jar::concurrency::test
@@ -0,0 +1,208 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file stop_token_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include "jar/concurrency/bulk.hpp"
+#include "jar/concurrency/latch.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/schedule.hpp"
+#include "jar/concurrency/stop_token.hpp"
+#include "jar/concurrency/then.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/timer.hpp"
+#include "jar/concurrency/wait.hpp"
+#include "jar/concurrency/when_all.hpp"
+
+namespace jar::concurrency::test {
+
+using namespace std::chrono_literals;
+
+TEST(stop_token_test, test_default_token)
+{
+  stop_token token;
+  EXPECT_FALSE(token.stop_possible());
+  EXPECT_FALSE(token.stop_requested());
+
+  bool is_invoked{false};
+  stop_callback callback{token, [&is_invoked]() noexcept {
+                           is_invoked = true;
+                         }};
+  EXPECT_FALSE(is_invoked);
+}
+
+TEST(stop_token_test, test_request_stop)
+{
+  stop_source source;
+  auto token = source.get_token();
+  EXPECT_TRUE(token.stop_possible());
+  EXPECT_FALSE(token.stop_requested());
+
+  unsigned invoked{0U};
+  stop_callback callback{token, [&invoked]() noexcept {
+                           ++invoked;
+                         }};
+  EXPECT_EQ(0U, invoked);
+
+  EXPECT_TRUE(source.request_stop());
+  EXPECT_FALSE(source.request_stop());
+  EXPECT_TRUE(token.stop_requested());
+  EXPECT_TRUE(source.stop_requested());
+  EXPECT_EQ(1U, invoked);
+
+  // A callback registered after the request is invoked right away.
+  bool is_invoked{false};
+  stop_callback late{token, [&is_invoked]() noexcept {
+                       is_invoked = true;
+                     }};
+  EXPECT_TRUE(is_invoked);
+}
+
+TEST(stop_token_test, test_deregister)
+{
+  stop_source source;
+  bool is_invoked{false};
+  {
+    stop_callback callback{source.get_token(), [&is_invoked]() noexcept {
+                             is_invoked = true;
+                           }};
+  }
+  source.request_stop();
+  EXPECT_FALSE(is_invoked);
+}
+
+TEST(stop_token_test, test_token_outlives_source)
+{
+  std::optional<stop_token> token;
+  {
+    stop_source source;
+    token = source.get_token();
+    source.request_stop();
+  }
+  EXPECT_TRUE(token->stop_requested());
+}
+
+TEST(stop_token_test, test_deregister_waits_for_callback)
+{
+  stop_source source;
+  std::atomic_bool is_running{false}, is_done{false};
+
+  auto slow = [&is_running, &is_done]() noexcept {
+    is_running.store(true);
+    std::this_thread::sleep_for(20ms);
+    is_done.store(true);
+  };
+  auto callback = std::make_unique<stop_callback<decltype(slow)>>(source.get_token(), slow);
+
+  std::thread requester{[&source]() {
+    source.request_stop();
+  }};
+  while (!is_running.load()) {
+    std::this_thread::yield();
+  }
+  callback.reset();
+  EXPECT_TRUE(is_done.load());
+  requester.join();
+}
+
+TEST(stop_token_test, test_stop_then_chain)
+{
+  thread_pool<rr_scheduler> executor{1U};
+  stop_source source;
+  latch step1_running{1U}, step1_release{1U};
+  std::atomic_bool is_step2_executed{false};
+
+  auto chain = then(then(schedule(executor.get_scheduler()),
+                         [&step1_running, &step1_release]() {
+                           step1_running.count_down();
+                           step1_release.wait();
+                           return 1;
+                         }),
+                    [&is_step2_executed](int value) {
+                      is_step2_executed.store(true);
+                      return value;
+                    });
+  auto future = wait(std::move(chain), source.get_token());
+
+  // Stop is requested while the chain is in flight, the rest of the chain is skipped.
+  step1_running.wait();
+  source.request_stop();
+  step1_release.count_down();
+
+  EXPECT_TRUE(future.get().is_canceled());
+  EXPECT_FALSE(is_step2_executed.load());
+}
+
+TEST(stop_token_test, test_stop_before_schedule)
+{
+  thread_pool<rr_scheduler> executor{1U};
+  stop_source source;
+  source.request_stop();
+
+  auto future = wait(then(schedule(executor.get_scheduler()),
+                          []() {
+                            ADD_FAILURE() << "Stopped 'then' executed!";
+                          }),
+                     source.get_token());
+  EXPECT_TRUE(future.get().is_canceled());
+}
+
+TEST(stop_token_test, test_stop_when_all)
+{
+  thread_pool<rr_scheduler> executor{1U};
+  timer timer_service;
+  stop_source source;
+
+  auto future = wait(when_all(schedule_after(timer_service, executor.get_scheduler(), 2s),
+                              schedule_after(timer_service, executor.get_scheduler(), 2s)),
+                     source.get_token());
+  EXPECT_EQ(2U, timer_service.size());
+
+  // The stop reaches the children of the combinator through its own stop source.
+  source.request_stop();
+  EXPECT_TRUE(future.get().is_canceled());
+  EXPECT_EQ(0U, timer_service.size());
+}
+
+TEST(stop_token_test, test_stop_bulk)
+{
+  static constexpr std::size_t count{1000000U};
+
+  thread_pool<rr_scheduler> executor{2U};
+  stop_source source;
+  std::atomic_size_t executed{0U};
+
+  auto future = wait(bulk(executor.get_scheduler(), count,
+                          [&source, &executed](std::size_t) {
+                            if (1000U == executed.fetch_add(1U, std::memory_order_relaxed)) {
+                              source.request_stop();
+                            }
+                          }),
+                     source.get_token());
+
+  EXPECT_TRUE(future.get().is_canceled());
+  // The runners stop at the next chunk boundary.
+  EXPECT_GT(count, executed.load());
+}
+
+}  // namespace jar::concurrency::test
@@ -0,0 +1,158 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file task_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "jar/concurrency/coroutine.hpp"
+#include "jar/concurrency/future.hpp"
+#include "jar/concurrency/latch.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/stop_token.hpp"
+#include "jar/concurrency/task.hpp"
+#include "jar/concurrency/then.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/timer.hpp"
+#include "jar/concurrency/wait.hpp"
+#include "jar/concurrency/ws_scheduler.hpp"
+
+namespace jar::concurrency::test {
+
+using namespace std::chrono_literals;
+
+TEST(task_test, test_await_sender)
+{
+  thread_pool<rr_scheduler> executor{1U};
+  auto const caller = std::this_thread::get_id();
+
+  auto handler = [](auto scheduler, std::thread::id caller) -> task<int> {
+    auto const value = co_await then(schedule(scheduler), []() {
+      return 42;
+    });
+    EXPECT_NE(caller, std::this_thread::get_id());
+    co_return value + 1;
+  };
+
+  auto future = wait(handler(executor.get_scheduler(), caller));
+  EXPECT_EQ(43, future.get().value());
+}
+
+TEST(task_test, test_await_future)
+{
+  promise<int> producer;
+
+  auto handler = [](future<int> input) -> task<int> {
+    co_return 2 * co_await std::move(input);
+  };
+
+  auto future = wait(handler(producer.get_future()));
+  producer.set_value(21);
+  EXPECT_EQ(42, future.get().value());
+}
+
+TEST(task_test, test_nested_tasks)
+{
+  struct sum {
+    static task<int> of(int n)
+    {
+      if (0 == n) {
+        co_return 0;
+      }
+      co_return n + co_await of(n - 1);
+    }
+  };
+
+  EXPECT_EQ(500500, wait(sum::of(1000)).get().value());
+}
+
+TEST(task_test, test_error)
+{
+  thread_pool<rr_scheduler> executor{1U};
+
+  auto inner = [](auto scheduler) -> task<void> {
+    co_await resume_on(scheduler);
+    throw std::runtime_error{"inner"};
+  };
+  auto outer = [inner](auto scheduler) -> task<void> {
+    co_await inner(scheduler);
+    ADD_FAILURE() << "Task resumed after the error!";
+  };
+
+  auto future = wait(outer(executor.get_scheduler()));
+  EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(task_test, test_stop)
+{
+  thread_pool<rr_scheduler> executor{1U};
+  stop_source source;
+  latch running{1U}, release{1U};
+
+  auto handler = [&running, &release](auto scheduler) -> task<void> {
+    co_await resume_on(scheduler);
+    running.count_down();
+    release.wait();
+    co_await resume_on(scheduler);
+    ADD_FAILURE() << "Stopped task resumed!";
+  };
+
+  auto future = wait(handler(executor.get_scheduler()), source.get_token());
+  running.wait();
+  source.request_stop();
+  release.count_down();
+  EXPECT_TRUE(future.get().is_canceled());
+}
+
+TEST(task_test, test_concurrent_handlers)
+{
+  static constexpr std::size_t count{100000U};
+
+  thread_pool<ws_scheduler> executor{4U};
+  timer timer_service;
+  std::atomic_size_t running{0U}, peak{0U};
+
+  auto handler = [&timer_service, &running, &peak](auto scheduler, std::size_t request) -> task<std::size_t> {
+    co_await resume_on(scheduler);
+    auto const now = running.fetch_add(1U) + 1U;
+    for (auto seen = peak.load(); seen < now && !peak.compare_exchange_weak(seen, now);) {
+    }
+    co_await schedule_after(timer_service, scheduler, 1ms);
+    running.fetch_sub(1U);
+    co_return request;
+  };
+
+  std::vector<future<std::size_t>> futures;
+  futures.reserve(count);
+  for (std::size_t request = 0U; request != count; ++request) {
+    futures.emplace_back(wait(handler(executor.get_scheduler(), request)));
+  }
+
+  std::size_t sum{0U};
+  for (auto& future : futures) {
+    sum += future.get().value();
+  }
+  EXPECT_EQ(count * (count - 1U) / 2U, sum);
+  // The handlers were suspended on the timer at the same time, none of them held a worker thread.
+  EXPECT_LT(4U, peak.load());
+}
+
+}  // namespace jar::concurrency::test
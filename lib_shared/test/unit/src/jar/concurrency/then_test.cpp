@@ -19,6 +19,7 @@
 #include <future>
 #include <memory>
 #include <string>
+#include <system_error>
 #include <tuple>
 
 #include "jar/concurrency/details/value_receiver.hpp"
@@ -61,6 +62,20 @@ TEST_F(then_test, test_complete)
   EXPECT_EQ(s_expected, *value.value());
 }
 
+TEST_F(then_test, test_error_code_value)
+{
+  auto const expected = std::make_error_code(std::errc::connection_reset);
+  auto step = then(schedule(executor().get_scheduler()), [expected]() {
+    return expected;
+  });
+
+  // A std::error_code result is a value, not the error channel.
+  auto future = wait(std::move(step));
+  auto const result = future.get();
+  EXPECT_FALSE(result.has_error());
+  EXPECT_EQ(expected, result.value());
+}
+
 TEST_F(then_test, test_fail)
 {
   std::atomic_bool step1_flag{false}, step2_flag{false}, step3_flag{false};
@@ -17,11 +17,24 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <condition_variable>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <stdexcept>
+#include <vector>
 
+#include "jar/concurrency/parallel_for.hpp"
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/schedule.hpp"
+#include "jar/concurrency/then.hpp"
 #include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/wait.hpp"
+#include "jar/concurrency/ws_scheduler.hpp"
 
 using ::testing::Return;
 
@@ -102,6 +115,29 @@ TEST(thread_pool_test, test_lifetime)
   }
 }
 
+TEST(thread_pool_test, test_placement)
+{
+  auto& instance = mock_scheduler::singleton::get_instance();
+
+  EXPECT_CALL(instance, constructor(2U)).Times(1U);
+  EXPECT_CALL(instance, scheduled()).Times(2U);
+  EXPECT_CALL(instance, clear()).Times(1U);
+  {
+    thread_pool<mock_scheduler> thread_pool{thread_pool_options{2U, placement_policy::compact}};
+    EXPECT_EQ(1U, thread_pool.partition_count());
+  }
+
+  auto const node_count = system_topology().size();
+  EXPECT_CALL(instance, constructor(::testing::_)).Times(node_count);
+  EXPECT_CALL(instance, scheduled()).Times(node_count);
+  EXPECT_CALL(instance, clear()).Times(node_count);
+  {
+    thread_pool_options const options{static_cast<unsigned>(node_count), placement_policy::numa};
+    thread_pool<mock_scheduler> thread_pool{options};
+    EXPECT_EQ(node_count, thread_pool.partition_count());
+  }
+}
+
 TEST(thread_pool_test, test_execution)
 {
   static constexpr unsigned thread_count{4U};
@@ -138,4 +174,171 @@ TEST(thread_pool_test, test_execution)
   }
 }
 
+namespace {
+
+/// \brief Elastic options with short periods, so that the tests see the pool grow and shrink quickly
+thread_pool_options elastic_pool_options(unsigned min_threads, unsigned max_threads)
+{
+  thread_pool_options options{min_threads, placement_policy::none, idle_strategy{}, elastic_options{}};
+  options.elastic.min_threads = min_threads;
+  options.elastic.max_threads = max_threads;
+  options.elastic.queue_age = std::chrono::milliseconds{2};
+  options.elastic.keep_alive = std::chrono::milliseconds{20};
+  return options;
+}
+
+/// \brief Computes a Fibonacci number by forking the left branch to the scheduler and waiting on it
+template <typename Scheduler> int fork_join_fibonacci(Scheduler scheduler, int n)
+{
+  if (n < 2) {
+    return n;
+  }
+
+  auto left = wait(then(schedule(scheduler), [scheduler, n]() {
+    return fork_join_fibonacci(scheduler, n - 1);
+  }));
+  auto const right = fork_join_fibonacci(scheduler, n - 2);
+  return left.get().value() + right;
+}
+
+template <typename Predicate> bool eventually(Predicate&& predicate)
+{
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(thread_pool_test, test_helping_wait)
+{
+  // A single worker waits on sub-tasks that are queued behind it, it runs them while it waits instead of deadlocking.
+  thread_pool<rr_scheduler> single{1U};
+  auto fibonacci = wait(then(schedule(single.get_scheduler()), [scheduler = single.get_scheduler()]() {
+    return fork_join_fibonacci(scheduler, 15);
+  }));
+  EXPECT_EQ(610, fibonacci.get().value());
+
+  thread_pool<ws_scheduler> stealing{2U};
+  fibonacci = wait(then(schedule(stealing.get_scheduler()), [scheduler = stealing.get_scheduler()]() {
+    return fork_join_fibonacci(scheduler, 18);
+  }));
+  EXPECT_EQ(2584, fibonacci.get().value());
+}
+
+TEST(thread_pool_test, test_nested_parallel_for)
+{
+  static constexpr std::size_t count{64U};
+
+  thread_pool<ws_scheduler> pool{2U};
+  auto scheduler = pool.get_scheduler();
+  std::atomic_size_t sum{0U};
+
+  parallel_for(scheduler, count, [scheduler, &sum](std::size_t) {
+    parallel_for(scheduler, count, [&sum](std::size_t index) {
+      sum.fetch_add(index, std::memory_order_relaxed);
+    });
+  });
+  EXPECT_EQ(count * count * (count - 1U) / 2U, sum.load());
+}
+
+TEST(thread_pool_test, test_elastic_precondition)
+{
+  EXPECT_THROW({ thread_pool<rr_ring_scheduler>{elastic_pool_options(4U, 2U)}; }, std::invalid_argument);
+  EXPECT_THROW({ thread_pool<mock_scheduler>{elastic_pool_options(1U, 2U)}; }, std::invalid_argument);
+
+  auto options = elastic_pool_options(1U, 2U);
+  options.placement = placement_policy::numa;
+  EXPECT_THROW({ thread_pool<rr_ring_scheduler>{options}; }, std::invalid_argument);
+}
+
+TEST(thread_pool_test, test_elastic_growth_and_retirement)
+{
+  static constexpr unsigned max_threads{4U};
+
+  std::promise<void> release;
+  auto const released = release.get_future().share();
+  std::atomic_uint running{0U};
+
+  thread_pool<rr_ring_scheduler> pool{elastic_pool_options(1U, max_threads)};
+  EXPECT_EQ(1U, pool.thread_count());
+
+  // Blocking tasks stall the queue, the supervisor adds workers until every task runs.
+  auto scheduler = pool.get_scheduler();
+  for (unsigned n = 0U; n != max_threads; ++n) {
+    scheduler.schedule([&running, released]() {
+      running.fetch_add(1U);
+      released.wait();
+    });
+  }
+
+  EXPECT_TRUE(eventually([&running]() {
+    return max_threads == running.load();
+  }));
+  EXPECT_EQ(max_threads, pool.thread_count());
+
+  // Idle workers retire after the keep-alive period, down to the minimum.
+  release.set_value();
+  EXPECT_TRUE(eventually([&pool]() {
+    return 1U == pool.thread_count();
+  }));
+}
+
+TEST(thread_pool_test, test_elastic_churn)
+{
+  static constexpr unsigned round_count{4U};
+
+  thread_pool<ws_scheduler> pool{elastic_pool_options(0U, 1U)};
+  auto scheduler = pool.get_scheduler();
+
+  for (unsigned round = 0U; round != round_count; ++round) {
+    // Wait until the worker has retired, the next task respawns it into the same slot.
+    EXPECT_TRUE(eventually([&pool]() {
+      return 0U == pool.thread_count();
+    }));
+
+    // A respawned worker owns the deque of its slot, so the tasks it schedules are popped in LIFO order.
+    std::promise<std::vector<int>> done;
+    scheduler.schedule([scheduler, &done]() mutable {
+      auto order = std::make_shared<std::vector<int>>();
+      scheduler.schedule([order, &done]() {
+        order->push_back(1);
+        done.set_value(*order);
+      });
+      scheduler.schedule([order]() {
+        order->push_back(2);
+      });
+    });
+    EXPECT_EQ((std::vector<int>{2, 1}), done.get_future().get());
+  }
+}
+
+TEST(thread_pool_test, test_elastic_shutdown)
+{
+  static constexpr unsigned task_count{1000U};
+
+  std::atomic_uint count{0U};
+  {
+    thread_pool<rr_ring_scheduler> pool{elastic_pool_options(0U, 4U)};
+    EXPECT_EQ(0U, pool.thread_count());
+
+    auto scheduler = pool.get_scheduler();
+    for (unsigned n = 0U; n != task_count; ++n) {
+      scheduler.schedule([&count]() {
+        count.fetch_add(1U);
+      });
+    }
+
+    EXPECT_TRUE(eventually([&count]() {
+      return task_count == count.load();
+    }));
+  }
+  EXPECT_EQ(task_count, count.load());
+}
+
 }  // namespace jar::concurrency::test
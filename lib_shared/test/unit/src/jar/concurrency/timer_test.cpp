@@ -0,0 +1,312 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file timer_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/stop_token.hpp"
+#include "jar/concurrency/then.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/timer.hpp"
+#include "jar/concurrency/wait.hpp"
+
+namespace jar::concurrency::test {
+
+using namespace std::chrono_literals;
+
+TEST(timer_test, test_precondition)
+{
+  EXPECT_THROW({ timer{timer::clock::duration::zero()}; }, std::invalid_argument);
+
+  timer timer_service{1ms};
+  EXPECT_THROW(timer_service.schedule_every(100us, []() {}), std::invalid_argument);
+}
+
+TEST(timer_test, test_schedule_after)
+{
+  timer timer_service;
+  std::promise<timer::clock::time_point> fired;
+  auto fired_at = fired.get_future();
+
+  auto const scheduled = timer::clock::now();
+  timer_service.schedule_after(20ms, [&fired]() {
+    fired.set_value(timer::clock::now());
+  });
+
+  EXPECT_GE(fired_at.get() - scheduled, 20ms);
+  EXPECT_EQ(0U, timer_service.size());
+}
+
+TEST(timer_test, test_deadline_order)
+{
+  static constexpr unsigned timer_count{5U};
+
+  timer timer_service;
+  std::mutex mutex;
+  std::vector<unsigned> order;
+  std::promise<void> done;
+
+  auto const now = timer::clock::now();
+  for (unsigned n = timer_count; n != 0U; --n) {
+    timer_service.schedule_at(now + n * 5ms, [&mutex, &order, &done, n]() {
+      std::lock_guard<std::mutex> lock{mutex};
+      order.push_back(n);
+      if (timer_count == order.size()) {
+        done.set_value();
+      }
+    });
+  }
+
+  done.get_future().wait();
+  EXPECT_EQ((std::vector<unsigned>{1U, 2U, 3U, 4U, 5U}), order);
+}
+
+TEST(timer_test, test_cancel)
+{
+  timer timer_service;
+  std::atomic_bool has_run{false};
+
+  auto const cancelled = timer_service.schedule_after(10ms, [&has_run]() {
+    has_run.store(true);
+  });
+  EXPECT_EQ(1U, timer_service.size());
+  EXPECT_TRUE(timer_service.cancel(cancelled));
+  EXPECT_FALSE(timer_service.cancel(cancelled));
+  EXPECT_EQ(0U, timer_service.size());
+
+  std::promise<void> fired;
+  auto const expired = timer_service.schedule_after(1ms, [&fired]() {
+    fired.set_value();
+  });
+  fired.get_future().wait();
+  std::this_thread::sleep_for(20ms);
+
+  EXPECT_FALSE(timer_service.cancel(expired));
+  EXPECT_FALSE(has_run.load());
+}
+
+TEST(timer_test, test_periodic)
+{
+  static constexpr unsigned run_count{3U};
+
+  timer timer_service;
+  std::atomic_uint count{0U};
+  std::promise<void> done;
+
+  auto const periodic = timer_service.schedule_every(2ms, [&count, &done]() {
+    if (run_count == count.fetch_add(1U) + 1U) {
+      done.set_value();
+    }
+  });
+
+  done.get_future().wait();
+  EXPECT_TRUE(timer_service.cancel(periodic));
+
+  auto const cancelled_at = count.load();
+  std::this_thread::sleep_for(20ms);
+  EXPECT_LE(count.load(), cancelled_at + 1U);
+  EXPECT_EQ(0U, timer_service.size());
+}
+
+TEST(timer_test, test_task_destructor)
+{
+  /// \brief Schedules and cancels timers on the same timer when the last reference to it is dropped
+  struct rescheduler {
+    rescheduler(timer& service, std::shared_ptr<std::promise<void>> promise)
+      : timer_service{service}
+      , done{std::move(promise)}
+    {
+    }
+
+    rescheduler(rescheduler const&) = delete;
+    rescheduler& operator=(rescheduler const&) = delete;
+
+    ~rescheduler()
+    {
+      timer_service.cancel(timer_service.schedule_after(1h, []() {}));
+      timer_service.schedule_after(1ms, [this_done = done]() { this_done->set_value(); });
+    }
+
+    timer& timer_service;
+    std::shared_ptr<std::promise<void>> done;
+  };
+
+  timer timer_service;
+  auto done = std::make_shared<std::promise<void>>();
+  auto rescheduled = done->get_future();
+
+  auto owner = std::make_shared<rescheduler>(timer_service, done);
+  timer_service.schedule_after(1ms, [owner]() {});
+  auto const periodic = timer_service.schedule_every(1ms, [owner]() {});
+  owner.reset();
+
+  std::this_thread::sleep_for(10ms);
+  EXPECT_TRUE(timer_service.cancel(periodic));
+  EXPECT_EQ(std::future_status::ready, rescheduled.wait_for(1s));
+}
+
+TEST(timer_test, test_cascading)
+{
+  // With a microsecond resolution the deadlines land on the upper levels of the wheel and are cascaded down.
+  timer timer_service{1us};
+
+  std::mutex mutex;
+  std::vector<timer::clock::duration> lateness;
+  std::promise<void> done;
+
+  auto const now = timer::clock::now();
+  std::vector<timer::clock::duration> const delays{50us, 3ms, 70ms, 300ms};
+  for (auto const delay : delays) {
+    timer_service.schedule_at(now + delay, [&, deadline = now + delay]() {
+      std::lock_guard<std::mutex> lock{mutex};
+      lateness.push_back(timer::clock::now() - deadline);
+      if (delays.size() == lateness.size()) {
+        done.set_value();
+      }
+    });
+  }
+
+  // A far away timer must neither fire nor disturb the others.
+  auto const far = timer_service.schedule_after(24h, []() {});
+
+  done.get_future().wait();
+  for (auto const late : lateness) {
+    EXPECT_GE(late, timer::clock::duration::zero());
+  }
+  EXPECT_EQ(1U, timer_service.size());
+  EXPECT_TRUE(timer_service.cancel(far));
+}
+
+TEST(timer_test, test_many_timers)
+{
+  static constexpr unsigned timer_count{10000U};
+
+  timer timer_service;
+  std::atomic_uint count{0U};
+
+  std::mt19937 generator{42U};
+  std::uniform_int_distribution<int> delay{1, 50};
+  std::vector<timer::handle> handles;
+  for (unsigned n = 0U; n != timer_count; ++n) {
+    handles.push_back(timer_service.schedule_after(std::chrono::milliseconds{delay(generator)}, [&count]() {
+      count.fetch_add(1U);
+    }));
+  }
+
+  // Cancel every other timer, only the rest runs.
+  unsigned cancelled{0U};
+  for (std::size_t n = 0U; n < handles.size(); n += 2U) {
+    cancelled += timer_service.cancel(handles[n]) ? 1U : 0U;
+  }
+
+  auto const deadline = timer::clock::now() + 10s;
+  while (timer_count - cancelled != count.load() && timer::clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_EQ(timer_count - cancelled, count.load());
+  EXPECT_EQ(0U, timer_service.size());
+}
+
+TEST(timer_test, test_schedule_after_sender)
+{
+  thread_pool<rr_scheduler> pool{2U};
+  timer timer_service;
+
+  auto const scheduled = timer::clock::now();
+  auto sender = then(schedule_after(timer_service, pool.get_scheduler(), 10ms), []() {
+    return timer::clock::now();
+  });
+
+  auto future = wait(std::move(sender));
+  auto const result = future.get();
+  EXPECT_GE(result.value() - scheduled, 10ms);
+}
+
+TEST(timer_test, test_schedule_at_sender)
+{
+  thread_pool<rr_scheduler> pool{2U};
+  timer timer_service;
+
+  auto const deadline = timer::clock::now() + 5ms;
+  auto future = wait(then(schedule_at(timer_service, pool.get_scheduler(), deadline), []() {
+    return 42;
+  }));
+  EXPECT_EQ(42, future.get().value());
+  EXPECT_GE(timer::clock::now(), deadline);
+}
+
+TEST(timer_test, test_stop_sender)
+{
+  thread_pool<rr_scheduler> pool{2U};
+  timer timer_service;
+
+  // A stop request cancels a long timer right away instead of holding it until the deadline.
+  stop_source source;
+  auto future = wait(schedule_after(timer_service, pool.get_scheduler(), 1h), source.get_token());
+  EXPECT_EQ(1U, timer_service.size());
+
+  auto const stopped = timer::clock::now();
+  source.request_stop();
+  auto const result = future.get();
+  EXPECT_TRUE(result.is_canceled());
+  EXPECT_LT(timer::clock::now() - stopped, 1s);
+  EXPECT_EQ(0U, timer_service.size());
+
+  // A timer that is stopped before it is armed is never scheduled, an expired one is not affected by a later stop.
+  future = wait(schedule_after(timer_service, pool.get_scheduler(), 1h), source.get_token());
+  EXPECT_TRUE(future.get().is_canceled());
+  EXPECT_EQ(0U, timer_service.size());
+
+  stop_source late;
+  future = wait(schedule_after(timer_service, pool.get_scheduler(), 1ms), late.get_token());
+  auto const expired = future.get();
+  EXPECT_FALSE(expired.is_canceled());
+  late.request_stop();
+}
+
+TEST(timer_test, test_stop_sender_race)
+{
+  static constexpr std::size_t timer_count{200U};
+
+  thread_pool<rr_scheduler> pool{2U};
+  timer timer_service;
+
+  // Stop requests race with expiring deadlines, every receiver is completed or canceled exactly once.
+  std::size_t canceled{0U};
+  for (std::size_t n = 0U; n != timer_count; ++n) {
+    stop_source source;
+    auto future = wait(schedule_after(timer_service, pool.get_scheduler(), std::chrono::microseconds{n * 10U}),
+                       source.get_token());
+    std::this_thread::sleep_for(std::chrono::microseconds{(timer_count - n) * 5U});
+    source.request_stop();
+    auto const result = future.get();
+    canceled += result.is_canceled() ? 1U : 0U;
+  }
+  EXPECT_GE(timer_count, canceled);
+  EXPECT_EQ(0U, timer_service.size());
+}
+
+}  // namespace jar::concurrency::test
@@ -0,0 +1,98 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file unique_task_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <array>
+#include <functional>
+#include <memory>
+
+#include "jar/concurrency/unique_task.hpp"
+
+namespace jar::concurrency::test {
+
+TEST(unique_task_test, test_empty)
+{
+  unique_task task;
+  EXPECT_FALSE(task);
+  EXPECT_THROW(task(), std::bad_function_call);
+
+  unique_task null_task{nullptr};
+  EXPECT_FALSE(null_task);
+}
+
+TEST(unique_task_test, test_inline_storage)
+{
+  auto small = [value = std::array<char, 48U>{}]() {
+    static_cast<void>(value);
+  };
+  auto large = [value = std::array<char, 128U>{}]() {
+    static_cast<void>(value);
+  };
+
+  EXPECT_TRUE(unique_task::is_inline<decltype(small)>);
+  EXPECT_FALSE(unique_task::is_inline<decltype(large)>);
+  EXPECT_TRUE(basic_unique_task<128U>::is_inline<decltype(large)>);
+}
+
+TEST(unique_task_test, test_move_only_callable)
+{
+  int result{0};
+  auto pointer = std::make_unique<int>(42);
+
+  unique_task task{[&result, pointer = std::move(pointer)]() {
+    result = *pointer;
+  }};
+  ASSERT_TRUE(task);
+
+  unique_task moved{std::move(task)};
+  EXPECT_FALSE(task);
+  ASSERT_TRUE(moved);
+
+  moved();
+  EXPECT_EQ(42, result);
+}
+
+TEST(unique_task_test, test_lifetime)
+{
+  auto counter = std::make_shared<int>(0);
+  std::array<char, 128U> padding{};
+
+  {
+    unique_task small{[counter]() {
+      ++*counter;
+    }};
+    unique_task large{[counter, padding]() {
+      static_cast<void>(padding);
+      ++*counter;
+    }};
+    EXPECT_EQ(3, counter.use_count());
+
+    small();
+    large();
+    EXPECT_EQ(2, *counter);
+
+    small = std::move(large);
+    EXPECT_EQ(2, counter.use_count());
+
+    small();
+    EXPECT_EQ(3, *counter);
+  }
+
+  EXPECT_EQ(1, counter.use_count());
+}
+
+}  // namespace jar::concurrency::test
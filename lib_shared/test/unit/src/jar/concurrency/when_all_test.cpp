@@ -0,0 +1,180 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file when_all_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "jar/concurrency/details/value_receiver.hpp"
+
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/schedule.hpp"
+#include "jar/concurrency/then.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/timer.hpp"
+#include "jar/concurrency/wait.hpp"
+#include "jar/concurrency/when_all.hpp"
+
+namespace jar::concurrency::test {
+
+using namespace std::chrono_literals;
+
+class when_all_test : public ::testing::Test {
+public:
+  static constexpr int s_expected{256};
+
+  thread_pool<rr_scheduler>& executor() { return m_executor; }
+
+private:
+  thread_pool<rr_scheduler> m_executor;
+};
+
+TEST_F(when_all_test, test_complete)
+{
+  auto sender = when_all(then(schedule(executor().get_scheduler()),
+                              []() {
+                                return s_expected;
+                              }),
+                         schedule(executor().get_scheduler()),
+                         then(schedule(executor().get_scheduler()), []() {
+                           return std::to_string(s_expected);
+                         }));
+  static_assert(std::is_same_v<std::tuple<int, std::monostate, std::string>, decltype(sender)::result_type>);
+
+  auto future = wait(std::move(sender));
+  auto value = future.get();
+  EXPECT_EQ(s_expected, std::get<0>(value.value()));
+  EXPECT_EQ(std::to_string(s_expected), std::get<2>(value.value()));
+}
+
+TEST_F(when_all_test, test_fail)
+{
+  timer timer_service;
+  std::atomic_bool is_executed{false};
+
+  auto future = wait(when_all(then(schedule(executor().get_scheduler()),
+                                   []() -> int {
+                                     throw std::runtime_error{"expected test error"};
+                                   }),
+                              then(schedule_after(timer_service, executor().get_scheduler(), 50ms), [&is_executed]() {
+                                is_executed.store(true);
+                              })));
+
+  EXPECT_THROW(future.get(), std::runtime_error);
+  EXPECT_FALSE(is_executed.load());
+}
+
+TEST_F(when_all_test, test_stop_timer)
+{
+  timer timer_service;
+
+  auto const started = timer::clock::now();
+  auto future = wait(when_all(schedule_after(timer_service, executor().get_scheduler(), 2s),
+                              then(schedule(executor().get_scheduler()), []() -> int {
+                                throw std::runtime_error{"expected test error"};
+                              })));
+
+  // The failure cancels the timer child, it does not wait for the deadline.
+  EXPECT_THROW(future.get(), std::runtime_error);
+  EXPECT_LT(timer::clock::now() - started, 1s);
+  EXPECT_EQ(0U, timer_service.size());
+}
+
+/// \brief A sender that signals an error code without throwing
+class error_sender {
+  template <typename Receiver> class state {
+  public:
+    explicit state(Receiver&& receiver)
+      : m_receiver{std::move(receiver)}
+    {
+    }
+
+    void start() { details::set_error(m_receiver, std::make_error_code(std::errc::connection_reset)); }
+
+  private:
+    Receiver m_receiver;
+  };
+
+public:
+  using result_type = int;
+
+  template <typename Receiver> auto connect(Receiver&& receiver)
+  {
+    return state<std::decay_t<Receiver>>{std::forward<Receiver>(receiver)};
+  }
+};
+
+TEST_F(when_all_test, test_error_code)
+{
+  auto future = wait(when_all(error_sender{}, then(schedule(executor().get_scheduler()), []() {
+                                return s_expected;
+                              })));
+
+  auto const result = future.get();
+  EXPECT_TRUE(result.has_error());
+  EXPECT_EQ(std::make_error_code(std::errc::connection_reset), result.error());
+}
+
+TEST_F(when_all_test, test_cancel)
+{
+  auto sender = when_all(then(schedule(executor().get_scheduler()),
+                              []() -> int {
+                                ADD_FAILURE() << "Canceled 'when_all' executed!";
+                                return 0;
+                              }),
+                         schedule(executor().get_scheduler()));
+
+  details::value_receiver<decltype(sender)::result_type> receiver{};
+  auto future = receiver.get_future();
+
+  auto state = sender.connect(std::move(receiver));
+  future.cancel();
+  state.start();
+
+  EXPECT_TRUE(future.get().is_canceled());
+}
+
+TEST_F(when_all_test, test_concurrent)
+{
+  static constexpr int operation_count{1000};
+
+  std::vector<future<std::tuple<int, int>>> futures;
+  futures.reserve(operation_count);
+  for (int n = 0; n != operation_count; ++n) {
+    futures.emplace_back(wait(when_all(then(schedule(executor().get_scheduler()),
+                                            [n]() {
+                                              return n;
+                                            }),
+                                       then(schedule(executor().get_scheduler()), [n]() {
+                                         return -n;
+                                       }))));
+  }
+
+  for (int n = 0; n != operation_count; ++n) {
+    auto value = futures[n].get();
+    EXPECT_EQ(std::make_tuple(n, -n), value.value());
+  }
+}
+
+}  // namespace jar::concurrency::test
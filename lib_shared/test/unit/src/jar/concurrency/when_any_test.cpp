@@ -0,0 +1,141 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file when_any_test.cpp
+///
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <variant>
+
+#include "jar/concurrency/details/value_receiver.hpp"
+
+#include "jar/concurrency/rr_scheduler.hpp"
+#include "jar/concurrency/schedule.hpp"
+#include "jar/concurrency/then.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/timer.hpp"
+#include "jar/concurrency/wait.hpp"
+#include "jar/concurrency/when_any.hpp"
+
+namespace jar::concurrency::test {
+
+using namespace std::chrono_literals;
+
+class when_any_test : public ::testing::Test {
+public:
+  static constexpr int s_expected{256};
+
+  thread_pool<rr_scheduler>& executor() { return m_executor; }
+  timer& timer_service() { return m_timer; }
+
+private:
+  thread_pool<rr_scheduler> m_executor;
+  timer m_timer;
+};
+
+TEST_F(when_any_test, test_first_completes)
+{
+  std::atomic_bool is_executed{false};
+
+  auto future = wait(when_any(then(schedule_after(timer_service(), executor().get_scheduler(), 50ms),
+                                   [&is_executed]() {
+                                     is_executed.store(true);
+                                     return 0;
+                                   }),
+                              then(schedule(executor().get_scheduler()), []() {
+                                return s_expected;
+                              })));
+
+  EXPECT_EQ(s_expected, future.get().value());
+  std::this_thread::sleep_for(100ms);
+  EXPECT_FALSE(is_executed.load());
+}
+
+TEST_F(when_any_test, test_variant)
+{
+  auto sender = when_any(then(schedule_after(timer_service(), executor().get_scheduler(), 50ms),
+                              []() {
+                                return 0;
+                              }),
+                         then(schedule(executor().get_scheduler()), []() {
+                           return std::to_string(s_expected);
+                         }));
+  static_assert(std::is_same_v<std::variant<int, std::string>, decltype(sender)::result_type>);
+
+  auto future = wait(std::move(sender));
+  auto value = future.get();
+  ASSERT_EQ(1U, value.value().index());
+  EXPECT_EQ(std::to_string(s_expected), std::get<1>(value.value()));
+}
+
+TEST_F(when_any_test, test_fail)
+{
+  auto future = wait(when_any(then(schedule(executor().get_scheduler()),
+                                   []() -> int {
+                                     throw std::runtime_error{"expected test error"};
+                                   }),
+                              then(schedule_after(timer_service(), executor().get_scheduler(), 20ms), []() {
+                                return s_expected;
+                              })));
+
+  // An error is delivered only if no sender completes.
+  EXPECT_EQ(s_expected, future.get().value());
+
+  future = wait(when_any(then(schedule(executor().get_scheduler()),
+                              []() -> int {
+                                throw std::runtime_error{"expected test error"};
+                              }),
+                         then(schedule(executor().get_scheduler()), []() -> int {
+                           throw std::logic_error{"expected test error"};
+                         })));
+
+  EXPECT_THROW(future.get(), std::exception);
+}
+
+TEST_F(when_any_test, test_stop_timer)
+{
+  auto const started = timer::clock::now();
+  auto future = wait(when_any(schedule_after(timer_service(), executor().get_scheduler(), 2s),
+                              schedule(executor().get_scheduler())));
+
+  // The timer child is canceled once the other child completes, it does not wait for the deadline.
+  auto const result = future.get();
+  EXPECT_FALSE(result.is_canceled());
+  EXPECT_FALSE(result.has_error());
+  EXPECT_LT(timer::clock::now() - started, 1s);
+  EXPECT_EQ(0U, timer_service().size());
+}
+
+TEST_F(when_any_test, test_cancel)
+{
+  auto sender = when_any(schedule(executor().get_scheduler()), schedule(executor().get_scheduler()));
+  static_assert(std::is_same_v<void, decltype(sender)::result_type>);
+
+  details::value_receiver<void> receiver{};
+  auto future = receiver.get_future();
+
+  auto state = sender.connect(std::move(receiver));
+  future.cancel();
+  state.start();
+
+  EXPECT_TRUE(future.get().is_canceled());
+}
+
+}  // namespace jar::concurrency::test
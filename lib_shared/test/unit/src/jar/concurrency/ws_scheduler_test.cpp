@@ -0,0 +1,164 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file ws_scheduler_test.cpp
+///
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include "jar/concurrency/latch.hpp"
+#include "jar/concurrency/thread_pool.hpp"
+#include "jar/concurrency/ws_scheduler.hpp"
+
+namespace jar::concurrency::test {
+
+class mock_ws_task {
+public:
+  MOCK_METHOD(void, op, (), ());
+  void operator()() { op(); }
+
+  MOCK_METHOD(void, op_int, (int), ());
+  void operator()(int arg) { op_int(arg); }
+};
+
+TEST(ws_scheduler_test, test_precondition)
+{
+  EXPECT_THROW({ ws_scheduler{0U}; }, std::invalid_argument);
+}
+
+TEST(ws_scheduler_test, test_traits)
+{
+  EXPECT_TRUE(is_input_scheduler<ws_scheduler>::value);
+  EXPECT_TRUE(is_output_scheduler<ws_scheduler>::value);
+  EXPECT_TRUE(has_scheduler_adapter<ws_scheduler>::value);
+  EXPECT_TRUE(has_worker_attach<ws_scheduler>::value);
+}
+
+TEST(ws_scheduler_test, test_attach)
+{
+  ws_scheduler sched{1U};
+
+  // The first thread takes the only deque, a later thread schedules through the shared injection queue in FIFO order.
+  std::thread{[&sched]() {
+    EXPECT_EQ(std::nullopt, sched.try_scheduled());
+  }}.join();
+
+  auto const first_popped = [&sched](bool attach) {
+    if (attach) {
+      sched.attach(0U);
+    }
+    std::atomic_int popped{0};
+    sched.schedule([&popped]() {
+      popped.store(1);
+    });
+    sched.schedule([&popped]() {
+      popped.store(2);
+    });
+    sched.try_scheduled().value()();
+    sched.try_scheduled().value()();
+    return popped.load();
+  };
+  EXPECT_EQ(2, std::async(std::launch::async, first_popped, false).get());
+
+  // An attached thread owns the deque of the retired thread and pops its own tasks in LIFO order.
+  EXPECT_EQ(1, std::async(std::launch::async, first_popped, true).get());
+}
+
+TEST(ws_scheduler_test, test_scheduling)
+{
+  static constexpr unsigned task_count{3U};
+
+  ws_scheduler sched{1U};
+  mock_ws_task task1, task2, task3;
+
+  EXPECT_CALL(task1, op).Times(1U);
+  EXPECT_CALL(task2, op()).Times(1U);
+  EXPECT_CALL(task3, op()).Times(1U);
+
+  sched.schedule(std::ref(task1));
+  sched.schedule(std::ref(task2));
+  sched.schedule(std::ref(task3));
+
+  auto worker = std::async(std::launch::async, [&sched]() {
+    for (unsigned n = 0U; n < task_count; ++n) {
+      auto task = sched.scheduled();
+      task.value()();
+    }
+  });
+
+  EXPECT_NO_THROW(worker.get());
+}
+
+TEST(ws_scheduler_test, test_clear)
+{
+  ws_scheduler sched{1U};
+
+  auto worker = std::async(std::launch::async, [&sched]() {
+    EXPECT_EQ(std::nullopt, sched.scheduled());
+  });
+
+  sched.clear();
+  EXPECT_NO_THROW(worker.get());
+}
+
+TEST(ws_scheduler_test, test_scheduling_with_adapter)
+{
+  static constexpr int arg{1024};
+  ws_scheduler sched{1U};
+  mock_ws_task task1, task2;
+
+  EXPECT_CALL(task1, op).Times(1U);
+  EXPECT_CALL(task2, op_int(arg)).Times(1U);
+
+  auto adapter = sched.get_adapter();
+  EXPECT_NO_THROW(adapter.schedule(std::ref(task1)));
+  EXPECT_NO_THROW(adapter.schedule(std::ref(task2), arg));
+
+  auto worker = std::async(std::launch::async, [&sched]() {
+    sched.scheduled().value()();
+    sched.scheduled().value()();
+  });
+
+  EXPECT_NO_THROW(worker.get());
+}
+
+TEST(ws_scheduler_test, test_nested_scheduling_in_thread_pool)
+{
+  static constexpr unsigned fan_out{64U};
+
+  // Declared before the pool so that the workers are joined before the latch is destroyed.
+  latch done{fan_out * fan_out};
+  thread_pool<ws_scheduler> pool{4U};
+  auto scheduler = pool.get_scheduler();
+
+  for (unsigned n = 0U; n < fan_out; ++n) {
+    scheduler.schedule([scheduler, &done]() mutable {
+      // Tasks scheduled from a worker go to the worker's own deque, idle workers steal them.
+      for (unsigned m = 0U; m < fan_out; ++m) {
+        scheduler.schedule([&done]() {
+          done.count_down();
+        });
+      }
+    });
+  }
+
+  EXPECT_NO_THROW(done.wait());
+}
+
+}  // namespace jar::concurrency::test
@@ -0,0 +1,524 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file async.hpp
+///
+
+#ifndef JAR_COM_ASYNC_HPP
+#define JAR_COM_ASYNC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <jar/concurrency/details/block_pool.hpp>
+#include <jar/concurrency/details/error_channel.hpp>
+#include <jar/concurrency/stop_token.hpp>
+#include <jar/concurrency/type_traits.hpp>
+#include <jar/core/contract.hpp>
+
+#include "jar/com/basic_stream_socket.hpp"
+#include "jar/com/proactor.hpp"
+#include "jar/com/reactor.hpp"
+#include "jar/com/stream_server_socket.hpp"
+#include "jar/com/stream_socket.hpp"
+
+namespace jar::com {
+namespace details {
+
+/// \brief A non-blocking receive from a stream socket
+template <typename Socket, typename Protocol> class receive_operation {
+public:
+  using result_type = std::size_t;
+  using socket_type = basic_stream_socket<Socket, Protocol>;
+
+  inline static constexpr reactor::event_mask s_interest{reactor::readable};
+
+  receive_operation(socket_type& socket, std::uint8_t* buffer, std::size_t length) noexcept
+    : m_socket{&socket}
+    , m_buffer{buffer}
+    , m_length{length}
+  {
+  }
+
+  socket_type& socket() const noexcept { return *m_socket; }
+
+  result_type operator()(std::error_code& error) { return m_socket->receive(m_buffer, m_length, error); }
+
+  template <typename Scheduler, typename Handler>
+  proactor::handle submit(proactor& io, Scheduler scheduler, Handler&& handler)
+  {
+    return io.receive(*m_socket, m_buffer, m_length, std::move(scheduler), std::forward<Handler>(handler));
+  }
+
+private:
+  socket_type* m_socket;
+  std::uint8_t* m_buffer;
+  std::size_t m_length;
+};
+
+/// \brief A non-blocking send to a stream socket
+template <typename Socket, typename Protocol> class send_operation {
+public:
+  using result_type = std::size_t;
+  using socket_type = basic_stream_socket<Socket, Protocol>;
+
+  inline static constexpr reactor::event_mask s_interest{reactor::writable};
+
+  send_operation(socket_type& socket, std::uint8_t const* buffer, std::size_t length) noexcept
+    : m_socket{&socket}
+    , m_buffer{buffer}
+    , m_length{length}
+  {
+  }
+
+  socket_type& socket() const noexcept { return *m_socket; }
+
+  result_type operator()(std::error_code& error) { return m_socket->send(m_buffer, m_length, error); }
+
+  template <typename Scheduler, typename Handler>
+  proactor::handle submit(proactor& io, Scheduler scheduler, Handler&& handler)
+  {
+    return io.send(*m_socket, m_buffer, m_length, std::move(scheduler), std::forward<Handler>(handler));
+  }
+
+private:
+  socket_type* m_socket;
+  std::uint8_t const* m_buffer;
+  std::size_t m_length;
+};
+
+/// \brief A non-blocking accept from a listening stream server socket
+template <typename Socket, typename Protocol> class accept_operation {
+public:
+  using result_type = stream_socket<Socket, Protocol>;
+  using socket_type = stream_server_socket<Socket, Protocol>;
+
+  inline static constexpr reactor::event_mask s_interest{reactor::readable};
+
+  explicit accept_operation(socket_type& socket) noexcept
+    : m_socket{&socket}
+  {
+  }
+
+  socket_type& socket() const noexcept { return *m_socket; }
+
+  result_type operator()(std::error_code& error) noexcept { return m_socket->accept(error); }
+
+  template <typename Scheduler, typename Handler>
+  proactor::handle submit(proactor& io, Scheduler scheduler, Handler&& handler)
+  {
+    return io.accept(*m_socket, std::move(scheduler), std::forward<Handler>(handler));
+  }
+
+private:
+  socket_type* m_socket;
+};
+
+/// \brief Completes the receiver with the result of an operation, or with its error code
+template <typename Receiver, typename Result>
+void complete_io(Receiver& receiver, Result&& result, std::error_code error) noexcept
+{
+  if (error) {
+    concurrency::details::set_error(receiver, error);
+    return;
+  }
+
+  try {
+    receiver.complete(std::forward<Result>(result));
+  } catch (...) {
+    receiver.fail(std::current_exception());
+  }
+}
+
+/// \brief The block shared by a waiting operation and the stop callback of its receiver
+///
+/// Allocated from the block pool when the receiver can be stopped. The completion of the operation and a stop request
+/// race to claim the receiver: a stop request removes the reactor registration, or cancels the proactor operation, and
+/// cancels the receiver right away instead of when the socket becomes ready. The countdown keeps the block alive for
+/// the arming thread, the handler and the claim; the stop callback is deregistered when the block is destroyed.
+template <typename Receiver, typename Context, typename Operation> class io_block {
+  using handle_type = std::conditional_t<std::is_same_v<Context, proactor>, proactor::handle, reactor::handle>;
+
+  struct on_stop {
+    void operator()() const noexcept { block->stop(); }
+
+    io_block* block;
+  };
+
+  /// \brief The reference of the handler, arrives when the handler is destroyed, whether it ran or not
+  class handler_reference {
+  public:
+    explicit handler_reference(io_block* block) noexcept
+      : m_block{block}
+    {
+    }
+
+    handler_reference(handler_reference const&) = delete;
+    handler_reference(handler_reference&& other) noexcept
+      : m_block{std::exchange(other.m_block, nullptr)}
+    {
+    }
+
+    handler_reference& operator=(handler_reference const&) = delete;
+    handler_reference& operator=(handler_reference&&) = delete;
+
+    ~handler_reference()
+    {
+      if (nullptr != m_block) {
+        m_block->drop();
+      }
+    }
+
+    io_block* operator->() const noexcept { return m_block; }
+
+  private:
+    io_block* m_block;
+  };
+
+public:
+  static io_block* create(Receiver&& receiver, Context& io, Operation const& operation)
+  {
+    auto* block = concurrency::details::state_pool<io_block>::allocate();
+    try {
+      return ::new (block) io_block{std::move(receiver), io, operation};
+    } catch (...) {
+      concurrency::details::state_pool<io_block>::deallocate(block);
+      throw;
+    }
+  }
+
+  /// \brief Starts waiting and registers the stop callback, consumes the reference of the arming thread
+  template <typename Scheduler> void arm(Scheduler&& scheduler)
+  {
+    // The token is taken first, the handler may complete the receiver before the wait has been registered.
+    auto const token = concurrency::details::get_stop_token(m_receiver);
+    try {
+      if constexpr (std::is_same_v<Context, proactor>) {
+        m_handle = m_operation.submit(*m_context, std::move(scheduler),
+                                      [reference = handler_reference{this}](std::error_code error, auto&& result) {
+                                        reference->finish(std::forward<decltype(result)>(result), error);
+                                      });
+      } else {
+        auto const descriptor = reactor::descriptor(m_operation.socket());
+        m_handle = m_context->add(descriptor, Operation::s_interest, std::move(scheduler),
+                                  [reference = handler_reference{this}](reactor::event_mask, reactor::handle handle) {
+                                    reference->resume(handle);
+                                  });
+      }
+    } catch (...) {
+      arrive();
+      throw;
+    }
+
+    // A stop that has been requested already runs the callback right here.
+    m_on_stop.emplace(token, on_stop{this});
+    arrive();
+  }
+
+private:
+  io_block(Receiver&& receiver, Context& io, Operation const& operation)
+    : m_pending{3U}
+    , m_is_claimed{false}
+    , m_receiver{std::move(receiver)}
+    , m_context{&io}
+    , m_operation{operation}
+    , m_handle{}
+    , m_on_stop{}
+  {
+  }
+
+  bool claim() noexcept { return !m_is_claimed.exchange(true, std::memory_order_acq_rel); }
+
+  /// \brief Runs on the scheduler when the socket becomes ready
+  void resume(reactor::handle registered)
+  {
+    if (m_is_claimed.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    if (m_receiver.is_canceled()) {
+      if (claim()) {
+        static_cast<void>(m_context->remove(registered));
+        m_receiver.cancel();
+        arrive();
+      }
+      return;
+    }
+
+    std::error_code error;
+    auto result = m_operation(error);
+    if (error == std::errc::operation_would_block) {
+      return;
+    }
+
+    // The registration is removed before the receiver is completed, since the receiver may close the socket.
+    if (claim()) {
+      static_cast<void>(m_context->remove(registered));
+      complete_io(m_receiver, std::move(result), error);
+      arrive();
+    }
+  }
+
+  /// \brief Runs on the scheduler when the proactor completes the operation
+  template <typename Result> void finish(Result&& result, std::error_code error)
+  {
+    if (claim()) {
+      complete_io(m_receiver, std::forward<Result>(result), error);
+      arrive();
+    }
+  }
+
+  /// \brief Runs on the thread that requests stop
+  void stop() noexcept
+  {
+    if (claim()) {
+      try {
+        if constexpr (std::is_same_v<Context, proactor>) {
+          static_cast<void>(m_context->cancel(m_handle));
+        } else {
+          static_cast<void>(m_context->remove(m_handle));
+        }
+      } catch (...) {
+        // The cancellation could not be submitted, the operation completes on its own and is dropped then.
+      }
+      m_receiver.cancel();
+      arrive();
+    }
+  }
+
+  /// \brief Runs when the handler is destroyed, a handler that never ran leaves the receiver to the block destructor
+  void drop() noexcept
+  {
+    if (claim()) {
+      arrive();
+    }
+    arrive();
+  }
+
+  void arrive() noexcept
+  {
+    if (1U != m_pending.fetch_sub(1U, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    this->~io_block();
+    concurrency::details::state_pool<io_block>::deallocate(this);
+  }
+
+  std::atomic<std::uint32_t> m_pending;
+  std::atomic_bool m_is_claimed;
+  Receiver m_receiver;
+  Context* const m_context;
+  Operation m_operation;
+  handle_type m_handle;
+  std::optional<concurrency::stop_callback<on_stop>> m_on_stop;
+};
+
+/// \brief The operation state of a socket sender
+///
+/// On a reactor the operation is tried on the thread that starts the state. Only if it would block, the state moves
+/// into a reactor registration and the operation is tried again whenever the socket becomes ready. On a proactor the
+/// operation is submitted and the receiver moves into its handler. Either way the receiver is completed on the
+/// scheduler. A receiver that can be stopped waits in an io_block instead, so a stop request cancels the wait right
+/// away.
+template <typename Receiver, typename Scheduler, typename Context, typename Operation> class io_state {
+public:
+  io_state(Receiver&& receiver, Scheduler&& scheduler, Context& io, Operation const& operation)
+    : m_receiver{std::move(receiver)}
+    , m_scheduler{std::move(scheduler)}
+    , m_context{&io}
+    , m_operation{operation}
+  {
+  }
+
+  void start()
+  {
+    if (m_receiver.is_canceled()) {
+      m_receiver.cancel();
+      return;
+    }
+
+    if constexpr (std::is_same_v<Context, proactor>) {
+      if (concurrency::details::get_stop_token(m_receiver).stop_possible()) {
+        io_block<Receiver, Context, Operation>::create(std::move(m_receiver), *m_context, m_operation)
+            ->arm(std::move(m_scheduler));
+        return;
+      }
+
+      m_operation.submit(*m_context, std::move(m_scheduler),
+                         [receiver = std::move(m_receiver)](std::error_code error, auto&& result) mutable {
+                           complete_io(receiver, std::forward<decltype(result)>(result), error);
+                         });
+    } else {
+      attempt();
+    }
+  }
+
+private:
+  /// \brief Tries the operation, registers the socket to the reactor if it would block
+  ///
+  /// The operations do not block, so the socket is registered as it is, without switching its mode every time.
+  void attempt()
+  {
+    std::error_code error;
+    auto result = m_operation(error);
+    if (error == std::errc::operation_would_block) {
+      if (concurrency::details::get_stop_token(m_receiver).stop_possible()) {
+        io_block<Receiver, Context, Operation>::create(std::move(m_receiver), *m_context, m_operation)
+            ->arm(std::move(m_scheduler));
+        return;
+      }
+
+      auto* const io = m_context;
+      auto const descriptor = reactor::descriptor(m_operation.socket());
+      Scheduler scheduler{m_scheduler};
+      io->add(descriptor, Operation::s_interest, std::move(scheduler),
+              [state = std::move(*this)](reactor::event_mask, reactor::handle registered) mutable {
+                state.resume(registered);
+              });
+      return;
+    }
+
+    // The bytes have been moved already, so a cancellation is not observed after this point.
+    m_scheduler.schedule([receiver = std::move(m_receiver), result = std::move(result), error]() mutable {
+      complete_io(receiver, std::move(result), error);
+    });
+  }
+
+  /// \brief Tries the operation again on the scheduler
+  ///
+  /// The registration is removed before the receiver is completed, since the receiver may close the socket.
+  void resume(reactor::handle registered)
+  {
+    if (m_receiver.is_canceled()) {
+      m_context->remove(registered);
+      m_receiver.cancel();
+      return;
+    }
+
+    std::error_code error;
+    auto result = m_operation(error);
+    if (error == std::errc::operation_would_block) {
+      return;
+    }
+
+    m_context->remove(registered);
+    complete_io(m_receiver, std::move(result), error);
+  }
+
+  Receiver m_receiver;
+  Scheduler m_scheduler;
+  Context* m_context;
+  Operation m_operation;
+};
+
+template <typename Scheduler, typename Context, typename Operation> class io_sender {
+public:
+  using result_type = typename Operation::result_type;
+
+  io_sender(Scheduler&& scheduler, Context& io, Operation const& operation) noexcept
+    : m_scheduler{std::move(scheduler)}
+    , m_context{&io}
+    , m_operation{operation}
+  {
+    static_assert(std::is_same_v<Context, reactor> || std::is_same_v<Context, proactor>,
+                  "context must be a reactor or a proactor");
+  }
+
+  template <typename Receiver> auto connect(Receiver&& receiver)
+  {
+    return io_state<Receiver, Scheduler, Context, Operation>{std::forward<Receiver>(receiver), std::move(m_scheduler),
+                                                             *m_context, m_operation};
+  }
+
+private:
+  Scheduler m_scheduler;
+  Context* m_context;
+  Operation m_operation;
+};
+
+}  // namespace details
+
+/// \brief Gets a sender that receives bytes from the socket and completes on the scheduler
+///
+/// On a reactor the receive is tried right away, the socket is registered to the reactor only if no bytes are
+/// available. On a proactor the receive is submitted. The sender completes with the number of bytes received, zero
+/// when the peer has shut down, or with the error code. A waiting receive is canceled as soon as stop is requested
+/// on the stop token of its receiver; on a proactor it also completes with the error code when the socket is removed.
+///
+/// \throws std::invalid_argument if the arguments are invalid
+template <typename Context, typename Scheduler, typename Socket, typename Protocol>
+auto async_receive(Context& io, Scheduler scheduler, basic_stream_socket<Socket, Protocol>& socket,
+                   std::uint8_t* buffer, std::size_t length)
+{
+  static_assert(concurrency::is_output_scheduler<Scheduler>::value,
+                "scheduler must fulfill output Scheduler type requirements");
+  contract::not_null(buffer, "buffer cannot be nullptr");
+  contract::not_zero(length, "length cannot be zero");
+
+  using operation_type = details::receive_operation<Socket, Protocol>;
+  return details::io_sender<Scheduler, Context, operation_type>{std::move(scheduler), io,
+                                                                operation_type{socket, buffer, length}};
+}
+
+/// \brief Gets a sender that sends bytes to the socket and completes on the scheduler
+///
+/// On a reactor the send is tried right away, the socket is registered to the reactor only if its send buffer is full.
+/// On a proactor the send is submitted. The sender completes with the number of bytes sent, which may be less than the
+/// length, or with the error code.
+///
+/// \throws std::invalid_argument if the arguments are invalid
+template <typename Context, typename Scheduler, typename Socket, typename Protocol>
+auto async_send(Context& io, Scheduler scheduler, basic_stream_socket<Socket, Protocol>& socket,
+                std::uint8_t const* buffer, std::size_t length)
+{
+  static_assert(concurrency::is_output_scheduler<Scheduler>::value,
+                "scheduler must fulfill output Scheduler type requirements");
+  contract::not_null(buffer, "buffer cannot be nullptr");
+  contract::not_zero(length, "length cannot be zero");
+
+  using operation_type = details::send_operation<Socket, Protocol>;
+  return details::io_sender<Scheduler, Context, operation_type>{std::move(scheduler), io,
+                                                                operation_type{socket, buffer, length}};
+}
+
+/// \brief Gets a sender that accepts a connection and completes on the scheduler
+///
+/// On a reactor the server socket is switched to non-blocking mode and the accept is tried right away, the socket is
+/// registered to the reactor only if no connection is pending. On a proactor the accept is submitted. The sender
+/// completes with the connected socket or with the error code.
+///
+/// \throws std::system_error if operation fails due to a system error
+template <typename Context, typename Scheduler, typename Socket, typename Protocol>
+auto async_accept(Context& io, Scheduler scheduler, stream_server_socket<Socket, Protocol>& server)
+{
+  static_assert(concurrency::is_output_scheduler<Scheduler>::value,
+                "scheduler must fulfill output Scheduler type requirements");
+  if constexpr (std::is_same_v<Context, reactor>) {
+    server.non_blocking(true);
+  }
+
+  using operation_type = details::accept_operation<Socket, Protocol>;
+  return details::io_sender<Scheduler, Context, operation_type>{std::move(scheduler), io, operation_type{server}};
+}
+
+}  // namespace jar::com
+
+#endif  // JAR_COM_ASYNC_HPP
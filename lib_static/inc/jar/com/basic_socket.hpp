@@ -29,6 +29,9 @@
 
 namespace jar::com {
 
+class proactor;
+class reactor;
+
 /// \brief A RAII class that represents a socket
 ///
 /// This class is an immutable handle to a socket with automatic lifetime management. Only exception to being immutable
@@ -41,6 +44,10 @@ class basic_socket : public system::basic_handle<Socket>, public Protocol {
   /// \brief Short-hand for base type
   using handle_type = system::basic_handle<Socket>;
 
+  /// \brief Friend declarations for reactor and proactor, which register the native handle
+  friend class proactor;
+  friend class reactor;
+
 public:
   /// \brief Deleted copy constructor
   basic_socket(const basic_socket&) = delete;
@@ -18,9 +18,12 @@
 #ifndef JAR_COM_BASIC_STREAM_SOCKET_HPP
 #define JAR_COM_BASIC_STREAM_SOCKET_HPP
 
+#include <system_error>
+
 #include <jar/core/contract.hpp>
 
 #include "jar/com/basic_socket.hpp"
+#include "jar/com/buffer.hpp"
 
 namespace jar::com {
 
@@ -56,6 +59,22 @@ public:
     return Socket::receive(*this, buffer, length);
   }
 
+  /// \brief Receive bytes from the remote peer without blocking
+  ///
+  /// \param[in]  buffer      Buffer for the received bytes
+  /// \param[in]  length      Buffer length
+  /// \param[out] error       Error code, std::errc::operation_would_block if no bytes are available
+  ///
+  /// \return Zero when the peer has performed an orderly shutdown or on error; otherwise number of bytes read
+  ///
+  /// \throws std::invalid_argument if the arguments are invalid
+  std::size_t receive(std::uint8_t* buffer, std::size_t length, std::error_code& error)
+  {
+    contract::not_null(buffer, "buffer cannot be nullptr");
+    contract::not_zero(length, "length cannot be zero");
+    return Socket::receive(*this, buffer, length, error);
+  }
+
   /// \brief Send bytes to the remote peer
   ///
   /// \param[in]  buffer      Buffer of containing the bytes to send
@@ -72,6 +91,83 @@ public:
     return Socket::send(*this, buffer, length);
   }
 
+  /// \brief Send bytes to the remote peer without blocking
+  ///
+  /// \param[in]  buffer      Buffer of containing the bytes to send
+  /// \param[in]  length      Buffer length
+  /// \param[out] error       Error code, std::errc::operation_would_block if the send buffer is full
+  ///
+  /// \return Number of bytes send, zero on error
+  ///
+  /// \throws std::invalid_argument if the arguments are invalid
+  std::size_t send(std::uint8_t const* buffer, std::size_t length, std::error_code& error)
+  {
+    contract::not_null(buffer, "buffer cannot be nullptr");
+    contract::not_zero(length, "length cannot be zero");
+    return Socket::send(*this, buffer, length, error);
+  }
+
+  /// \brief Receive bytes from the remote peer to a sequence of segments with a single system call
+  ///
+  /// The segments are filled in order, so a header and a payload can be received to separate buffers.
+  ///
+  /// \param[in]  buffers     Segments for the received bytes, at most Socket::max_segments()
+  ///
+  /// \return Zero when the peer has performed an orderly shutdown; otherwise number of bytes read, which may end in the
+  /// middle of any segment
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  std::size_t receive(mutable_buffers buffers)
+  {
+    check_segments(buffers);
+    return Socket::receive(*this, buffers);
+  }
+
+  /// \brief Receive bytes from the remote peer to a sequence of segments without blocking
+  ///
+  /// \param[in]  buffers     Segments for the received bytes, at most Socket::max_segments()
+  /// \param[out] error       Error code, std::errc::operation_would_block if no bytes are available
+  ///
+  /// \return Zero when the peer has performed an orderly shutdown or on error; otherwise number of bytes read
+  ///
+  /// \throws std::invalid_argument if the arguments are invalid
+  std::size_t receive(mutable_buffers buffers, std::error_code& error)
+  {
+    check_segments(buffers);
+    return Socket::receive(*this, buffers, error);
+  }
+
+  /// \brief Send a sequence of segments to the remote peer with a single system call
+  ///
+  /// The segments are sent in order, so a header and a payload can be sent without copying them to one buffer.
+  ///
+  /// \param[in]  buffers     Segments of the bytes to send, at most Socket::max_segments()
+  ///
+  /// \return Number of bytes send, which may end in the middle of any segment
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  std::size_t send(const_buffers buffers)
+  {
+    check_segments(buffers);
+    return Socket::send(*this, buffers);
+  }
+
+  /// \brief Send a sequence of segments to the remote peer without blocking
+  ///
+  /// \param[in]  buffers     Segments of the bytes to send, at most Socket::max_segments()
+  /// \param[out] error       Error code, std::errc::operation_would_block if the send buffer is full
+  ///
+  /// \return Number of bytes send, zero on error
+  ///
+  /// \throws std::invalid_argument if the arguments are invalid
+  std::size_t send(const_buffers buffers, std::error_code& error)
+  {
+    check_segments(buffers);
+    return Socket::send(*this, buffers, error);
+  }
+
 protected:
   /// \brief Native socket handle type
   using native_type = typename basic_socket_t::native_type;
@@ -102,6 +198,19 @@ protected:
   ///
   /// This class is not a polymorphic base class.
   ~basic_stream_socket() = default;
+
+private:
+  /// \brief Checks the segments like the single buffer operations check their buffer
+  template <typename Buffer> static void check_segments(buffer_sequence<Buffer> buffers)
+  {
+    contract::not_null(buffers.data(), "buffers cannot be nullptr");
+    contract::not_zero(buffers.size(), "buffers cannot be empty");
+    contract::not_greater(buffers.size(), Socket::max_segments(), "buffers cannot exceed the maximum segment count");
+    for (auto const& segment : buffers) {
+      contract::not_null(segment.data, "segment data cannot be nullptr");
+      contract::not_zero(segment.size, "segment size cannot be zero");
+    }
+  }
 };
 
 }  // namespace jar::com
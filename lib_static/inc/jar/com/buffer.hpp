@@ -0,0 +1,83 @@
+/// Copyright 2020 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file buffer.hpp
+///
+
+#ifndef JAR_COM_BUFFER_HPP
+#define JAR_COM_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace jar::com {
+
+/// \brief A segment of bytes to send
+struct const_buffer {
+  std::uint8_t const* data; ///< Bytes of the segment
+  std::size_t size;         ///< Segment length
+};
+
+/// \brief A segment of a buffer for received bytes
+struct mutable_buffer {
+  std::uint8_t* data; ///< Bytes of the segment
+  std::size_t size;   ///< Segment length
+};
+
+/// \brief A non-owning view of a contiguous sequence of segments
+///
+/// \tparam Buffer     Segment type, const_buffer or mutable_buffer
+template <typename Buffer> class buffer_sequence {
+public:
+  /// \brief Construct a view of count segments starting from buffers
+  constexpr buffer_sequence(Buffer const* buffers, std::size_t count) noexcept
+    : m_data{buffers}
+    , m_size{count}
+  {
+  }
+
+  /// \brief Construct a view of a contiguous container of segments, like std::array or std::vector
+  template <typename Container,
+            typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<Container const&>().data()),
+                                                              Buffer const*>>>
+  constexpr buffer_sequence(Container const& buffers) noexcept // NOLINT(google-explicit-constructor)
+    : m_data{buffers.data()}
+    , m_size{buffers.size()}
+  {
+  }
+
+  [[nodiscard]] constexpr Buffer const* data() const noexcept { return m_data; }
+
+  [[nodiscard]] constexpr std::size_t size() const noexcept { return m_size; }
+
+  [[nodiscard]] constexpr Buffer const* begin() const noexcept { return m_data; }
+
+  [[nodiscard]] constexpr Buffer const* end() const noexcept { return m_data + m_size; }
+
+private:
+  Buffer const* m_data;
+  std::size_t m_size;
+};
+
+/// \brief Segments of bytes to send
+using const_buffers = buffer_sequence<const_buffer>;
+
+/// \brief Segments for received bytes
+using mutable_buffers = buffer_sequence<mutable_buffer>;
+
+} // namespace jar::com
+
+#endif // JAR_COM_BUFFER_HPP
@@ -18,9 +18,12 @@
 #ifndef JAR_COM_DATAGRAM_SOCKET_HPP
 #define JAR_COM_DATAGRAM_SOCKET_HPP
 
+#include <array>
+
 #include "jar/core/contract.hpp"
 
 #include "jar/com/basic_socket.hpp"
+#include "jar/com/buffer.hpp"
 
 namespace jar::com {
 
@@ -113,9 +116,70 @@ public:
     return Socket::receive_from(*this, static_cast<native_type*>(remote_address), buffer, length);
   }
 
+  /// \brief Send a batch of datagrams with a single system call
+  ///
+  /// \param[in]  remote_addresses    Remote address of each datagram, one for every buffer
+  /// \param[in]  buffers             A buffer for each datagram, at most Socket::max_batch()
+  ///
+  /// \return Number of datagrams send, the datagrams after it were not send
+  ///
+  /// \throws std::system_error if the first datagram cannot be send due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  [[nodiscard]] std::size_t send_batch(address_type const* remote_addresses, const_buffers buffers)
+  {
+    contract::not_null(remote_addresses, "remote_addresses cannot be nullptr");
+    check_batch(buffers);
+
+    std::array<native_type const*, Socket::max_batch()> addresses{};
+    for (std::size_t index = 0U; index != buffers.size(); ++index) {
+      contract::not_zero(remote_addresses[index].length(), "remote_addresses cannot be empty");
+      addresses[index] = static_cast<native_type const*>(remote_addresses[index]);
+    }
+    return Socket::send_batch(*this, addresses.data(), buffers);
+  }
+
+  /// \brief Receive a batch of datagrams with a single system call
+  ///
+  /// Blocks until the first datagram arrives, the rest of the batch is filled with the datagrams that are already
+  /// queued.
+  ///
+  /// \param[out] remote_addresses    Remote address of each datagram, one for every buffer
+  /// \param[in]  buffers             A buffer for each datagram, at most Socket::max_batch()
+  /// \param[out] lengths             Length of each received datagram, one for every buffer
+  ///
+  /// \return Number of datagrams received, only as many addresses and lengths are set
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  [[nodiscard]] std::size_t receive_batch(address_type* remote_addresses, mutable_buffers buffers,
+                                          std::size_t* lengths)
+  {
+    contract::not_null(remote_addresses, "remote_addresses cannot be nullptr");
+    contract::not_null(lengths, "lengths cannot be nullptr");
+    check_batch(buffers);
+
+    std::array<native_type*, Socket::max_batch()> addresses{};
+    for (std::size_t index = 0U; index != buffers.size(); ++index) {
+      addresses[index] = static_cast<native_type*>(remote_addresses[index]);
+    }
+    return Socket::receive_batch(*this, addresses.data(), buffers, lengths);
+  }
+
 private:
   /// \brief Type alias for native socket address type
   using native_type = typename address_type::native_type;
+
+  /// \brief Checks the batch buffers like the single datagram operations check their buffer
+  template <typename Buffer> static void check_batch(buffer_sequence<Buffer> buffers)
+  {
+    contract::not_null(buffers.data(), "buffers cannot be nullptr");
+    contract::not_zero(buffers.size(), "buffers cannot be empty");
+    contract::not_greater(buffers.size(), Socket::max_batch(), "buffers cannot exceed the maximum batch size");
+    for (auto const& buffer : buffers) {
+      contract::not_null(buffer.data, "buffer cannot be nullptr");
+      contract::not_zero(buffer.size, "length cannot be zero");
+    }
+  }
 };
 
 }  // namespace jar::com
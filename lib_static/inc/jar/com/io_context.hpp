@@ -0,0 +1,48 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file io_context.hpp
+///
+
+#ifndef JAR_COM_IO_CONTEXT_HPP
+#define JAR_COM_IO_CONTEXT_HPP
+
+#include "jar/com/proactor.hpp"
+#include "jar/com/reactor.hpp"
+
+#include "jar/system/posix/uring.hpp"
+
+namespace jar::com {
+
+/// \brief Selects the I/O context of a socket at compile time
+///
+/// The sockets are served by the reactor unless their system socket asks for the proactor. The trait takes either the
+/// system socket or a socket template of it, e.g. ipc::uring::stream_socket.
+template <typename Socket> struct io_context {
+  using type = reactor;
+};
+
+template <> struct io_context<system::posix::uring_socket> {
+  using type = proactor;
+};
+
+template <template <typename, typename> class Type, typename Socket, typename Protocol>
+struct io_context<Type<Socket, Protocol>> : io_context<Socket> {};
+
+/// \brief Type alias for the I/O context of a socket
+template <typename Socket> using io_context_t = typename io_context<Socket>::type;
+
+}  // namespace jar::com
+
+#endif  // JAR_COM_IO_CONTEXT_HPP
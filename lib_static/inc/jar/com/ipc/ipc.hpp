@@ -30,6 +30,10 @@
 #include "jar/system/posix/socket.hpp"
 #endif
 
+#if defined(__linux__)
+#include "jar/system/posix/uring.hpp"
+#endif
+
 namespace jar::com {
 namespace ipc {
 
@@ -55,6 +59,22 @@ using stream_server_socket = com::stream_server_socket<system::posix::socket, pr
 #error not implemented
 #endif
 
+#if defined(__linux__)
+/// \brief Sockets whose asynchronous operations are served by the proactor, see io_context_t
+namespace uring {
+
+/// \brief Type alias for ipc datagram socket
+using datagram_socket = com::datagram_socket<system::posix::uring_socket, protocol>;
+
+/// \brief Type alias for ipc stream socket
+using stream_socket = com::stream_socket<system::posix::uring_socket, protocol>;
+
+/// \brief Type alias for ipc stream server socket
+using stream_server_socket = com::stream_server_socket<system::posix::uring_socket, protocol>;
+
+}  // namespace uring
+#endif
+
 }  // namespace ipc
 
 #if defined(__unix__)
@@ -68,6 +88,17 @@ template class stream_socket<system::posix::socket, ipc::protocol>;
 template class stream_server_socket<system::posix::socket, ipc::protocol>;
 #endif
 
+#if defined(__linux__)
+/// \brief Explicit instantiation declaration for ipc datagram socket served by the proactor
+template class datagram_socket<system::posix::uring_socket, ipc::protocol>;
+
+/// \brief Explicit instantiation declaration for ipc stream socket served by the proactor
+template class stream_socket<system::posix::uring_socket, ipc::protocol>;
+
+/// \brief Explicit instantiation declaration for ipc stream server socket served by the proactor
+template class stream_server_socket<system::posix::uring_socket, ipc::protocol>;
+#endif
+
 }  // namespace jar::com
 
 #endif  // JAR_COM_IPC_HPP
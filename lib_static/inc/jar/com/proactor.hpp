@@ -0,0 +1,443 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file proactor.hpp
+///
+
+#ifndef JAR_COM_PROACTOR_HPP
+#define JAR_COM_PROACTOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <jar/concurrency/type_traits.hpp>
+#include <jar/core/contract.hpp>
+
+#include "jar/com/basic_socket.hpp"
+#include "jar/com/basic_stream_socket.hpp"
+#include "jar/com/reactor.hpp"
+#include "jar/com/stream_server_socket.hpp"
+#include "jar/com/stream_socket.hpp"
+
+namespace jar::com {
+
+/// \brief A completion-based I/O engine for sockets built on io_uring
+///
+/// The operations are queued to the submission ring and submitted in batches: the completion thread submits every
+/// queued operation with the same system call it waits for the completions with, so a burst of operations started by
+/// the handlers costs a single io_uring_enter. Sockets that are added to the proactor are used through the fixed file
+/// table, buffers that are registered are used by the fixed buffer operations, and the multishot operations keep
+/// accepting or receiving until they fail or are canceled.
+///
+/// The handlers are dispatched onto the scheduler given with the operation and must not throw. The handler of a
+/// multishot operation never runs concurrently with itself. If io_uring is not available, the proactor falls back to
+/// a reactor: an operation is tried right away and waits for epoll readiness only if it would block.
+class proactor {
+public:
+  /// \brief I/O backend
+  enum class backend { uring, epoll };
+
+  /// \brief Handle to a started operation
+  struct handle {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+  /// \brief A buffer for the fixed buffer operations
+  struct buffer {
+    std::uint8_t* data;
+    std::size_t size;
+  };
+
+  /// \brief Constructor, starts the completion thread
+  ///
+  /// \param[in]  entries     Submission queue entry count, the operations beyond it are submitted right away
+  /// \param[in]  preferred   Preferred backend, epoll is used if io_uring is not supported
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the entry count is zero
+  explicit proactor(unsigned entries = 256U, backend preferred = backend::uring);
+
+  proactor(proactor const&) = delete;
+  proactor(proactor&&) = delete;
+  proactor& operator=(proactor const&) = delete;
+  proactor& operator=(proactor&&) = delete;
+
+  /// \brief Destructor, stops the completion thread and waits for the dispatched handlers to return
+  ///
+  /// The pending operations are dropped without invoking their handlers. The schedulers must outlive the proactor.
+  ~proactor();
+
+  /// \brief Gets the backend in use
+  backend get_backend() const noexcept { return m_backend; }
+
+  /// \brief Adds a socket to the fixed file table, the socket is switched to the blocking mode the backend expects
+  ///
+  /// A socket that is not added can still be used, its operations just look up the descriptor every time.
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  template <typename Socket, typename Protocol> void add(basic_socket<Socket, Protocol>& socket)
+  {
+    static_assert(std::is_same_v<typename Socket::native_type, int>, "socket must have a file descriptor handle");
+    socket.non_blocking(backend::epoll == m_backend);
+    add(static_cast<int>(socket));
+  }
+
+  /// \brief Cancels the pending operations of a socket and removes it from the fixed file table
+  ///
+  /// The handlers of the canceled operations are invoked with std::errc::operation_canceled. The socket may be closed
+  /// once this returns.
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  template <typename Socket, typename Protocol> void remove(basic_socket<Socket, Protocol>& socket)
+  {
+    remove(static_cast<int>(socket));
+  }
+
+  /// \brief Registers the buffers of receive_fixed(), the buffers can be registered once
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  void register_buffers(buffer const* buffers, std::size_t count);
+
+  /// \brief Allocates the provided buffers of receive_multishot(), the buffers can be allocated once
+  ///
+  /// \param[in]  count       Buffer count, up to 65535
+  /// \param[in]  size        Buffer size
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  void register_receive_buffers(std::size_t count, std::size_t size);
+
+  /// \brief Receives bytes, the handler is invoked with an error code and the number of bytes received
+  ///
+  /// \return Handle to the operation, which can be canceled with cancel()
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  template <typename Socket, typename Protocol, typename Scheduler, typename Handler>
+  handle receive(basic_stream_socket<Socket, Protocol>& socket, std::uint8_t* buffer, std::size_t length,
+                 Scheduler scheduler, Handler&& handler)
+  {
+    contract::not_null(buffer, "buffer cannot be nullptr");
+    contract::not_zero(length, "length cannot be zero");
+    return start(request{opcode::receive, static_cast<int>(socket), buffer, length, 0U}, std::move(scheduler),
+                 transfer_handler(std::forward<Handler>(handler)));
+  }
+
+  /// \brief Sends bytes, the handler is invoked with an error code and the number of bytes sent
+  ///
+  /// \return Handle to the operation, which can be canceled with cancel()
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  template <typename Socket, typename Protocol, typename Scheduler, typename Handler>
+  handle send(basic_stream_socket<Socket, Protocol>& socket, std::uint8_t const* buffer, std::size_t length,
+              Scheduler scheduler, Handler&& handler)
+  {
+    contract::not_null(buffer, "buffer cannot be nullptr");
+    contract::not_zero(length, "length cannot be zero");
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    return start(request{opcode::send, static_cast<int>(socket), const_cast<std::uint8_t*>(buffer), length, 0U},
+                 std::move(scheduler), transfer_handler(std::forward<Handler>(handler)));
+  }
+
+  /// \brief Receives bytes to a registered buffer, the handler is invoked with an error code and the number of bytes
+  ///
+  /// \param[in]  socket      Socket
+  /// \param[in]  index       Index of the registered buffer
+  /// \param[in]  offset      Offset in the registered buffer
+  /// \param[in]  length      Number of bytes to receive at most
+  /// \param[in]  scheduler   Scheduler the handler is dispatched onto
+  /// \param[in]  handler     Handler
+  ///
+  /// \return Handle to the operation, which can be canceled with cancel()
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the arguments are invalid
+  template <typename Socket, typename Protocol, typename Scheduler, typename Handler>
+  handle receive_fixed(basic_stream_socket<Socket, Protocol>& socket, std::size_t index, std::size_t offset,
+                       std::size_t length, Scheduler scheduler, Handler&& handler)
+  {
+    return start(fixed_request(static_cast<int>(socket), index, offset, length), std::move(scheduler),
+                 transfer_handler(std::forward<Handler>(handler)));
+  }
+
+  /// \brief Accepts a connection, the handler is invoked with an error code and the connected socket
+  ///
+  /// \return Handle to the operation, which can be canceled with cancel()
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  template <typename Socket, typename Protocol, typename Scheduler, typename Handler>
+  handle accept(stream_server_socket<Socket, Protocol>& server, Scheduler scheduler, Handler&& handler)
+  {
+    prepare_accept(server);
+    return start(request{opcode::accept, static_cast<int>(server), nullptr, 0U, 0U}, std::move(scheduler),
+                 accept_handler<Socket, Protocol>(std::forward<Handler>(handler)));
+  }
+
+  /// \brief Accepts connections until canceled, the handler is invoked with an error code and the connected socket
+  ///
+  /// The operation ends when the handler is invoked with an error, e.g. std::errc::operation_canceled.
+  ///
+  /// \return Handle to the operation, which can be canceled with cancel()
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  template <typename Socket, typename Protocol, typename Scheduler, typename Handler>
+  handle accept_multishot(stream_server_socket<Socket, Protocol>& server, Scheduler scheduler, Handler&& handler)
+  {
+    prepare_accept(server);
+    return start(request{opcode::accept_multishot, static_cast<int>(server), nullptr, 0U, 0U}, std::move(scheduler),
+                 accept_handler<Socket, Protocol>(std::forward<Handler>(handler)));
+  }
+
+  /// \brief Receives bytes to the provided buffers until canceled
+  ///
+  /// The handler is invoked with an error code and the received bytes, which are valid until the handler returns. The
+  /// operation ends when the handler is invoked with an error or with zero bytes, which means that the peer has shut
+  /// down. Running out of provided buffers pauses the operation until the handlers give buffers back.
+  ///
+  /// \return Handle to the operation, which can be canceled with cancel()
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the receive buffers have not been registered
+  template <typename Socket, typename Protocol, typename Scheduler, typename Handler>
+  handle receive_multishot(basic_stream_socket<Socket, Protocol>& socket, Scheduler scheduler, Handler&& handler)
+  {
+    contract::not_zero(m_receive_buffer_size, "receive buffers must be registered");
+    return start(request{opcode::receive_multishot, static_cast<int>(socket), nullptr, m_receive_buffer_size, 0U},
+                 std::move(scheduler),
+                 [handler = std::forward<Handler>(handler)](std::int32_t result, std::uint8_t const* data) mutable {
+                   handler(to_error(result), data, result < 0 ? std::size_t{0U} : static_cast<std::size_t>(result));
+                 });
+  }
+
+  /// \brief Cancels a started operation
+  ///
+  /// The handler is invoked with std::errc::operation_canceled, unless the operation completes first. Other operations
+  /// of the socket are not affected, on io_uring the cancellation is submitted right away and matches the operation by
+  /// its user data.
+  ///
+  /// \return True if the cancellation was requested, false if the operation had got its final result already
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  bool cancel(handle started);
+
+private:
+  enum class opcode : std::uint8_t { receive, send, receive_fixed, accept, accept_multishot, receive_multishot };
+
+  /// \brief Parameters of an operation
+  struct request {
+    opcode code;
+    int descriptor;
+    std::uint8_t* buffer;
+    std::size_t length;
+    std::uint16_t buffer_index;
+  };
+
+  /// \brief A completion of an operation, the fallback carries the received bytes in the data
+  struct result {
+    std::int32_t value;
+    std::uint32_t flags;
+    std::vector<std::uint8_t> data;
+  };
+
+  /// \brief A started operation, its pending results are delivered to the handler in order
+  struct operation : std::enable_shared_from_this<operation> {
+    operation() = default;
+    operation(operation const&) = delete;
+    operation& operator=(operation const&) = delete;
+    virtual ~operation() = default;
+
+    /// \brief Schedules run() on the scheduler of the operation
+    virtual void dispatch() = 0;
+
+    /// \brief Registers the watched descriptor of the operation to the fallback reactor
+    virtual reactor::handle watch(reactor& io, reactor::event_mask interest) = 0;
+
+    /// \brief Invokes the handler with a result
+    virtual void invoke(std::int32_t value, std::uint8_t const* data) = 0;
+
+    /// \brief Invokes the handler until no results are pending, releases the operation after the last result
+    void run() noexcept;
+
+    proactor* owner{nullptr};
+    request params{};
+    std::uint32_t index{0U};
+    std::uint32_t generation{0U};
+    reactor::handle registered{};
+    int watched{-1};
+    bool is_canceled{false};
+
+    std::mutex mutex;
+    std::vector<result> pending;
+    std::vector<result> running;
+    bool is_scheduled{false};
+    bool is_finished{false};
+  };
+
+  template <typename Scheduler, typename Invocable> struct basic_operation final : operation {
+    basic_operation(Scheduler&& operation_scheduler, Invocable&& operation_invocable)
+      : scheduler{std::move(operation_scheduler)}
+      , invocable{std::move(operation_invocable)}
+    {
+    }
+
+    void dispatch() override
+    {
+      scheduler.schedule([this]() {
+        run();
+      });
+    }
+
+    reactor::handle watch(reactor& io, reactor::event_mask interest) override
+    {
+      return io.add(watched, interest, scheduler,
+                    [watched = shared_from_this()](reactor::event_mask, reactor::handle handle) {
+                      watched->owner->perform(*watched, handle);
+                    });
+    }
+
+    void invoke(std::int32_t value, std::uint8_t const* data) override { invocable(value, data); }
+
+    Scheduler scheduler;
+    Invocable invocable;
+  };
+
+  /// \brief A slot of a started operation, the slots of the operations on one descriptor are linked together
+  struct slot {
+    std::shared_ptr<operation> started;
+    std::uint32_t generation{0U};
+    std::uint32_t previous{0U};
+    std::uint32_t next{0U};
+  };
+
+  /// \brief The io_uring instance and its mapped rings, defined by the implementation
+  struct ring;
+
+  static std::error_code to_error(std::int32_t value) noexcept
+  {
+    return value < 0 ? std::error_code{-value, std::system_category()} : std::error_code{};
+  }
+
+  template <typename Handler> static auto transfer_handler(Handler&& handler)
+  {
+    return [handler = std::forward<Handler>(handler)](std::int32_t value, std::uint8_t const*) mutable {
+      handler(to_error(value), value < 0 ? std::size_t{0U} : static_cast<std::size_t>(value));
+    };
+  }
+
+  template <typename Socket, typename Protocol, typename Handler> static auto accept_handler(Handler&& handler)
+  {
+    return [handler = std::forward<Handler>(handler)](std::int32_t value, std::uint8_t const*) mutable {
+      handler(to_error(value), stream_socket<Socket, Protocol>{value < 0 ? Socket::invalid_value() : value});
+    };
+  }
+
+  template <typename Socket, typename Protocol> void prepare_accept(stream_server_socket<Socket, Protocol>& server)
+  {
+    static_assert(std::is_same_v<typename Socket::native_type, int>, "socket must have a file descriptor handle");
+    // The fallback accepts until the socket would block.
+    if (backend::epoll == m_backend) {
+      server.non_blocking(true);
+    }
+  }
+
+  template <typename Scheduler, typename Invocable>
+  handle start(request const& params, Scheduler&& scheduler, Invocable&& invocable)
+  {
+    static_assert(concurrency::is_output_scheduler<Scheduler>::value,
+                  "scheduler must fulfill output Scheduler type requirements");
+    auto started = std::make_shared<basic_operation<Scheduler, std::decay_t<Invocable>>>(
+        std::move(scheduler), std::forward<Invocable>(invocable));
+    started->owner = this;
+    started->params = params;
+    return start(std::move(started));
+  }
+
+  request fixed_request(int descriptor, std::size_t index, std::size_t offset, std::size_t length) const;
+
+  handle start(std::shared_ptr<operation> started);
+
+  void add(int descriptor);
+
+  void remove(int descriptor);
+
+  /// \brief Queues a result to the handler, returns false if the operation has already got its final result
+  bool post(operation& completed, std::int32_t value, std::uint32_t flags, std::vector<std::uint8_t> data = {});
+
+  /// \brief Removes the registration of an operation from the fallback reactor, returns false if already removed
+  bool unwatch(operation& watching, reactor::handle registered);
+
+  /// \brief Performs a ready operation of the epoll backend with the non-blocking system calls
+  void perform(operation& ready, reactor::handle registered);
+
+  /// \brief Performs an operation of the epoll backend until it would block, the multishot results are posted
+  ///
+  /// \return Final result, or -EAGAIN if the operation would block
+  std::int32_t attempt(operation& ready);
+
+  /// \brief Queues an operation to the submission ring, the mutex must be held
+  void submit(operation& submitted);
+
+  /// \brief Submits the operations again, the mutex must be held
+  void resubmit(std::vector<std::uint32_t> const& indices);
+
+  /// \brief Gives the provided buffer of a completion back to the kernel
+  void give_back(std::uint32_t flags);
+
+  void release(std::uint32_t index) noexcept;
+
+  /// \brief Links the slot to the operations of its descriptor, the mutex must be held
+  void link(std::uint32_t index) noexcept;
+
+  /// \brief Unlinks the slot from the operations of its descriptor, the mutex must be held
+  void unlink(std::uint32_t index) noexcept;
+
+  void notify();
+
+  /// \brief Runs the completion thread, which submits the queued operations and reaps the completions
+  void poll() noexcept;
+
+  backend const m_backend;
+  std::unique_ptr<ring> m_ring;
+  std::optional<reactor> m_reactor;
+
+  mutable std::mutex m_mutex;
+  std::vector<slot> m_slots;
+  std::vector<std::uint32_t> m_free;
+  std::vector<std::uint32_t> m_operations;
+  std::vector<std::uint32_t> m_files;
+  std::vector<std::uint32_t> m_free_files;
+  std::vector<buffer> m_buffers;
+  std::size_t m_receive_buffer_size;
+
+  std::atomic_bool m_is_stopping;
+  std::atomic_bool m_is_signaled;
+  std::atomic_size_t m_dispatched;
+  std::thread m_thread;
+};
+
+}  // namespace jar::com
+
+#endif  // JAR_COM_PROACTOR_HPP
@@ -0,0 +1,250 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file reactor.hpp
+///
+
+#ifndef JAR_COM_REACTOR_HPP
+#define JAR_COM_REACTOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <jar/system/basic_handle.hpp>
+
+#include "jar/com/basic_socket.hpp"
+
+#if defined(__linux__)
+#include "jar/system/posix/epoll.hpp"
+#else
+#error not implemented
+#endif
+
+namespace jar::com {
+namespace details {
+
+template <typename Receiver, typename Scheduler, typename Context, typename Operation> class io_state;
+template <typename Receiver, typename Context, typename Operation> class io_block;
+
+}  // namespace details
+
+/// \brief A readiness reactor for non-blocking sockets
+///
+/// The reactor threads wait on an epoll instance where the sockets are registered edge-triggered, so an event is
+/// delivered once per readiness change and an idle socket costs only its registration. The reactor threads do not run
+/// the handlers, they dispatch them onto the scheduler given at registration (e.g. a thread pool scheduler).
+///
+/// The handler of a socket never runs concurrently with itself, events that arrive while it runs are merged and the
+/// handler is invoked again when it returns. Since the events are edge-triggered, the handler must receive, send or
+/// accept until the operation would block, otherwise it is not notified again.
+class reactor {
+  /// \brief Friend declaration for proactor, which falls back to the reactor without io_uring
+  friend class proactor;
+
+  /// \brief Friend declarations for the socket senders, which register sockets whose operations never block
+  template <typename, typename, typename, typename> friend class details::io_state;
+  template <typename, typename, typename> friend class details::io_block;
+
+public:
+  /// \brief Readiness event bit mask
+  using event_mask = std::uint32_t;
+
+  inline static constexpr event_mask readable{1U};  ///< Bytes or a connection can be received
+  inline static constexpr event_mask writable{2U};  ///< Bytes can be sent
+  inline static constexpr event_mask closed{4U};    ///< Peer has shut down, receive returns zero
+  inline static constexpr event_mask error{8U};     ///< Socket has a pending error
+
+  /// \brief Handle to a registration
+  struct handle {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+  /// \brief Constructor, starts the reactor threads
+  ///
+  /// \param[in]  thread_count    Reactor thread count, a single thread serves any number of idle sockets
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  /// \throws std::invalid_argument if the thread count is zero
+  explicit reactor(unsigned thread_count = 1U);
+
+  reactor(reactor const&) = delete;
+  reactor(reactor&&) = delete;
+  reactor& operator=(reactor const&) = delete;
+  reactor& operator=(reactor&&) = delete;
+
+  /// \brief Destructor, stops the reactor threads and waits for the dispatched handlers to return
+  ///
+  /// The remaining registrations are dropped. The schedulers must outlive the reactor, since the dispatched handlers
+  /// must run for the destructor to return.
+  ~reactor();
+
+  /// \brief Registers a socket, the socket is switched to non-blocking mode unless it is in that mode already
+  ///
+  /// The handler is invoked on the scheduler with the ready events and must not throw. A handler that is also invocable
+  /// with the handle of its registration gets the handle, so it can remove its own registration before it lets go of
+  /// the socket. The socket must stay open until the registration is removed.
+  ///
+  /// \param[in]  socket      Socket (e.g. stream_socket, stream_server_socket or datagram_socket)
+  /// \param[in]  interest    Events of interest, closed and error events are always reported
+  /// \param[in]  scheduler   Scheduler the handler is dispatched onto
+  /// \param[in]  handler     Handler invocable with the ready event_mask, or with the event_mask and the handle
+  ///
+  /// \return Handle to the registration
+  ///
+  /// \throws std::system_error if operation fails due to a system error
+  template <typename Socket, typename Protocol, typename Scheduler, typename Handler>
+  handle add(basic_socket<Socket, Protocol>& socket, event_mask interest, Scheduler scheduler, Handler&& handler)
+  {
+    using handler_type = std::decay_t<Handler>;
+    static_assert(std::is_invocable_v<handler_type&, event_mask> ||
+                      std::is_invocable_v<handler_type&, event_mask, handle>,
+                  "handler must be invocable with an event_mask");
+
+    socket.non_blocking(true);
+    return add(descriptor(socket), interest, std::move(scheduler), std::forward<Handler>(handler));
+  }
+
+  /// \brief Removes a registration
+  ///
+  /// A handler that is running returns normally, but it is not invoked again. A handler may remove its own
+  /// registration.
+  ///
+  /// \return True if the registration was removed, false if it had been removed already
+  bool remove(handle registered);
+
+  /// \brief Gets the number of registrations
+  std::size_t size() const;
+
+private:
+  inline static constexpr event_mask s_event_bits{readable | writable | closed | error};
+  inline static constexpr std::uint32_t s_scheduled{std::uint32_t{1U} << 30U};
+  inline static constexpr std::uint32_t s_removed{std::uint32_t{1U} << 31U};
+  inline static constexpr std::uint64_t s_wakeup{~std::uint64_t{0U}};
+  inline static constexpr std::size_t s_batch_size{256U};
+
+  /// \brief A registered socket, its state holds the pending events and the scheduled and removed flags
+  struct registration {
+    registration() = default;
+    registration(registration const&) = delete;
+    registration& operator=(registration const&) = delete;
+    virtual ~registration() = default;
+
+    /// \brief Schedules run() on the scheduler of the registration
+    virtual void dispatch() = 0;
+
+    /// \brief Invokes the handler
+    virtual void invoke(event_mask events) = 0;
+
+    /// \brief Invokes the handler until no events are pending, releases the registration if it was removed
+    void run() noexcept;
+
+    reactor* owner{nullptr};
+    std::uint32_t index{0U};
+    std::uint32_t generation{0U};
+    int descriptor{-1};
+    std::atomic<std::uint32_t> state{0U};
+  };
+
+  template <typename Scheduler, typename Handler> struct basic_registration final : registration {
+    template <typename H>
+    basic_registration(Scheduler&& registered_scheduler, H&& registered_handler)
+      : scheduler{std::move(registered_scheduler)}
+      , handler{std::forward<H>(registered_handler)}
+    {
+    }
+
+    void dispatch() override
+    {
+      scheduler.schedule([this]() {
+        run();
+      });
+    }
+
+    void invoke(event_mask events) override
+    {
+      if constexpr (std::is_invocable_v<Handler&, event_mask, handle>) {
+        handler(events, handle{index, generation});
+      } else {
+        handler(events);
+      }
+    }
+
+    Scheduler scheduler;
+    Handler handler;
+  };
+
+  struct slot {
+    std::unique_ptr<registration> registered;
+    std::uint32_t generation{0U};
+  };
+
+  /// \brief An owned native handle of a system resource
+  template <typename Resource> class native_handle : public system::basic_handle<Resource> {
+  public:
+    native_handle()
+      : system::basic_handle<Resource>{}
+    {
+    }
+
+    typename Resource::native_type get() const noexcept { return *this; }
+  };
+
+  /// \brief Gets the descriptor of a socket
+  template <typename Socket, typename Protocol> static int descriptor(basic_socket<Socket, Protocol> const& socket)
+  {
+    static_assert(std::is_same_v<typename Socket::native_type, int>, "socket must have a file descriptor handle");
+    return static_cast<int>(socket);
+  }
+
+  /// \brief Registers a non-blocking descriptor
+  template <typename Scheduler, typename Handler>
+  handle add(int descriptor, event_mask interest, Scheduler scheduler, Handler&& handler)
+  {
+    return add(descriptor, interest,
+               std::make_unique<basic_registration<Scheduler, std::decay_t<Handler>>>(std::move(scheduler),
+                                                                                     std::forward<Handler>(handler)));
+  }
+
+  handle add(int descriptor, event_mask interest, std::unique_ptr<registration> registered);
+
+  void release(std::uint32_t index) noexcept;
+
+  void release_locked(std::uint32_t index) noexcept;
+
+  void poll() noexcept;
+
+  native_handle<system::posix::epoll> const m_epoll;
+  native_handle<system::posix::event> const m_wakeup;
+
+  mutable std::mutex m_mutex;
+  std::vector<slot> m_slots;
+  std::vector<std::uint32_t> m_free;
+  std::size_t m_size;
+
+  std::atomic_bool m_is_stopping;
+  std::atomic_size_t m_dispatched;
+  std::vector<std::thread> m_threads;
+};
+
+}  // namespace jar::com
+
+#endif  // JAR_COM_REACTOR_HPP
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <system_error>
 
 #include "jar/com/basic_stream_socket.hpp"
 #include "jar/com/stream_socket.hpp"
@@ -108,6 +109,18 @@ public:
     contract::not_null(handler, "handler cannot be nullptr");
     handler(stream_socket<Socket, Protocol>{Socket::accept(*this)});
   }
+
+  /// \brief Accept a pending connection without blocking
+  ///
+  /// Socket must be listening and in non-blocking mode.
+  ///
+  /// \param[out] error           Error code, std::errc::operation_would_block if no connection is pending
+  ///
+  /// \return Connected socket, not valid on error
+  stream_socket<Socket, Protocol> accept(std::error_code& error) noexcept
+  {
+    return stream_socket<Socket, Protocol>{Socket::accept(*this, error)};
+  }
 };
 
 }  // namespace jar::com
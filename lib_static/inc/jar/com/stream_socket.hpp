@@ -22,6 +22,9 @@
 
 namespace jar::com {
 
+/// \brief proactor forward declaration
+class proactor;
+
 /// \brief stream_server_socket forward declaration
 template <typename Socket, typename Protocol> class stream_server_socket;
 
@@ -37,6 +40,9 @@ template <typename Socket, typename Protocol> class stream_socket : public basic
   /// \brief Friend declaration for stream_server_socket
   friend class stream_server_socket<Socket, Protocol>;
 
+  /// \brief Friend declaration for proactor, which accepts connections asynchronously
+  friend class proactor;
+
 public:
   /// \brief Socket address type
   using address_type = typename Protocol::address_type;
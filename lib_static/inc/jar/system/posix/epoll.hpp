@@ -0,0 +1,90 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file epoll.hpp
+///
+
+#ifndef JAR_SYSTEM_POSIX_EPOLL
+#define JAR_SYSTEM_POSIX_EPOLL
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/epoll.h>
+
+namespace jar::system::posix {
+
+/// \brief An epoll instance, implements the resource concept of system::basic_handle
+class epoll {
+public:
+  /// \brief Implement native_type concept
+  using native_type = int;
+
+  /// \brief Native readiness event type
+  using event_type = ::epoll_event;
+
+  /// \brief Implement invalid handle concept
+  [[nodiscard]] constexpr static native_type invalid_value() { return native_type{-1}; }
+
+  /// \brief Implement construction concept
+  [[nodiscard]] static native_type construct();
+
+  /// \brief Implement destroy concept
+  static void destroy(native_type handle) noexcept;
+
+  /// \brief Registers a descriptor
+  ///
+  /// \param[in]  handle      Epoll handle
+  /// \param[in]  descriptor  Descriptor to register
+  /// \param[in]  events      Native event mask (e.g. EPOLLIN | EPOLLET)
+  /// \param[in]  data        User data delivered with the events
+  static void add(native_type handle, int descriptor, std::uint32_t events, std::uint64_t data);
+
+  /// \brief Unregisters a descriptor, a descriptor that is not registered is ignored
+  static void remove(native_type handle, int descriptor);
+
+  /// \brief Waits until at least one event is ready
+  ///
+  /// \return Number of events stored, zero if the wait was interrupted by a signal
+  [[nodiscard]] static std::size_t wait(native_type handle, event_type* events, std::size_t max_events);
+
+private:
+  epoll() = default;
+};
+
+/// \brief An event counter for waking up epoll waiters, implements the resource concept of system::basic_handle
+class event {
+public:
+  /// \brief Implement native_type concept
+  using native_type = int;
+
+  /// \brief Implement invalid handle concept
+  [[nodiscard]] constexpr static native_type invalid_value() { return native_type{-1}; }
+
+  /// \brief Implement construction concept
+  [[nodiscard]] static native_type construct();
+
+  /// \brief Implement destroy concept
+  static void destroy(native_type handle) noexcept;
+
+  /// \brief Signals the event, the event stays readable until it is read
+  static void signal(native_type handle);
+
+private:
+  event() = default;
+};
+
+}  // namespace jar::system::posix
+
+#endif  // JAR_SYSTEM_POSIX_EPOLL
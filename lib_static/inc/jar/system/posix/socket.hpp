@@ -18,12 +18,16 @@
 #ifndef JAR_SYSTEM_POSIX_SOCKET
 #define JAR_SYSTEM_POSIX_SOCKET
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdint>
+#include <system_error>
 #include <type_traits>
 
 #include <sys/socket.h>
 
+#include "jar/com/buffer.hpp"
 #include "jar/com/shutdown_mode.hpp"
 #include "jar/com/socket_family.hpp"
 #include "jar/com/socket_protocol.hpp"
@@ -45,6 +49,12 @@ public:
     return std::size_t{SOMAXCONN};
   }
 
+  /// \brief Gets the maximum number of segments of a vectored send or receive
+  [[nodiscard]] constexpr static std::size_t max_segments() { return std::size_t{64U}; }
+
+  /// \brief Gets the maximum number of datagrams of a batched send or receive
+  [[nodiscard]] constexpr static std::size_t max_batch() { return std::size_t{64U}; }
+
   /// \brief Implement construction concept
   [[nodiscard]] static native_type construct(com::socket_family family, com::socket_type type,
                                              com::socket_protocol protocol);
@@ -88,12 +98,41 @@ public:
   /// \brief Implement listen concept
   [[nodiscard]] static native_type accept(native_type handle);
 
+  /// \brief Implement non-blocking accept concept, the error is std::errc::operation_would_block if none is pending
+  ///
+  /// The socket must be in non-blocking mode, otherwise the call blocks until a connection is pending.
+  [[nodiscard]] static native_type accept(native_type handle, std::error_code& error) noexcept;
+
   /// \brief Implement receive concept
   [[nodiscard]] static std::size_t receive(native_type handle, std::uint8_t* buffer, std::size_t length);
 
+  /// \brief Implement non-blocking receive concept, the error is std::errc::operation_would_block if nothing is ready
+  [[nodiscard]] static std::size_t receive(native_type handle, std::uint8_t* buffer, std::size_t length,
+                                           std::error_code& error) noexcept;
+
   /// \brief Implement send concept
   [[nodiscard]] static std::size_t send(native_type handle, const std::uint8_t* buffer, std::size_t length);
 
+  /// \brief Implement non-blocking send concept, the error is std::errc::operation_would_block if the buffer is full
+  [[nodiscard]] static std::size_t send(native_type handle, const std::uint8_t* buffer, std::size_t length,
+                                        std::error_code& error) noexcept;
+
+  /// \brief Implement vectored receive concept, the bytes fill the segments in order
+  [[nodiscard]] static std::size_t receive(native_type handle, com::mutable_buffers buffers);
+
+  /// \brief Implement non-blocking vectored receive concept, the error is std::errc::operation_would_block if nothing
+  /// is ready
+  [[nodiscard]] static std::size_t receive(native_type handle, com::mutable_buffers buffers,
+                                           std::error_code& error) noexcept;
+
+  /// \brief Implement vectored send concept, the bytes are taken from the segments in order
+  [[nodiscard]] static std::size_t send(native_type handle, com::const_buffers buffers);
+
+  /// \brief Implement non-blocking vectored send concept, the error is std::errc::operation_would_block if the buffer
+  /// is full
+  [[nodiscard]] static std::size_t send(native_type handle, com::const_buffers buffers,
+                                        std::error_code& error) noexcept;
+
   /// \brief Implement send concept
   template <typename AddressType>
   [[nodiscard]] static std::size_t send_to(native_type handle, AddressType remote_address, const std::uint8_t* buffer,
@@ -116,6 +155,34 @@ public:
                         sizeof(native_address_type));
   }
 
+  /// \brief Implement batched send concept, each buffer is sent as one datagram to the address at the same index
+  template <typename AddressType>
+  [[nodiscard]] static std::size_t send_batch(native_type handle, AddressType const* remote_addresses,
+                                              com::const_buffers buffers)
+  {
+    static_assert(std::is_pointer_v<AddressType>, "remote_addresses must be pointers");
+    using native_address_type = std::remove_pointer_t<AddressType>;
+    std::array<::sockaddr const*, max_batch()> addresses{};
+    std::transform(remote_addresses, remote_addresses + buffers.size(), addresses.begin(), [](AddressType address) {
+      return reinterpret_cast<::sockaddr const*>(address);
+    });
+    return send_batch(handle, buffers, addresses.data(), sizeof(native_address_type));
+  }
+
+  /// \brief Implement batched receive concept, waits for the first datagram and takes the ones that are ready
+  template <typename AddressType>
+  [[nodiscard]] static std::size_t receive_batch(native_type handle, AddressType const* remote_addresses,
+                                                 com::mutable_buffers buffers, std::size_t* lengths)
+  {
+    static_assert(std::is_pointer_v<AddressType>, "remote_addresses must be pointers");
+    using native_address_type = std::remove_pointer_t<AddressType>;
+    std::array<::sockaddr*, max_batch()> addresses{};
+    std::transform(remote_addresses, remote_addresses + buffers.size(), addresses.begin(), [](AddressType address) {
+      return reinterpret_cast<::sockaddr*>(address);
+    });
+    return receive_batch(handle, buffers, addresses.data(), sizeof(native_address_type), lengths);
+  }
+
   /// \brief Implement send timeout concept
   static void set_send_timeout(native_type handle, std::chrono::microseconds microseconds);
 
@@ -165,6 +232,30 @@ protected:
   [[nodiscard]] static std::size_t receive_from(native_type handle, std::uint8_t* buffer, std::size_t length,
                                                 ::sockaddr* const, std::size_t address_size);
 
+  /// \brief Send the buffers as datagrams with a single system call
+  ///
+  /// \param handle
+  /// \param buffers
+  /// \param remote_addresses
+  /// \param address_size
+  ///
+  /// \return Number of datagrams send
+  [[nodiscard]] static std::size_t send_batch(native_type handle, com::const_buffers buffers,
+                                              ::sockaddr const* const* remote_addresses, std::size_t address_size);
+
+  /// \brief Receive datagrams to the buffers with a single system call
+  ///
+  /// \param handle
+  /// \param buffers
+  /// \param remote_addresses
+  /// \param address_size
+  /// \param lengths
+  ///
+  /// \return Number of datagrams received
+  [[nodiscard]] static std::size_t receive_batch(native_type handle, com::mutable_buffers buffers,
+                                                 ::sockaddr* const* remote_addresses, std::size_t address_size,
+                                                 std::size_t* lengths);
+
 private:
   socket() = default;
 };
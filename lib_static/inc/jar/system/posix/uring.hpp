@@ -0,0 +1,105 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file uring.hpp
+///
+
+#ifndef JAR_SYSTEM_POSIX_URING
+#define JAR_SYSTEM_POSIX_URING
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+#include <sys/uio.h>
+
+#include "jar/system/posix/socket.hpp"
+
+namespace jar::system::posix {
+
+/// \brief An io_uring instance, implements the resource concept of system::basic_handle
+///
+/// The instance is set up and driven with the raw system calls, no library is required.
+class uring {
+public:
+  /// \brief Implement native_type concept
+  using native_type = int;
+
+  /// \brief Native setup parameter type, tells the ring offsets after the setup
+  using params_type = ::io_uring_params;
+
+  /// \brief Native submission queue entry type
+  using submission_type = ::io_uring_sqe;
+
+  /// \brief Native completion queue entry type
+  using completion_type = ::io_uring_cqe;
+
+  /// \brief Implement invalid handle concept
+  [[nodiscard]] constexpr static native_type invalid_value() { return native_type{-1}; }
+
+  /// \brief Implement construction concept
+  ///
+  /// \param[in]      entries     Submission queue entry count, clamped to the system limit
+  /// \param[out]     params      Ring parameters
+  [[nodiscard]] static native_type construct(unsigned entries, params_type& params);
+
+  /// \brief Implement destroy concept
+  static void destroy(native_type handle) noexcept;
+
+  /// \brief Checks whether io_uring can be set up and supports multishot receive, the result is probed once
+  ///
+  /// io_uring may be missing or disabled (e.g. by seccomp or the kernel.io_uring_disabled sysctl), and kernels older
+  /// than 6.0 lack some of the operations used by the proactor.
+  [[nodiscard]] static bool is_supported() noexcept;
+
+  /// \brief Submits the queued entries and waits for the completions
+  ///
+  /// \param[in]  handle          Ring handle
+  /// \param[in]  to_submit       Maximum number of entries to submit
+  /// \param[in]  min_complete    Number of completions to wait for
+  ///
+  /// \return Number of entries submitted, zero if the wait was interrupted or the completion queue is full
+  static unsigned enter(native_type handle, unsigned to_submit, unsigned min_complete);
+
+  /// \brief Registers buffers for the fixed buffer operations
+  static void register_buffers(native_type handle, ::iovec const* buffers, unsigned count);
+
+  /// \brief Registers a sparse file table, the descriptors are set with update_file()
+  static void register_files(native_type handle, unsigned count);
+
+  /// \brief Sets a descriptor in the file table, -1 clears the entry
+  static void update_file(native_type handle, unsigned index, int descriptor);
+
+  /// \brief Maps a ring of the instance to the memory
+  [[nodiscard]] static void* map(native_type handle, std::size_t length, std::uint64_t offset);
+
+  /// \brief Unmaps a ring
+  static void unmap(void* address, std::size_t length) noexcept;
+
+private:
+  uring() = default;
+};
+
+/// \brief A socket whose asynchronous operations are served by io_uring
+///
+/// The synchronous operations are the ones of the posix socket, only the I/O context differs (see com::io_context_t).
+class uring_socket : public socket {
+private:
+  uring_socket() = default;
+};
+
+}  // namespace jar::system::posix
+
+#endif  // JAR_SYSTEM_POSIX_URING
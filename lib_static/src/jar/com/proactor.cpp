@@ -0,0 +1,887 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file proactor.cpp
+///
+#include "jar/com/proactor.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <unistd.h>
+
+#include "jar/system/posix/epoll.hpp"
+#include "jar/system/posix/uring.hpp"
+
+namespace jar::com {
+namespace {
+
+using system::posix::uring;
+
+constexpr std::uint64_t s_wakeup{~std::uint64_t{0U}};
+constexpr std::uint64_t s_ignored{~std::uint64_t{0U} - 1U};
+constexpr std::uint32_t s_no_file{~std::uint32_t{0U}};
+constexpr std::uint32_t s_no_slot{~std::uint32_t{0U}};
+constexpr std::uint32_t s_more{IORING_CQE_F_MORE};
+constexpr std::uint32_t s_file_count{1024U};
+constexpr std::uint16_t s_buffer_group{0U};
+constexpr std::size_t s_batch_size{256U};
+
+/// \brief Largest transfer of a single system call on Linux, which keeps the byte count in the result value
+constexpr std::size_t s_max_length{0x7ffff000U};
+
+template <typename T> T load_acquire(T const* value) noexcept { return __atomic_load_n(value, __ATOMIC_ACQUIRE); }
+
+template <typename T> void store_release(T* value, T desired) noexcept
+{
+  __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+/// \brief An owned native handle of a system resource
+template <typename Resource> class native_handle : public system::basic_handle<Resource> {
+public:
+  template <typename... Args>
+  explicit native_handle(Args&&... args)
+    : system::basic_handle<Resource>{std::forward<Args>(args)...}
+  {
+  }
+
+  typename Resource::native_type get() const noexcept { return *this; }
+};
+
+}  // namespace
+
+/// \brief The io_uring instance, its mapped rings and the provided receive buffers
+///
+/// The submission ring is written under the mutex of the proactor, the completion ring is read by the completion
+/// thread only.
+struct proactor::ring {
+  explicit ring(unsigned entries);
+
+  ring(ring const&) = delete;
+  ring& operator=(ring const&) = delete;
+
+  ~ring();
+
+  /// \brief Gets the next free submission entry, submits the queued entries if the ring is full
+  uring::submission_type& next();
+
+  /// \brief Publishes the entry got with next()
+  void push() noexcept;
+
+  /// \brief Queues a multishot poll of the wake-up event
+  void arm_wakeup();
+
+  /// \brief Queues the provided buffers from the first id on to be given to the kernel
+  void provide(std::uint16_t first, std::uint16_t count);
+
+  /// \brief Gets the provided buffer of a completion
+  std::uint8_t const* buffer_at(std::uint32_t flags) const noexcept
+  {
+    return buffer_data.get() + (flags >> IORING_CQE_BUFFER_SHIFT) * buffer_size;
+  }
+
+  // The buffers are declared first, so they are released after the instance has been closed.
+  std::unique_ptr<std::uint8_t[]> buffer_data;
+  std::size_t buffer_size{0U};
+  std::size_t free_buffers{0U};
+  std::vector<std::uint32_t> starved;
+
+  uring::params_type params;
+  native_handle<uring> handle;
+  native_handle<system::posix::event> wakeup;
+
+  void* rings{nullptr};
+  std::size_t rings_length{0U};
+  uring::submission_type* entries{nullptr};
+  std::size_t entries_length{0U};
+
+  unsigned* sq_head{nullptr};
+  unsigned* sq_tail{nullptr};
+  unsigned sq_mask{0U};
+  unsigned sq_entries{0U};
+  unsigned sq_local_tail{0U};
+
+  unsigned* cq_head{nullptr};
+  unsigned* cq_tail{nullptr};
+  unsigned cq_mask{0U};
+  uring::completion_type* cqes{nullptr};
+};
+
+proactor::ring::ring(unsigned entry_count)
+  : params{}
+  , handle{entry_count, params}
+  , wakeup{}
+{
+  rings_length = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                       params.cq_off.cqes + params.cq_entries * sizeof(uring::completion_type));
+  rings = uring::map(handle.get(), rings_length, IORING_OFF_SQ_RING);
+
+  entries_length = params.sq_entries * sizeof(uring::submission_type);
+  try {
+    entries = static_cast<uring::submission_type*>(uring::map(handle.get(), entries_length, IORING_OFF_SQES));
+  } catch (...) {
+    uring::unmap(rings, rings_length);
+    throw;
+  }
+
+  auto* const base = static_cast<std::uint8_t*>(rings);
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+  sq_head = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+  sq_tail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+  sq_mask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+  sq_entries = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_entries);
+  sq_local_tail = *sq_tail;
+
+  // The submission entries are used in ring order, so the indirection array is an identity.
+  auto* const array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+  for (unsigned n = 0U; n != sq_entries; ++n) {
+    array[n] = n;
+  }
+
+  cq_head = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+  cq_tail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+  cq_mask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+  cqes = reinterpret_cast<uring::completion_type*>(base + params.cq_off.cqes);
+  // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+proactor::ring::~ring()
+{
+  uring::unmap(entries, entries_length);
+  uring::unmap(rings, rings_length);
+}
+
+uring::submission_type& proactor::ring::next()
+{
+  while (sq_local_tail - load_acquire(sq_head) == sq_entries) {
+    static_cast<void>(uring::enter(handle.get(), sq_entries, 0U));
+  }
+
+  auto& entry = entries[sq_local_tail & sq_mask];
+  entry = uring::submission_type{};
+  return entry;
+}
+
+void proactor::ring::push() noexcept { store_release(sq_tail, ++sq_local_tail); }
+
+void proactor::ring::arm_wakeup()
+{
+  // The wake-up event is never read, every signal wakes up the multishot poll once.
+  auto& entry = next();
+  entry.opcode = IORING_OP_POLL_ADD;
+  entry.fd = wakeup.get();
+  entry.poll32_events = POLLIN;
+  entry.len = IORING_POLL_ADD_MULTI;
+  entry.user_data = s_wakeup;
+  push();
+}
+
+void proactor::ring::provide(std::uint16_t first, std::uint16_t count)
+{
+  // The buffers are given with a submission, the submissions are performed in order, so an operation submitted after
+  // this can select them.
+  auto& entry = next();
+  entry.opcode = IORING_OP_PROVIDE_BUFFERS;
+  entry.fd = count;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  entry.addr = reinterpret_cast<std::uintptr_t>(buffer_data.get() + std::size_t{first} * buffer_size);
+  entry.len = static_cast<std::uint32_t>(buffer_size);
+  entry.off = first;
+  entry.buf_group = s_buffer_group;
+  entry.user_data = s_ignored;
+  push();
+  free_buffers += count;
+}
+
+proactor::proactor(unsigned entries, backend preferred)
+  : m_backend{backend::uring == preferred && uring::is_supported() ? backend::uring : backend::epoll}
+  , m_ring{}
+  , m_reactor{}
+  , m_slots{}
+  , m_free{}
+  , m_operations{}
+  , m_files{}
+  , m_free_files{}
+  , m_buffers{}
+  , m_receive_buffer_size{0U}
+  , m_is_stopping{false}
+  , m_is_signaled{false}
+  , m_dispatched{0U}
+  , m_thread{}
+{
+  contract::not_zero(entries, "entries cannot be zero");
+
+  if (backend::epoll == m_backend) {
+    m_reactor.emplace(1U);
+    return;
+  }
+
+  m_ring = std::make_unique<ring>(entries);
+  uring::register_files(m_ring->handle.get(), s_file_count);
+  for (auto file = s_file_count; 0U != file; --file) {
+    m_free_files.push_back(file - 1U);
+  }
+
+  // The wake-up poll is submitted by the first wait of the completion thread.
+  m_ring->arm_wakeup();
+  m_thread = std::thread{[this]() {
+    poll();
+  }};
+}
+
+proactor::~proactor()
+{
+  if (backend::epoll == m_backend) {
+    // The reactor waits for its handlers, which are the only ones that post results.
+    m_reactor.reset();
+  } else {
+    m_is_stopping.store(true, std::memory_order_release);
+    try {
+      system::posix::event::signal(m_ring->wakeup.get());
+    } catch (...) {
+      std::terminate();
+    }
+    m_thread.join();
+  }
+
+  // The operations are released only after their handlers have returned.
+  while (0U != m_dispatched.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+void proactor::register_buffers(buffer const* buffers, std::size_t count)
+{
+  contract::not_null(buffers, "buffers cannot be nullptr");
+  contract::not_zero(count, "count cannot be zero");
+  contract::not_greater(count, std::size_t{UINT16_MAX} + 1U, "count cannot exceed 65536");
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  contract::not_equal(m_buffers.empty(), false, "buffers can be registered once");
+
+  std::vector<buffer> registered{buffers, buffers + count};
+  if (backend::uring == m_backend) {
+    std::vector<::iovec> native(count);
+    std::transform(registered.begin(), registered.end(), native.begin(), [](buffer const& registered_buffer) {
+      contract::not_null(registered_buffer.data, "buffer data cannot be nullptr");
+      contract::not_zero(registered_buffer.size, "buffer size cannot be zero");
+      return ::iovec{registered_buffer.data, registered_buffer.size};
+    });
+    uring::register_buffers(m_ring->handle.get(), native.data(), static_cast<unsigned>(count));
+  }
+  m_buffers = std::move(registered);
+}
+
+void proactor::register_receive_buffers(std::size_t count, std::size_t size)
+{
+  contract::not_zero(count, "count cannot be zero");
+  contract::not_greater(count, std::size_t{UINT16_MAX}, "count cannot exceed 65535");
+  contract::not_zero(size, "size cannot be zero");
+  contract::not_greater(size, s_max_length / count, "buffers are too large");
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  contract::not_equal(0U == m_receive_buffer_size, false, "receive buffers can be registered once");
+
+  if (backend::uring == m_backend) {
+    auto& registered = *m_ring;
+    registered.buffer_data = std::make_unique<std::uint8_t[]>(count * size);
+    registered.buffer_size = size;
+    registered.provide(0U, static_cast<std::uint16_t>(count));
+  }
+  m_receive_buffer_size = size;
+}
+
+proactor::request proactor::fixed_request(int descriptor, std::size_t index, std::size_t offset,
+                                          std::size_t length) const
+{
+  contract::not_zero(length, "length cannot be zero");
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  contract::not_greater(index + 1U, m_buffers.size(), "index must refer to a registered buffer");
+  auto const& registered = m_buffers[index];
+  contract::not_greater(offset, registered.size, "offset must be within the registered buffer");
+  contract::not_greater(length, registered.size - offset, "length must be within the registered buffer");
+  return request{opcode::receive_fixed, descriptor, registered.data + offset, length,
+                 static_cast<std::uint16_t>(index)};
+}
+
+proactor::handle proactor::start(std::shared_ptr<operation> started)
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  auto const position = static_cast<std::size_t>(started->params.descriptor);
+  if (m_operations.size() <= position) {
+    m_operations.resize(position + 1U, s_no_slot);
+  }
+
+  std::uint32_t index{0U};
+  if (!m_free.empty()) {
+    index = m_free.back();
+    m_free.pop_back();
+  } else {
+    contract::not_greater(m_slots.size(), std::size_t{~std::uint32_t{0U}} - 1U, "too many operations");
+    m_slots.emplace_back();
+    m_free.reserve(m_slots.size());
+    index = static_cast<std::uint32_t>(m_slots.size() - 1U);
+  }
+
+  auto& added = *started;
+  added.index = index;
+  added.generation = m_slots[index].generation;
+  m_slots[index].started = started;
+  link(index);
+  handle const started_handle{index, added.generation};
+
+  if (backend::epoll == m_backend) {
+    // The operation is tried right away like on a reactor, only an operation that would block is watched. The local
+    // reference keeps it alive, a concurrent remove() or cancel() may finish and release it meanwhile.
+    lock.unlock();
+    auto const value = attempt(added);
+    if (-EAGAIN != value) {
+      static_cast<void>(post(added, value, 0U));
+      return started_handle;
+    }
+
+    lock.lock();
+    if (added.is_canceled) {
+      return started_handle;
+    }
+
+    // epoll takes a descriptor once, so every operation watches a duplicate and a socket can receive while it sends.
+    auto const interest = opcode::send == added.params.code ? reactor::writable : reactor::readable;
+    try {
+      added.watched = ::dup(added.params.descriptor);
+      contract::no_system_error(added.watched);
+      added.registered = added.watch(*m_reactor, interest);
+    } catch (...) {
+      if (-1 != added.watched) {
+        ::close(added.watched);
+      }
+      unlink(index);
+      m_slots[index].started.reset();
+      m_free.push_back(index);
+      throw;
+    }
+    return started_handle;
+  }
+
+  submit(added);
+  lock.unlock();
+  notify();
+  return started_handle;
+}
+
+void proactor::add(int descriptor)
+{
+  if (backend::epoll == m_backend) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  auto const position = static_cast<std::size_t>(descriptor);
+  if (m_files.size() <= position) {
+    m_files.resize(position + 1U, s_no_file);
+  }
+
+  // A socket that does not fit in the file table is used through its descriptor.
+  if (s_no_file != m_files[position] || m_free_files.empty()) {
+    return;
+  }
+  uring::update_file(m_ring->handle.get(), m_free_files.back(), descriptor);
+  m_files[position] = m_free_files.back();
+  m_free_files.pop_back();
+}
+
+void proactor::remove(int descriptor)
+{
+  std::vector<std::shared_ptr<operation>> canceled;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    auto const position = static_cast<std::size_t>(descriptor);
+    auto const first = position < m_operations.size() ? m_operations[position] : s_no_slot;
+
+    if (backend::epoll == m_backend) {
+      for (auto index = first; s_no_slot != index; index = m_slots[index].next) {
+        auto const& started = m_slots[index].started;
+        if (unwatch(*started, started->registered)) {
+          canceled.push_back(started);
+        }
+      }
+    } else {
+      auto const file = position < m_files.size() ? m_files[position] : s_no_file;
+
+      for (auto index = first; s_no_slot != index; index = m_slots[index].next) {
+        m_slots[index].started->is_canceled = true;
+      }
+
+      // A starved multishot receive has no request in the kernel to cancel.
+      auto& starved = m_ring->starved;
+      starved.erase(std::remove_if(starved.begin(), starved.end(),
+                                   [this, &canceled](std::uint32_t index) {
+                                     if (!m_slots[index].started->is_canceled) {
+                                       return false;
+                                     }
+                                     canceled.push_back(m_slots[index].started);
+                                     return true;
+                                   }),
+                    starved.end());
+
+      auto& entry = m_ring->next();
+      entry.opcode = IORING_OP_ASYNC_CANCEL;
+      entry.fd = s_no_file == file ? descriptor : static_cast<int>(file);
+      entry.cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL |
+                           (s_no_file == file ? 0U : unsigned{IORING_ASYNC_CANCEL_FD_FIXED});
+      entry.user_data = s_ignored;
+      m_ring->push();
+
+      // The cancellation is submitted right away, since the socket may be closed once this returns.
+      static_cast<void>(uring::enter(m_ring->handle.get(), m_ring->sq_entries, 0U));
+
+      if (s_no_file != file) {
+        uring::update_file(m_ring->handle.get(), file, -1);
+        m_files[position] = s_no_file;
+        m_free_files.push_back(file);
+      }
+    }
+  }
+
+  for (auto const& operation : canceled) {
+    static_cast<void>(post(*operation, -ECANCELED, 0U));
+  }
+}
+
+bool proactor::cancel(handle started)
+{
+  std::shared_ptr<operation> canceled;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (started.index >= m_slots.size() || m_slots[started.index].generation != started.generation ||
+        !m_slots[started.index].started) {
+      return false;
+    }
+
+    auto const& pending = m_slots[started.index].started;
+    {
+      // The final result may wait for the handler, the operation is released only after it has run.
+      std::lock_guard<std::mutex> result_lock{pending->mutex};
+      if (pending->is_finished) {
+        return false;
+      }
+    }
+
+    if (backend::epoll == m_backend) {
+      if (!unwatch(*pending, pending->registered)) {
+        return false;
+      }
+      canceled = pending;
+    } else {
+      pending->is_canceled = true;
+
+      // A starved multishot receive has no request in the kernel to cancel.
+      auto& starved = m_ring->starved;
+      auto const position = std::find(starved.begin(), starved.end(), started.index);
+      if (starved.end() != position) {
+        starved.erase(position);
+        canceled = pending;
+      } else {
+        auto& entry = m_ring->next();
+        entry.opcode = IORING_OP_ASYNC_CANCEL;
+        entry.fd = -1;
+        entry.addr = std::uint64_t{started.generation} << 32U | started.index;
+        entry.user_data = s_ignored;
+        m_ring->push();
+
+        // The cancellation is submitted right away, so a found operation no longer uses its buffer once this returns.
+        static_cast<void>(uring::enter(m_ring->handle.get(), m_ring->sq_entries, 0U));
+      }
+    }
+  }
+
+  return !canceled || post(*canceled, -ECANCELED, 0U);
+}
+
+bool proactor::post(operation& completed, std::int32_t value, std::uint32_t flags, std::vector<std::uint8_t> data)
+{
+  bool is_accepted{false};
+  bool is_dispatched{false};
+  {
+    std::lock_guard<std::mutex> lock{completed.mutex};
+    if (!completed.is_finished) {
+      completed.is_finished = 0U == (flags & s_more);
+      completed.pending.push_back(result{value, flags, std::move(data)});
+      is_accepted = true;
+      is_dispatched = !completed.is_scheduled;
+      completed.is_scheduled = true;
+    }
+  }
+
+  if (!is_accepted) {
+    // The result arrived after the final one, e.g. after a cancellation, and owns nothing the handler can get.
+    auto const code = completed.params.code;
+    if ((opcode::accept == code || opcode::accept_multishot == code) && 0 <= value) {
+      ::close(value);
+    }
+    if (0U != (flags & IORING_CQE_F_BUFFER)) {
+      give_back(flags);
+    }
+    return false;
+  }
+
+  if (is_dispatched) {
+    m_dispatched.fetch_add(1U, std::memory_order_relaxed);
+    completed.dispatch();
+  }
+  return true;
+}
+
+bool proactor::unwatch(operation& watching, reactor::handle registered)
+{
+  if (-1 == watching.watched) {
+    // The operation is being tried by start(), which does not watch it once it has been canceled.
+    auto const is_watchable = !watching.is_canceled;
+    watching.is_canceled = true;
+    return is_watchable;
+  }
+
+  if (!m_reactor->remove(registered)) {
+    return false;
+  }
+  ::close(watching.watched);
+  return true;
+}
+
+void proactor::perform(operation& ready, reactor::handle registered)
+{
+  // The registration is removed before the final result, a concurrent remove() posts the cancellation instead.
+  auto const value = attempt(ready);
+  if (-EAGAIN != value && unwatch(ready, registered)) {
+    static_cast<void>(post(ready, value, 0U));
+  }
+}
+
+std::int32_t proactor::attempt(operation& ready)
+{
+  auto const& params = ready.params;
+  auto const length = std::min(params.length, s_max_length);
+  for (;;) {
+    std::vector<std::uint8_t> data;
+    ::ssize_t rv{-1};
+    switch (params.code) {
+    case opcode::receive:
+    case opcode::receive_fixed:
+      rv = ::recv(params.descriptor, params.buffer, length, MSG_DONTWAIT);
+      break;
+    case opcode::send:
+      rv = ::send(params.descriptor, params.buffer, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+      break;
+    case opcode::accept:
+    case opcode::accept_multishot:
+      rv = ::accept(params.descriptor, nullptr, nullptr);
+      break;
+    case opcode::receive_multishot:
+      data.resize(length);
+      rv = ::recv(params.descriptor, data.data(), data.size(), MSG_DONTWAIT);
+      break;
+    }
+
+    if (rv < 0) {
+      auto const error = errno;
+      if (EINTR == error) {
+        continue;
+      }
+      return EWOULDBLOCK == error ? -EAGAIN : -error;
+    }
+
+    auto const value = static_cast<std::int32_t>(rv);
+    if (opcode::accept_multishot == params.code) {
+      if (!post(ready, value, s_more)) {
+        return -ECANCELED;
+      }
+    } else if (opcode::receive_multishot == params.code && 0 != value) {
+      data.resize(static_cast<std::size_t>(value));
+      if (!post(ready, value, s_more, std::move(data))) {
+        return -ECANCELED;
+      }
+    } else {
+      return value;
+    }
+  }
+}
+
+void proactor::submit(operation& submitted)
+{
+  auto const& params = submitted.params;
+  auto const position = static_cast<std::size_t>(params.descriptor);
+  auto const file = position < m_files.size() ? m_files[position] : s_no_file;
+
+  auto& entry = m_ring->next();
+  if (s_no_file == file) {
+    entry.fd = params.descriptor;
+  } else {
+    entry.fd = static_cast<int>(file);
+    entry.flags = IOSQE_FIXED_FILE;
+  }
+  entry.user_data = std::uint64_t{submitted.generation} << 32U | submitted.index;
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto const address = reinterpret_cast<std::uintptr_t>(params.buffer);
+  auto const length = static_cast<std::uint32_t>(std::min(params.length, s_max_length));
+  switch (params.code) {
+  case opcode::receive:
+    entry.opcode = IORING_OP_RECV;
+    entry.addr = address;
+    entry.len = length;
+    break;
+  case opcode::send:
+    entry.opcode = IORING_OP_SEND;
+    entry.addr = address;
+    entry.len = length;
+    entry.msg_flags = MSG_NOSIGNAL;
+    break;
+  case opcode::receive_fixed:
+    entry.opcode = IORING_OP_READ_FIXED;
+    entry.addr = address;
+    entry.len = length;
+    entry.buf_index = params.buffer_index;
+    break;
+  case opcode::accept:
+    entry.opcode = IORING_OP_ACCEPT;
+    break;
+  case opcode::accept_multishot:
+    entry.opcode = IORING_OP_ACCEPT;
+    entry.ioprio = IORING_ACCEPT_MULTISHOT;
+    break;
+  case opcode::receive_multishot:
+    entry.opcode = IORING_OP_RECV;
+    entry.ioprio = IORING_RECV_MULTISHOT;
+    entry.flags |= IOSQE_BUFFER_SELECT;
+    entry.buf_group = s_buffer_group;
+    break;
+  }
+  m_ring->push();
+}
+
+void proactor::resubmit(std::vector<std::uint32_t> const& indices)
+{
+  for (auto const index : indices) {
+    submit(*m_slots[index].started);
+  }
+}
+
+void proactor::give_back(std::uint32_t flags)
+{
+  std::vector<std::uint32_t> starved;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_ring->provide(static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT), 1U);
+    starved.swap(m_ring->starved);
+    resubmit(starved);
+  }
+
+  if (!starved.empty()) {
+    notify();
+  }
+}
+
+void proactor::release(std::uint32_t index) noexcept
+{
+  std::shared_ptr<operation> released;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    unlink(index);
+    released = std::move(m_slots[index].started);
+    ++m_slots[index].generation;
+    // The slot count only grows, so the free list never outgrows its capacity.
+    m_free.push_back(index);
+  }
+}
+
+void proactor::link(std::uint32_t index) noexcept
+{
+  auto& linked = m_slots[index];
+  auto& first = m_operations[static_cast<std::size_t>(linked.started->params.descriptor)];
+  linked.previous = s_no_slot;
+  linked.next = first;
+  if (s_no_slot != first) {
+    m_slots[first].previous = index;
+  }
+  first = index;
+}
+
+void proactor::unlink(std::uint32_t index) noexcept
+{
+  auto& unlinked = m_slots[index];
+  if (s_no_slot != unlinked.previous) {
+    m_slots[unlinked.previous].next = unlinked.next;
+  } else {
+    m_operations[static_cast<std::size_t>(unlinked.started->params.descriptor)] = unlinked.next;
+  }
+  if (s_no_slot != unlinked.next) {
+    m_slots[unlinked.next].previous = unlinked.previous;
+  }
+}
+
+void proactor::notify()
+{
+  if (!m_is_signaled.exchange(true, std::memory_order_acq_rel)) {
+    system::posix::event::signal(m_ring->wakeup.get());
+  }
+}
+
+void proactor::poll() noexcept
+{
+  struct completion {
+    std::shared_ptr<operation> completed;
+    std::int32_t value;
+    std::uint32_t flags;
+  };
+
+  auto& io = *m_ring;
+  std::vector<completion> completions;
+  std::vector<std::uint32_t> resubmitted;
+  completions.reserve(s_batch_size);
+
+  for (;;) {
+    // A signal after this point wakes up the wait, the operations started before it are submitted by the wait.
+    m_is_signaled.store(false, std::memory_order_seq_cst);
+    if (m_is_stopping.load(std::memory_order_acquire)) {
+      break;
+    }
+
+    try {
+      static_cast<void>(uring::enter(io.handle.get(), io.sq_entries, 1U));
+
+      // The wait returns early if it is interrupted, the mutex is taken only for completions.
+      auto head = *io.cq_head;
+      auto const tail = load_acquire(io.cq_tail);
+      if (tail == head) {
+        continue;
+      }
+
+      std::lock_guard<std::mutex> lock{m_mutex};
+      for (; tail != head; ++head) {
+        auto const& cqe = io.cqes[head & io.cq_mask];
+        if (s_wakeup == cqe.user_data) {
+          if (0U == (cqe.flags & s_more)) {
+            io.arm_wakeup();
+          }
+          continue;
+        }
+        if (s_ignored == cqe.user_data) {
+          continue;
+        }
+
+        auto const index = static_cast<std::uint32_t>(cqe.user_data);
+        auto const& started = m_slots[index].started;
+        if (!started || m_slots[index].generation != static_cast<std::uint32_t>(cqe.user_data >> 32U)) {
+          continue;
+        }
+        auto flags = cqe.flags;
+        if (0U != (flags & IORING_CQE_F_BUFFER)) {
+          --io.free_buffers;
+        }
+
+        auto const code = started->params.code;
+        auto const is_multishot = opcode::accept_multishot == code || opcode::receive_multishot == code;
+        if (is_multishot && 0U == (flags & s_more)) {
+          if (opcode::receive_multishot == code && -ENOBUFS == cqe.res) {
+            // Out of provided buffers, the receive goes on once a handler gives a buffer back.
+            if (started->is_canceled) {
+              completions.push_back(completion{started, -ECANCELED, 0U});
+            } else if (0U != io.free_buffers) {
+              resubmitted.push_back(index);
+            } else {
+              io.starved.push_back(index);
+            }
+            continue;
+          }
+
+          // The kernel may end a multishot operation early, e.g. on a completion queue overflow.
+          auto const is_final = opcode::receive_multishot == code ? cqe.res <= 0 : cqe.res < 0;
+          if (!is_final) {
+            flags |= s_more;
+            if (started->is_canceled) {
+              completions.push_back(completion{started, cqe.res, flags});
+              completions.push_back(completion{started, -ECANCELED, 0U});
+              continue;
+            }
+            resubmitted.push_back(index);
+          }
+        }
+        completions.push_back(completion{started, cqe.res, flags});
+      }
+      store_release(io.cq_head, head);
+
+      resubmit(resubmitted);
+    } catch (...) {
+      std::terminate();
+    }
+
+    resubmitted.clear();
+    for (auto& completed : completions) {
+      static_cast<void>(post(*completed.completed, completed.value, completed.flags));
+    }
+    completions.clear();
+  }
+}
+
+void proactor::operation::run() noexcept
+{
+  auto* const dispatcher = owner;
+  {
+    // The last result releases the operation, which stays alive until the handler has returned.
+    auto const self = shared_from_this();
+    for (;;) {
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        running.clear();
+        if (pending.empty()) {
+          is_scheduled = false;
+          break;
+        }
+        std::swap(pending, running);
+      }
+
+      for (auto const& completed : running) {
+        auto const is_provided = 0U != (completed.flags & IORING_CQE_F_BUFFER);
+        auto const* data = completed.data.empty() ? nullptr : completed.data.data();
+        if (is_provided) {
+          data = dispatcher->m_ring->buffer_at(completed.flags);
+        }
+
+        try {
+          invoke(completed.value, data);
+          if (is_provided) {
+            dispatcher->give_back(completed.flags);
+          }
+        } catch (...) {
+          std::terminate();
+        }
+
+        if (0U == (completed.flags & s_more)) {
+          dispatcher->release(index);
+        }
+      }
+    }
+  }
+  dispatcher->m_dispatched.fetch_sub(1U, std::memory_order_release);
+}
+
+}  // namespace jar::com
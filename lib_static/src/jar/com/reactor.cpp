@@ -0,0 +1,253 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file reactor.cpp
+///
+#include "jar/com/reactor.hpp"
+
+#include <array>
+
+#include "jar/core/contract.hpp"
+
+namespace jar::com {
+namespace {
+
+/// \brief Converts the events of interest to native edge-triggered events, hang-up and error are always reported
+std::uint32_t to_native(reactor::event_mask interest) noexcept
+{
+  std::uint32_t events{EPOLLET | EPOLLRDHUP};
+  if (0U != (interest & reactor::readable)) {
+    events |= EPOLLIN;
+  }
+  if (0U != (interest & reactor::writable)) {
+    events |= EPOLLOUT;
+  }
+  return events;
+}
+
+reactor::event_mask from_native(std::uint32_t events) noexcept
+{
+  reactor::event_mask ready{0U};
+  if (0U != (events & EPOLLIN)) {
+    ready |= reactor::readable;
+  }
+  if (0U != (events & EPOLLOUT)) {
+    ready |= reactor::writable;
+  }
+  if (0U != (events & (EPOLLRDHUP | EPOLLHUP))) {
+    ready |= reactor::closed;
+  }
+  if (0U != (events & EPOLLERR)) {
+    ready |= reactor::error;
+  }
+  return ready;
+}
+
+}  // namespace
+
+reactor::reactor(unsigned thread_count)
+  : m_epoll{}
+  , m_wakeup{}
+  , m_slots{}
+  , m_free{}
+  , m_size{0U}
+  , m_is_stopping{false}
+  , m_dispatched{0U}
+  , m_threads{}
+{
+  contract::not_zero(thread_count, "thread_count cannot be zero");
+
+  // The wake-up event is level-triggered and never read, once signaled it wakes up every reactor thread.
+  system::posix::epoll::add(m_epoll.get(), m_wakeup.get(), EPOLLIN, s_wakeup);
+
+  try {
+    for (unsigned thread = 0U; thread != thread_count; ++thread) {
+      m_threads.emplace_back([this]() {
+        poll();
+      });
+    }
+  } catch (...) {
+    m_is_stopping.store(true, std::memory_order_release);
+    system::posix::event::signal(m_wakeup.get());
+    for (auto& thread : m_threads) {
+      thread.join();
+    }
+    throw;
+  }
+}
+
+reactor::~reactor()
+{
+  m_is_stopping.store(true, std::memory_order_release);
+  try {
+    system::posix::event::signal(m_wakeup.get());
+  } catch (...) {
+    std::terminate();
+  }
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+
+  // The registrations of the dispatched handlers are released only after the handlers have returned.
+  while (0U != m_dispatched.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+bool reactor::remove(handle registered)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  if (registered.index >= m_slots.size() || m_slots[registered.index].generation != registered.generation ||
+      !m_slots[registered.index].registered) {
+    return false;
+  }
+
+  auto& removed = *m_slots[registered.index].registered;
+  auto const state = removed.state.fetch_or(s_removed, std::memory_order_acq_rel);
+  if (0U != (state & s_removed)) {
+    return false;
+  }
+
+  system::posix::epoll::remove(m_epoll.get(), removed.descriptor);
+  --m_size;
+
+  // A scheduled handler releases the registration when it returns.
+  if (0U == (state & s_scheduled)) {
+    release_locked(registered.index);
+  }
+  return true;
+}
+
+std::size_t reactor::size() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_size;
+}
+
+void reactor::registration::run() noexcept
+{
+  // The registration may be released as soon as it is no longer scheduled, but the reactor outlives the handler.
+  auto* const dispatcher = owner;
+
+  for (;;) {
+    auto const pending = state.fetch_and(~s_event_bits, std::memory_order_acq_rel);
+    if (0U != (pending & s_removed)) {
+      break;
+    }
+    if (0U != (pending & s_event_bits)) {
+      invoke(pending & s_event_bits);
+    }
+
+    auto expected = s_scheduled;
+    if (state.compare_exchange_strong(expected, 0U, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      dispatcher->m_dispatched.fetch_sub(1U, std::memory_order_release);
+      return;
+    }
+  }
+
+  dispatcher->release(index);
+  dispatcher->m_dispatched.fetch_sub(1U, std::memory_order_release);
+}
+
+reactor::handle reactor::add(int descriptor, event_mask interest, std::unique_ptr<registration> registered)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+
+  std::uint32_t index{0U};
+  if (!m_free.empty()) {
+    index = m_free.back();
+    m_free.pop_back();
+  } else {
+    contract::not_greater(m_slots.size(), std::size_t{~std::uint32_t{0U}} - 1U, "too many registrations");
+    // The free list has room for every slot, so releasing a registration never allocates.
+    if (m_free.capacity() <= m_slots.size()) {
+      m_free.reserve(2U * m_slots.size() + 1U);
+    }
+    m_slots.emplace_back();
+    index = static_cast<std::uint32_t>(m_slots.size() - 1U);
+  }
+
+  auto& added = m_slots[index];
+  registered->owner = this;
+  registered->index = index;
+  registered->generation = added.generation;
+  registered->descriptor = descriptor;
+
+  try {
+    system::posix::epoll::add(m_epoll.get(), descriptor, to_native(interest),
+                              (std::uint64_t{added.generation} << 32U) | index);
+  } catch (...) {
+    m_free.push_back(index);
+    throw;
+  }
+
+  added.registered = std::move(registered);
+  ++m_size;
+  return handle{index, added.generation};
+}
+
+void reactor::release(std::uint32_t index) noexcept
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  release_locked(index);
+}
+
+void reactor::release_locked(std::uint32_t index) noexcept
+{
+  auto& released = m_slots[index];
+  released.registered.reset();
+  ++released.generation;
+  m_free.push_back(index);
+}
+
+void reactor::poll() noexcept
+{
+  std::array<system::posix::epoll::event_type, s_batch_size> events{};
+  std::array<registration*, s_batch_size> ready{};
+
+  while (!m_is_stopping.load(std::memory_order_acquire)) {
+    auto const count = system::posix::epoll::wait(m_epoll.get(), events.data(), events.size());
+
+    std::size_t ready_count{0U};
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      for (std::size_t n = 0U; n != count; ++n) {
+        auto const data = events[n].data.u64;
+        if (s_wakeup == data) {
+          continue;
+        }
+
+        // Events of a removed registration may still be in the batch, the generation tells them apart.
+        auto const& notified = m_slots[static_cast<std::uint32_t>(data)];
+        if (notified.generation != static_cast<std::uint32_t>(data >> 32U) || !notified.registered) {
+          continue;
+        }
+
+        auto const state = notified.registered->state.fetch_or(from_native(events[n].events) | s_scheduled,
+                                                               std::memory_order_acq_rel);
+        if (0U == (state & (s_scheduled | s_removed))) {
+          ready[ready_count++] = notified.registered.get();
+        }
+      }
+    }
+
+    // A scheduled registration is not released before its handler has run, so it is safe to dispatch unlocked.
+    m_dispatched.fetch_add(ready_count, std::memory_order_relaxed);
+    for (std::size_t n = 0U; n != ready_count; ++n) {
+      ready[n]->dispatch();
+    }
+  }
+}
+
+}  // namespace jar::com
@@ -0,0 +1,87 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file epoll.cpp
+///
+#include "jar/system/posix/epoll.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <exception>
+
+#include <sys/eventfd.h>
+
+#include <unistd.h>
+
+#include "jar/core/contract.hpp"
+
+namespace jar::system::posix {
+
+[[nodiscard]] epoll::native_type epoll::construct()
+{
+  auto const handle{::epoll_create1(EPOLL_CLOEXEC)};
+  contract::no_system_error(handle);
+  return handle;
+}
+
+void epoll::destroy(native_type handle) noexcept
+{
+  if (contract::is_system_error(::close(handle))) {
+    std::terminate();
+  }
+}
+
+void epoll::add(native_type handle, int descriptor, std::uint32_t events, std::uint64_t data)
+{
+  event_type event{};
+  event.events = events;
+  event.data.u64 = data;
+  contract::no_system_error(::epoll_ctl(handle, EPOLL_CTL_ADD, descriptor, &event));
+}
+
+void epoll::remove(native_type handle, int descriptor)
+{
+  // Closing the last descriptor of a file removes it from the epoll instance, so it may be gone already.
+  contract::no_system_error_other_than(::epoll_ctl(handle, EPOLL_CTL_DEL, descriptor, nullptr), ENOENT, EBADF);
+}
+
+[[nodiscard]] std::size_t epoll::wait(native_type handle, event_type* events, std::size_t max_events)
+{
+  auto const count{::epoll_wait(handle, events, static_cast<int>(std::min<std::size_t>(max_events, INT_MAX)), -1)};
+  contract::no_system_error_other_than(count, EINTR);
+  return count < 0 ? 0U : static_cast<std::size_t>(count);
+}
+
+[[nodiscard]] event::native_type event::construct()
+{
+  auto const handle{::eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK)};
+  contract::no_system_error(handle);
+  return handle;
+}
+
+void event::destroy(native_type handle) noexcept
+{
+  if (contract::is_system_error(::close(handle))) {
+    std::terminate();
+  }
+}
+
+void event::signal(native_type handle)
+{
+  ::eventfd_t const value{1U};
+  contract::no_system_error_other_than(::write(handle, &value, sizeof(value)), EAGAIN);
+}
+
+}  // namespace jar::system::posix
@@ -18,8 +18,10 @@
 #include "jar/system/posix/socket.hpp"
 
 #include <algorithm>
+#include <array>
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 
 #include <fcntl.h>
@@ -29,6 +31,48 @@
 #include "jar/core/enum.hpp"
 
 namespace jar::system::posix {
+namespace {
+
+using io_vectors = std::array<::iovec, socket::max_segments()>;
+
+/// \brief Describes the segments as a message, the segments are validated by the socket templates
+template <typename Buffer>
+::msghdr to_message(com::buffer_sequence<Buffer> buffers, io_vectors& vectors) noexcept
+{
+  std::transform(buffers.begin(), buffers.end(), vectors.begin(), [](Buffer const& buffer) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    return ::iovec{const_cast<std::uint8_t*>(buffer.data), buffer.size};
+  });
+
+  ::msghdr message{};
+  message.msg_iov = vectors.data();
+  message.msg_iovlen = buffers.size();
+  return message;
+}
+
+using batch_vectors = std::array<::iovec, socket::max_batch()>;
+using batch_messages = std::array<::mmsghdr, socket::max_batch()>;
+
+/// \brief Describes each buffer as a message of its own with the address at the same index
+template <typename Buffer, typename Address>
+void to_messages(com::buffer_sequence<Buffer> buffers, Address const* addresses, std::size_t address_size,
+                 batch_vectors& vectors, batch_messages& messages) noexcept
+{
+  for (std::size_t index = 0U; index != buffers.size(); ++index) {
+    auto const& buffer = buffers.data()[index];
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    vectors[index] = ::iovec{const_cast<std::uint8_t*>(buffer.data), buffer.size};
+
+    messages[index] = ::mmsghdr{};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    messages[index].msg_hdr.msg_name = const_cast<::sockaddr*>(addresses[index]);
+    messages[index].msg_hdr.msg_namelen = static_cast<::socklen_t>(address_size);
+    messages[index].msg_hdr.msg_iov = &vectors[index];
+    messages[index].msg_hdr.msg_iovlen = 1U;
+  }
+}
+
+}  // namespace
 
 using core::to_integral;
 
@@ -59,8 +103,11 @@ void socket::non_blocking(native_type handle, bool mode)
 {
   const auto flags{get_descriptor_flags(handle)};
   int new_flags{mode ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)};
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-  contract::no_system_error(::fcntl(handle, F_SETFL, new_flags));
+  // A socket that is in the mode already, e.g. on every registration to a reactor, costs a single system call.
+  if (new_flags != flags) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    contract::no_system_error(::fcntl(handle, F_SETFL, new_flags));
+  }
 }
 
 void socket::shutdown(native_type handle, com::shutdown_mode mode)
@@ -88,6 +135,13 @@ socket::native_type socket::accept(native_type handle)
   return socket_handle;
 }
 
+socket::native_type socket::accept(native_type handle, std::error_code& error) noexcept
+{
+  const auto socket_handle{::accept(handle, nullptr, nullptr)};
+  error = contract::is_system_error(socket_handle) ? std::error_code{errno, std::system_category()} : std::error_code{};
+  return socket_handle;
+}
+
 void socket::bind(native_type handle, ::sockaddr const* const local_address, std::size_t address_size)
 {
   ::socklen_t length{static_cast<::socklen_t>(address_size)};
@@ -107,6 +161,18 @@ void socket::connect(native_type handle, const ::sockaddr* remote_address, std::
   return static_cast<std::size_t>(bytes_received);
 }
 
+[[nodiscard]] std::size_t socket::receive(native_type handle, std::uint8_t* buffer, std::size_t length,
+                                         std::error_code& error) noexcept
+{
+  const auto bytes_received{::recv(handle, static_cast<void*>(buffer), length, MSG_DONTWAIT)};
+  if (contract::is_system_error(bytes_received)) {
+    error = std::error_code{errno, std::system_category()};
+    return 0U;
+  }
+  error.clear();
+  return static_cast<std::size_t>(bytes_received);
+}
+
 [[nodiscard]] std::size_t socket::send(native_type handle, const std::uint8_t* buffer, std::size_t length)
 {
   const auto bytes_send{::send(handle, static_cast<const void*>(buffer), length, MSG_NOSIGNAL)};
@@ -114,6 +180,64 @@ void socket::connect(native_type handle, const ::sockaddr* remote_address, std::
   return static_cast<std::size_t>(bytes_send);
 }
 
+[[nodiscard]] std::size_t socket::send(native_type handle, const std::uint8_t* buffer, std::size_t length,
+                                      std::error_code& error) noexcept
+{
+  const auto bytes_send{::send(handle, static_cast<const void*>(buffer), length, MSG_NOSIGNAL | MSG_DONTWAIT)};
+  if (contract::is_system_error(bytes_send)) {
+    error = std::error_code{errno, std::system_category()};
+    return 0U;
+  }
+  error.clear();
+  return static_cast<std::size_t>(bytes_send);
+}
+
+[[nodiscard]] std::size_t socket::receive(native_type handle, com::mutable_buffers buffers)
+{
+  io_vectors vectors;
+  auto message{to_message(buffers, vectors)};
+  const auto bytes_received{::recvmsg(handle, &message, 0)};
+  contract::no_system_error(bytes_received);
+  return static_cast<std::size_t>(bytes_received);
+}
+
+[[nodiscard]] std::size_t socket::receive(native_type handle, com::mutable_buffers buffers,
+                                         std::error_code& error) noexcept
+{
+  io_vectors vectors;
+  auto message{to_message(buffers, vectors)};
+  const auto bytes_received{::recvmsg(handle, &message, MSG_DONTWAIT)};
+  if (contract::is_system_error(bytes_received)) {
+    error = std::error_code{errno, std::system_category()};
+    return 0U;
+  }
+  error.clear();
+  return static_cast<std::size_t>(bytes_received);
+}
+
+[[nodiscard]] std::size_t socket::send(native_type handle, com::const_buffers buffers)
+{
+  io_vectors vectors;
+  auto const message{to_message(buffers, vectors)};
+  const auto bytes_send{::sendmsg(handle, &message, MSG_NOSIGNAL)};
+  contract::no_system_error(bytes_send);
+  return static_cast<std::size_t>(bytes_send);
+}
+
+[[nodiscard]] std::size_t socket::send(native_type handle, com::const_buffers buffers,
+                                      std::error_code& error) noexcept
+{
+  io_vectors vectors;
+  auto const message{to_message(buffers, vectors)};
+  const auto bytes_send{::sendmsg(handle, &message, MSG_NOSIGNAL | MSG_DONTWAIT)};
+  if (contract::is_system_error(bytes_send)) {
+    error = std::error_code{errno, std::system_category()};
+    return 0U;
+  }
+  error.clear();
+  return static_cast<std::size_t>(bytes_send);
+}
+
 [[nodiscard]] std::size_t socket::send_to(native_type handle, const std::uint8_t* buffer, std::size_t length,
                                           ::sockaddr const* const remote_address, std::size_t address_size)
 {
@@ -132,6 +256,34 @@ void socket::connect(native_type handle, const ::sockaddr* remote_address, std::
   return static_cast<std::size_t>(bytes_received);
 }
 
+[[nodiscard]] std::size_t socket::send_batch(native_type handle, com::const_buffers buffers,
+                                             ::sockaddr const* const* remote_addresses, std::size_t address_size)
+{
+  batch_vectors vectors;
+  batch_messages messages;
+  to_messages(buffers, remote_addresses, address_size, vectors, messages);
+  const auto datagrams_send{::sendmmsg(handle, messages.data(), static_cast<unsigned>(buffers.size()), 0)};
+  contract::no_system_error(datagrams_send);
+  return static_cast<std::size_t>(datagrams_send);
+}
+
+[[nodiscard]] std::size_t socket::receive_batch(native_type handle, com::mutable_buffers buffers,
+                                                ::sockaddr* const* remote_addresses, std::size_t address_size,
+                                                std::size_t* lengths)
+{
+  batch_vectors vectors;
+  batch_messages messages;
+  to_messages(buffers, remote_addresses, address_size, vectors, messages);
+  // Block only until the first datagram arrives, the rest of the batch takes the datagrams that are already queued.
+  const auto datagrams_received{
+      ::recvmmsg(handle, messages.data(), static_cast<unsigned>(buffers.size()), MSG_WAITFORONE, nullptr)};
+  contract::no_system_error(datagrams_received);
+  std::transform(messages.begin(), messages.begin() + datagrams_received, lengths, [](::mmsghdr const& message) {
+    return std::size_t{message.msg_len};
+  });
+  return static_cast<std::size_t>(datagrams_received);
+}
+
 void socket::set_send_timeout(native_type handle, std::chrono::microseconds microseconds)
 {
   ::timeval time_value{};
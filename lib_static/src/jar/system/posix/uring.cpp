@@ -0,0 +1,148 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file uring.cpp
+///
+#include "jar/system/posix/uring.hpp"
+
+#include <array>
+#include <cerrno>
+#include <exception>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <unistd.h>
+
+#include "jar/core/contract.hpp"
+
+namespace jar::system::posix {
+namespace {
+
+/// \brief Checks whether the ring supports every operation that the proactor submits
+bool supports_operations(uring::native_type handle) noexcept
+{
+  // IORING_OP_SEND_ZC arrived in 6.0 together with multishot receive, which is the newest feature in use.
+  constexpr std::array<std::uint8_t, 8U> required{
+      IORING_OP_ACCEPT,     IORING_OP_RECV,         IORING_OP_SEND,    IORING_OP_POLL_ADD,
+      IORING_OP_READ_FIXED, IORING_OP_ASYNC_CANCEL, IORING_OP_SEND_ZC, IORING_OP_PROVIDE_BUFFERS};
+  constexpr std::size_t op_count{256U};
+
+  // The probe ends in a flexible array of operations, so it is placed in a buffer that holds every operation.
+  alignas(::io_uring_probe) std::array<std::uint8_t, sizeof(::io_uring_probe) + op_count * sizeof(::io_uring_probe_op)>
+      buffer{};
+  auto* const result = reinterpret_cast<::io_uring_probe*>(buffer.data());
+  if (contract::is_system_error(::syscall(__NR_io_uring_register, handle, IORING_REGISTER_PROBE, result, op_count))) {
+    return false;
+  }
+
+  for (auto const op : required) {
+    if (op > result->last_op || 0U == (result->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool probe() noexcept
+{
+  uring::params_type params{};
+  auto const handle{static_cast<int>(::syscall(__NR_io_uring_setup, 2U, &params))};
+  if (contract::is_system_error(handle)) {
+    return false;
+  }
+
+  auto const is_supported = 0U != (params.features & IORING_FEAT_SINGLE_MMAP) &&
+                            0U != (params.features & IORING_FEAT_NODROP) && supports_operations(handle);
+  ::close(handle);
+  return is_supported;
+}
+
+}  // namespace
+
+[[nodiscard]] uring::native_type uring::construct(unsigned entries, params_type& params)
+{
+  params = params_type{};
+  params.flags = IORING_SETUP_CLAMP;
+  auto const handle{static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params))};
+  contract::no_system_error(handle);
+  return handle;
+}
+
+void uring::destroy(native_type handle) noexcept
+{
+  if (contract::is_system_error(::close(handle))) {
+    std::terminate();
+  }
+}
+
+[[nodiscard]] bool uring::is_supported() noexcept
+{
+  static bool const s_is_supported{probe()};
+  return s_is_supported;
+}
+
+unsigned uring::enter(native_type handle, unsigned to_submit, unsigned min_complete)
+{
+  auto const flags = 0U == min_complete ? 0U : unsigned{IORING_ENTER_GETEVENTS};
+  auto const submitted{
+      static_cast<int>(::syscall(__NR_io_uring_enter, handle, to_submit, min_complete, flags, nullptr, 0U))};
+  // The completion queue is full (EBUSY) or the kernel is short of memory (EAGAIN), reaping the completions helps.
+  contract::no_system_error_other_than(submitted, EINTR, EAGAIN, EBUSY);
+  return submitted < 0 ? 0U : static_cast<unsigned>(submitted);
+}
+
+void uring::register_buffers(native_type handle, ::iovec const* buffers, unsigned count)
+{
+  contract::no_system_error(
+      static_cast<int>(::syscall(__NR_io_uring_register, handle, IORING_REGISTER_BUFFERS, buffers, count)));
+}
+
+void uring::register_files(native_type handle, unsigned count)
+{
+  ::io_uring_rsrc_register files{};
+  files.nr = count;
+  files.flags = IORING_RSRC_REGISTER_SPARSE;
+  contract::no_system_error(static_cast<int>(
+      ::syscall(__NR_io_uring_register, handle, IORING_REGISTER_FILES2, &files, sizeof(files))));
+}
+
+void uring::update_file(native_type handle, unsigned index, int descriptor)
+{
+  ::io_uring_rsrc_update update{};
+  update.offset = index;
+  update.data = reinterpret_cast<std::uintptr_t>(&descriptor);
+  contract::no_system_error(
+      static_cast<int>(::syscall(__NR_io_uring_register, handle, IORING_REGISTER_FILES_UPDATE, &update, 1U)));
+}
+
+[[nodiscard]] void* uring::map(native_type handle, std::size_t length, std::uint64_t offset)
+{
+  auto* const address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, handle,
+                               static_cast<::off_t>(offset));
+  if (MAP_FAILED == address) {
+    throw std::system_error{errno, std::system_category()};
+  }
+  return address;
+}
+
+void uring::unmap(void* address, std::size_t length) noexcept
+{
+  if (contract::is_system_error(::munmap(address, length))) {
+    std::terminate();
+  }
+}
+
+}  // namespace jar::system::posix
@@ -19,6 +19,7 @@
 
 #include <benchmark/benchmark.h>
 
+#include <array>
 #include <random>
 
 namespace jar::com::bench {
@@ -73,4 +73,62 @@ BENCHMARK_REGISTER_F(datagram_socket_benchmark, throughput)
     ->Range(64, 4096)
     ->Iterations(1'000'000);
 
+/// \brief A benchmark case for batched datagram socket throughput
+///
+/// Every iteration sends one batch with a single system call when the receiver keeps up.
+///
+/// This benchmark provides the following counters:
+///   - messages per second
+///   - bytes per second
+BENCHMARK_DEFINE_F(datagram_batch_benchmark, throughput)(::benchmark::State& state)
+{
+  using ::benchmark::Counter;
+
+  std::size_t messages{0U};
+  ipc::datagram_socket socket;
+  socket.bind(endpoint_b());
+
+  auto const data = generate();
+  std::vector<ipc::address> const remote_addresses(batch_size(), endpoint_a());
+  std::vector<const_buffer> const buffers(batch_size(), const_buffer{data.data(), data.size()});
+
+  for (auto _ : state) {
+    std::size_t datagrams_send{0U};
+    while (datagrams_send != buffers.size()) {
+      const_buffers const remaining{buffers.data() + datagrams_send, buffers.size() - datagrams_send};
+      datagrams_send += socket.send_batch(remote_addresses.data() + datagrams_send, remaining);
+    }
+    messages += datagrams_send;
+  }
+
+  wait_received(messages);
+  socket.shutdown();
+
+  auto const bytes = static_cast<std::int64_t>(messages * data.size());
+  state.counters["Bytes"] = Counter(bytes, ::benchmark::Counter::kIsRate, Counter::kIs1024);
+  state.counters["Messages"] = Counter(static_cast<std::int64_t>(messages), Counter::kIsRate, Counter::kIs1000);
+}
+
+/// \brief A benchmark configuration for batched throughput with 64 byte messages and batch sizes between 1 and 64
+///
+/// This benchmark configuration provides the following custom statistics:
+///   - minimum duration
+///   - maximum duration
+BENCHMARK_REGISTER_F(datagram_batch_benchmark, throughput)
+    ->ComputeStatistics("max",
+                        [](const std::vector<double>& elapsed) -> double {
+                          return *(std::max_element(std::begin(elapsed), std::end(elapsed)));
+                        })
+    ->ComputeStatistics("min",
+                        [](const std::vector<double>& elapsed) -> double {
+                          return *(std::min_element(std::begin(elapsed), std::end(elapsed)));
+                        })
+    ->ArgNames({"size", "batch"})
+    ->Apply([](::benchmark::internal::Benchmark* benchmark) {
+      for (std::int64_t batch = 1; batch <= 64; batch *= 2) {
+        benchmark->Args({64, batch});
+      }
+    })
+    ->Iterations(100'000);
+
 }  // namespace jar::com::bench
@@ -21,6 +21,7 @@
 
 #include <future>
 #include <thread>
+#include <vector>
 
 #include <jar/com/ipc/ipc.hpp>
 
@@ -102,6 +103,104 @@ private:
   std::thread m_thread;
 };
 
+/// \brief Benchmark fixture class for batched datagrams
+///
+/// The first argument is the message size and the second one the batch size. Instead of echoing, a sink thread
+/// receives the datagrams in batches of the same size, so the sender and the receiver both amortize their system calls.
+class datagram_batch_benchmark : public basic_socket_benchmark {
+public:
+  /// \brief Sets up the test fixture
+  ///
+  /// \param[in|out]  state       Benchmark state
+  void SetUp(::benchmark::State& state) override
+  {
+    basic_socket_benchmark::SetUp(state);
+    m_batch_size = static_cast<std::size_t>(state.range(1));
+    m_received.store(0U);
+    m_is_running.store(true);
+
+    auto thread_ready = make_sink_thread();
+    thread_ready.wait();
+  }
+
+  /// \brief Tears down the test fixture
+  ///
+  /// \param[in|out]  state       Benchmark state
+  void TearDown(::benchmark::State& state) override
+  {
+    m_is_running.store(false);
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+
+    basic_socket_benchmark::TearDown(state);
+  }
+
+  /// \brief Waits until the sink thread has received the given number of datagrams
+  ///
+  /// \param[in]  count       Datagram count
+  void wait_received(std::size_t count) const noexcept
+  {
+    while (m_received.load() < count && m_is_running.load()) {
+      std::this_thread::yield();
+    }
+  }
+
+  /// \brief Gets the batch size
+  std::size_t batch_size() const noexcept { return m_batch_size; }
+
+  /// \brief Gets the ipc address b
+  ipc::address const& endpoint_b() noexcept { return m_endpoint_b; }
+
+  /// \brief Gets the ipc address a
+  ipc::address const& endpoint_a() const noexcept { return m_endpoint_a; }
+
+private:
+  /// \brief Init a batched receive thread for the benchmark
+  ///
+  /// \return A future that indicates when the setup phase of the thread is done
+  std::future<void> make_sink_thread()
+  {
+    std::promise<void> thread_init;
+    auto thread_ready = thread_init.get_future();
+
+    m_thread = std::thread{[this, thread_init = std::move(thread_init)]() mutable {
+      ipc::datagram_socket socket;
+      socket.bind(m_endpoint_a);
+      socket.set_timeout(std::chrono::milliseconds{100U});
+
+      std::vector<ipc::address> endpoints(m_batch_size);
+      std::vector<std::uint8_t> buffer(m_batch_size * message_size());
+      std::vector<mutable_buffer> buffers;
+      for (std::size_t n = 0U; n != m_batch_size; ++n) {
+        buffers.push_back(mutable_buffer{buffer.data() + n * message_size(), message_size()});
+      }
+      std::vector<std::size_t> lengths(m_batch_size);
+
+      thread_init.set_value();
+
+      try {
+        while (m_is_running.load()) {
+          m_received.fetch_add(socket.receive_batch(endpoints.data(), buffers, lengths.data()));
+        };
+      } catch (const std::system_error& e) {
+        contract::no_system_error_other_than(e.code().value(), ETIMEDOUT);
+      }
+
+      socket.shutdown();
+    }};
+
+    return thread_ready;
+  }
+
+  ipc::address const m_endpoint_a{DGRAM_CHANNEL_A};
+  ipc::address const m_endpoint_b{DGRAM_CHANNEL_B};
+  std::atomic_bool m_is_running{true};
+  std::atomic_size_t m_received{0U};
+  std::size_t m_batch_size{1U};
+  std::thread m_thread;
+};
+
 }  // namespace jar::com::bench
 
 #endif  // JAR_NET_DATAGRAM_SOCKET_BENCHMARK_HPP
@@ -0,0 +1,44 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file reactor_benchmark.cpp
+///
+#include "reactor_benchmark.hpp"
+
+namespace jar::com::bench {
+
+/// \brief A benchmark case for a round trip through a reactor handler, next to a number of idle connections
+///
+/// The round trip time should not depend on the number of idle connections.
+///
+/// This benchmark provides the following counters:
+///   - round trips per second
+///   - heap bytes per idle connection (sockets, registration and the reactor slot)
+BENCHMARK_DEFINE_F(reactor_benchmark, round_trip)(::benchmark::State& state)
+{
+  using ::benchmark::Counter;
+
+  std::array<std::uint8_t, 1U> data{0x2a};
+  for (auto _ : state) {
+    static_cast<void>(client().send(data.data(), data.size()));
+    static_cast<void>(client().receive(data.data(), data.size()));
+  }
+
+  state.counters["RoundTrips"] = Counter(static_cast<double>(state.iterations()), Counter::kIsRate);
+  state.counters["BytesPerIdle"] = bytes_per_idle();
+}
+
+BENCHMARK_REGISTER_F(reactor_benchmark, round_trip)->Arg(0)->Arg(1024)->Arg(8192);
+
+}  // namespace jar::com::bench
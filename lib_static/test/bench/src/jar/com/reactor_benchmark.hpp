@@ -0,0 +1,143 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file reactor_benchmark.hpp
+///
+#ifndef JAR_NET_REACTOR_BENCHMARK_HPP
+#define JAR_NET_REACTOR_BENCHMARK_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <cerrno>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include <jar/com/ipc/ipc.hpp>
+#include <jar/com/reactor.hpp>
+#include <jar/concurrency/thread_pool.hpp>
+#include <jar/concurrency/ws_scheduler.hpp>
+
+namespace jar::com::bench {
+
+/// \brief Benchmark fixture class for the reactor, with a number of idle connections registered next to the active one
+class reactor_benchmark : public ::benchmark::Fixture {
+public:
+  /// \brief Sets up the test fixture
+  ///
+  /// \param[in|out]  state       Benchmark state
+  void SetUp(::benchmark::State& state) override
+  {
+    // Every connection takes two descriptors.
+    ::rlimit limit{};
+    if (0 == ::getrlimit(RLIMIT_NOFILE, &limit)) {
+      limit.rlim_cur = limit.rlim_max;
+      static_cast<void>(::setrlimit(RLIMIT_NOFILE, &limit));
+    }
+
+    m_pool = std::make_unique<concurrency::thread_pool<concurrency::ws_scheduler>>(2U);
+    m_reactor = std::make_unique<reactor>();
+    m_server_socket.emplace();
+    m_server_socket->bind(m_server_address);
+    m_server_socket->listen();
+
+    auto const heap = heap_size();
+    auto const idle_count = static_cast<std::size_t>(state.range(0));
+    for (std::size_t n = 0U; n != idle_count; ++n) {
+      add_connection([](reactor::event_mask) {});
+    }
+    m_bytes_per_idle = 0U == idle_count ? 0.0 : static_cast<double>(heap_size() - heap) / idle_count;
+
+    add_connection([this](reactor::event_mask) {
+      echo(*m_connections.back().server);
+    });
+
+    Fixture::SetUp(state);
+  }
+
+  /// \brief Tears down the test fixture
+  ///
+  /// \param[in|out]  state       Benchmark state
+  void TearDown(::benchmark::State& state) override
+  {
+    for (auto& connection : m_connections) {
+      m_reactor->remove(connection.registered);
+    }
+    m_reactor.reset();
+    m_connections.clear();
+    m_server_socket.reset();
+    m_pool.reset();
+
+    Fixture::TearDown(state);
+  }
+
+  /// \brief Gets the client socket of the active connection
+  ipc::stream_socket& client() noexcept { return *m_connections.back().client; }
+
+  /// \brief Gets the heap memory taken by an idle connection, in bytes
+  double bytes_per_idle() const noexcept { return m_bytes_per_idle; }
+
+private:
+  struct connection {
+    std::unique_ptr<ipc::stream_socket> client;
+    std::unique_ptr<ipc::stream_socket> server;
+    reactor::handle registered;
+  };
+
+  template <typename Handler> void add_connection(Handler&& handler)
+  {
+    auto& added = m_connections.emplace_back();
+    added.client = std::make_unique<ipc::stream_socket>();
+    added.client->connect(m_server_address);
+    m_server_socket->accept([&added](ipc::stream_socket&& socket) {
+      added.server = std::make_unique<ipc::stream_socket>(std::move(socket));
+    });
+    added.registered =
+        m_reactor->add(*added.server, reactor::readable, m_pool->get_scheduler(), std::forward<Handler>(handler));
+  }
+
+  /// \brief Sends the received bytes back until the socket would block
+  static void echo(ipc::stream_socket& socket)
+  {
+    std::array<std::uint8_t, 64U> buffer{};
+    try {
+      for (auto bytes = socket.receive(buffer.data(), buffer.size()); 0U != bytes;
+           bytes = socket.receive(buffer.data(), buffer.size())) {
+        static_cast<void>(socket.send(buffer.data(), bytes));
+      }
+    } catch (std::system_error const& e) {
+      if (EAGAIN != e.code().value()) {
+        throw;
+      }
+    }
+  }
+
+  /// \brief Gets the heap bytes in use
+  static std::size_t heap_size() { return ::mallinfo2().uordblks; }
+
+  ipc::address const m_server_address{SOCKET_ADDRESS};
+  std::unique_ptr<concurrency::thread_pool<concurrency::ws_scheduler>> m_pool;
+  std::unique_ptr<reactor> m_reactor;
+  std::optional<ipc::stream_server_socket> m_server_socket;
+  std::vector<connection> m_connections;
+  double m_bytes_per_idle{0.0};
+};
+
+}  // namespace jar::com::bench
+
+#endif  // JAR_NET_REACTOR_BENCHMARK_HPP
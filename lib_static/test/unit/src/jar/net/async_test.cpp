@@ -0,0 +1,228 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file async_test.cpp
+///
+#include "reactor_test.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <jar/com/async.hpp>
+#include <jar/concurrency/schedule.hpp>
+#include <jar/concurrency/stop_token.hpp>
+#include <jar/concurrency/then.hpp>
+#include <jar/concurrency/wait.hpp>
+#include <jar/concurrency/when_all.hpp>
+#include <jar/concurrency/when_any.hpp>
+
+namespace jar::com::test {
+
+/// \brief Test fixture for socket sender test cases
+class async_test : public reactor_test {};
+
+TEST_F(async_test, invalid_arguments)
+{
+  ipc::stream_socket client;
+  std::array<std::uint8_t, s_size> buffer{};
+
+  EXPECT_THROW(async_receive(get_reactor(), get_scheduler(), client, nullptr, s_size), std::invalid_argument);
+  EXPECT_THROW(async_receive(get_reactor(), get_scheduler(), client, buffer.data(), 0U), std::invalid_argument);
+  EXPECT_THROW(async_send(get_reactor(), get_scheduler(), client, nullptr, s_size), std::invalid_argument);
+  EXPECT_THROW(async_send(get_reactor(), get_scheduler(), client, s_data.data(), 0U), std::invalid_argument);
+}
+
+TEST_F(async_test, receive_inline)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+  EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+  std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+  // The bytes are available already, so the socket is never registered to the reactor.
+  std::array<std::uint8_t, s_size> buffer{};
+  auto const caller = std::this_thread::get_id();
+  auto future = concurrency::wait(concurrency::then(
+      async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()),
+      [caller](std::size_t received) {
+        EXPECT_NE(caller, std::this_thread::get_id());
+        return received;
+      }));
+
+  EXPECT_EQ(s_size, future.get().value());
+  EXPECT_EQ(s_data, buffer);
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+TEST_F(async_test, receive_pending)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+  server.non_blocking(true);
+
+  std::array<std::uint8_t, s_size> buffer{};
+  auto future = concurrency::wait(async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()));
+  EXPECT_EQ(1U, get_reactor().size());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+
+  EXPECT_EQ(s_size, future.get().value());
+  EXPECT_EQ(s_data, buffer);
+}
+
+TEST_F(async_test, receive_shutdown)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+  server.non_blocking(true);
+
+  std::array<std::uint8_t, s_size> buffer{};
+  auto future = concurrency::wait(async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()));
+  client.shutdown();
+
+  EXPECT_EQ(0U, future.get().value());
+}
+
+TEST_F(async_test, receive_canceled)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+  server.non_blocking(true);
+
+  concurrency::stop_source source;
+  std::array<std::uint8_t, s_size> buffer{};
+  auto future = concurrency::wait(async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()),
+                                  source.get_token());
+  EXPECT_EQ(1U, get_reactor().size());
+  source.request_stop();
+
+  // The waiting receive is canceled right away, the socket never becomes ready.
+  EXPECT_TRUE(future.get().is_canceled());
+  EXPECT_EQ(0U, get_reactor().size());
+
+  // The bytes sent after the cancellation are left to the next receive.
+  EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+  concurrency::stop_source next;
+  auto received = concurrency::wait(async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()),
+                                    next.get_token());
+  EXPECT_EQ(s_size, received.get().value());
+  EXPECT_EQ(s_data, buffer);
+}
+
+TEST_F(async_test, receive_stop_race)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+  server.non_blocking(true);
+
+  // Whichever wins, the receiver is completed or canceled exactly once.
+  std::array<std::uint8_t, s_size> buffer{};
+  for (unsigned round = 0U; round != 100U; ++round) {
+    concurrency::stop_source source;
+    auto future = concurrency::wait(
+        async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()), source.get_token());
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+    source.request_stop();
+
+    auto const result = future.get();
+    if (result.is_canceled()) {
+      EXPECT_EQ(s_size, receive_some(server, buffer.data(), buffer.size()));
+    } else {
+      EXPECT_EQ(s_size, result.value());
+    }
+  }
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+TEST_F(async_test, receive_when_any)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  // The receive on the idle socket is canceled once the other child completes.
+  std::array<std::uint8_t, s_size> buffer{};
+  auto future = concurrency::wait(
+      concurrency::when_any(async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()),
+                            concurrency::then(concurrency::schedule(get_scheduler()), []() {
+                              return s_size;
+                            })));
+
+  EXPECT_EQ(s_size, future.get().value());
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+TEST_F(async_test, receive_when_all)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  // The receive on the idle socket is canceled once the other child fails.
+  std::array<std::uint8_t, s_size> buffer{};
+  auto future = concurrency::wait(
+      concurrency::when_all(async_receive(get_reactor(), get_scheduler(), server, buffer.data(), buffer.size()),
+                            concurrency::then(concurrency::schedule(get_scheduler()), []() -> int {
+                              throw std::runtime_error{"expected test error"};
+                            })));
+
+  EXPECT_THROW(future.get(), std::runtime_error);
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+TEST_F(async_test, send)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  auto future = concurrency::wait(async_send(get_reactor(), get_scheduler(), server, s_data.data(), s_size));
+  EXPECT_EQ(s_size, future.get().value());
+
+  std::array<std::uint8_t, s_size> buffer{};
+  EXPECT_EQ(s_size, client.receive(buffer.data(), buffer.size()));
+  EXPECT_EQ(s_data, buffer);
+}
+
+TEST_F(async_test, send_error)
+{
+  ipc::stream_socket client;
+  {
+    auto server = connect(client);
+    server.shutdown();
+  }
+
+  // The peer is gone, the error is delivered as an error code instead of an exception.
+  auto future = concurrency::wait(async_send(get_reactor(), get_scheduler(), client, s_data.data(), s_size));
+  auto result = future.get();
+  EXPECT_TRUE(result.has_error());
+  EXPECT_EQ(std::errc::broken_pipe, result.error());
+}
+
+TEST_F(async_test, accept)
+{
+  auto future = concurrency::wait(async_accept(get_reactor(), get_scheduler(), server_socket()));
+  EXPECT_TRUE(server_socket().is_non_blocking());
+  EXPECT_EQ(1U, get_reactor().size());
+
+  ipc::stream_socket client;
+  client.connect(server_address());
+  auto server = std::move(future.get().value());
+
+  EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+  std::array<std::uint8_t, s_size> buffer{};
+  EXPECT_EQ(s_size, server.receive(buffer.data(), buffer.size()));
+  EXPECT_EQ(s_data, buffer);
+}
+
+}  // namespace jar::com::test
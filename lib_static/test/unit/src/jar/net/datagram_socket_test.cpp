@@ -16,7 +16,9 @@
 ///
 #include "datagram_socket_test.hpp"
 
+#include <algorithm>
 #include <future>
+#include <vector>
 
 namespace jar::com::test {
 
@@ -103,4 +105,96 @@ TEST_F(datagram_socket_test, receive_fail)
   EXPECT_THROW(std::ignore = socket.receive_from(remote_address, buffer.data(), 0U), std::invalid_argument);
 }
 
+TEST_F(datagram_socket_test, send_batch)
+{
+  ipc::address address_b{DGRAM_CHANNEL_B};
+  ipc::datagram_socket socket;
+  socket.bind(address_b);
+
+  // Every datagram gets a different part of the data.
+  std::array<ipc::address, 3U> const remote_addresses{address_a(), address_a(), address_a()};
+  std::array<const_buffer, 3U> const buffers{const_buffer{s_data.data(), 3U}, const_buffer{s_data.data() + 3U, 4U},
+                                             const_buffer{s_data.data() + 7U, s_size - 7U}};
+  EXPECT_EQ(buffers.size(), socket.send_batch(remote_addresses.data(), buffers));
+
+  for (auto const& buffer : buffers) {
+    ipc::address address_r;
+    std::array<std::uint8_t, s_size> received{};
+    EXPECT_EQ(buffer.size, socket_channel_a().receive_from(address_r, received.data(), received.size()));
+    EXPECT_EQ(address_b, address_r);
+    EXPECT_TRUE(std::equal(buffer.data, buffer.data + buffer.size, received.begin()));
+  }
+}
+
+TEST_F(datagram_socket_test, receive_batch)
+{
+  constexpr std::size_t datagram_count{4U};
+  ipc::address address_b{DGRAM_CHANNEL_B};
+  ipc::datagram_socket socket;
+  socket.bind(address_b);
+
+  for (std::size_t n = 0U; n != datagram_count; ++n) {
+    EXPECT_EQ(s_size - n, socket_channel_a().send_to(address_b, s_data.data(), s_size - n));
+  }
+
+  // The batch is larger than the queued datagrams, only the queued ones are received.
+  std::array<ipc::address, 8U> remote_addresses{};
+  std::array<std::array<std::uint8_t, s_size>, 8U> received{};
+  std::array<mutable_buffer, 8U> buffers{};
+  std::array<std::size_t, 8U> lengths{};
+  for (std::size_t n = 0U; n != buffers.size(); ++n) {
+    buffers[n] = mutable_buffer{received[n].data(), received[n].size()};
+  }
+
+  EXPECT_EQ(datagram_count, socket.receive_batch(remote_addresses.data(), buffers, lengths.data()));
+  for (std::size_t n = 0U; n != datagram_count; ++n) {
+    EXPECT_EQ(address_a(), remote_addresses[n]);
+    EXPECT_EQ(s_size - n, lengths[n]);
+    EXPECT_TRUE(std::equal(s_data.begin(), s_data.end() - n, received[n].begin()));
+  }
+}
+
+TEST_F(datagram_socket_test, batch_fail)
+{
+  ipc::datagram_socket socket;
+  std::array<std::uint8_t, s_size> buffer{};
+  std::array<ipc::address, 2U> remote_addresses{ipc::address{NO_ADDRESS}, ipc::address{}};
+  std::array<const_buffer, 2U> const send_buffers{const_buffer{s_data.data(), s_size}, const_buffer{nullptr, 1U}};
+  std::array<mutable_buffer, 2U> const receive_buffers{mutable_buffer{buffer.data(), s_size},
+                                                       mutable_buffer{buffer.data(), 0U}};
+  std::vector<const_buffer> too_many(system::posix::socket::max_batch() + 1U, const_buffer{s_data.data(), s_size});
+  std::vector<ipc::address> too_many_addresses(too_many.size(), ipc::address{NO_ADDRESS});
+  std::array<std::size_t, 2U> lengths{};
+
+  EXPECT_THROW(
+      {
+        try {
+          std::ignore = socket.send_batch(remote_addresses.data(), const_buffers{send_buffers.data(), 1U});
+        } catch (const std::system_error& e) {
+          EXPECT_EQ(ECONNREFUSED, e.code().value());
+          throw;
+        }
+      },
+      std::system_error);
+
+  EXPECT_THROW(std::ignore = socket.send_batch(nullptr, send_buffers), std::invalid_argument);
+  EXPECT_THROW(std::ignore = socket.send_batch(remote_addresses.data(), const_buffers{nullptr, 1U}),
+               std::invalid_argument);
+  EXPECT_THROW(std::ignore = socket.send_batch(remote_addresses.data(), const_buffers{send_buffers.data(), 0U}),
+               std::invalid_argument);
+  EXPECT_THROW(std::ignore = socket.send_batch(remote_addresses.data(), send_buffers), std::invalid_argument);
+  EXPECT_THROW(std::ignore = socket.send_batch(too_many_addresses.data(), too_many), std::invalid_argument);
+
+  // An empty address is rejected before anything is send.
+  std::array<const_buffer, 2U> const valid_buffers{const_buffer{s_data.data(), s_size},
+                                                   const_buffer{s_data.data(), s_size}};
+  EXPECT_THROW(std::ignore = socket.send_batch(remote_addresses.data(), valid_buffers), std::invalid_argument);
+
+  EXPECT_THROW(std::ignore = socket.receive_batch(nullptr, receive_buffers, lengths.data()), std::invalid_argument);
+  EXPECT_THROW(std::ignore = socket.receive_batch(remote_addresses.data(), receive_buffers, nullptr),
+               std::invalid_argument);
+  EXPECT_THROW(std::ignore = socket.receive_batch(remote_addresses.data(), receive_buffers, lengths.data()),
+               std::invalid_argument);
+}
+
 }  // namespace jar::com::test
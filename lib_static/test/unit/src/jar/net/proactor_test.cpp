@@ -0,0 +1,433 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file proactor_test.cpp
+///
+#include "reactor_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <jar/com/async.hpp>
+#include <jar/com/io_context.hpp>
+#include <jar/com/proactor.hpp>
+#include <jar/concurrency/stop_token.hpp>
+#include <jar/concurrency/wait.hpp>
+#include <jar/system/posix/uring.hpp>
+
+namespace jar::com::test {
+
+/// \brief Test fixture for proactor test cases, every case runs on both backends
+class proactor_test : public reactor_test {
+protected:
+  /// \brief Runs a test case on a proactor of each backend, the proactor is destroyed before the next one
+  template <typename Invocable> void for_each_backend(Invocable&& invocable)
+  {
+    for (auto const preferred : {proactor::backend::uring, proactor::backend::epoll}) {
+      SCOPED_TRACE(proactor::backend::uring == preferred ? "uring" : "epoll");
+      proactor io{8U, preferred};
+      invocable(io);
+    }
+  }
+};
+
+TEST_F(proactor_test, construct)
+{
+  EXPECT_THROW(proactor{0U}, std::invalid_argument);
+
+  proactor fallback{8U, proactor::backend::epoll};
+  EXPECT_EQ(proactor::backend::epoll, fallback.get_backend());
+
+  proactor preferred{};
+  auto const expected = system::posix::uring::is_supported() ? proactor::backend::uring : proactor::backend::epoll;
+  EXPECT_EQ(expected, preferred.get_backend());
+}
+
+TEST_F(proactor_test, invalid_arguments)
+{
+  for_each_backend([this](proactor& io) {
+    ipc::stream_socket client;
+    std::array<std::uint8_t, s_size> buffer{};
+    auto const ignore = [](std::error_code, auto&&...) {};
+
+    EXPECT_THROW(io.receive(client, nullptr, s_size, get_scheduler(), ignore), std::invalid_argument);
+    EXPECT_THROW(io.send(client, buffer.data(), 0U, get_scheduler(), ignore), std::invalid_argument);
+    EXPECT_THROW(io.receive_fixed(client, 0U, 0U, s_size, get_scheduler(), ignore), std::invalid_argument);
+    EXPECT_THROW(io.receive_multishot(client, get_scheduler(), ignore), std::invalid_argument);
+
+    proactor::buffer const registered{buffer.data(), buffer.size()};
+    EXPECT_THROW(io.register_buffers(nullptr, 1U), std::invalid_argument);
+    EXPECT_NO_THROW(io.register_buffers(&registered, 1U));
+    EXPECT_THROW(io.register_buffers(&registered, 1U), std::domain_error);
+    EXPECT_THROW(io.receive_fixed(client, 1U, 0U, s_size, get_scheduler(), ignore), std::invalid_argument);
+    EXPECT_THROW(io.receive_fixed(client, 0U, 1U, s_size, get_scheduler(), ignore), std::invalid_argument);
+
+    EXPECT_THROW(io.register_receive_buffers(0U, s_size), std::invalid_argument);
+    EXPECT_THROW(io.register_receive_buffers(4U, 0U), std::invalid_argument);
+  });
+}
+
+TEST_F(proactor_test, receive_send)
+{
+  for_each_backend([this](proactor& io) {
+    ipc::stream_socket client;
+    auto server = connect(client);
+    io.add(server);
+
+    std::array<std::uint8_t, s_size> buffer{};
+    std::promise<std::size_t> received;
+    std::promise<std::size_t> sent;
+    io.receive(client, buffer.data(), buffer.size(), get_scheduler(), [&](std::error_code error, std::size_t bytes) {
+      EXPECT_FALSE(error);
+      received.set_value(bytes);
+    });
+    io.send(server, s_data.data(), s_size, get_scheduler(), [&](std::error_code error, std::size_t bytes) {
+      EXPECT_FALSE(error);
+      sent.set_value(bytes);
+    });
+
+    EXPECT_EQ(s_size, sent.get_future().get());
+    EXPECT_EQ(s_size, received.get_future().get());
+    EXPECT_EQ(s_data, buffer);
+    io.remove(server);
+  });
+}
+
+TEST_F(proactor_test, send_error)
+{
+  for_each_backend([this](proactor& io) {
+    ipc::stream_socket client;
+    auto server = connect(client);
+    client.shutdown();
+
+    std::promise<std::error_code> failed;
+    io.send(server, s_data.data(), s_size, get_scheduler(), [&](std::error_code error, std::size_t) {
+      failed.set_value(error);
+    });
+    EXPECT_EQ(std::errc::broken_pipe, failed.get_future().get());
+  });
+}
+
+TEST_F(proactor_test, receive_fixed)
+{
+  for_each_backend([this](proactor& io) {
+    ipc::stream_socket client;
+    auto server = connect(client);
+    io.add(server);
+
+    std::array<std::uint8_t, s_size * 2U> buffer{};
+    proactor::buffer const registered{buffer.data(), buffer.size()};
+    io.register_buffers(&registered, 1U);
+
+    std::promise<std::size_t> received;
+    io.receive_fixed(server, 0U, s_size, s_size, get_scheduler(), [&](std::error_code error, std::size_t bytes) {
+      EXPECT_FALSE(error);
+      received.set_value(bytes);
+    });
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+
+    EXPECT_EQ(s_size, received.get_future().get());
+    EXPECT_TRUE(std::equal(s_data.begin(), s_data.end(), buffer.begin() + s_size));
+    io.remove(server);
+  });
+}
+
+TEST_F(proactor_test, accept)
+{
+  for_each_backend([this](proactor& io) {
+    std::promise<ipc::stream_socket> accepted;
+    io.accept(server_socket(), get_scheduler(), [&](std::error_code error, ipc::stream_socket&& socket) {
+      EXPECT_FALSE(error);
+      accepted.set_value(std::move(socket));
+    });
+
+    ipc::stream_socket client;
+    client.connect(server_address());
+    auto server = accepted.get_future().get();
+    server.non_blocking(false);
+
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+    std::array<std::uint8_t, s_size> buffer{};
+    EXPECT_EQ(s_size, server.receive(buffer.data(), buffer.size()));
+    EXPECT_EQ(s_data, buffer);
+  });
+}
+
+TEST_F(proactor_test, ready)
+{
+  for_each_backend([this](proactor& io) {
+    // The connection and the bytes are pending before the operations start, the fallback completes them right away.
+    ipc::stream_socket client;
+    client.connect(server_address());
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+
+    std::promise<ipc::stream_socket> accepted;
+    io.accept(server_socket(), get_scheduler(), [&](std::error_code error, ipc::stream_socket&& socket) {
+      EXPECT_FALSE(error);
+      accepted.set_value(std::move(socket));
+    });
+    auto server = accepted.get_future().get();
+
+    std::array<std::uint8_t, s_size> buffer{};
+    std::promise<std::size_t> received;
+    io.receive(server, buffer.data(), buffer.size(), get_scheduler(), [&](std::error_code error, std::size_t bytes) {
+      EXPECT_FALSE(error);
+      received.set_value(bytes);
+    });
+    EXPECT_EQ(s_size, received.get_future().get());
+    EXPECT_EQ(s_data, buffer);
+
+    // A completed operation can no longer be canceled.
+    std::promise<std::size_t> sent;
+    auto const started = io.send(server, s_data.data(), s_size, get_scheduler(),
+                                 [&](std::error_code error, std::size_t bytes) {
+                                   EXPECT_FALSE(error);
+                                   sent.set_value(bytes);
+                                 });
+    EXPECT_EQ(s_size, sent.get_future().get());
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_FALSE(io.cancel(started));
+  });
+}
+
+TEST_F(proactor_test, accept_multishot)
+{
+  for_each_backend([this](proactor& io) {
+    constexpr std::size_t connection_count{8U};
+    std::vector<ipc::stream_socket> accepted;
+    std::promise<void> done;
+    std::promise<std::error_code> ended;
+    io.accept_multishot(server_socket(), get_scheduler(), [&](std::error_code error, ipc::stream_socket&& socket) {
+      if (error) {
+        ended.set_value(error);
+        return;
+      }
+      accepted.emplace_back(std::move(socket));
+      if (connection_count == accepted.size()) {
+        done.set_value();
+      }
+    });
+
+    std::vector<ipc::stream_socket> clients(connection_count);
+    for (auto& client : clients) {
+      client.connect(server_address());
+    }
+    EXPECT_NO_THROW(done.get_future().get());
+
+    io.remove(server_socket());
+    EXPECT_EQ(std::errc::operation_canceled, ended.get_future().get());
+    EXPECT_EQ(connection_count, accepted.size());
+  });
+}
+
+TEST_F(proactor_test, receive_multishot)
+{
+  for_each_backend([this](proactor& io) {
+    constexpr std::size_t message_count{1000U};
+    ipc::stream_socket client;
+    auto server = connect(client);
+    io.add(server);
+
+    // Fewer and smaller buffers than the messages, so the receive runs out of buffers and goes on later.
+    io.register_receive_buffers(4U, s_size / 2U);
+
+    std::atomic_int running{0};
+    std::vector<std::uint8_t> received;
+    std::promise<std::error_code> ended;
+    auto const handler = [&](std::error_code error, std::uint8_t const* data, std::size_t bytes) {
+      EXPECT_EQ(0, running.fetch_add(1));
+      EXPECT_GE(s_size / 2U, bytes);
+      received.insert(received.end(), data, data + bytes);
+      running.fetch_sub(1);
+      if (error || 0U == bytes) {
+        ended.set_value(error);
+      }
+    };
+    io.receive_multishot(server, get_scheduler(), handler);
+
+    for (std::size_t n = 0U; n != message_count; ++n) {
+      EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+    }
+    client.shutdown();
+
+    EXPECT_FALSE(ended.get_future().get());
+    ASSERT_EQ(message_count * s_size, received.size());
+    for (std::size_t n = 0U; n != message_count; ++n) {
+      EXPECT_TRUE(std::equal(s_data.begin(), s_data.end(), received.begin() + n * s_size));
+    }
+    io.remove(server);
+  });
+}
+
+TEST_F(proactor_test, remove)
+{
+  for_each_backend([this](proactor& io) {
+    ipc::stream_socket client;
+    auto server = connect(client);
+    io.add(server);
+    io.register_receive_buffers(4U, s_size);
+
+    ipc::stream_socket other_client;
+    auto other_server = connect(other_client);
+    io.add(other_server);
+
+    std::array<std::uint8_t, s_size> buffer{};
+    std::array<std::uint8_t, s_size> other_buffer{};
+    std::promise<std::error_code> received;
+    std::promise<std::error_code> ended;
+    std::promise<std::size_t> other_received;
+    io.receive(other_server, other_buffer.data(), other_buffer.size(), get_scheduler(),
+               [&](std::error_code error, std::size_t bytes) {
+                 EXPECT_FALSE(error);
+                 other_received.set_value(bytes);
+               });
+    io.receive(server, buffer.data(), buffer.size(), get_scheduler(), [&](std::error_code error, std::size_t) {
+      received.set_value(error);
+    });
+    io.receive_multishot(server, get_scheduler(), [&](std::error_code error, std::uint8_t const*, std::size_t) {
+      ended.set_value(error);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    io.remove(server);
+    EXPECT_EQ(std::errc::operation_canceled, received.get_future().get());
+    EXPECT_EQ(std::errc::operation_canceled, ended.get_future().get());
+
+    // Only the operations of the removed socket end.
+    EXPECT_EQ(s_size, other_client.send(s_data.data(), s_size));
+    EXPECT_EQ(s_size, other_received.get_future().get());
+    io.remove(other_server);
+
+    // The socket can be added again after it has been removed.
+    io.add(server);
+    std::promise<std::size_t> resumed;
+    io.receive(server, buffer.data(), buffer.size(), get_scheduler(), [&](std::error_code error, std::size_t bytes) {
+      EXPECT_FALSE(error);
+      resumed.set_value(bytes);
+    });
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+    EXPECT_EQ(s_size, resumed.get_future().get());
+    io.remove(server);
+  });
+}
+
+TEST_F(proactor_test, cancel)
+{
+  for_each_backend([this](proactor& io) {
+    ipc::stream_socket client;
+    auto server = connect(client);
+    io.add(server);
+
+    std::array<std::uint8_t, s_size> buffer{};
+    std::promise<std::error_code> canceled;
+    std::promise<std::size_t> received;
+    auto const started = io.receive(server, buffer.data(), buffer.size(), get_scheduler(),
+                                    [&](std::error_code error, std::size_t) {
+                                      canceled.set_value(error);
+                                    });
+    io.send(server, s_data.data(), s_size, get_scheduler(), [](std::error_code error, std::size_t) {
+      EXPECT_FALSE(error);
+    });
+
+    // Only the canceled operation ends, the other operations of the socket are not affected.
+    std::array<std::uint8_t, s_size> other{};
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_EQ(s_size, receive_some(client, other.data(), other.size()));
+    EXPECT_TRUE(io.cancel(started));
+    EXPECT_EQ(std::errc::operation_canceled, canceled.get_future().get());
+
+    io.receive(server, buffer.data(), buffer.size(), get_scheduler(), [&](std::error_code error, std::size_t bytes) {
+      EXPECT_FALSE(error);
+      received.set_value(bytes);
+    });
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+    EXPECT_EQ(s_size, received.get_future().get());
+
+    // The operation has finished and its slot may have been reused.
+    EXPECT_FALSE(io.cancel(started));
+    io.remove(server);
+  });
+}
+
+TEST_F(proactor_test, destroy_pending)
+{
+  // The sockets outlive the proactors, closing them would complete the receives.
+  ipc::stream_socket client;
+  auto server = connect(client);
+  std::array<std::uint8_t, s_size> buffer{};
+
+  for_each_backend([&](proactor& io) {
+    // The proactor drops the pending operation without invoking its handler.
+    io.receive(server, buffer.data(), buffer.size(), get_scheduler(), [](std::error_code, std::size_t) {
+      ADD_FAILURE();
+    });
+  });
+}
+
+TEST_F(proactor_test, io_context)
+{
+  EXPECT_TRUE((std::is_same_v<reactor, io_context_t<ipc::stream_socket>>));
+  EXPECT_TRUE((std::is_same_v<reactor, io_context_t<system::posix::socket>>));
+  EXPECT_TRUE((std::is_same_v<proactor, io_context_t<ipc::uring::stream_socket>>));
+  EXPECT_TRUE((std::is_same_v<proactor, io_context_t<ipc::uring::datagram_socket>>));
+}
+
+TEST_F(proactor_test, async)
+{
+  for_each_backend([this](proactor& io) {
+    auto accepted = concurrency::wait(async_accept(io, get_scheduler(), server_socket()));
+
+    ipc::uring::stream_socket client;
+    client.connect(server_address());
+    auto server = std::move(accepted.get().value());
+    io.add(server);
+
+    std::array<std::uint8_t, s_size> buffer{};
+    auto received = concurrency::wait(async_receive(io, get_scheduler(), server, buffer.data(), buffer.size()));
+    auto sent = concurrency::wait(async_send(io, get_scheduler(), client, s_data.data(), s_size));
+
+    EXPECT_EQ(s_size, sent.get().value());
+    EXPECT_EQ(s_size, received.get().value());
+    EXPECT_EQ(s_data, buffer);
+
+    // A pending receive completes with the error code once its socket is removed.
+    auto canceled = concurrency::wait(async_receive(io, get_scheduler(), server, buffer.data(), buffer.size()));
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    io.remove(server);
+    auto const result = canceled.get();
+    ASSERT_TRUE(result.has_error());
+    EXPECT_EQ(std::errc::operation_canceled, result.error());
+
+    // A stop request cancels the pending receive without removing its socket.
+    io.add(server);
+    concurrency::stop_source source;
+    auto stopped = concurrency::wait(async_receive(io, get_scheduler(), server, buffer.data(), buffer.size()),
+                                     source.get_token());
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    source.request_stop();
+    EXPECT_TRUE(stopped.get().is_canceled());
+
+    auto resumed = concurrency::wait(async_receive(io, get_scheduler(), server, buffer.data(), buffer.size()));
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+    EXPECT_EQ(s_size, resumed.get().value());
+    io.remove(server);
+  });
+}
+
+}  // namespace jar::com::test
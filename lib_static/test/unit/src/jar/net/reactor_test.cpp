@@ -0,0 +1,263 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file reactor_test.cpp
+///
+#include "reactor_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace jar::com::test {
+
+TEST_F(reactor_test, construct)
+{
+  EXPECT_THROW(reactor{0U}, std::invalid_argument);
+  EXPECT_NO_THROW(reactor{2U});
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+TEST_F(reactor_test, receive)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  std::array<std::uint8_t, s_size> buffer{};
+  std::size_t received{0U};
+  std::promise<std::thread::id> done;
+
+  auto const registered =
+      get_reactor().add(server, reactor::readable, get_scheduler(), [&](reactor::event_mask events) {
+        EXPECT_NE(0U, events & reactor::readable);
+        received += receive_some(server, buffer.data() + received, buffer.size() - received);
+        if (s_size == received) {
+          done.set_value(std::this_thread::get_id());
+        }
+      });
+  EXPECT_TRUE(server.is_non_blocking());
+  EXPECT_EQ(1U, get_reactor().size());
+
+  // Send in two parts, the handler is dispatched again for the second edge.
+  EXPECT_EQ(5U, client.send(s_data.data(), 5U));
+  std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  EXPECT_EQ(s_size - 5U, client.send(s_data.data() + 5U, s_size - 5U));
+
+  EXPECT_NE(std::this_thread::get_id(), done.get_future().get());
+  EXPECT_EQ(s_data, buffer);
+  EXPECT_TRUE(get_reactor().remove(registered));
+}
+
+TEST_F(reactor_test, accept)
+{
+  constexpr std::size_t connection_count{8U};
+  std::vector<ipc::stream_socket> accepted;
+  bool is_done{false};
+  std::promise<void> done;
+
+  auto const registered =
+      get_reactor().add(server_socket(), reactor::readable, get_scheduler(), [&](reactor::event_mask) {
+        try {
+          for (;;) {
+            server_socket().accept([&accepted](ipc::stream_socket&& socket) {
+              accepted.emplace_back(std::move(socket));
+            });
+          }
+        } catch (std::system_error const& e) {
+          EXPECT_EQ(EAGAIN, e.code().value());
+        }
+        // Edges that arrive while the handler runs dispatch it again after all connections have been accepted.
+        if (connection_count == accepted.size() && !is_done) {
+          is_done = true;
+          done.set_value();
+        }
+      });
+
+  std::vector<ipc::stream_socket> clients(connection_count);
+  for (auto& client : clients) {
+    client.connect(server_address());
+  }
+
+  EXPECT_NO_THROW(done.get_future().get());
+  EXPECT_TRUE(get_reactor().remove(registered));
+}
+
+TEST_F(reactor_test, receive_from)
+{
+  ipc::address address_a{DGRAM_CHANNEL_A};
+  ipc::address address_b{DGRAM_CHANNEL_B};
+  ipc::datagram_socket socket_a;
+  ipc::datagram_socket socket_b;
+  socket_a.bind(address_a);
+  socket_b.bind(address_b);
+
+  std::promise<void> done;
+  auto const registered = get_reactor().add(socket_b, reactor::readable, get_scheduler(), [&](reactor::event_mask) {
+    ipc::address address_r;
+    std::array<std::uint8_t, s_size> buffer{};
+    EXPECT_EQ(s_size, socket_b.receive_from(address_r, buffer.data(), buffer.size()));
+    EXPECT_EQ(address_a, address_r);
+    EXPECT_EQ(s_data, buffer);
+    done.set_value();
+  });
+
+  EXPECT_EQ(s_size, socket_a.send_to(address_b, s_data.data(), s_size));
+  EXPECT_NO_THROW(done.get_future().get());
+  EXPECT_TRUE(get_reactor().remove(registered));
+}
+
+TEST_F(reactor_test, remove)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  std::atomic_size_t invoked{0U};
+  auto const registered = get_reactor().add(server, reactor::readable, get_scheduler(), [&](reactor::event_mask) {
+    invoked.fetch_add(1U);
+  });
+
+  EXPECT_TRUE(get_reactor().remove(registered));
+  EXPECT_FALSE(get_reactor().remove(registered));
+  EXPECT_FALSE(get_reactor().remove(reactor::handle{registered.index, registered.generation + 1U}));
+  EXPECT_EQ(0U, get_reactor().size());
+
+  EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+  std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  EXPECT_EQ(0U, invoked.load());
+}
+
+TEST_F(reactor_test, remove_from_handler)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  std::promise<bool> removed;
+  auto registered = std::make_shared<reactor::handle>();
+  *registered = get_reactor().add(server, reactor::readable, get_scheduler(), [&, registered](reactor::event_mask) {
+    removed.set_value(get_reactor().remove(*registered));
+  });
+
+  EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+  EXPECT_TRUE(removed.get_future().get());
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+TEST_F(reactor_test, remove_by_own_handle)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  std::promise<bool> removed;
+  get_reactor().add(server, reactor::readable, get_scheduler(), [&](reactor::event_mask, reactor::handle registered) {
+    std::array<std::uint8_t, s_size> buffer{};
+    EXPECT_EQ(s_size, receive_some(server, buffer.data(), buffer.size()));
+    removed.set_value(get_reactor().remove(registered));
+  });
+
+  EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+  EXPECT_TRUE(removed.get_future().get());
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+TEST_F(reactor_test, closed)
+{
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  std::promise<reactor::event_mask> done;
+  auto const registered =
+      get_reactor().add(server, reactor::readable, get_scheduler(), [&](reactor::event_mask events) {
+        std::array<std::uint8_t, s_size> buffer{};
+        EXPECT_EQ(0U, receive_some(server, buffer.data(), buffer.size()));
+        done.set_value(events);
+      });
+
+  client.shutdown();
+  EXPECT_NE(0U, done.get_future().get() & reactor::closed);
+  EXPECT_TRUE(get_reactor().remove(registered));
+}
+
+TEST_F(reactor_test, serialized_handler)
+{
+  constexpr std::size_t message_count{1000U};
+  ipc::stream_socket client;
+  auto server = connect(client);
+
+  std::atomic_int running{0};
+  std::size_t received{0U};
+  std::promise<void> done;
+  auto const registered = get_reactor().add(server, reactor::readable, get_scheduler(), [&](reactor::event_mask) {
+    EXPECT_EQ(0, running.fetch_add(1));
+    std::array<std::uint8_t, s_size * 16U> buffer{};
+    for (auto bytes = receive_some(server, buffer.data(), buffer.size()); 0U != bytes;
+         bytes = receive_some(server, buffer.data(), buffer.size())) {
+      received += bytes;
+    }
+    running.fetch_sub(1);
+    if (message_count * s_size == received) {
+      done.set_value();
+    }
+  });
+
+  for (std::size_t n = 0U; n != message_count; ++n) {
+    EXPECT_EQ(s_size, client.send(s_data.data(), s_size));
+  }
+  EXPECT_NO_THROW(done.get_future().get());
+  EXPECT_TRUE(get_reactor().remove(registered));
+}
+
+TEST_F(reactor_test, idle_connections)
+{
+  constexpr std::size_t connection_count{512U};
+
+  struct connection {
+    ipc::stream_socket client;
+    std::optional<ipc::stream_socket> server;
+    reactor::handle registered;
+    std::atomic_size_t received{0U};
+  };
+
+  std::vector<std::unique_ptr<connection>> connections;
+  std::atomic_size_t active{0U};
+  std::promise<void> done;
+  for (std::size_t n = 0U; n != connection_count; ++n) {
+    auto& added = *connections.emplace_back(std::make_unique<connection>());
+    added.server.emplace(connect(added.client));
+    added.registered = get_reactor().add(*added.server, reactor::readable, get_scheduler(), [&](reactor::event_mask) {
+      std::array<std::uint8_t, s_size> buffer{};
+      auto const bytes = receive_some(*added.server, buffer.data(), buffer.size());
+      if (0U == added.received.fetch_add(bytes) && connection_count / 8U == active.fetch_add(1U) + 1U) {
+        done.set_value();
+      }
+    });
+  }
+  EXPECT_EQ(connection_count, get_reactor().size());
+
+  // Only every eighth connection wakes up, the rest stay idle.
+  for (std::size_t n = 0U; n < connection_count; n += 8U) {
+    EXPECT_EQ(s_size, connections[n]->client.send(s_data.data(), s_size));
+  }
+  EXPECT_NO_THROW(done.get_future().get());
+
+  for (std::size_t n = 0U; n != connection_count; ++n) {
+    EXPECT_EQ(0U == n % 8U ? s_size : 0U, connections[n]->received.load());
+    EXPECT_TRUE(get_reactor().remove(connections[n]->registered));
+  }
+  EXPECT_EQ(0U, get_reactor().size());
+}
+
+}  // namespace jar::com::test
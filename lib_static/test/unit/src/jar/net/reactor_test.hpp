@@ -0,0 +1,115 @@
+/// Copyright 2022 Jani Arola, All rights reserved.
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// \file reactor_test.hpp
+
+#ifndef JAR_NET_REACTOR_TEST_HPP
+#define JAR_NET_REACTOR_TEST_HPP
+
+#include "basic_socket_test.hpp"
+
+#include <cerrno>
+#include <optional>
+#include <system_error>
+
+#include <jar/com/ipc/ipc.hpp>
+#include <jar/com/reactor.hpp>
+#include <jar/concurrency/thread_pool.hpp>
+#include <jar/concurrency/ws_scheduler.hpp>
+
+namespace jar::com::test {
+
+/// \brief Test fixture for reactor test cases
+class reactor_test : public basic_socket_test {
+protected:
+  /// \brief Constructor
+  reactor_test()
+    : m_pool{4U}
+    , m_reactor{}
+    , m_server_socket{}
+    , m_server_address{SOCKET_ADDRESS}
+  {
+  }
+
+  /// \brief Sets up the test fixture
+  void SetUp() override
+  {
+    m_server_socket.bind(m_server_address);
+    m_server_socket.listen();
+  }
+
+  /// \brief Tears down the test fixture
+  void TearDown() override { m_server_socket.shutdown(); }
+
+  /// \brief Connects a client to the test server
+  ///
+  /// \param[out] client      Connected client socket
+  ///
+  /// \return Server side of the connection
+  ipc::stream_socket connect(ipc::stream_socket& client)
+  {
+    client.connect(m_server_address);
+
+    std::optional<ipc::stream_socket> accepted;
+    m_server_socket.accept([&accepted](ipc::stream_socket&& socket) {
+      accepted.emplace(std::move(socket));
+    });
+    return std::move(accepted.value());
+  }
+
+  /// \brief Receives until the buffer is full or the socket would block
+  ///
+  /// \return Number of bytes received
+  static std::size_t receive_some(ipc::stream_socket& socket, std::uint8_t* buffer, std::size_t length)
+  {
+    std::size_t received{0U};
+    try {
+      while (received != length) {
+        auto const bytes = socket.receive(buffer + received, length - received);
+        if (0U == bytes) {
+          break;
+        }
+        received += bytes;
+      }
+    } catch (std::system_error const& e) {
+      if (EAGAIN != e.code().value()) {
+        throw;
+      }
+    }
+    return received;
+  }
+
+  /// \brief Gets the reactor under test
+  reactor& get_reactor() noexcept { return m_reactor; }
+
+  /// \brief Gets the scheduler the handlers are dispatched onto
+  auto get_scheduler() noexcept { return m_pool.get_scheduler(); }
+
+  /// \brief Gets the test server socket
+  ipc::stream_server_socket& server_socket() noexcept { return m_server_socket; }
+
+  /// \brief Get test server address
+  const ipc::address& server_address() const noexcept { return m_server_address; }
+
+private:
+  // The reactor is destroyed first, it waits for the handlers dispatched onto the pool.
+  concurrency::thread_pool<concurrency::ws_scheduler> m_pool;
+  reactor m_reactor;
+  ipc::stream_server_socket m_server_socket;
+  ipc::address m_server_address;
+};
+
+}  // namespace jar::com::test
+
+#endif  // JAR_NET_REACTOR_TEST_HPP
@@ -17,6 +17,7 @@
 #include <jar/com/stream_socket.hpp>
 
 #include <thread>
+#include <vector>
 
 #include "stream_socket_test.hpp"
 
@@ -281,4 +282,120 @@ TEST_F(stream_socket_test, send_buffer)
       std::system_error);
 }
 
+TEST_F(stream_socket_test, send_segments)
+{
+  auto connect = std::make_shared<std::promise<void>>();
+  auto connecting = connect->get_future();
+
+  auto closing = async_accept([connect = std::move(connect)](ipc::stream_socket&& client_socket) mutable {
+    connect->set_value();
+
+    // The segments arrive as one contiguous stream.
+    std::array<std::uint8_t, s_size> receive_buffer{};
+    std::size_t received{0U};
+    while (received != s_size) {
+      received += client_socket.receive(receive_buffer.data() + received, receive_buffer.size() - received);
+    }
+    EXPECT_EQ(s_data, receive_buffer);
+
+    client_socket.shutdown();
+  });
+
+  ipc::stream_socket socket;
+  socket.connect(server_address());
+  EXPECT_NO_THROW(connecting.get());
+
+  // A header and a payload are sent with a single call.
+  std::array<const_buffer, 2U> const segments{const_buffer{s_data.data(), 5U},
+                                              const_buffer{s_data.data() + 5U, s_size - 5U}};
+  EXPECT_EQ(s_size, socket.send(segments));
+
+  EXPECT_NO_THROW(closing.get());
+}
+
+TEST_F(stream_socket_test, receive_segments)
+{
+  auto connect = std::make_shared<std::promise<void>>();
+  auto connecting = connect->get_future();
+
+  auto closing = async_accept([connect = std::move(connect)](ipc::stream_socket&& client_socket) mutable {
+    connect->set_value();
+    EXPECT_EQ(s_size, client_socket.send(s_data.data(), s_size));
+    client_socket.shutdown();
+  });
+
+  ipc::stream_socket socket;
+  socket.connect(server_address());
+  EXPECT_NO_THROW(connecting.get());
+  EXPECT_NO_THROW(closing.get());
+
+  // The bytes fill the header first and the rest goes to the payload.
+  std::array<std::uint8_t, 5U> header{};
+  std::array<std::uint8_t, s_size> payload{};
+  std::array<mutable_buffer, 2U> const segments{mutable_buffer{header.data(), header.size()},
+                                                mutable_buffer{payload.data(), payload.size()}};
+  EXPECT_EQ(s_size, socket.receive(segments));
+  EXPECT_TRUE(std::equal(header.begin(), header.end(), s_data.begin()));
+  EXPECT_TRUE(std::equal(s_data.begin() + header.size(), s_data.end(), payload.begin()));
+
+  std::error_code error;
+  EXPECT_EQ(0U, socket.receive(segments, error));
+  EXPECT_FALSE(error);
+}
+
+TEST_F(stream_socket_test, send_segments_partial)
+{
+  // Create buffer that is larger than '/proc/sys/net/core/wmem_default'
+  static constexpr std::size_t wmem_default{212992U};
+  std::vector<std::uint8_t> buffer(4U * wmem_default, 'A');
+
+  ipc::stream_socket socket;
+  socket.non_blocking(true);
+  socket.connect(server_address());
+
+  // The send buffer fills up in the middle of the second segment, the bytes sent so far are reported.
+  std::array<const_buffer, 3U> const segments{const_buffer{s_data.data(), s_size},
+                                              const_buffer{buffer.data(), buffer.size()},
+                                              const_buffer{s_data.data(), s_size}};
+  std::error_code error;
+  auto const sent = socket.send(segments, error);
+  EXPECT_FALSE(error);
+  EXPECT_LT(s_size, sent);
+  EXPECT_GT(s_size + buffer.size(), sent);
+
+  EXPECT_EQ(0U, socket.send(segments, error));
+  EXPECT_EQ(std::errc::operation_would_block, error);
+}
+
+TEST_F(stream_socket_test, segments_fail)
+{
+  ipc::stream_socket socket;
+  std::array<std::uint8_t, s_size> buffer{};
+  std::array<const_buffer, 2U> send_segments{const_buffer{s_data.data(), s_size}, const_buffer{s_data.data(), 0U}};
+  std::array<mutable_buffer, 2U> receive_segments{mutable_buffer{buffer.data(), s_size}, mutable_buffer{nullptr, 1U}};
+  std::vector<const_buffer> too_many(system::posix::socket::max_segments() + 1U, const_buffer{s_data.data(), s_size});
+
+  EXPECT_THROW(
+      {
+        try {
+          socket.send(const_buffers{send_segments.data(), 1U});
+        } catch (const std::system_error& e) {
+          EXPECT_EQ(ENOTCONN, e.code().value());
+          throw;
+        }
+      },
+      std::system_error);
+
+  EXPECT_THROW(socket.send(const_buffers{nullptr, 1U}), std::invalid_argument);
+  EXPECT_THROW(socket.send(const_buffers{send_segments.data(), 0U}), std::invalid_argument);
+  EXPECT_THROW(socket.send(send_segments), std::invalid_argument);
+  EXPECT_THROW(socket.send(too_many), std::invalid_argument);
+  too_many.pop_back();
+  std::error_code error;
+  EXPECT_NO_THROW(socket.send(too_many, error));
+  EXPECT_EQ(std::errc::not_connected, error);
+  EXPECT_THROW(socket.receive(mutable_buffers{nullptr, 1U}), std::invalid_argument);
+  EXPECT_THROW(socket.receive(receive_segments), std::invalid_argument);
+}
+
 }  // namespace jar::com::test